@@ -0,0 +1,120 @@
+#include "VPPBenchmark.h"
+
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include "VPPException.h"
+
+// Ctor
+VPPBenchmark::VPPBenchmark(double minTime, const string& filter) :
+	minTime_(minTime),
+	filter_(filter) {
+
+}
+
+// Dtor
+VPPBenchmark::~VPPBenchmark() {
+
+}
+
+// Run and time a case
+void VPPBenchmark::run(const string& name, std::function<void()> f, bool repeat) {
+
+	if(!isSelected(name))
+		return;
+
+	std::cout<<"Running benchmark "<<name<<"..."<<std::endl;
+
+	// Run once out of the timer, to warm up the caches. The full runs
+	// are too long to be worth it
+	if(repeat)
+		f();
+
+	size_t nIterations=0;
+	double elapsed=0;
+	std::chrono::steady_clock::time_point start= std::chrono::steady_clock::now();
+	do {
+		f();
+		nIterations++;
+		elapsed= std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	} while(repeat && elapsed<minTime_);
+
+	BenchmarkResult result;
+	result.name_= name;
+	result.nIterations_= nIterations;
+	result.timePerIteration_= elapsed * 1.e9 / nIterations;
+	result.resultDeviation_= NAN;
+	results_.push_back(result);
+}
+
+// Set the deviation of the results of the last case run
+void VPPBenchmark::setResultDeviation(double deviation) {
+	if(results_.size())
+		results_.back().resultDeviation_= deviation;
+}
+
+// Is a case selected by the filter?
+bool VPPBenchmark::isSelected(const string& name) const {
+	return name.find(filter_) != string::npos;
+}
+
+// Write the timings in csv format
+void VPPBenchmark::write(FILE* outStream) const {
+
+	fprintf(outStream,"name,iterations,ns_per_iteration,result_deviation\n");
+	for(size_t i=0; i<results_.size(); i++)
+		fprintf(outStream,"%s,%zu,%.6e,%.6e\n",
+				results_[i].name_.c_str(),
+				results_[i].nIterations_,
+				results_[i].timePerIteration_,
+				results_[i].resultDeviation_);
+}
+
+// Compare the timings with the ones of a baseline csv file
+size_t VPPBenchmark::compare(const string& baselineFile, double tolerance) const {
+
+	std::ifstream in(baselineFile.c_str());
+	if(!in) {
+		char msg[256];
+		sprintf(msg,"Cannot read the benchmark baseline \'%s\'",baselineFile.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	// Read the baseline timings, skipping the header
+	std::map<string,double> baseline;
+	string line;
+	std::getline(in,line);
+	while(std::getline(in,line)) {
+		std::stringstream ss(line);
+		string name, nIterations, time;
+		if(std::getline(ss,name,',') && std::getline(ss,nIterations,',') && std::getline(ss,time,','))
+			baseline[name]= atof(time.c_str());
+	}
+
+	printf("\n%-40s %14s %14s %8s\n","Benchmark","Time [ns]","Baseline [ns]","Ratio");
+
+	size_t nRegressions=0;
+	for(size_t i=0; i<results_.size(); i++) {
+
+		std::map<string,double>::const_iterator it= baseline.find(results_[i].name_);
+		if(it==baseline.end()) {
+			printf("%-40s %14.6e %14s %8s\n",results_[i].name_.c_str(),results_[i].timePerIteration_,"-","-");
+			continue;
+		}
+
+		double ratio= results_[i].timePerIteration_ / it->second;
+		bool isRegression= ratio > 1 + tolerance;
+		if(isRegression)
+			nRegressions++;
+
+		printf("%-40s %14.6e %14.6e %8.3f %s\n",results_[i].name_.c_str(),
+				results_[i].timePerIteration_,it->second,ratio,
+				isRegression ? "REGRESSION" : "");
+	}
+
+	return nRegressions;
+}
@@ -0,0 +1,75 @@
+#ifndef VPP_BENCHMARK_H
+#define VPP_BENCHMARK_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+/// Timing of a benchmark case
+struct BenchmarkResult {
+
+	/// Name of the case
+	string name_;
+
+	/// Number of times the case was run
+	size_t nIterations_;
+
+	/// Average wall time of a run [ns]
+	double timePerIteration_;
+
+	/// Max deviation of the state vectors computed by the case from a
+	/// baseline result file. NAN when the case was not compared
+	double resultDeviation_;
+};
+
+/// Lightweight benchmark harness used to time the VPP model and solvers.
+/// Each case is repeated until a minimum wall time is reached, and the
+/// average time per iteration is written to a csv file that can be
+/// compared against a stored baseline:
+///   name,iterations,ns_per_iteration,result_deviation
+class VPPBenchmark {
+
+	public:
+
+		/// Ctor. Each case is repeated for at least minTime seconds. Only the
+		/// cases the name of which contains filter are run
+		VPPBenchmark(double minTime=0.5, const string& filter="");
+
+		/// Dtor
+		~VPPBenchmark();
+
+		/// Run and time a case. If repeat is false, the case is run once:
+		/// this is meant for the full wind grid runs
+		void run(const string& name, std::function<void()> f, bool repeat=true);
+
+		/// Set the deviation of the results of the last case run
+		void setResultDeviation(double);
+
+		/// Is a case selected by the filter?
+		bool isSelected(const string& name) const;
+
+		/// Write the timings in csv format
+		void write(FILE* outStream) const;
+
+		/// Compare the timings with the ones of a baseline csv file, and
+		/// print the comparison. A case slower than the baseline by more
+		/// than the relative tolerance is a regression. Returns the number
+		/// of regressions. Throws if the baseline cannot be read
+		size_t compare(const string& baselineFile, double tolerance) const;
+
+	private:
+
+		/// Minimum time each case is repeated for [s]
+		double minTime_;
+
+		/// Only the cases the name of which contains the filter are run
+		string filter_;
+
+		/// Timings of the cases run so far
+		std::vector<BenchmarkResult> results_;
+};
+
+#endif
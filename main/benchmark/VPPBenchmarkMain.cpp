@@ -0,0 +1,379 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+#include <limits>
+#include <getopt.h>
+
+using namespace std;
+
+// ------------------------
+// Directives for EIGEN
+#include <Eigen/Core>
+using namespace Eigen;
+
+#include "VPPBenchmark.h"
+#include "VariableFileParser.h"
+#include "SailSet.h"
+#include "VPPItemFactory.h"
+#include "VPPException.h"
+#include "VPPJacobian.h"
+#include "VPPGradient.h"
+#include "VPPHessian.h"
+#include "NRSolver.h"
+#include "Interpolator.h"
+#include "VPPResultIO.h"
+#include "VPPSolverFactoryBase.h"
+#include "VPPJobRunner.h"
+
+// Print the usage of the benchmark program
+void printUsage(const char* programName) {
+
+	std::cout<<"\nUsage: "<<programName<<" [options]"<<std::endl;
+	std::cout<<"  Run from the root of the repository, where the folder testFiles is"<<std::endl;
+	std::cout<<"Options:"<<std::endl;
+	std::cout<<"  -v variableFile   : Default : testFiles/variableFile_ipOptFullTest.txt"<<std::endl;
+	std::cout<<"  -c sailCoeffFile  : Default : testFiles/sailCoeffs.sailCoeff"<<std::endl;
+	std::cout<<"  -r resultBaseline : results the full runs are compared to."<<std::endl;
+	std::cout<<"                      Default : testFiles/vppRunTest_baseline.vpp"<<std::endl;
+	std::cout<<"  -o outFile        : csv file the timings are written to. Default : vppBenchmark.csv"<<std::endl;
+	std::cout<<"  -b baseline       : csv file of a previous run the timings are compared to"<<std::endl;
+	std::cout<<"  -t tolerance      : relative slow-down reported as a regression. Default : 0.2"<<std::endl;
+	std::cout<<"  -m minTime        : min time each case is repeated for [s]. Default : 0.5"<<std::endl;
+	std::cout<<"  -f filter         : only run the cases the name of which contains filter"<<std::endl;
+	std::cout<<"  -h                : print this message\n"<<std::endl;
+}
+
+// Instantiate the items and load the sail coefficients
+VPPItemFactory* makeItems(VariableFileParser& parser, std::shared_ptr<SailSet> pSails, const string& sailCoeffFile) {
+
+	VPPItemFactory* pVppItems= new VPPItemFactory(&parser,pSails);
+
+	SailCoefficientItem* pSailCoeffItem= pVppItems->getSailCoefficientItem();
+	pSailCoeffItem->getClIO()->parse( sailCoeffFile );
+	pSailCoeffItem->getCdIO()->parse( sailCoeffFile );
+	pSailCoeffItem->interpolateCoeffs();
+	pVppItems->clearCache();
+
+	return pVppItems;
+}
+
+// Max deviation of the state vectors of the results from the baseline results.
+// Only the points that are valid in both containers are compared
+double getResultDeviation(ResultContainer* pResults, ResultContainer& baseline) {
+
+	double deviation=0;
+	for(size_t iWv=0; iWv<baseline.windVelocitySize(); iWv++)
+		for(size_t iWa=0; iWa<baseline.windAngleSize(); iWa++) {
+			if(pResults->discard(iWv,iWa) || baseline.discard(iWv,iWa))
+				continue;
+			Eigen::VectorXd x= *pResults->get(iWv,iWa).getX();
+			Eigen::VectorXd baseX= *baseline.get(iWv,iWa).getX();
+			deviation= std::max(deviation, (x - baseX).cwiseAbs().maxCoeff());
+		}
+
+	return deviation;
+}
+
+// MAIN : time the model, the derivatives and the solvers
+int main(int argc, char* argv[]) {
+
+	string variableFile("testFiles/variableFile_ipOptFullTest.txt");
+	string sailCoeffFile("testFiles/sailCoeffs.sailCoeff");
+	string resultBaseline("testFiles/vppRunTest_baseline.vpp");
+	string outFile("vppBenchmark.csv"), baselineFile, filter;
+	double tolerance=0.2, minTime=0.5;
+
+	int opt;
+	while( (opt=getopt(argc,argv,"v:c:r:o:b:t:m:f:h")) != -1 ) {
+		switch(opt) {
+		case 'v' :
+			variableFile= optarg;
+			break;
+		case 'c' :
+			sailCoeffFile= optarg;
+			break;
+		case 'r' :
+			resultBaseline= optarg;
+			break;
+		case 'o' :
+			outFile= optarg;
+			break;
+		case 'b' :
+			baselineFile= optarg;
+			break;
+		case 't' :
+			tolerance= atof(optarg);
+			break;
+		case 'm' :
+			minTime= atof(optarg);
+			break;
+		case 'f' :
+			filter= optarg;
+			break;
+		case 'h' :
+			printUsage(argv[0]);
+			return 0;
+		default:
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	try {
+
+		VariableFileParser parser;
+		parser.parse(variableFile);
+		parser.check();
+
+		std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+		std::shared_ptr<VPPItemFactory> pVppItems( makeItems(parser,pSails,sailCoeffFile) );
+
+		// Import the baseline results the full runs are compared to
+		ResultContainer baselineResults(pVppItems->getWind());
+		VPPResultIO reader(&parser, &baselineResults);
+		reader.parse(resultBaseline);
+
+		VPPBenchmark benchmark(minTime,filter);
+
+		// State vector and wind indices of the model benchmarks
+		Eigen::VectorXd x(4);
+		x << 2, 0.4, 2, .9;
+		int twv=3, twa=6;
+
+		// -- MODEL
+
+		// Disable the cache of the residuals, otherwise we only time the lookup
+		pVppItems->setCacheSize(0);
+		benchmark.run("VPPItemFactory::getResiduals", [&]() {
+			pVppItems->getResiduals(twv,twa,x);
+		});
+
+		pVppItems->setCompiled(true);
+		benchmark.run("VPPItemFactory::getResiduals_compiled", [&]() {
+			pVppItems->getResiduals(twv,twa,x);
+		});
+		pVppItems->setCompiled(false);
+
+		// A batch of 64 states around x, to be compared with 64 single evaluations
+		StateBatch states(64);
+		for(size_t i=0; i<states.size(); i++) {
+			Eigen::VectorXd xi(x);
+			xi(0)+= 0.01*i;
+			states.set(i,xi);
+		}
+		benchmark.run("VPPItemFactory::getResiduals_batch64", [&]() {
+			pVppItems->getResiduals(twv,twa,states);
+		});
+
+		pVppItems->setCacheSize(32);
+		benchmark.run("VPPItemFactory::getResiduals_cached", [&]() {
+			pVppItems->getResiduals(twv,twa,x);
+		});
+
+		// The induced resistance combines two splines built once, rather than
+		// rebuilding the spline of the effective span at each update
+		InducedResistanceItem* pInduced= pVppItems->getInducedResistanceItem();
+		WindCondition wc= pVppItems->getWind()->getWindCondition(twv,twa);
+		benchmark.run("InducedResistanceItem::update", [&]() {
+			pInduced->updateSolution(wc,x);
+		});
+
+		Eigen::ArrayXd phiD(4), Te(4);
+		phiD << 0, 10, 20, 30;
+		phiD *= ( M_PI / 180.0);
+		Te << 1.2, 1.5, 1.6, 1.55;
+		double teSum=0;
+		benchmark.run("SplineInterpolator::build", [&]() {
+			SplineInterpolator interpolator(phiD,Te);
+			teSum+= interpolator.interpolate(x(1));
+		});
+
+		// Spline through a smooth curve, evaluated all over its range
+		Eigen::ArrayXd xs(10), ys(10);
+		for(size_t i=0; i<10; i++) {
+			xs(i)= i;
+			ys(i)= std::sin(0.3*i);
+		}
+		SplineInterpolator spline(xs,ys);
+		double sum=0, xi=0;
+		benchmark.run("SplineInterpolator::interpolate", [&]() {
+			xi+= 0.001;
+			if(xi>9) xi=0;
+			sum+= spline.interpolate(xi);
+		});
+
+		// -- DERIVATIVES
+
+		pVppItems->setCacheSize(0);
+
+		VPPJacobian jFD(x,pVppItems.get(),2,4);
+		benchmark.run("VPPJacobian::run_fd", [&]() {
+			jFD.run(twv,twa);
+		});
+
+		pVppItems->setCompiled(true);
+		benchmark.run("VPPJacobian::run_fd_batch", [&]() {
+			jFD.run(twv,twa);
+		});
+		pVppItems->setCompiled(false);
+
+		VPPJacobian jAD(x,pVppItems.get(),2,4,automaticDifferentiation);
+		benchmark.run("VPPJacobian::run_ad", [&]() {
+			jAD.run(twv,twa);
+		});
+
+		VPPHessian hessian(x,pVppItems.get());
+		benchmark.run("VPPHessian::run", [&]() {
+			hessian.run(twv,twa);
+		});
+
+		pVppItems->setCacheSize(32);
+
+		// The gradient is computed at equilibrium
+		NRSolver solver(pVppItems.get(),4,2);
+		Eigen::VectorXd xEq(x);
+		xEq= solver.run(twv,twa,xEq);
+
+		VPPGradient gNewton(xEq,pVppItems.get());
+		benchmark.run("VPPGradient::run_newton", [&]() {
+			gNewton.run(twv,twa);
+		});
+
+		VPPGradient gIFT(xEq,pVppItems.get(),implicitFunctionTheorem);
+		benchmark.run("VPPGradient::run_ift", [&]() {
+			gIFT.run(twv,twa);
+		});
+
+		// -- SOLVERS
+
+		benchmark.run("NRSolver::run", [&]() {
+			Eigen::VectorXd xGuess(x);
+			pVppItems->clearCache();
+			solver.run(twv,twa,xGuess);
+		});
+
+		// Warm-started from the neighbouring wind velocity, whose Jacobian is reused
+		NRSolver broyden(pVppItems.get(),4,2);
+		broyden.setMode(nrBroyden);
+		Eigen::VectorXd xNeighbour(x);
+		xNeighbour= broyden.run(twv-1,twa,xNeighbour);
+		benchmark.run("NRSolver::run_broyden", [&]() {
+			Eigen::VectorXd xGuess(xNeighbour);
+			pVppItems->clearCache();
+			broyden.run(twv,twa,xGuess);
+		});
+
+		// Full runs of the wind grid, each with its own items. The results
+		// are compared to the baseline
+		size_t nta= parser.get(Var::nta_), ntw= parser.get(Var::ntw_);
+
+		std::shared_ptr<VPPItemFactory> pSolverItems( makeItems(parser,pSails,sailCoeffFile) );
+		Optim::SolverFactory solverFactory(pSolverItems);
+		benchmark.run("SolverFactory::fullRun", [&]() {
+			VPPJobRunner(&solverFactory,nta,ntw,1);
+		}, false);
+		if(benchmark.isSelected("SolverFactory::fullRun"))
+			benchmark.setResultDeviation( getResultDeviation(solverFactory.get()->getResults(),baselineResults) );
+
+		std::shared_ptr<VPPItemFactory> pNLOptItems( makeItems(parser,pSails,sailCoeffFile) );
+		Optim::NLOptSolverFactory nlOptFactory(pNLOptItems);
+		benchmark.run("NLOptSolverFactory::fullRun", [&]() {
+			VPPJobRunner(&nlOptFactory,nta,ntw,1);
+		}, false);
+		if(benchmark.isSelected("NLOptSolverFactory::fullRun"))
+			benchmark.setResultDeviation( getResultDeviation(nlOptFactory.get()->getResults(),baselineResults) );
+
+		std::shared_ptr<VPPItemFactory> pSLSQPItems( makeItems(parser,pSails,sailCoeffFile) );
+		Optim::NLOptSLSQPSolverFactory slsqpFactory(pSLSQPItems);
+		benchmark.run("NLOptSLSQPSolverFactory::fullRun", [&]() {
+			VPPJobRunner(&slsqpFactory,nta,ntw,1);
+		}, false);
+		if(benchmark.isSelected("NLOptSLSQPSolverFactory::fullRun"))
+			benchmark.setResultDeviation( getResultDeviation(slsqpFactory.get()->getResults(),baselineResults) );
+
+		std::shared_ptr<VPPItemFactory> pSAOAItems( makeItems(parser,pSails,sailCoeffFile) );
+		Optim::SAOASolverFactory saoaFactory(pSAOAItems);
+		benchmark.run("SAOASolverFactory::fullRun", [&]() {
+			VPPJobRunner(&saoaFactory,nta,ntw,1);
+		}, false);
+		if(benchmark.isSelected("SAOASolverFactory::fullRun"))
+			benchmark.setResultDeviation( getResultDeviation(saoaFactory.get()->getResults(),baselineResults) );
+
+		std::shared_ptr<VPPItemFactory> pAdaptiveItems( makeItems(parser,pSails,sailCoeffFile) );
+		Optim::SAOASolverFactory adaptiveFactory(pAdaptiveItems);
+		adaptiveFactory.get()->setSampling(Optim::saoaAdaptive);
+		benchmark.run("SAOASolverFactory::fullRun_adaptive", [&]() {
+			VPPJobRunner(&adaptiveFactory,nta,ntw,1);
+		}, false);
+		if(benchmark.isSelected("SAOASolverFactory::fullRun_adaptive"))
+			benchmark.setResultDeviation( getResultDeviation(adaptiveFactory.get()->getResults(),baselineResults) );
+
+		std::shared_ptr<VPPItemFactory> pIpOptItems( makeItems(parser,pSails,sailCoeffFile) );
+		Optim::IpOptSolverFactory ipOptFactory(pIpOptItems);
+		benchmark.run("IpOptSolverFactory::fullRun", [&]() {
+			VPPJobRunner(&ipOptFactory,nta,ntw,1);
+		}, false);
+		if(benchmark.isSelected("IpOptSolverFactory::fullRun"))
+			benchmark.setResultDeviation( getResultDeviation(ipOptFactory.get()->getResults(),baselineResults) );
+
+		std::shared_ptr<VPPItemFactory> pNumericalHessianItems( makeItems(parser,pSails,sailCoeffFile) );
+		Optim::IpOptSolverFactory numericalHessianFactory(pNumericalHessianItems);
+		numericalHessianFactory.setNumericalHessian(true);
+		benchmark.run("IpOptSolverFactory::fullRun_numericalHessian", [&]() {
+			VPPJobRunner(&numericalHessianFactory,nta,ntw,1);
+		}, false);
+		if(benchmark.isSelected("IpOptSolverFactory::fullRun_numericalHessian"))
+			benchmark.setResultDeviation( getResultDeviation(numericalHessianFactory.get()->getResults(),baselineResults) );
+
+		std::shared_ptr<VPPItemFactory> pImplicitGradientItems( makeItems(parser,pSails,sailCoeffFile) );
+		Optim::IpOptSolverFactory implicitGradientFactory(pImplicitGradientItems);
+		implicitGradientFactory.get()->setGradientMode(implicitFunctionTheorem);
+		benchmark.run("IpOptSolverFactory::fullRun_implicitGradient", [&]() {
+			VPPJobRunner(&implicitGradientFactory,nta,ntw,1);
+		}, false);
+		if(benchmark.isSelected("IpOptSolverFactory::fullRun_implicitGradient"))
+			benchmark.setResultDeviation( getResultDeviation(implicitGradientFactory.get()->getResults(),baselineResults) );
+
+		std::shared_ptr<VPPItemFactory> pWarmStartItems( makeItems(parser,pSails,sailCoeffFile) );
+		Optim::IpOptSolverFactory warmStartFactory(pWarmStartItems);
+		warmStartFactory.get()->setWarmStart(true);
+		benchmark.run("IpOptSolverFactory::fullRun_warmStart", [&]() {
+			VPPJobRunner(&warmStartFactory,nta,ntw,1);
+		}, false);
+		if(benchmark.isSelected("IpOptSolverFactory::fullRun_warmStart"))
+			benchmark.setResultDeviation( getResultDeviation(warmStartFactory.get()->getResults(),baselineResults) );
+
+		// Keep the interpolations alive
+		if(sum==std::numeric_limits<double>::max())
+			std::cout<<sum<<std::endl;
+
+		// -- OUTPUT
+
+		benchmark.write(stdout);
+
+		FILE* outStream= fopen(outFile.c_str(),"w");
+		if(!outStream) {
+			char msg[256];
+			sprintf(msg,"Cannot write the benchmark file \'%s\'",outFile.c_str());
+			throw VPPException(HERE,msg);
+		}
+		benchmark.write(outStream);
+		fclose(outStream);
+
+		if(baselineFile.size() && benchmark.compare(baselineFile,tolerance))
+			return 2;
+
+	} catch(std::exception& e) {
+		std::cout<<"\n-----------------------------------------"<<std::endl;
+		std::cout<<" Exception caught in Main:  "<<std::endl;
+		std::cout<<" --> "<<e.what()<<std::endl;
+		std::cout<<" The program is terminated. "<<std::endl;
+		std::cout<<"-----------------------------------------\n"<<std::endl;
+		return 1;
+	}	catch(...) {
+		cout << "Unknown Exception occurred\n";
+		return 1;
+	}
+
+	return 0;
+}
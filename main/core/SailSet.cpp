@@ -7,30 +7,30 @@
 SailSet::SailSet(const VariableFileParser& parser) :
 pParser_(&parser) {
 
-	const VarSet& v = *(pParser_->getVariables());
+	const VariableFileParser& v = *pParser_;
 
 	// Compute the mainSail area AM =  0.5 * P * E * MROACH
-	sailVariables_.insert( Variable(Var::am_, 0.5 * v[Var::p_] * v[Var::e_] * v[Var::mroach_] ) );
+	insert( Var::am_, 0.5 * v.get(Var::p_) * v.get(Var::e_) * v.get(Var::mroach_) );
 
 	// Compute the Jib area AJ =  0.5 * sqrt( I^2 + J^2) * LPG
-	sailVariables_.insert( Variable(Var::aj_, 0.5 * sqrt( v[Var::i_] * v[Var::i_] + v[Var::j_] * v[Var::j_] ) * v["LPG"] ) );
+	insert( Var::aj_, 0.5 * sqrt( v.get(Var::i_) * v.get(Var::i_) + v.get(Var::j_) * v.get(Var::j_) ) * v.get(Var::lpg_) );
 
 	// Compute the Spinnaker area AS = 1.15 * SL * J;
-	sailVariables_.insert( Variable(Var::as_, 1.15 * v[Var::sl_] * v[Var::sl_] ) );
+	insert( Var::as_, 1.15 * v.get(Var::sl_) * v.get(Var::sl_) );
 
 	// Compute the Fore Triangle area AF =  0.5 * I * J
-	sailVariables_.insert( Variable(Var::af_, 0.5 * v[Var::i_] * v[Var::j_] ) );
+	insert( Var::af_, 0.5 * v.get(Var::i_) * v.get(Var::j_) );
 
 	// Compute heights :
 
 	// Compute the MainSail center's height ZCEM = 0.39 * P + BAD
-	sailVariables_.insert( Variable(Var::zcem_, 0.39 * v[Var::p_] + v[Var::bad_] ) );
+	insert( Var::zcem_, 0.39 * v.get(Var::p_) + v.get(Var::bad_) );
 
 	// Compute the Jib center's height ZCEJ = 0.39 .* geom.I;
-	sailVariables_.insert( Variable(Var::zcej_, 0.39 * v[Var::i_] ) );
+	insert( Var::zcej_, 0.39 * v.get(Var::i_) );
 
 	// Compute the Spinnaker center's height ZCES = 0.59 * I;
-	sailVariables_.insert( Variable(Var::zces_, 0.59 * v[Var::i_] ) );
+	insert( Var::zces_, 0.59 * v.get(Var::i_) );
 
 }
 
@@ -66,15 +66,23 @@ SailSet::~SailSet() {
 }
 
 // Get the value of a variable
-double SailSet::get(string varName) {
+double SailSet::get(const string& varName) const {
 	return sailVariables_[varName];
 }
 
+// Insert a sail variable to both the VarSet and the dense store
+void SailSet::insert(const varData& var, double val) {
+	sailVariables_.insert( Variable(var, val) );
+	sailValues_.set(var, val);
+}
+
+#ifndef VPP_HEADLESS
 // Populate the tree model that will be used to
 // visualize the variables in the UI
 void SailSet::populate(VariableTreeModel* pTreeModel) {
 	sailVariables_.populate(pTreeModel);
 }
+#endif
 
 //////////////////////////////////////////////////////////
 
@@ -83,10 +91,10 @@ MainOnlySailSet::MainOnlySailSet(const VariableFileParser& parser) :
 			SailSet(parser) {
 
 	// Compute the Sail Nominal Area AN = AM
-	sailVariables_.insert( Variable(Var::an_, sailVariables_[Var::am_] ) );
+	insert( Var::an_, get(Var::am_) );
 
 	// Compute the Sail Nominal Height ZCE = ZCEM
-	sailVariables_.insert( Variable(Var::zce_, sailVariables_[Var::zcem_] ) );
+	insert( Var::zce_, get(Var::zcem_) );
 
 }
 
@@ -107,15 +115,12 @@ SailCoefficientItem* MainOnlySailSet::sailCoefficientItemFactory(WindItem* pWind
 MainAndJibSailSet::MainAndJibSailSet(const VariableFileParser& parser) :
 			SailSet(parser) {
 
-	// use a tmp var to refer to sailVariables_
-	VarSet& sv = sailVariables_;
-
 	// Compute the Sail Nominal Area AN = AF + AM
-	sailVariables_.insert( Variable(Var::an_, sv[Var::af_] + sv[Var::am_] ) );
+	insert( Var::an_, get(Var::af_) + get(Var::am_) );
 
 	// Compute the Sail Nominal Height ZCE = (ZCEM .* AM + ZCEJ .* AJ) ./ (AM + AJ);
-	sailVariables_.insert( Variable(Var::zce_,
-			( sv[Var::zcem_] * sv[Var::am_] + sv[Var::zcej_] * sv[Var::aj_] ) / ( sv[Var::am_] + sv[Var::aj_] ) ) );
+	insert( Var::zce_,
+			( get(Var::zcem_) * get(Var::am_) + get(Var::zcej_) * get(Var::aj_) ) / ( get(Var::am_) + get(Var::aj_) ) );
 
 }
 
@@ -136,15 +141,12 @@ SailCoefficientItem* MainAndJibSailSet::sailCoefficientItemFactory(WindItem* pWi
 MainAndSpiSailSet::MainAndSpiSailSet(const VariableFileParser& parser):
 			SailSet(parser) {
 
-	// use a tmp var to refer to sailVariables_
-	VarSet& sv = sailVariables_;
-
 	// Compute the Sail Nominal Area AN = AS + AM
-	sailVariables_.insert( Variable(Var::an_, sv[Var::as_] + sv[Var::am_] ) );
+	insert( Var::an_, get(Var::as_) + get(Var::am_) );
 
 	// Compute the Sail Nominal Height ZCE = (ZCEM .* AM + ZCES .* AS) ./ (AM + AS)
-	sailVariables_.insert( Variable(Var::zce_,
-			(sv[Var::zcem_] * sv[Var::am_] + sv[Var::zces_] * sv[Var::as_] ) / ( sv[Var::am_] + sv[Var::as_] ) ) );
+	insert( Var::zce_,
+			(get(Var::zcem_) * get(Var::am_) + get(Var::zces_) * get(Var::as_) ) / ( get(Var::am_) + get(Var::as_) ) );
 
 }
 
@@ -165,16 +167,13 @@ SailCoefficientItem* MainAndSpiSailSet::sailCoefficientItemFactory(WindItem* pWi
 MainJibAndSpiSailSet::MainJibAndSpiSailSet(const VariableFileParser& parser):
 			SailSet(parser) {
 
-	// use a tmp var to refer to sailVariables_
-	VarSet& sv = sailVariables_;
-
 	// Compute the Sail Nominal Area AN = AF + AS + AM
-	sailVariables_.insert( Variable(Var::an_, sv[Var::af_] + sv[Var::as_] + sv[Var::am_] ) );
+	insert( Var::an_, get(Var::af_) + get(Var::as_) + get(Var::am_) );
 
 	// Compute the Sail Nominal Height ZCE = (ZCEM .* AM + ZCEJ .* AJ + ZCES .* AS) ./ (AM + AJ + AS)
-	sailVariables_.insert( Variable(Var::zce_,
-			(sv[Var::zcem_] * sv[Var::am_] + sv[Var::zcej_] * sv[Var::aj_] + sv[Var::zces_] * sv[Var::as_] ) /
-			( sv[Var::am_] + sv[Var::aj_] + sv[Var::as_] ) ) );
+	insert( Var::zce_,
+			(get(Var::zcem_) * get(Var::am_) + get(Var::zcej_) * get(Var::aj_) + get(Var::zces_) * get(Var::as_) ) /
+			( get(Var::am_) + get(Var::aj_) + get(Var::as_) ) );
 
 }
 
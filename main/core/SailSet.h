@@ -47,15 +47,23 @@ class SailSet {
 		virtual size_t getType()=0;
 
 		/// Get the value of a variable
-		double get(string);
+		double get(const string&) const;
+
+		/// Get the value of a variable by descriptor. This is an
+		/// O(1) read of the dense store, use it on the hot path
+		inline double get(const varData& var) const {
+			return sailValues_.get(var);
+		}
 
 		/// Make a new SailCoefficientItem of the type required for
 		/// this sailSet
 		virtual SailCoefficientItem* sailCoefficientItemFactory(WindItem*) =0;
 
+#ifndef VPP_HEADLESS
 		/// Populate the tree model that will be used to
 		/// visualize the variables in the UI
 		void populate(VariableTreeModel* pTreeModel);
+#endif
 
 	protected:
 
@@ -63,9 +71,15 @@ class SailSet {
 		/// from the input file
 		const VariableFileParser* pParser_;
 
+		/// Insert a sail variable to both the VarSet and the dense store
+		void insert(const varData& var, double val);
+
 		/// Sail-specific variables
 		VarSet sailVariables_;
 
+		/// Same values of sailVariables_, addressed by varData slot
+		VarArray sailValues_;
+
 };
 
 class MainOnlySailSet : public SailSet {
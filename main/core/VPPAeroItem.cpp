@@ -3,10 +3,13 @@
 #include "IOUtils.h"
 #include "VPPException.h"
 #include "mathUtils.h"
+#include <algorithm>
+#ifndef VPP_HEADLESS
 #include "MultiplePlotWidget.h"
 #include "VppTabDockWidget.h"
 #include "VppXYCustomPlotWidget.h"
 #include "VPPDialogs.h"
+#endif
 #include "VPPSailCoefficientIO.h"
 
 using namespace mathUtils;
@@ -17,7 +20,7 @@ WindItem::WindItem(VariableFileParser* pParser, std::shared_ptr<SailSet> pSailSe
 								twv_(0),
 								twa_(0),
 								awa_(0),
-								awv_(Eigen::Vector2d::Zero())   {
+								awNorm_(0)   {
 
 	// Get the max/min wind velocities from the parser
 	v_tw_min_= pParser_->get(Var::vtwBounds_.min_);
@@ -60,34 +63,13 @@ WindItem::~WindItem() {
 }
 
 /// Update the items for the current step (wind velocity and angle)
-void WindItem::update(int vTW, int aTW) {
-
-	// TODO dtrimarchi : it this method is called n times by the optimizer, so it is
-	// stupid to re-compute twv_ e twa_ at each time! But it is the only place where I
-	// can update.
-
-	// Update the true wind velocity
-	// vmin to vmax in N steps : vMin + vTW * ( (vMax-vMin)/(nSteps-2) - 1 )
-	twv_= getTWV(vTW);
-	if(mathUtils::isNotValid(twv_)) throw VPPException(HERE,"twv_ is NAN!");
-
-	// Update the true wind angle: make as per the velocity
-	twa_= getTWA(aTW);
-	if(mathUtils::isNotValid(twa_)) throw VPPException(HERE,"twa_ is NAN!");
-
-	// Update the apparent wind velocity vector
-	awv_(0)= x_(stateVars::u) + twv_ * cos( twa_ );
-	if(mathUtils::isNotValid(awv_(0))) throw VPPException(HERE,"awv_(0) is NAN!");
-
-	awv_(1)= twv_ * sin( twa_ );
-	if(mathUtils::isNotValid(awv_(1))) throw VPPException(HERE,"awv_(1) is NAN!");
-	if(awv_(1)<0)
-		throw VPPException(HERE,"awv_(1) is Negative!");
-
-	// Update the apparent wind angle
-	awa_= atan2( awv_(1),awv_(0) );
-	if(mathUtils::isNotValid(awa_))	throw VPPException(HERE,"awa_ is NAN!");
+void WindItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the apparent wind for the current step
+void WindItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
 // Returns the true wind velocity for a given step
@@ -110,6 +92,25 @@ const double WindItem::getTWA(size_t iA) const {
 	return vTwa_[iA];
 }
 
+// Returns the wind condition of the grid point (iV, iA)
+WindCondition WindItem::getWindCondition(size_t iV, size_t iA) const {
+	return WindCondition(getTWV(iV),getTWA(iA));
+}
+
+// Look for the grid point of the wind condition wc. The grid conditions are
+// built from the same values, so that they compare exactly
+bool WindItem::getWindIndices(const WindCondition& wc, size_t& iV, size_t& iA) const {
+
+	std::vector<double>::const_iterator itV= std::find(vTwv_.begin(),vTwv_.end(),wc.twv_);
+	std::vector<double>::const_iterator itA= std::find(vTwa_.begin(),vTwa_.end(),wc.twa_);
+	if(itV==vTwv_.end() || itA==vTwa_.end())
+		return false;
+
+	iV= itV - vTwv_.begin();
+	iA= itA - vTwa_.begin();
+	return true;
+}
+
 // Returns the current true wind angle for this step
 const double WindItem::getTWA() const {
 	return twa_;
@@ -127,12 +128,22 @@ const double WindItem::getAWA() const {
 
 // Returns the apparent wind velocity vector for this step
 const Eigen::Vector2d WindItem::getAWV() const {
-	return awv_;
+	return Eigen::Vector2d( x_(stateVars::u) + twv_ * cos( twa_ ), twv_ * sin( twa_ ) );
 }
 
 // Returns the apparent wind velocity vector norm for this step
 const double WindItem::getAWNorm() const {
-	return awv_.norm();
+	return awNorm_;
+}
+
+// Returns the apparent wind angle and its derivatives for this step
+const Dual& WindItem::getAWADual() const {
+	return awaD_;
+}
+
+// Returns the apparent wind velocity vector norm and its derivatives
+const Dual& WindItem::getAWNormDual() const {
+	return awNormD_;
 }
 
 //=================================================================
@@ -144,10 +155,9 @@ SailCoefficientItem::SailCoefficientItem(WindItem* pWindItem) :
 								awa_(0),
 								ar_(0),
 								cl_(0),
-								cdp_(0),
-								cdI_(0),
 								cd0_(0),
-								cd_(0) {
+								cd_(0),
+								an_(pWindItem->getSailSet()->get(Var::an_)) {
 
 	// Instantiate a VPPSailCoefficientIO to get the sail coefficients
 	// (default OR user-defined
@@ -155,6 +165,25 @@ SailCoefficientItem::SailCoefficientItem(WindItem* pWindItem) :
 	pCd_.reset(new VPP_CD_IO );
 
 	interpolateCoeffs();
+
+	// Update the Aspect Ratio
+	double h= pParser_->get(Var::ehm_) + pParser_->get(Var::avgfreb_);
+
+//	// TODO: restore this and introduce a proper smoothing function
+//	if(awa_ < toRad(45))
+//		// h = mast height above deck + Average freeboard
+//		h= pParser_->get(Var::ehm_) + pParser_->get(Var::avgfreb_);
+//	else
+//		// h = mast height above deck
+//		h= pParser_->get(Var::ehm_);
+
+	// Compute the aspect ratio
+	ar_ = 1.1 * h * h / pSailSet_->get(Var::an_);
+
+	// Compute cd0, see the Hazen's model Larsson p.148
+	cd0_= 1.13 * ( 	(pParser_->get(Var::b_) * pParser_->get(Var::avgfreb_)) +
+									(pParser_->get(Var::ehm_)*pParser_->get(Var::emdc_) ) ) /
+											pSailSet_->get(Var::an_);
 }
 
 void SailCoefficientItem::interpolateCoeffs() {
@@ -176,10 +205,6 @@ void SailCoefficientItem::interpolateCoeffs() {
 		y=pCd_->getCoefficientMatrix()->col(i);
 		interpCdVec_.push_back( std::shared_ptr<SplineInterpolator>( new SplineInterpolator(x,y)) );
 	}
-
-	// resize and init cl_ and cd_ for storing the interpolated values
-	allCl_=Eigen::Vector3d::Zero();
-	allCd_=Eigen::Vector3d::Zero();
 }
 
 // Destructor
@@ -196,52 +221,23 @@ vector< std::shared_ptr<SplineInterpolator> >& SailCoefficientItem::getCdInterpo
 	return interpCdVec_	;
 }
 
-// Implement the pure virtual
-void SailCoefficientItem::update(int vTW, int aTW) {
-
-	// Update the local copy of the the apparent wind angle
-	awa_= pWindItem_->getAWA();
-	if(mathUtils::isNotValid(awa_)) throw VPPException(HERE,"awa_ is NaN");
-
-	// Update the Aspect Ratio
-	double h= pParser_->get(Var::ehm_) + pParser_->get(Var::avgfreb_);
-
-//	// TODO: restore this and introduce a proper smoothing function
-//	if(awa_ < toRad(45))
-//		// h = mast height above deck + Average freeboard
-//		h= pParser_->get(Var::ehm_) + pParser_->get(Var::avgfreb_);
-//	else
-//		// h = mast height above deck
-//		h= pParser_->get(Var::ehm_);
-
-	// Compute the aspect ratio for this awa_
-	ar_ = 1.1 * h * h / pSailSet_->get(Var::an_);
-
-	// Compute cd0, see the Hazen's model Larsson p.148
-	cd0_= 1.13 * ( 	(pParser_->get(Var::b_) * pParser_->get(Var::avgfreb_)) +
-									(pParser_->get(Var::ehm_)*pParser_->get(Var::emdc_) ) ) /
-											pSailSet_->get(Var::an_);
-
-	// Compute the coefficients based on the sail configuration
-	compute();
-
+// Implement the pure virtual. The aspect ratio and cd0 do not depend
+// on the state vector, and have been computed by the ctor
+void SailCoefficientItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
 }
 
-// Called by the children as a decorator for update.
-// Do all is required after cl and cdp have been computed
-void SailCoefficientItem::postUpdate() {
-
-	// Reduce cl with the flattening factor of the state vector
-	cl_ *= x_(stateVars::f);
-	if(mathUtils::isNotValid(cl_)) throw VPPException(HERE,"cl_ is nan");
-
-	// Compute the induced resistance
-	cdI_ = cl_ * cl_ * ( 1. / (M_PI * ar_) + 0.005 );
-
-	// Compute the total sail drag coefficient now
-	cd_ = cdp_ + cd0_ + cdI_;
-	if(mathUtils::isNotValid(cd_)) throw VPPException(HERE,"cd_ is nan");
+// Update the derivatives of the coefficients for the current step
+void SailCoefficientItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
+}
 
+// Add a sail to the lift and to the drag coefficients of the sailset
+void SailCoefficientItem::addSail(activeSail clSail, double clArea, activeSail cdSail, double cdArea) {
+	clSails_.push_back(clSail);
+	clAreas_.push_back(clArea);
+	cdSails_.push_back(cdSail);
+	cdAreas_.push_back(cdArea);
 }
 
 // Returns a ptr to the wind Item
@@ -249,6 +245,11 @@ WindItem* SailCoefficientItem::getWindItem() const {
 	return pWindItem_;
 }
 
+// Bind this item to a wind item. Used by clone
+void SailCoefficientItem::setWindItem(WindItem* pWindItem) {
+	pWindItem_= pWindItem;
+}
+
 // Returns a ptr to the CL_IO container
 VPP_CL_IO* SailCoefficientItem::getClIO() const {
 	return pCl_.get();
@@ -259,30 +260,6 @@ VPP_CD_IO* SailCoefficientItem::getCdIO() const {
 	return pCd_.get();
 }
 
-void SailCoefficientItem::computeForMain() {
-
-	// Interpolate the values of the sail coefficients for the MainSail
-	allCl_(activeSail::mainSail) = interpClVec_[activeSail::mainSail]->interpolate(awa_);
-	allCd_(activeSail::mainSail) = interpCdVec_[activeSail::mainSail]->interpolate(awa_);
-
-}
-
-void SailCoefficientItem::computeForJib() {
-
-	// Interpolate the values of the sail coefficients for the Jib
-	allCl_(activeSail::jib)  = interpClVec_[activeSail::jib]->interpolate(awa_);
-	allCd_(activeSail::jib)  = interpCdVec_[activeSail::jib]->interpolate(awa_);
-
-}
-
-void SailCoefficientItem::computeForSpi() {
-
-	// Interpolate the values of the sail coefficients for the Spi
-	allCl_(activeSail::jib)  = interpClVec_[activeSail::spi]->interpolate(awa_);
-	allCd_(activeSail::spi) = interpCdVec_[activeSail::spi]->interpolate(awa_);
-
-}
-
 // Returns the current value of the lift coefficient for
 // the current sail
 const double SailCoefficientItem::getCl() const {
@@ -294,12 +271,27 @@ const double SailCoefficientItem::getCd() const {
 	return cd_;
 }
 
+// Returns the current lift coefficient and its derivatives
+const Dual& SailCoefficientItem::getClDual() const {
+	return clD_;
+}
+
+// Returns the current drag coefficient and its derivatives
+const Dual& SailCoefficientItem::getCdDual() const {
+	return cdD_;
+}
+
 /// PrintOut the coefficient matrices
 void SailCoefficientItem::printCoefficients() {
 
 	std::cout<<"\n=== Sail Coefficients: ============\n "<<std::endl;
-	std::cout<<"Cl= \n"<<allCl_<<std::endl;
-	std::cout<<"Cd= \n"<<allCd_<<std::endl;
+	Eigen::Vector3d allCl, allCd;
+	for(size_t i=0; i<3; i++) {
+		allCl(i)= interpClVec_[i]->interpolate(awa_);
+		allCd(i)= interpCdVec_[i]->interpolate(awa_);
+	}
+	std::cout<<"Cl= \n"<<allCl<<std::endl;
+	std::cout<<"Cd= \n"<<allCd<<std::endl;
 	std::cout<<"\n===================================\n "<<std::endl;
 }
 
@@ -308,7 +300,10 @@ void SailCoefficientItem::printCoefficients() {
 // Constructor
 MainOnlySailCoefficientItem::MainOnlySailCoefficientItem(WindItem* pWind) :
 						SailCoefficientItem(pWind) {
-	// do nothing
+
+	// The lift/drag coeffs are just the ones of the main
+	addSail(activeSail::mainSail,1.,activeSail::mainSail,1.);
+	an_= 1.;
 }
 
 // Destructor
@@ -316,31 +311,15 @@ MainOnlySailCoefficientItem::~MainOnlySailCoefficientItem() {
 
 }
 
-// Implement the pure virtual method of the abstract base class
-void MainOnlySailCoefficientItem::compute() {
-
-	// Compute the sail coefficients for the main sail
-	computeForMain();
-
-}
-
-// Update the item for the current step (wind velocity and angle),
-// the values of the state vector x computed by the optimizer have
-// already been treated by the parent
-void MainOnlySailCoefficientItem::update(int vTW, int aTW) {
-
-	// Decorate the parent class method that updates the value of awa_
-	SailCoefficientItem::update(vTW,aTW);
-
-	// In this case the lift/drag coeffs are just what was computed for main
-	cl_ = allCl_(activeSail::mainSail) ;
-	cdp_ = allCd_(activeSail::mainSail) ;
-
-	// Call the parent method that computes the effective cd=cdp+cd0+cdI
-	SailCoefficientItem::postUpdate();
+// Make a copy of this item bound to the given wind item
+SailCoefficientItem* MainOnlySailCoefficientItem::clone(WindItem* pWind) const {
 
+	MainOnlySailCoefficientItem* pClone= new MainOnlySailCoefficientItem(*this);
+	pClone->setWindItem(pWind);
+	return pClone;
 }
 
+#ifndef VPP_HEADLESS
 // Plot the spline-interpolated curves based on the Larsson's
 // sail coefficients. The range is set 0-180deg
 // Fill a multiple plot
@@ -409,6 +388,7 @@ void MainOnlySailCoefficientItem::plot_D2_InterpolatedCoefficients( MultiplePlot
 	pMultiPlotWidget->addChart(pCdMainPlot,0,1);
 
 }
+#endif
 
 
 //=================================================================
@@ -416,7 +396,10 @@ void MainOnlySailCoefficientItem::plot_D2_InterpolatedCoefficients( MultiplePlot
 // Constructor
 MainAndJibCoefficientItem::MainAndJibCoefficientItem(WindItem* pWind) :
 						SailCoefficientItem(pWind) {
-	// do nothing
+
+	// 	Cl = ( Cl_M * AM + Cl_J * AJ ) / AN
+	addSail(activeSail::mainSail,pSailSet_->get(Var::am_),activeSail::mainSail,pSailSet_->get(Var::am_));
+	addSail(activeSail::jib,pSailSet_->get(Var::aj_),activeSail::jib,pSailSet_->get(Var::aj_));
 }
 
 // Destructor
@@ -424,38 +407,15 @@ MainAndJibCoefficientItem::~MainAndJibCoefficientItem() {
 
 }
 
-// Implement the pure virtual method of the abstract base class
-void MainAndJibCoefficientItem::compute() {
-
-	// Compute the sail coefficients for the main sail and the Jib
-	computeForMain();
-	computeForJib();
-
-}
-
-// Update the item for the current step (wind velocity and angle),
-// the values of the state vector x computed by the optimizer have
-// already been treated by the parent
-void MainAndJibCoefficientItem::update(int vTW, int aTW) {
-
-	// Decorate the parent class method that updates the value of awa_
-	SailCoefficientItem::update(vTW,aTW);
-
-	// create an alias for code readability
-	std::shared_ptr<SailSet> ps= pSailSet_;
-
-	// 	Cl = ( Cl_M * AM + Cl_J * AJ ) / AN
-	cl_ = ( allCl_(activeSail::mainSail)  * ps->get(Var::am_) + allCl_(activeSail::jib)  *  ps->get(Var::aj_) ) /  ps->get(Var::an_);
-	cdp_ = ( allCd_(activeSail::mainSail)  * ps->get(Var::am_) + allCd_(activeSail::jib)  *  ps->get(Var::aj_) ) /  ps->get(Var::an_);
-
-	if(mathUtils::isNotValid(cl_)) throw VPPException(HERE,"cl_ is nan");
-	if(mathUtils::isNotValid(cdp_)) throw VPPException(HERE,"cdp_ is nan");
-
-	// Call the parent method that computes the effective cd=cdp+cd0+cdI
-	SailCoefficientItem::postUpdate();
+// Make a copy of this item bound to the given wind item
+SailCoefficientItem* MainAndJibCoefficientItem::clone(WindItem* pWind) const {
 
+	MainAndJibCoefficientItem* pClone= new MainAndJibCoefficientItem(*this);
+	pClone->setWindItem(pWind);
+	return pClone;
 }
 
+#ifndef VPP_HEADLESS
 // Plot the spline-interpolated curves based on the Larsson's sail coefficients.
 // The range is set 0-180deg
 void MainAndJibCoefficientItem::plotInterpolatedCoefficients( MultiplePlotWidget* pMultiPlotWidget ) const {
@@ -532,13 +492,19 @@ void MainAndJibCoefficientItem::plot_D2_InterpolatedCoefficients(MultiplePlotWid
 	pMultiPlotWidget->addChart(pd2CdJibPlot,1,1);
 
 }
+#endif
 
 //=================================================================
 
 // Constructor
 MainAndSpiCoefficientItem::MainAndSpiCoefficientItem(WindItem* pWind) :
 						SailCoefficientItem(pWind) {
-	// do nothing
+
+	// 	Cl = Cl_M * AM / AN, Cd = ( Cd_M * AM + Cd_S * AS ) / AN : the lift
+	// of the spi is not accounted for
+	addSail(activeSail::mainSail,pSailSet_->get(Var::am_),activeSail::mainSail,pSailSet_->get(Var::am_));
+	cdSails_.push_back(activeSail::spi);
+	cdAreas_.push_back(pSailSet_->get(Var::as_));
 }
 
 // Destructor
@@ -546,37 +512,15 @@ MainAndSpiCoefficientItem::~MainAndSpiCoefficientItem() {
 
 }
 
-// Implement the pure virtual method of the abstract base class
-void MainAndSpiCoefficientItem::compute() {
-
-	// Compute the sail coefficients for the main sail and the Jib
-	computeForMain();
-	computeForSpi();
-
-}
-
-// Update the item for the current step (wind velocity and angle),
-// the values of the state vector x computed by the optimizer have
-// already been treated by the parent
-void MainAndSpiCoefficientItem::update(int vTW, int aTW) {
-
-	// Decorate the parent class method that updates the value of awa_
-	SailCoefficientItem::update(vTW,aTW);
-
-	// create an alias for code readability
-	std::shared_ptr<SailSet> ps= pSailSet_;
-
-	// 	Cl = ( Cl_M * AM + Cl_J * AJ ) / AN
-	cl_ = ( allCl_(activeSail::mainSail)  * ps->get(Var::am_) + allCl_(activeSail::spi) *  ps->get(Var::as_) ) /  ps->get(Var::an_);
-	cdp_ = ( allCd_(activeSail::mainSail)  * ps->get(Var::am_) + allCd_(activeSail::spi) *  ps->get(Var::as_) ) /  ps->get(Var::an_);
-	if(mathUtils::isNotValid(cl_)) throw VPPException(HERE,"cl_ is nan");
-	if(mathUtils::isNotValid(cdp_)) throw VPPException(HERE,"cdp_ is nan");
-
-	// Call the parent method that computes the effective cd=cdp+cd0+cdI
-	SailCoefficientItem::postUpdate();
+// Make a copy of this item bound to the given wind item
+SailCoefficientItem* MainAndSpiCoefficientItem::clone(WindItem* pWind) const {
 
+	MainAndSpiCoefficientItem* pClone= new MainAndSpiCoefficientItem(*this);
+	pClone->setWindItem(pWind);
+	return pClone;
 }
 
+#ifndef VPP_HEADLESS
 // Plot the spline-interpolated curves based on the Larsson's
 // sail coefficients. The range is set 0-180deg
 // Fill a multiple plot
@@ -651,6 +595,7 @@ void MainAndSpiCoefficientItem::plot_D2_InterpolatedCoefficients(MultiplePlotWid
 	pMultiPlotWidget->addChart(pd2CdSpiPlot,1,1);
 
 }
+#endif
 
 
 //=================================================================
@@ -658,7 +603,13 @@ void MainAndSpiCoefficientItem::plot_D2_InterpolatedCoefficients(MultiplePlotWid
 // Constructor
 MainJibAndSpiCoefficientItem::MainJibAndSpiCoefficientItem(WindItem* pWind) :
 						SailCoefficientItem(pWind) {
-	// do nothing
+
+	// 	Cl = ( Cl_M * AM + Cl_S * AJ ) / AN : the lift of the spi is scaled
+	// with the area of the jib, and the lift of the jib is not accounted for
+	addSail(activeSail::mainSail,pSailSet_->get(Var::am_),activeSail::mainSail,pSailSet_->get(Var::am_));
+	addSail(activeSail::spi,pSailSet_->get(Var::aj_),activeSail::jib,pSailSet_->get(Var::aj_));
+	cdSails_.push_back(activeSail::spi);
+	cdAreas_.push_back(pSailSet_->get(Var::as_));
 }
 
 // Destructor
@@ -666,38 +617,15 @@ MainJibAndSpiCoefficientItem::~MainJibAndSpiCoefficientItem() {
 
 }
 
-// Implement the pure virtual method of the abstract base class
-void MainJibAndSpiCoefficientItem::compute() {
-
-	// Compute the sail coefficients for the main sail and the Jib
-	computeForMain();
-	computeForJib();
-	computeForSpi();
-
-}
-
-// Update the item for the current step (wind velocity and angle),
-// the values of the state vector x computed by the optimizer have
-// already been treated by the parent
-void MainJibAndSpiCoefficientItem::update(int vTW, int aTW) {
-
-	// Decorate the parent class method that updates the value of awa_
-	SailCoefficientItem::update(vTW,aTW);
-
-	// create an alias for code readability
-	std::shared_ptr<SailSet> ps= pSailSet_;
-
-	// 	Cl = ( Cl_M * AM + Cl_J * AJ ) / AN
-	cl_ = ( allCl_(activeSail::mainSail)  * ps->get(Var::am_) + allCl_(activeSail::jib)  *  ps->get(Var::aj_) + allCl_(activeSail::spi) *  ps->get(Var::as_) ) /  ps->get(Var::an_);
-	cdp_ = ( allCd_(activeSail::mainSail)  * ps->get(Var::am_) + allCd_(activeSail::jib)  *  ps->get(Var::aj_) + allCd_(activeSail::spi) *  ps->get(Var::as_) ) /  ps->get(Var::an_);
-	if(mathUtils::isNotValid(cl_)) throw VPPException(HERE,"cl_ is nan");
-	if(mathUtils::isNotValid(cdp_)) throw VPPException(HERE,"cdp_ is nan");
-
-	// Call the parent method that computes the effective cd=cdp+cd0+cdI
-	SailCoefficientItem::postUpdate();
+// Make a copy of this item bound to the given wind item
+SailCoefficientItem* MainJibAndSpiCoefficientItem::clone(WindItem* pWind) const {
 
+	MainJibAndSpiCoefficientItem* pClone= new MainJibAndSpiCoefficientItem(*this);
+	pClone->setWindItem(pWind);
+	return pClone;
 }
 
+#ifndef VPP_HEADLESS
 // Plot the spline-interpolated curves based on the Larsson's
 // sail coefficients. The range is set 0-180deg
 // Fill a multiple plot
@@ -802,6 +730,7 @@ void MainJibAndSpiCoefficientItem::plot_D2_InterpolatedCoefficients(MultiplePlot
 	pMultiPlotWidget->addChart(pdCdSpiPlot,2,1);
 
 }
+#endif
 
 //=================================================================
 
@@ -824,43 +753,29 @@ AeroForcesItem::~AeroForcesItem() {
 
 }
 
-/// Update the items for the current ste§p (wind velocity and angle)
-void AeroForcesItem::update(int vTW, int aTW) {
-
-	// Gets the value of the apparent wind velocity
-	double awv = pWindItem_->getAWNorm();
-	if(mathUtils::isNotValid(awv)) throw VPPException(HERE,"awv is NAN!");
-
-	double awa = pWindItem_->getAWA();
-	if(mathUtils::isNotValid(awa)) throw VPPException(HERE,"awa is NAN!");
-
-	// Updates Lift = 0.5 * phys.rho_a * V_eff.^2 .* AN .* Cl;
-	// Note that the nominal area AN was scaled with cos( PHI ) and it
-	// takes the meaning of a projected surface
-	lift_ = 0.5 * Physic::rho_a * awv * awv * pSailSet_->get(Var::an_) * cos( x_(stateVars::phi) ) * pSailCoeffs_->getCl();
-	if(mathUtils::isNotValid(lift_)) throw VPPException(HERE,"lift_ is NAN!");
+// Make a copy of this item bound to the given sail coefficient
+// item, and to its wind item
+AeroForcesItem* AeroForcesItem::clone(SailCoefficientItem* pSailCoeffItem) const {
 
-	// Updates Drag = 0.5 * phys.rho_a * V_eff.^2 .* AN .* Cd;
-	// Note that the nominal area AN was scaled with cos( PHI ) and it
-	// takes the meaning of a projected surface
-	drag_ = 0.5 * Physic::rho_a * awv * awv * pSailSet_->get(Var::an_) * cos( x_(stateVars::phi) ) * pSailCoeffs_->getCd();
-	if(mathUtils::isNotValid(drag_)) throw VPPException(HERE,"drag_ is NAN!");
-
-	// Updates Fdrive = lift_ * sin(awa) - D * cos(awa);
-  fDrive_ = lift_ * sin( awa ) - drag_ * cos( awa );
-	if(mathUtils::isNotValid(fDrive_)) throw VPPException(HERE,"fDrive_ is NAN!");
-
-	// Updates FSide = L * cos(awa) + D * sin(awa);
-	fSide_ = lift_ * cos( awa ) + drag_ * sin( awa );
-	if(mathUtils::isNotValid(fSide_)) throw VPPException(HERE,"fSide_ is NAN!");
+	AeroForcesItem* pClone= new AeroForcesItem(*this);
+	pClone->pSailCoeffs_= pSailCoeffItem;
+	pClone->pWindItem_= pSailCoeffItem->getWindItem();
+	return pClone;
+}
 
-	// The righting moment arm is set as the distance between the center of sail effort and
-	// the hydrodynamic center, scaled with cos(PHI)
-	mHeel_ = fSide_ * ( 0.45 * pParser_->get(Var::t_) + pParser_->get(Var::avgfreb_) + pSailSet_->get(Var::zce_) ) * cos( x_(stateVars::phi) );
-	if(mathUtils::isNotValid(mHeel_)) throw VPPException(HERE,"mHeel_ is NAN!");
+// Update the item for the current step (wind velocity and angle),
+// the values of the state vector x computed by the optimizer have
+// already been treated by the parent
+void AeroForcesItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the forces for the current step
+void AeroForcesItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
+#ifndef VPP_HEADLESS
 // plot the aeroForces for a fixed range
 void AeroForcesItem::plot(MultiplePlotWidget* pMultiPlotWidget ) {
 
@@ -872,6 +787,9 @@ void AeroForcesItem::plot(MultiplePlotWidget* pMultiPlotWidget ) {
 	if (dg.exec() == QDialog::Rejected)
 		return;
 
+	// Wind condition of the grid point selected in the dialog
+	WindCondition wc= pWindItem_->getWindCondition(dg.getTWV(),dg.getTWA());
+
 	// Buffer the current solution
 	Eigen::VectorXd xbuf(4);
 	xbuf << x_(stateVars::u),x_(stateVars::phi),x_(stateVars::b),x_(stateVars::f);
@@ -914,13 +832,13 @@ void AeroForcesItem::plot(MultiplePlotWidget* pMultiPlotWidget ) {
 
 			// Update the wind. For the moment fix the apparent wind velocity and angle
 			// to the first values contained in the variableFiles.
-			pWindItem_->updateSolution(dg.getTWV(), dg.getTWA(), stateVector);
+			pWindItem_->updateSolution(wc, stateVector);
 
 			// Update the sail coefficients for the current wind
-			pSailCoeffs_->updateSolution(dg.getTWV(), dg.getTWA(), stateVector);
+			pSailCoeffs_->updateSolution(wc, stateVector);
 
 			// Update 'this': compute sail forces
-			update(dg.getTWV(), dg.getTWA());
+			update(wc);
 
 			// Store velocity-wise data:
 			x_fN[iTwv]= x_(stateVars::u) / sqrt( Physic::g * pParser_->get(Var::lwl_) );	// Fn...
@@ -1021,6 +939,7 @@ void AeroForcesItem::plot(MultiplePlotWidget* pMultiPlotWidget ) {
 	x_(stateVars::f)  = xbuf(3);
 
 }
+#endif
 
 // Get the value of the side force
 const double AeroForcesItem::getLift() const {
@@ -1047,6 +966,21 @@ const double AeroForcesItem::getMHeel() const {
 	return mHeel_;
 }
 
+// Get the side force and its derivatives
+const Dual& AeroForcesItem::getFSideDual() const {
+	return fSideD_;
+}
+
+// Get the drive force and its derivatives
+const Dual& AeroForcesItem::getFDriveDual() const {
+	return fDriveD_;
+}
+
+// Get the heel moment and its derivatives
+const Dual& AeroForcesItem::getMHeelDual() const {
+	return mHeelD_;
+}
+
 // Get a ptr to the wind item
 WindItem* AeroForcesItem::getWindItem() {
 	return pWindItem_;
@@ -42,6 +42,14 @@ class WindItem : public VPPItem {
 		/// Returns the number of true wind angles
 		const int getWASize() const;
 
+		/// Returns the wind condition of the grid point (iV, iA), i.e. the
+		/// true wind velocity iV and the true wind angle iA
+		WindCondition getWindCondition(size_t iV, size_t iA) const;
+
+		/// Look for the grid point of the wind condition wc. Returns false if wc
+		/// is not a point of the wind grid, otherwise fills its indices iV, iA
+		bool getWindIndices(const WindCondition& wc, size_t& iV, size_t& iA) const;
+
 		/// Returns the apparent wind angle for this step
 		const double getAWA() const;
 
@@ -51,6 +59,19 @@ class WindItem : public VPPItem {
 		/// Returns the apparent wind velocity vector norm for this step
 		const double getAWNorm() const;
 
+		/// Returns the apparent wind angle and its derivatives for this step
+		const Dual& getAWADual() const;
+
+		/// Returns the apparent wind velocity vector norm and its derivatives
+		/// for this step
+		const Dual& getAWNormDual() const;
+
+		/// Compute the apparent wind angle and velocity norm for the wind
+		/// condition wc and the boat velocity u. Shared by the updates of the
+		/// item and by the compiled kernel
+		template <class T>
+		void getApparentWind(const WindCondition& wc, const T& u, T& awa, T& awNorm) const;
+
 		/// Declare the macro to allow for fixed size vector support
 		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -62,7 +83,14 @@ class WindItem : public VPPItem {
 		/// Update the item for the current step (wind velocity and angle),
 		/// the values of the state vector x computed by the optimizer have
 		/// already been treated by the parent
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the apparent wind for the current step
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		/// True wind velocity
 		double twv_;
@@ -75,8 +103,11 @@ class WindItem : public VPPItem {
 		int n_twv_,n_alpha_tw_;
 		double alpha_tw_min_, alpha_tw_max_;
 
-		// Apparent wind velocity vector (x/y components)
-		Eigen::Vector2d awv_;
+		/// Apparent wind velocity vector norm
+		double awNorm_;
+
+		/// Apparent wind angle and velocity norm, with their derivatives
+		Dual awaD_, awNormD_;
 
 		/// Containers to store the values of the wind true
 		/// velocity an angles requested by the user
@@ -111,9 +142,20 @@ class SailCoefficientItem : public VPPItem {
 		/// Returns the current value of the lift coefficient
 		const double getCd() const;
 
+		/// Returns the current lift coefficient and its derivatives
+		const Dual& getClDual() const;
+
+		/// Returns the current drag coefficient and its derivatives
+		const Dual& getCdDual() const;
+
 		/// Returns a ptr to the wind Item
 		WindItem* getWindItem() const;
 
+		/// Make a copy of this item bound to the given wind item. The copy
+		/// shares the sail coefficient IO and the spline interpolators,
+		/// that are only read while solving
+		virtual SailCoefficientItem* clone(WindItem*) const =0;
+
 		/// Returns a ptr to the CL_IO container
 		VPP_CL_IO* getClIO() const;
 
@@ -125,6 +167,13 @@ class SailCoefficientItem : public VPPItem {
 		/// for the current awa_
 		void printCoefficients();
 
+		/// Compute the lift and the drag coefficients of the sailset for the
+		/// apparent wind angle awa and the flattening factor flat. Shared by
+		/// the updates of the item and by the compiled kernel
+		template <class T>
+		void getCoefficients(const T& awa, const T& flat, T& cl, T& cd) const;
+
+#ifndef VPP_HEADLESS
 		/// Plot the spline-interpolated curves based on the Larsson's
 		/// sail coefficients. The range is set 0-180deg
 		/// Fill a multiple plot
@@ -139,6 +188,7 @@ class SailCoefficientItem : public VPPItem {
 		/// curves based on the Larsson's sail coefficients.
 		/// The range is set 0-180deg
 		virtual void plot_D2_InterpolatedCoefficients( MultiplePlotWidget* ) const=0;
+#endif
 
 		/// Get a handle on the interpolators for the lift coeffs.
 		/// Added for test sailCoeffsIOTest. Make good use of this method!
@@ -148,53 +198,59 @@ class SailCoefficientItem : public VPPItem {
 		/// Added for test sailCoeffsIOTest. Make good use of this method!
 		vector< std::shared_ptr<SplineInterpolator> >& getCdInterpolators();
 
+		/// Make this class friend of the kernel, that interpolates the
+		/// coefficients of a batch of apparent wind angles
+		friend class VPPResidualKernel;
+
 	protected:
 
 		/// Update the item for the current step (wind velocity and angle),
 		/// the values of the state vector x computed by the optimizer have
 		/// already been treated by the parent
-		virtual void update(int vTW, int aTW);
-
-		/// Value of the apparent wind angle updated by the WindItem
-		double awa_;
+		virtual void update(const WindCondition& wc);
 
-		/// Compute the coefficients for the MainSail
-		void computeForMain();
+		/// Update the derivatives of the coefficients for the current step
+		virtual void updateDual(const WindCondition& wc);
 
-		/// Compute the coefficients for the Jib
-		void computeForJib();
+		/// Add a sail to the lift and to the drag coefficients of the sailset.
+		/// Called by the children's ctors as per the sail configuration
+		void addSail(activeSail clSail, double clArea, activeSail cdSail, double cdArea);
 
-		/// Compute the coefficients for the Spinnaker
-		void computeForSpi();
+		/// Bind this item to a wind item. Used by clone
+		void setWindItem(WindItem*);
 
-		/// Called after the children's update as a decorator
-		/// Computes the actual cl (decremented with the flat)
-		/// and the effective cd = cdp + cd0 + cdI
-		void postUpdate();
-
-		/// Current values of the lift and drag coefficients for Main,
-		/// Jib and Spi. The values are updated by update and interpolated
-		/// with the current awa computed by the WindItem with the actual
-		/// boat velocity from the state vector of the optimizer
-		Eigen::Vector3d allCl_, allCd_;
+		/// Value of the apparent wind angle updated by the WindItem
+		double awa_;
 
 		/// Current lift/drag coefficient values for the full sailset
 		double 	cl_, //< Lift coefficient
-		ar_, //<
-		cdp_,//<
-		cdI_, //< Induced SailSet Resistance
-		cd0_, //<
+		ar_, //< Aspect ratio
+		cd0_, //< Hull and mast drag coefficient
 		cd_; //< Drag coefficient
 
+		/// Derivatives of the lift and drag coefficients of the full sailset
+		Dual clD_, cdD_;
+
 		/// Interpolator vectors -- store a cubic spline that interpolates
 		/// the values of the sail coefficients
 		vector< std::shared_ptr<SplineInterpolator> > interpClVec_;
 		vector< std::shared_ptr<SplineInterpolator> > interpCdVec_;
 
+		/// Sails contributing to the lift and to the drag coefficients of the
+		/// sailset, i.e. the indices of their interpolators, with the area each
+		/// of them is scaled with
+		vector<activeSail> clSails_, cdSails_;
+		vector<double> clAreas_, cdAreas_;
+
+		/// Area the weighted sail coefficients are divided by. One for the main
+		/// only configuration, that does not scale the coefficients of the main
+		double an_;
+
 	private:
 
-		/// Pure virtual that makes this class abstract.
-		virtual void compute() =0;
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		/// Ptr to the wind item
 		WindItem* pWindItem_;
@@ -220,6 +276,10 @@ class MainOnlySailCoefficientItem : public SailCoefficientItem {
 		/// Destructor
 		~MainOnlySailCoefficientItem();
 
+		/// Make a copy of this item bound to the given wind item
+		virtual SailCoefficientItem* clone(WindItem*) const;
+
+#ifndef VPP_HEADLESS
 		/// Plot the spline-interpolated curves based on the Larsson's
 		/// sail coefficients. The range is set 0-180deg
 		/// Fill a multiple plot
@@ -234,16 +294,7 @@ class MainOnlySailCoefficientItem : public SailCoefficientItem {
 		/// curves based on the Larsson's sail coefficients.
 		/// The range is set 0-180deg
 		virtual void plot_D2_InterpolatedCoefficients(MultiplePlotWidget*) const;
-
-	private:
-
-		/// Implement the pure virtual method of the abstract base class
-		virtual void compute();
-
-		/// Update the item for the current step (wind velocity and angle),
-		/// the values of the state vector x computed by the optimizer have
-		/// already been treated by the parent
-		virtual void update(int vTW, int aTW);
+#endif
 
 };
 
@@ -259,6 +310,10 @@ class MainAndJibCoefficientItem : public SailCoefficientItem {
 		/// Destructor
 		~MainAndJibCoefficientItem();
 
+		/// Make a copy of this item bound to the given wind item
+		virtual SailCoefficientItem* clone(WindItem*) const;
+
+#ifndef VPP_HEADLESS
 		/// Plot the spline-interpolated curves based on the Larsson's
 		/// sail coefficients. The range is set 0-180deg
 		/// Fill a multiple plot
@@ -273,16 +328,7 @@ class MainAndJibCoefficientItem : public SailCoefficientItem {
 		/// curves based on the Larsson's sail coefficients.
 		/// The range is set 0-180deg
 		virtual void plot_D2_InterpolatedCoefficients(MultiplePlotWidget*) const;
-
-	private:
-
-		/// Implement the pure virtual method of the abstract base class
-		virtual void compute();
-
-		/// Update the item for the current step (wind velocity and angle),
-		/// the values of the state vector x computed by the optimizer have
-		/// already been treated by the parent
-		virtual void update(int vTW, int aTW);
+#endif
 
 };
 
@@ -298,6 +344,10 @@ class MainAndSpiCoefficientItem : public SailCoefficientItem {
 		/// Destructor
 		~MainAndSpiCoefficientItem();
 
+		/// Make a copy of this item bound to the given wind item
+		virtual SailCoefficientItem* clone(WindItem*) const;
+
+#ifndef VPP_HEADLESS
 		/// Plot the spline-interpolated curves based on the Larsson's
 		/// sail coefficients. The range is set 0-180deg
 		/// Fill a multiple plot
@@ -312,16 +362,7 @@ class MainAndSpiCoefficientItem : public SailCoefficientItem {
 		/// curves based on the Larsson's sail coefficients.
 		/// The range is set 0-180deg
 		virtual void plot_D2_InterpolatedCoefficients(MultiplePlotWidget*) const;
-
-	private:
-
-		/// Implement the pure virtual method of the abstract base class
-		virtual void compute();
-
-		/// Update the item for the current step (wind velocity and angle),
-		/// the values of the state vector x computed by the optimizer have
-		/// already been treated by the parent
-		virtual void update(int vTW, int aTW);
+#endif
 
 };
 
@@ -337,6 +378,10 @@ class MainJibAndSpiCoefficientItem : public SailCoefficientItem {
 		/// Destructor
 		~MainJibAndSpiCoefficientItem();
 
+		/// Make a copy of this item bound to the given wind item
+		virtual SailCoefficientItem* clone(WindItem*) const;
+
+#ifndef VPP_HEADLESS
 		/// Plot the spline-interpolated curves based on the Larsson's
 		/// sail coefficients. The range is set 0-180deg
 		/// Fill a multiple plot
@@ -351,16 +396,7 @@ class MainJibAndSpiCoefficientItem : public SailCoefficientItem {
 		/// curves based on the Larsson's sail coefficients.
 		/// The range is set 0-180deg
 		virtual void plot_D2_InterpolatedCoefficients(MultiplePlotWidget*) const;
-
-	private:
-
-		/// Implement the pure virtual method of the abstract base class
-		virtual void compute();
-
-		/// Update the item for the current step (wind velocity and angle),
-		/// the values of the state vector x computed by the optimizer have
-		/// already been treated by the parent
-		virtual void update(int vTW, int aTW);
+#endif
 
 };
 
@@ -391,6 +427,15 @@ class AeroForcesItem : public VPPItem {
 		/// Get the value of the heel moment
 		const double getMHeel() const;
 
+		/// Get the side force and its derivatives
+		const Dual& getFSideDual() const;
+
+		/// Get the drive force and its derivatives
+		const Dual& getFDriveDual() const;
+
+		/// Get the heel moment and its derivatives
+		const Dual& getMHeelDual() const;
+
 		/// Get a ptr to the wind item
 		WindItem* getWindItem();
 
@@ -403,16 +448,37 @@ class AeroForcesItem : public VPPItem {
 		/// Get a ptr to the sailCoeffs Item - const variety
 		const SailCoefficientItem* getSailCoeffItem() const;
 
+		/// Make a copy of this item bound to the given sail coefficient
+		/// item, and to its wind item
+		AeroForcesItem* clone(SailCoefficientItem*) const;
+
+		/// Compute the lift and the drag, the drive and the side forces and
+		/// the heel moment for the apparent wind velocity norm awv and angle
+		/// awa, the heel angle phi and the sail coefficients cl and cd. Shared
+		/// by the updates of the item and by the compiled kernel
+		template <class T>
+		void getForces(const T& awv, const T& awa, const T& phi, const T& cl, const T& cd,
+				T& lift, T& drag, T& fDrive, T& fSide, T& mHeel) const;
+
+#ifndef VPP_HEADLESS
 		/// plot the aeroForces for a fixed range. Fill a multiplePlotWidget
 		/// with this plot
 		void plot(MultiplePlotWidget*);
+#endif
 
 	private:
 
 		/// Update the item for the current step (wind velocity and angle),
 		/// the values of the state vector x computed by the optimizer have
 		/// already been treated by the parent
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the forces for the current step
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		/// The AeroForcesItem owns the sail coefficients
 		SailCoefficientItem* pSailCoeffs_;
@@ -424,7 +490,11 @@ class AeroForcesItem : public VPPItem {
 		fDrive_, fHeel_,	//< Drive and Heel forces, ie lift and drag projected to the boat's route
 		fSide_, 					//< Side force, or fHeel projected on the sea plane
 		mHeel_;						//< Heel moment due to fHeel
+
+		/// Drive and side forces and heel moment, with their derivatives
+		Dual fDriveD_, fSideD_, mHeelD_;
 };
 
+#include "VPPAeroItem_tpl.h"
 
 #endif
@@ -0,0 +1,127 @@
+#include "VPPException.h"
+#include "mathUtils.h"
+
+// Compute the apparent wind angle and velocity norm. Only the x component
+// of the apparent wind depends on the state vector
+template <class T>
+void WindItem::getApparentWind(const WindCondition& wc, const T& u, T& awa, T& awNorm) const {
+
+	T awv0= u + wc.twv_ * cos( wc.twa_ );
+
+	double awv1= wc.twv_ * sin( wc.twa_ );
+	if(awv1<0)
+		throw VPPException(HERE,"awv_(1) is Negative!");
+
+	awa= atan2( T(awv1), awv0 );
+	awNorm= sqrt( awv0 * awv0 + awv1 * awv1 );
+}
+
+// Update the items for the current step (wind velocity and angle)
+template <class T>
+void WindItem::updateScalar(const WindCondition& wc) {
+
+	// Update the true wind velocity and angle
+	twv_= wc.twv_;
+	if(mathUtils::isNotValid(twv_)) throw VPPException(HERE,"twv_ is NAN!");
+
+	twa_= wc.twa_;
+	if(mathUtils::isNotValid(twa_)) throw VPPException(HERE,"twa_ is NAN!");
+
+	// Update the apparent wind angle and velocity
+	T& awa= select<T>(awa_,awaD_);
+	T& awNorm= select<T>(awNorm_,awNormD_);
+	getApparentWind(wc,getState<T>(stateVars::u),awa,awNorm);
+	if(mathUtils::isNotValid(awNorm)) throw VPPException(HERE,"awNorm_ is NAN!");
+	if(mathUtils::isNotValid(awa))	throw VPPException(HERE,"awa_ is NAN!");
+}
+
+//=================================================================
+
+// Sum up the coefficients of the active sails, weighted with their areas.
+// Then reduce cl with the flattening factor, and compute the effective
+// cd = cdp + cd0 + cdI, see the Hazen's model Larsson p.148
+template <class T>
+void SailCoefficientItem::getCoefficients(const T& awa, const T& flat, T& cl, T& cd) const {
+
+	cl= 0.;
+	for(size_t i=0; i<clSails_.size(); i++)
+		cl += interpClVec_[clSails_[i]]->interpolate(awa) * clAreas_[i];
+	cl /= an_;
+
+	T cdp= 0.;
+	for(size_t i=0; i<cdSails_.size(); i++)
+		cdp += interpCdVec_[cdSails_[i]]->interpolate(awa) * cdAreas_[i];
+	cdp /= an_;
+
+	// Reduce cl with the flattening factor of the state vector
+	cl *= flat;
+
+	// Compute the induced resistance and the total sail drag coefficient
+	T cdI= cl * cl * ( 1. / (M_PI * ar_) + 0.005 );
+	cd= cdp + cd0_ + cdI;
+}
+
+// Update the coefficients for the current step
+template <class T>
+void SailCoefficientItem::updateScalar(const WindCondition& wc) {
+
+	// Update the local copy of the the apparent wind angle
+	T awa= select<T>(pWindItem_->getAWA(),pWindItem_->getAWADual());
+	awa_= valueOf(awa);
+	if(mathUtils::isNotValid(awa_)) throw VPPException(HERE,"awa_ is NaN");
+
+	T& cl= select<T>(cl_,clD_);
+	T& cd= select<T>(cd_,cdD_);
+	getCoefficients(awa,getState<T>(stateVars::f),cl,cd);
+	if(mathUtils::isNotValid(cl)) throw VPPException(HERE,"cl_ is nan");
+	if(mathUtils::isNotValid(cd)) throw VPPException(HERE,"cd_ is nan");
+}
+
+//=================================================================
+
+// Compute the aero forces, see AeroForcesItem::update
+template <class T>
+void AeroForcesItem::getForces(const T& awv, const T& awa, const T& phi, const T& cl, const T& cd,
+		T& lift, T& drag, T& fDrive, T& fSide, T& mHeel) const {
+
+	T qa= 0.5 * Physic::rho_a * awv * awv * pSailSet_->get(Var::an_) * cos( phi );
+	lift= qa * cl;
+	drag= qa * cd;
+
+	T sinAwa= sin( awa );
+	T cosAwa= cos( awa );
+	fDrive= lift * sinAwa - drag * cosAwa;
+	fSide= lift * cosAwa + drag * sinAwa;
+
+	mHeel= fSide * ( 0.45 * pParser_->get(Var::t_) + pParser_->get(Var::avgfreb_) + pSailSet_->get(Var::zce_) ) * cos( phi );
+}
+
+// Update the forces for the current step
+template <class T>
+void AeroForcesItem::updateScalar(const WindCondition& wc) {
+
+	T awv= select<T>(pWindItem_->getAWNorm(),pWindItem_->getAWNormDual());
+	if(mathUtils::isNotValid(awv)) throw VPPException(HERE,"awv is NAN!");
+
+	T awa= select<T>(pWindItem_->getAWA(),pWindItem_->getAWADual());
+	if(mathUtils::isNotValid(awa)) throw VPPException(HERE,"awa is NAN!");
+
+	T lift, drag;
+	T& fDrive= select<T>(fDrive_,fDriveD_);
+	T& fSide= select<T>(fSide_,fSideD_);
+	T& mHeel= select<T>(mHeel_,mHeelD_);
+	getForces(awv,awa,getState<T>(stateVars::phi),
+			select<T>(pSailCoeffs_->getCl(),pSailCoeffs_->getClDual()),
+			select<T>(pSailCoeffs_->getCd(),pSailCoeffs_->getCdDual()),
+			lift,drag,fDrive,fSide,mHeel);
+
+	lift_= valueOf(lift);
+	if(mathUtils::isNotValid(lift_)) throw VPPException(HERE,"lift_ is NAN!");
+
+	drag_= valueOf(drag);
+	if(mathUtils::isNotValid(drag_)) throw VPPException(HERE,"drag_ is NAN!");
+
+	if(mathUtils::isNotValid(fDrive)) throw VPPException(HERE,"fDrive_ is NAN!");
+	if(mathUtils::isNotValid(fSide)) throw VPPException(HERE,"fSide_ is NAN!");
+	if(mathUtils::isNotValid(mHeel)) throw VPPException(HERE,"mHeel_ is NAN!");
+}
@@ -3,7 +3,9 @@
 #include "IOUtils.h"
 #include "VPPException.h"
 #include "Warning.h"
+#ifndef VPP_HEADLESS
 #include "VPPDialogs.h"
+#endif
 
 // Constructor
 ResistanceItem::ResistanceItem(VariableFileParser* pParser, std::shared_ptr<SailSet> pSailSet) :
@@ -14,18 +16,13 @@ res_(0){
 }
 
 // drag the pure virtual method of the parent class one step down
-void ResistanceItem::update(int vTW, int aTW) {
-
-	// Update the Froude number using the state variable boat velocity
-	fN_= convertToFn( x_(stateVars::u) );
-	if(isNotValid(fN_)) throw VPPException(HERE,"fN_ is Nan");
-
-	//		if(fN_ > 0.6) {
-	//			char msg[256];
-	//			sprintf(msg,"The value of the Froude Number %f exceeds the limit value 0.6! "
-	//					"Results might be incorrect.",fN_);
-	//			Warning warning(msg);
-	//		}
+void ResistanceItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
+
+// Update the derivatives of the Froude number
+void ResistanceItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
 // Destructor
@@ -39,6 +36,11 @@ const double ResistanceItem::get() const {
 	return res_;
 }
 
+// Get the resistance and its derivatives for this ResistanceItem
+const Dual& ResistanceItem::getDual() const {
+	return resD_;
+}
+
 // Convert a velocity [m/s] to a Fn[-]
 double ResistanceItem::convertToFn( double velocity ){
 
@@ -60,8 +62,7 @@ InducedResistanceItem::InducedResistanceItem(AeroForcesItem* pAeroForcesItem) :
 								pAeroForcesItem_(pAeroForcesItem),
 								vf_(0.4 * sqrt(Physic::g * pParser_->get(Var::lwl_) )),
 								a_(1./(2*vf_)),
-								c_(vf_/2),
-								v_(0) {
+								c_(vf_/2) {
 
 	coeffA_.resize(4,4);
 	coeffA_ << 	3.7455,	-3.6246,	0.0589,	-0.0296,
@@ -99,6 +100,14 @@ InducedResistanceItem::InducedResistanceItem(AeroForcesItem* pAeroForcesItem) :
 	// coeffA(4x4) * vectA(4x1) = Tegeo(4x1)
 	Tegeo_ = (coeffA_ * vectA_).array();
 
+	// coeffB(4x2) * [1 Fn]' => TeFn(4x1) : split the constant and the linear
+	// part in Fn and build the spline of the effective span for each of them.
+	// Note that this is a coefficient-wise operation Tegeo(4x1) * TeFn(4x1)
+	Eigen::ArrayXd Teffective0 = t * Tegeo_ * coeffB_.col(0).array();
+	Eigen::ArrayXd Teffective1 = t * Tegeo_ * coeffB_.col(1).array();
+	pTe0_.reset( new SplineInterpolator(phiD_,Teffective0) );
+	pTe1_.reset( new SplineInterpolator(phiD_,Teffective1) );
+
 	// Define a smoothing function for Fn=0-0.2
 	pSf_.reset( new SmoothedStepFunction(0, 0.2) );
 
@@ -108,76 +117,34 @@ InducedResistanceItem::InducedResistanceItem(AeroForcesItem* pAeroForcesItem) :
 InducedResistanceItem::~InducedResistanceItem() {
 }
 
+// Make a copy of this item bound to the given aero forces item
+InducedResistanceItem* InducedResistanceItem::clone(AeroForcesItem* pAeroForcesItem) const {
 
-// Implement pure virtual method of the parent class
-void InducedResistanceItem::update(int vTW, int aTW) {
-
-	// Call the parent class update to update the Froude number
-	ResistanceItem::update(vTW,aTW);
-
-	Eigen::VectorXd vectB(2);
-	vectB << 1, fN_;
-
-	// coeffB(4x2) * vectB(2x1) => TeFn(4x1)
-	Eigen::ArrayXd TeFn = coeffB_ * vectB;
-
-	// Note that this is a coefficient-wise operation Tegeo(4x1) * TeFn(4x1) -> Teffective(4x1)
-	Eigen::ArrayXd Teffective = pParser_->get(Var::t_) * Tegeo_ * TeFn;
-
-	//std::cout<<"Teffective= \n"<<Teffective<<std::endl;
-
-	// Properly interpolate then values of TeD for the current value
-	// of the state variable x_(stateVars::phi) (heeling angle)
-	SplineInterpolator interpolator(phiD_,Teffective);
-	double Te= interpolator.interpolate(x_(stateVars::phi));
-
-	//  std::cout<<"phiDArr= "<<phiD_<<std::endl;
-	//  std::cout<<"TeD= "<<TeD<<std::endl;
-	//
-	//  Plotter plotter;
-	//  plotter.plot(phiD_,TeD);
-
-	// Make a check plot for the induced resistance6
-	// WARNING: as we are in update, this potentially leads to a
-	// large number of plots!
-	// interpolator.plot(0,toRad(30),30,"Effective Span","PHIº","Te");
-
-	// Get the aerodynamic side force. See DSYHS99 p 129. AeroForcesItem is supposedly up to
-	// date because it is stored in the aeroItems vector that is updated before the hydroItemsVector
-	double fHeel= pAeroForcesItem_->getFSide() / cos(x_(stateVars::phi));
-
-	// Compute the induced resistance Ri = Fheel^2 / (0.5 * rho_w * pi * Te^2 * V^2)
-	if(x_(stateVars::u)>0) {
-
-		// The velocity used in the denominator explodes the value of the induced resistance
-		// for small values of x_(stateVars::u). We limit then the value of res by bounding the lower value
-		// of the velocity with a parabola. This happens to preserve c1 continuity at the velocity
-		// corresponding to Fn=0.1
-		if( x_(stateVars::u)<vf_)
-			v_= a_ * x_(stateVars::u) * x_(stateVars::u) + c_;
-		else
-			v_= x_(stateVars::u);
-
-		res_ = ( fHeel * fHeel ) / ( 0.5 * Physic::rho_w * M_PI * Te * Te * v_ * v_);
-
-		// Superpose a further smoothing using a step function for  Fn=0-0.2
-		res_ *= pSf_->f( fN_ );
-
-	}
-	else
-		res_= pSf_->f( 0 ) *  ( fHeel * fHeel ) / ( 0.5 * Physic::rho_w * M_PI * Te * Te * c_ * c_);
+	InducedResistanceItem* pClone= new InducedResistanceItem(*this);
+	pClone->pAeroForcesItem_= pAeroForcesItem;
+	return pClone;
+}
 
 
-	// Whatever we have computed, make sure it is a valid number
-	if(isNotValid(res_)) throw VPPException(HERE,"res_ is Nan");
+// Implement pure virtual method of the parent class
+void InducedResistanceItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the induced resistance
+void InducedResistanceItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
+#ifndef VPP_HEADLESS
 /// Implement pure virtual of the parent class
 /// Each resistance component knows how to generate a widget
 /// to visualize itself in a plot
 std::vector<VppXYCustomPlotWidget*> InducedResistanceItem::plot(WindIndicesDialog* wd /*=0*/, StateVectorDialog* sd /*=0*/) {
 
+	// Wind condition of the grid point selected in the dialog
+	WindCondition wc= wd->getWind()->getWindCondition(wd->getTWV(),wd->getTWA());
+
 	Eigen::VectorXd xBuffer(x_);
 
 	// Prepare the vector to be returned
@@ -212,12 +179,12 @@ std::vector<VppXYCustomPlotWidget*> InducedResistanceItem::plot(WindIndicesDialo
 			x << x_(stateVars::u), x_(stateVars::phi), x_(stateVars::b), x_(stateVars::f);
 
 			// Update the aeroForceItems
-			pAeroForcesItem_->getWindItem()->updateSolution(wd->getTWV(),wd->getTWA(),x);
-			pAeroForcesItem_->getSailCoeffItem()->updateSolution(wd->getTWV(),wd->getTWA(),x);
-			pAeroForcesItem_->updateSolution(wd->getTWV(),wd->getTWA(),x);
+			pAeroForcesItem_->getWindItem()->updateSolution(wc,x);
+			pAeroForcesItem_->getSailCoeffItem()->updateSolution(wc,x);
+			pAeroForcesItem_->updateSolution(wc,x);
 
 			// Update the induced resistance Item
-			update(wd->getTWV(),wd->getTWA());
+			update(wc);
 
 			// Fill the vectors to be plot
 			fn.push_back( fN_ );
@@ -275,12 +242,12 @@ std::vector<VppXYCustomPlotWidget*> InducedResistanceItem::plot(WindIndicesDialo
 			x << x_(stateVars::u), x_(stateVars::phi), x_(stateVars::b), x_(stateVars::f);
 
 			// Update the aeroForceItems
-			pAeroForcesItem_->getWindItem()->updateSolution(wd->getTWV(),wd->getTWA(),x);
-			pAeroForcesItem_->getSailCoeffItem()->updateSolution(wd->getTWV(),wd->getTWA(),x);
-			pAeroForcesItem_->updateSolution(wd->getTWV(),wd->getTWA(),x);
+			pAeroForcesItem_->getWindItem()->updateSolution(wc,x);
+			pAeroForcesItem_->getSailCoeffItem()->updateSolution(wc,x);
+			pAeroForcesItem_->updateSolution(wc,x);
 
 			// Update the induced resistance Item
-			update(wd->getTWV(),wd->getTWA());
+			update(wc);
 
 			// Compute the heeling force
 			double fh= pAeroForcesItem_->getFSide() / cos(x_(stateVars::phi));
@@ -327,6 +294,7 @@ std::vector<VppXYCustomPlotWidget*> InducedResistanceItem::plot(WindIndicesDialo
 
 	return retVec;
 }
+#endif
 
 //=================================================================
 
@@ -341,24 +309,26 @@ ResiduaryResistanceItemBase::~ResiduaryResistanceItemBase(){
 }
 
 /// Implement pure virtual method of the parent class
-void ResiduaryResistanceItemBase::update(int vTW, int aTW) {
-
-	// Call the parent class update to update the Froude number
-	ResistanceItem::update(vTW,aTW);
-
-	// Compute the residuary resistance for the current froude number
-	res_ = pInterpolator_->interpolate(fN_);
-	if(isNotValid(res_)) throw VPPException(HERE,"res_ is Nan");
+void ResiduaryResistanceItemBase::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the residuary resistance
+void ResiduaryResistanceItemBase::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
+#ifndef VPP_HEADLESS
 // Implement pure virtual of the parent class
 // Each resistance component knows how to generate a widget
 // to visualize itself in a plot
 std::vector<VppXYCustomPlotWidget*> ResiduaryResistanceItemBase::plot(WindIndicesDialog* wd /*=0*/, StateVectorDialog* /*=0*/) {
 
+	// Wind condition of the grid point selected in the dialog
+	WindCondition wc= wd->getWind()->getWindCondition(wd->getTWV(),wd->getTWA());
+
 	// Make sure data are up to date
-	ResistanceItem::update(wd->getTWV(),wd->getTWA());
+	ResistanceItem::update(wc);
 	res_ = pInterpolator_->interpolate(fN_);
 
 	// Make a check plot for the residuary resistance
@@ -368,6 +338,7 @@ std::vector<VppXYCustomPlotWidget*> ResiduaryResistanceItemBase::plot(WindIndice
 
 	return std::vector<VppXYCustomPlotWidget*>(1,pPlot);
 }
+#endif
 
 //=================================================================
 
@@ -495,26 +466,13 @@ Delta_ResiduaryResistance_HeelItem::~Delta_ResiduaryResistance_HeelItem() {
 }
 
 // Implement pure virtual method of the parent class
-void Delta_ResiduaryResistance_HeelItem::update(int vTW, int aTW) {
-
-	// Call the parent class update to update the Froude number
-	ResistanceItem::update(vTW,aTW);
-
-	// limit the values to positive angles and Fn>0.25, as in the definition of the DHYS
-	// todo dtrimarchi : this might generate problems, we need to smooth the function down
-	// gently!!!
-	if(fN_<0.25) {
-		res_=0.;
-		return;
-	}
-
-	// Compute the residuary resistance for the current froude number
-	// RrhH = RrhH20 .* 6 .* ( phi ).^1.7;
-	// No matter the sign of phi, this is a positive resistance item and I want to
-	// make sure that negative angles increase the total resistance
-	res_ = pInterpolator_->interpolate(fN_) * 6. * std::pow( std::fabs(x_(stateVars::phi)),1.7) ;
-	if(isNotValid(res_)) throw VPPException(HERE,"res_ is Nan");
+void Delta_ResiduaryResistance_HeelItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the change in residuary resistance due to heel
+void Delta_ResiduaryResistance_HeelItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
 //=================================================================
@@ -582,11 +540,15 @@ DeltaResistanceItemBase::~DeltaResistanceItemBase() {
 
 }
 
+#ifndef VPP_HEADLESS
 // Implement pure virtual of the parent class
 // Each resistance component knows how to generate a widget
 // to visualize itself in a plot
 std::vector<VppXYCustomPlotWidget*> DeltaResistanceItemBase::plot(WindIndicesDialog* wd, StateVectorDialog* sd) {
 
+	// Wind condition of the grid point selected in the dialog
+	WindCondition wc= wd->getWind()->getWindCondition(wd->getTWV(),wd->getTWA());
+
 	// Init the state vector
 	x_(stateVars::b)= sd->getCrew();
 	x_(stateVars::f)= sd->getFlat();
@@ -613,7 +575,7 @@ std::vector<VppXYCustomPlotWidget*> DeltaResistanceItemBase::plot(WindIndicesDia
 			// Set a fictitious velocity (Fn=-0.-0.7)
 			x_(stateVars::u)= ( ( .7 / nVelocities * v ) ) * sqrt(Physic::g * pParser_->get(Var::lwl_));
 
-			update(wd->getTWV(),wd->getTWA());
+			update(wc);
 
 			// Fill the vectors to be plot
 			fn.push_back( x_(stateVars::u)/sqrt(Physic::g * pParser_->get(Var::lwl_) ) );
@@ -646,6 +608,7 @@ std::vector<VppXYCustomPlotWidget*> DeltaResistanceItemBase::plot(WindIndicesDia
 	return std::vector<VppXYCustomPlotWidget*>(1,pResPlot);
 
 }
+#endif
 
 //=================================================================
 
@@ -688,16 +651,13 @@ Delta_ResiduaryResistanceKeel_HeelItem::~Delta_ResiduaryResistanceKeel_HeelItem(
 }
 
 // Implement pure virtual method of the parent class
-void Delta_ResiduaryResistanceKeel_HeelItem::update(int vTW, int aTW) {
-
-	// Call the parent class update to update the Froude number
-	ResistanceItem::update(vTW,aTW);
-
-	// Compute the resistance
-	// RrkH = (geom.DVK.*phys.rho_w.*phys.g.*Ch)*Fn.^2.*phi*pi/180;
-	res_= Ch_ * fN_ * fN_ * x_(stateVars::phi);
-	if(isNotValid(res_)) throw VPPException(HERE,"res_ is Nan");
+void Delta_ResiduaryResistanceKeel_HeelItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the change in residuary resistance of the keel due to heel
+void Delta_ResiduaryResistanceKeel_HeelItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
 //=================================================================
@@ -712,6 +672,7 @@ ViscousResistanceItemBase::~ViscousResistanceItemBase() {
 
 }
 
+#ifndef VPP_HEADLESS
 // Implement pure virtual of the parent class
 // Each resistance component knows how to generate a widget
 // to visualize itself in a plot
@@ -749,6 +710,7 @@ std::vector<VppXYCustomPlotWidget*> ViscousResistanceItemBase::plot(WindIndicesD
 	return std::vector<VppXYCustomPlotWidget*>(1,pViscousResistancePlot);
 
 }
+#endif
 
 
 //=================================================================
@@ -774,32 +736,13 @@ ViscousResistanceItem::~ViscousResistanceItem() {
 }
 
 // Implement pure virtual method of the parent class
-void ViscousResistanceItem::update(int vTW, int aTW) {
-
-	// Call the parent class update to update the Froude number
-	ResistanceItem::update(vTW,aTW);
-
-	// Limit the computations to positive values
-	if(x_(stateVars::u)<=0) {
-		res_=0.;
-		return;
-	}
-
-	// Compute the Reynolds number
-	// Rn = geom.LWL .* 0.7 .* V ./ phys.ni_w;
-	double rN = rN0_ * x_(stateVars::u);
-
-	// Compute the Frictional coefficient
-	double cF = 0.075 / std::pow( (std::log10(rN) - 2), 2);
-
-	// Compute the Viscous resistance of the bare hull
-	// Rfh = 1/2 .* phys.rho_w .* V.^2 .* geom.SC .* Cf;
-	double rfh = rfh0_ * x_(stateVars::u) * x_(stateVars::u) * cF;
-
-	// Compute the frictional resistance
-	res_ = rfh * pParser_->get(Var::hullff_);
-	if(isNotValid(res_)) throw VPPException(HERE,"res_ is Nan");
+void ViscousResistanceItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the viscous resistance
+void ViscousResistanceItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
 //=================================================================
@@ -863,41 +806,16 @@ Delta_ViscousResistance_HeelItem::~Delta_ViscousResistance_HeelItem() {
 }
 
 // Implement pure virtual method of the parent class
-void Delta_ViscousResistance_HeelItem::update(int vTW, int aTW) {
-
-	// Call the parent class update to update the Froude number
-	ResistanceItem::update(vTW,aTW);
-
-	// Limit the computations to positive values and the heeling angles -> defined by the DHYS
-	//if(x_(stateVars::u)<=0. || x_(stateVars::phi) < mathUtils::toRad(5) ) {
-	if(x_(stateVars::u)<=0.){
-		res_=0.;
-		return;
-	}
-
-	// Compute the Reynolds number
-	// Rn = geom.LWL .* 0.7 .* V ./ phys.ni_w;
-	double rN = rN0_ * x_(stateVars::u);
-
-	// Compute the Frictional coefficient
-	double cF = 0.075 / std::pow( (std::log10(rN) - 2), 2);
-
-	// Compute the interpolated value of the change in wetted area wrt PHI [rad]
-	double SCphi = pInterpolator_->interpolate(x_(stateVars::phi));
-
-	// Compute the change in Viscous resistance using the delta of wetted surface
-	// Apart for the def. of the surface, the viscous resistance uses the std definition
-	// see DSYHS99 3.2.1.1 p119
-	// Rfh = 1/2 .* phys.rho_w .* V.^2 .* Cf .* ( S - S0 );
-	double rfhH = 0.5 * Physic::rho_w * x_(stateVars::u) * x_(stateVars::u) * cF * ( SCphi - pParser_->get(Var::sc_) );
-
-	// todo dtrimarchi: does it make sense to use the same hull form factor both for the upright and the heeled hull?
-	// See DSYHS99 p119, where the form factor is also defined. Here we ask the user to prompt a value
-	res_ = rfhH * pParser_->get(Var::hullff_);
-	if(isNotValid(res_)) throw VPPException(HERE,"res_ is Nan");
+void Delta_ViscousResistance_HeelItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the change in viscous resistance due to heel
+void Delta_ViscousResistance_HeelItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
+#ifndef VPP_HEADLESS
 // Plot the Viscous Resistance due to heel versus Fn curve
 std::vector<VppXYCustomPlotWidget*> Delta_ViscousResistance_HeelItem::plot_deltaWettedArea_heel() {
 
@@ -908,6 +826,7 @@ std::vector<VppXYCustomPlotWidget*> Delta_ViscousResistance_HeelItem::plot_delta
 	return std::vector<VppXYCustomPlotWidget*>(1,pPlot);
 
 }
+#endif
 
 //=================================================================
 
@@ -927,29 +846,13 @@ ViscousResistanceKeelItem::~ViscousResistanceKeelItem() {
 }
 
 // Implement pure virtual method of the parent class
-void ViscousResistanceKeelItem::update(int vTW, int aTW) {
-
-	// Call the parent class update to update the Froude number
-	ResistanceItem::update(vTW,aTW);
-
-	// Limit the computations to positive values
-	if(x_(stateVars::u)<=0.) {
-		res_=0.;
-		return;
-	}
-
-	// Define the Reynolds number using the mean chord length of the keel,
-	// this is a value provided by the user. The viscous resistance is
-	// defined in the std way, see DSYHS99 3.2.1.1 p 119
-	double rN = pParser_->get(Var::chmek_) * x_(stateVars::u) / Physic::ni_w;
-	double cf = 0.075 / std::pow((std::log10(rN) - 2),2);
-	double rfk= 0.5 * Physic::rho_w * x_(stateVars::u) * x_(stateVars::u) * pParser_->get(Var::sk_) * cf;
-
-	// todo dtrimarchi : this form factor can be computed from the
-	// Keel geometry (see DSYHS99) Ch.3.2.11
-	res_ = rfk * pParser_->get(Var::keelff_);
-	if(isNotValid(res_)) throw VPPException(HERE,"res_ is Nan");
+void ViscousResistanceKeelItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the viscous resistance of the keel
+void ViscousResistanceKeelItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
 //=================================================================
@@ -970,29 +873,13 @@ ViscousResistanceRudderItem::~ViscousResistanceRudderItem() {
 }
 
 /// Implement pure virtual method of the parent class
-void ViscousResistanceRudderItem::update(int vTW, int aTW) {
-
-	// Call the parent class update to update the Froude number
-	ResistanceItem::update(vTW,aTW);
-
-	// Limit the computations to positive values
-	if(x_(stateVars::u)<=0.) {
-		res_=0.;
-		return;
-	}
-
-	// Define the Reynolds number using the mean chord length of the rudder,
-	// this is a value provided by the user. The viscous resistance is
-	// defined in the std way, see DSYHS99 3.2.1.1 p 119
-	double rN = pParser_->get(Var::chmer_) * x_(stateVars::u) / Physic::ni_w;
-	double cf = 0.075 / std::pow((std::log10(rN) - 2),2);
-	double rfr= 0.5 * Physic::rho_w * x_(stateVars::u) * x_(stateVars::u) * pParser_->get(Var::sr_) * cf;
-
-	// todo dtrimarchi : this form factor can be computed from the
-	// Rudder geometry (see DSYHS99) Ch.3.2.11
-	res_ = rfr * pParser_->get(Var::ruddff_);
-	if(isNotValid(res_)) throw VPPException(HERE,"res_ is Nan");
+void ViscousResistanceRudderItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the viscous resistance of the rudder
+void ViscousResistanceRudderItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
 //=================================================================
@@ -1013,18 +900,13 @@ NegativeResistanceItem::~NegativeResistanceItem() {
 }
 
 /// Implement pure virtual method of the parent class
-void NegativeResistanceItem::update(int vTW, int aTW) {
-
-	// Call the parent class update to update the Froude number
-	ResistanceItem::update(vTW,aTW);
-
-	// Limit the computations to negative values. In this case
-	// define negative resistance as v^3
-	if(x_(stateVars::u)<0.)
-		res_=x_(stateVars::u)*x_(stateVars::u)*x_(stateVars::u);
-	else
-		res_=0;
+void NegativeResistanceItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the negative resistance
+void NegativeResistanceItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
 
 
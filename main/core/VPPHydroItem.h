@@ -4,8 +4,10 @@
 #include "VPPItem.h"
 #include "VPPAeroItem.h"
 #include "mathUtils.h"
+#ifndef VPP_HEADLESS
 #include "VppXYCustomPlotWidget.h"
 #include "MultiplePlotWidget.h"
+#endif
 
 using namespace mathUtils;
 
@@ -25,15 +27,25 @@ class ResistanceItem : public VPPItem {
 		// Get the value of the resistance for this ResistanceItem
 		const double get() const;
 
+		/// Get the resistance and its derivatives for this ResistanceItem
+		const Dual& getDual() const;
+
 		/// Convert a velocity [m/s] to a Fn[-]
 		double convertToFn( double velocity );
 
 		/// Convert a Fn[-] to a velocity [m/s]
 		double convertToVelocity( double Fn );
 
+		/// Froude number for the boat velocity u. Shared by the updates of
+		/// the items and by the compiled kernel
+		template <class T>
+		T getFroudeNumber(const T& u) const;
+
+#ifndef VPP_HEADLESS
 		/// Each resistance component knows how to generate a widget
 		/// to visualize itself in a plot
 		virtual std::vector<VppXYCustomPlotWidget*> plot(WindIndicesDialog* wd =0, StateVectorDialog* =0) =0;
+#endif
 
 		/// Declare the macro to allow for fixed size vector support
 		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -44,7 +56,14 @@ class ResistanceItem : public VPPItem {
 		ResistanceItem(VariableFileParser*, std::shared_ptr<SailSet>);
 
 		/// drag the pure virtual method of the parent class one step down
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// drag the pure virtual method of the parent class one step down
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual, decorated by the children
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		/// Froude number
 		double fN_;
@@ -52,6 +71,9 @@ class ResistanceItem : public VPPItem {
 		/// Value of the resistance
 		double res_;
 
+		/// Froude number and resistance, with their derivatives
+		Dual fND_, resD_;
+
 };
 
 ///=================================================================
@@ -66,15 +88,40 @@ class InducedResistanceItem : public ResistanceItem {
 		/// Destructor
 		~InducedResistanceItem();
 
+		/// Make a copy of this item bound to the given aero forces item
+		InducedResistanceItem* clone(AeroForcesItem*) const;
+
+		/// Effective span Te [m] for the heel angle phi [rad] and the Froude
+		/// number fN, see DSYHS99 ch4 p128
+		template <class T>
+		T getEffectiveSpan(const T& phi, const T& fN) const;
+
+		/// Induced resistance for the velocity u, the heel angle phi, the
+		/// Froude number fN and the aerodynamic side force fSide
+		template <class T>
+		T getResistance(const T& u, const T& phi, const T& fN, const T& fSide) const;
+
+#ifndef VPP_HEADLESS
 		/// Implement pure virtual of the parent class
 		/// Each resistance component knows how to generate a widget
 		/// to visualize itself in a plot
 		virtual std::vector<VppXYCustomPlotWidget*> plot(WindIndicesDialog* wd =0, StateVectorDialog* =0);
+#endif
 
 	private:
 
+		/// The compiled kernel reads the constants of this item
+		friend class VPPResidualKernel;
+
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		/// Pointer to the aerodynamic forces item
 		AeroForcesItem* pAeroForcesItem_;
@@ -84,9 +131,14 @@ class InducedResistanceItem : public ResistanceItem {
 		Eigen::VectorXd vectA_;
 		Eigen::ArrayXd phiD_,Tegeo_;
 
+		/// The effective span is linear in Fn through coeffB_, and so is the
+		/// spline through its values: Te(phi,Fn) = Te0(phi) + Fn * Te1(phi).
+		/// Both splines are built once in the ctor and combined in update
+		std::shared_ptr<SplineInterpolator> pTe0_, pTe1_;
+
 		/// Variables to be used to set a lower bound to the velocity
 		/// ( Parabolic fitting in 0 -> V|(Fn=0.1)  )
-		double vf_, a_, c_, v_;
+		double vf_, a_, c_;
 
 		/// Smoothed step function used to smooth the values of the induced
 		/// resistance in the neighborhood of 0
@@ -106,10 +158,16 @@ class ResiduaryResistanceItemBase : public ResistanceItem {
 		/// Destructor
 		~ResiduaryResistanceItemBase();
 
+		/// Residuary resistance for the Froude number fN
+		template <class T>
+		T getResistance(const T& fN) const;
+
+#ifndef VPP_HEADLESS
 		/// Implement pure virtual of the parent class
 		/// Each resistance component knows how to generate a widget
 		/// to visualize itself in a plot
 		virtual std::vector<VppXYCustomPlotWidget*> plot(WindIndicesDialog* wd =0, StateVectorDialog* =0);
+#endif
 
 	protected:
 
@@ -118,8 +176,18 @@ class ResiduaryResistanceItemBase : public ResistanceItem {
 
 	private:
 
+		/// The compiled kernel reads the constants of this item
+		friend class VPPResidualKernel;
+
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 };
 
@@ -152,10 +220,12 @@ class DeltaResistanceItemBase : public ResistanceItem {
 		/// Destructor
 		virtual ~DeltaResistanceItemBase();
 
+#ifndef VPP_HEADLESS
 		/// Implement pure virtual of the parent class
 		/// Each resistance component knows how to generate a widget
 		/// to visualize itself in a plot
 		virtual std::vector<VppXYCustomPlotWidget*> plot(WindIndicesDialog* wd, StateVectorDialog*);
+#endif
 
 };
 
@@ -172,10 +242,25 @@ class Delta_ResiduaryResistance_HeelItem : public DeltaResistanceItemBase {
 		/// Destructor
 		virtual ~Delta_ResiduaryResistance_HeelItem();
 
+		/// Change in residuary resistance for the Froude number fN and the
+		/// heel angle phi
+		template <class T>
+		T getResistance(const T& fN, const T& phi) const;
+
 	private:
 
+		/// The compiled kernel reads the constants of this item
+		friend class VPPResidualKernel;
+
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		/// Interpolator that stores the residuary resistance curve for all froude numbers
 		std::shared_ptr<SplineInterpolator> pInterpolator_;
@@ -212,10 +297,25 @@ class Delta_ResiduaryResistanceKeel_HeelItem : public DeltaResistanceItemBase {
 		/// Destructor
 		~Delta_ResiduaryResistanceKeel_HeelItem();
 
+		/// Change in residuary resistance of the keel for the Froude number
+		/// fN and the heel angle phi
+		template <class T>
+		T getResistance(const T& fN, const T& phi) const;
+
 	private:
 
+		/// The compiled kernel reads the constants of this item
+		friend class VPPResidualKernel;
+
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		/// Resistance coefficient
 		double Ch_;
@@ -235,10 +335,12 @@ class ViscousResistanceItemBase : public ResistanceItem {
 		/// Destructor
 		~ViscousResistanceItemBase();
 
+#ifndef VPP_HEADLESS
 		/// Implement pure virtual of the parent class
 		/// Each resistance component knows how to generate a widget
 		/// to visualize itself in a plot
 		virtual std::vector<VppXYCustomPlotWidget*> plot(WindIndicesDialog* wd =0, StateVectorDialog* =0);
+#endif
 
 	protected:
 
@@ -247,7 +349,10 @@ class ViscousResistanceItemBase : public ResistanceItem {
 	private:
 
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW)=0;
+		virtual void update(const WindCondition& wc)=0;
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc)=0;
 
 };
 
@@ -264,10 +369,24 @@ class ViscousResistanceItem : public ViscousResistanceItemBase {
 		/// Destructor
 		~ViscousResistanceItem();
 
+		/// Viscous resistance for the velocity u
+		template <class T>
+		T getResistance(const T& u) const;
+
 	private:
 
+		/// The compiled kernel reads the constants of this item
+		friend class VPPResidualKernel;
+
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		double 	rN0_,  //< Velocity Independent part of the Reynolds number
 		rfh0_; //< Velocity Independent part of the viscous resistance of the bare hull
@@ -288,13 +407,30 @@ class Delta_ViscousResistance_HeelItem : public DeltaResistanceItemBase {
 		/// Destructor
 		~Delta_ViscousResistance_HeelItem();
 
+		/// Change in viscous resistance for the velocity u and the heel
+		/// angle phi
+		template <class T>
+		T getResistance(const T& u, const T& phi) const;
+
+#ifndef VPP_HEADLESS
 		/// Plot the Viscous Resistance due to heel vs Fn curve
 		std::vector<VppXYCustomPlotWidget*> plot_deltaWettedArea_heel();
+#endif
 
 	private:
 
+		/// The compiled kernel reads the constants of this item
+		friend class VPPResidualKernel;
+
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		//< Velocity Independent part of the Reynolds number
 		double 	rN0_;
@@ -316,10 +452,21 @@ class ViscousResistanceKeelItem : public ViscousResistanceItemBase {
 		/// Destructor
 		~ViscousResistanceKeelItem();
 
+		/// Viscous resistance of the keel for the velocity u
+		template <class T>
+		T getResistance(const T& u) const;
+
 	private:
 
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 };
 
@@ -335,10 +482,21 @@ class ViscousResistanceRudderItem : public ViscousResistanceItemBase {
 		/// Destructor
 		~ViscousResistanceRudderItem();
 
+		/// Viscous resistance of the rudder for the velocity u
+		template <class T>
+		T getResistance(const T& u) const;
+
 	private:
 
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 };
 
@@ -355,13 +513,26 @@ class NegativeResistanceItem : public ViscousResistanceItemBase {
 		/// Destructor
 		~NegativeResistanceItem();
 
+		/// Negative resistance for the velocity u
+		template <class T>
+		T getResistance(const T& u) const;
+
 	private:
 
 		/// Implement pure virtual method of the parent class
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the resistance
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 };
 
 //=================================================================
 
+#include "VPPHydroItem_tpl.h"
+
 #endif
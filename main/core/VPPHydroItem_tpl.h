@@ -0,0 +1,318 @@
+#include "VPPException.h"
+
+// Froude number for the boat velocity u
+template <class T>
+T ResistanceItem::getFroudeNumber(const T& u) const {
+	return u / sqrt(Physic::g * pParser_->get(Var::lwl_));
+}
+
+// Update the Froude number using the state variable boat velocity
+template <class T>
+void ResistanceItem::updateScalar(const WindCondition& wc) {
+
+	T& fN= select<T>(fN_,fND_);
+	fN= getFroudeNumber(getState<T>(stateVars::u));
+	if(isNotValid(fN)) throw VPPException(HERE,"fN_ is Nan");
+
+	//		if(fN_ > 0.6) {
+	//			char msg[256];
+	//			sprintf(msg,"The value of the Froude Number %f exceeds the limit value 0.6! "
+	//					"Results might be incorrect.",fN_);
+	//			Warning warning(msg);
+	//		}
+}
+
+//=================================================================
+
+// Effective span for the heel angle phi and the Froude number fN
+template <class T>
+T InducedResistanceItem::getEffectiveSpan(const T& phi, const T& fN) const {
+	return pTe0_->interpolate(phi) + fN * pTe1_->interpolate(phi);
+}
+
+// Compute the induced resistance Ri = Fheel^2 / (0.5 * rho_w * pi * Te^2 * V^2)
+template <class T>
+T InducedResistanceItem::getResistance(const T& u, const T& phi, const T& fN, const T& fSide) const {
+
+	// Properly interpolate then values of TeD for the current value
+	// of the heeling angle. The spline of Teffective = T * Tegeo * (coeffB * [1 Fn]')
+	// is the combination of the two splines built in the ctor
+	T Te= getEffectiveSpan(phi,fN);
+
+	// Get the aerodynamic side force. See DSYHS99 p 129
+	T fHeel= fSide / cos(phi);
+
+	if(u>0) {
+
+		// The velocity used in the denominator explodes the value of the induced resistance
+		// for small values of u. We limit then the value of res by bounding the lower value
+		// of the velocity with a parabola. This happens to preserve c1 continuity at the velocity
+		// corresponding to Fn=0.1
+		T v;
+		if( u<vf_)
+			v= a_ * u * u + c_;
+		else
+			v= u;
+
+		T res= ( fHeel * fHeel ) / ( 0.5 * Physic::rho_w * M_PI * Te * Te * v * v);
+
+		// Superpose a further smoothing using a step function for  Fn=0-0.2
+		res *= pSf_->f( fN );
+		return res;
+	}
+
+	return pSf_->f( 0 ) *  ( fHeel * fHeel ) / ( 0.5 * Physic::rho_w * M_PI * Te * Te * c_ * c_);
+}
+
+// Update the induced resistance. AeroForcesItem is supposedly up to date because
+// it is stored in the aeroItems vector that is updated before the hydroItemsVector
+template <class T>
+void InducedResistanceItem::updateScalar(const WindCondition& wc) {
+
+	// Call the parent class method to update the Froude number
+	ResistanceItem::updateScalar<T>(wc);
+
+	T& res= select<T>(res_,resD_);
+	res= getResistance(getState<T>(stateVars::u),getState<T>(stateVars::phi),select<T>(fN_,fND_),
+			select<T>(pAeroForcesItem_->getFSide(),pAeroForcesItem_->getFSideDual()));
+
+	// Whatever we have computed, make sure it is a valid number
+	if(isNotValid(res)) throw VPPException(HERE,"res_ is Nan");
+}
+
+//=================================================================
+
+// Compute the residuary resistance for the froude number fN
+template <class T>
+T ResiduaryResistanceItemBase::getResistance(const T& fN) const {
+	return pInterpolator_->interpolate(fN);
+}
+
+// Update the residuary resistance
+template <class T>
+void ResiduaryResistanceItemBase::updateScalar(const WindCondition& wc) {
+
+	// Call the parent class method to update the Froude number
+	ResistanceItem::updateScalar<T>(wc);
+
+	T& res= select<T>(res_,resD_);
+	res= getResistance(select<T>(fN_,fND_));
+	if(isNotValid(res)) throw VPPException(HERE,"res_ is Nan");
+}
+
+//=================================================================
+
+// Compute the change in residuary resistance : RrhH = RrhH20 .* 6 .* ( phi ).^1.7;
+// No matter the sign of phi, this is a positive resistance item and I want to
+// make sure that negative angles increase the total resistance
+template <class T>
+T Delta_ResiduaryResistance_HeelItem::getResistance(const T& fN, const T& phi) const {
+
+	// limit the values to positive angles and Fn>0.25, as in the definition of the DHYS
+	// todo dtrimarchi : this might generate problems, we need to smooth the function down
+	// gently!!!
+	if(fN<0.25)
+		return T(0.);
+
+	return pInterpolator_->interpolate(fN) * 6. * pow( fabs(phi),1.7);
+}
+
+// Update the change in residuary resistance due to heel
+template <class T>
+void Delta_ResiduaryResistance_HeelItem::updateScalar(const WindCondition& wc) {
+
+	// Call the parent class method to update the Froude number
+	ResistanceItem::updateScalar<T>(wc);
+
+	T& res= select<T>(res_,resD_);
+	res= getResistance(select<T>(fN_,fND_),getState<T>(stateVars::phi));
+	if(isNotValid(res)) throw VPPException(HERE,"res_ is Nan");
+}
+
+//=================================================================
+
+// Compute the resistance
+// RrkH = (geom.DVK.*phys.rho_w.*phys.g.*Ch)*Fn.^2.*phi*pi/180;
+template <class T>
+T Delta_ResiduaryResistanceKeel_HeelItem::getResistance(const T& fN, const T& phi) const {
+	return Ch_ * fN * fN * phi;
+}
+
+// Update the change in residuary resistance of the keel due to heel
+template <class T>
+void Delta_ResiduaryResistanceKeel_HeelItem::updateScalar(const WindCondition& wc) {
+
+	// Call the parent class method to update the Froude number
+	ResistanceItem::updateScalar<T>(wc);
+
+	T& res= select<T>(res_,resD_);
+	res= getResistance(select<T>(fN_,fND_),getState<T>(stateVars::phi));
+	if(isNotValid(res)) throw VPPException(HERE,"res_ is Nan");
+}
+
+//=================================================================
+
+// Compute the viscous resistance of the bare hull
+template <class T>
+T ViscousResistanceItem::getResistance(const T& u) const {
+
+	// Limit the computations to positive values
+	if(u<=0)
+		return T(0.);
+
+	// Compute the Reynolds number
+	// Rn = geom.LWL .* 0.7 .* V ./ phys.ni_w;
+	T rN = rN0_ * u;
+
+	// Compute the Frictional coefficient
+	T cF = 0.075 / pow( (log10(rN) - 2), 2);
+
+	// Compute the Viscous resistance of the bare hull
+	// Rfh = 1/2 .* phys.rho_w .* V.^2 .* geom.SC .* Cf;
+	T rfh = rfh0_ * u * u * cF;
+
+	// Compute the frictional resistance
+	return rfh * pParser_->get(Var::hullff_);
+}
+
+// Update the viscous resistance
+template <class T>
+void ViscousResistanceItem::updateScalar(const WindCondition& wc) {
+
+	// Call the parent class method to update the Froude number
+	ResistanceItem::updateScalar<T>(wc);
+
+	T& res= select<T>(res_,resD_);
+	res= getResistance(getState<T>(stateVars::u));
+	if(isNotValid(res)) throw VPPException(HERE,"res_ is Nan");
+}
+
+//=================================================================
+
+// Compute the change in viscous resistance due to heel
+template <class T>
+T Delta_ViscousResistance_HeelItem::getResistance(const T& u, const T& phi) const {
+
+	// Limit the computations to positive values
+	if(u<=0.)
+		return T(0.);
+
+	// Compute the Reynolds number
+	// Rn = geom.LWL .* 0.7 .* V ./ phys.ni_w;
+	T rN = rN0_ * u;
+
+	// Compute the Frictional coefficient
+	T cF = 0.075 / pow( (log10(rN) - 2), 2);
+
+	// Compute the interpolated value of the change in wetted area wrt PHI [rad]
+	T SCphi = pInterpolator_->interpolate(phi);
+
+	// Compute the change in Viscous resistance using the delta of wetted surface
+	// Apart for the def. of the surface, the viscous resistance uses the std definition
+	// see DSYHS99 3.2.1.1 p119
+	// Rfh = 1/2 .* phys.rho_w .* V.^2 .* Cf .* ( S - S0 );
+	T rfhH = 0.5 * Physic::rho_w * u * u * cF * ( SCphi - pParser_->get(Var::sc_) );
+
+	// todo dtrimarchi: does it make sense to use the same hull form factor both for the upright and the heeled hull?
+	// See DSYHS99 p119, where the form factor is also defined. Here we ask the user to prompt a value
+	return rfhH * pParser_->get(Var::hullff_);
+}
+
+// Update the change in viscous resistance due to heel
+template <class T>
+void Delta_ViscousResistance_HeelItem::updateScalar(const WindCondition& wc) {
+
+	// Call the parent class method to update the Froude number
+	ResistanceItem::updateScalar<T>(wc);
+
+	T& res= select<T>(res_,resD_);
+	res= getResistance(getState<T>(stateVars::u),getState<T>(stateVars::phi));
+	if(isNotValid(res)) throw VPPException(HERE,"res_ is Nan");
+}
+
+//=================================================================
+
+// Compute the viscous resistance of the keel. The Reynolds number uses the
+// mean chord length of the keel, this is a value provided by the user. The
+// viscous resistance is defined in the std way, see DSYHS99 3.2.1.1 p 119
+template <class T>
+T ViscousResistanceKeelItem::getResistance(const T& u) const {
+
+	// Limit the computations to positive values
+	if(u<=0.)
+		return T(0.);
+
+	T rN = pParser_->get(Var::chmek_) * u / Physic::ni_w;
+	T cf = 0.075 / pow((log10(rN) - 2),2);
+	T rfk= 0.5 * Physic::rho_w * u * u * pParser_->get(Var::sk_) * cf;
+
+	// todo dtrimarchi : this form factor can be computed from the
+	// Keel geometry (see DSYHS99) Ch.3.2.11
+	return rfk * pParser_->get(Var::keelff_);
+}
+
+// Update the viscous resistance of the keel
+template <class T>
+void ViscousResistanceKeelItem::updateScalar(const WindCondition& wc) {
+
+	// Call the parent class method to update the Froude number
+	ResistanceItem::updateScalar<T>(wc);
+
+	T& res= select<T>(res_,resD_);
+	res= getResistance(getState<T>(stateVars::u));
+	if(isNotValid(res)) throw VPPException(HERE,"res_ is Nan");
+}
+
+//=================================================================
+
+// Compute the viscous resistance of the rudder, as per the keel
+template <class T>
+T ViscousResistanceRudderItem::getResistance(const T& u) const {
+
+	// Limit the computations to positive values
+	if(u<=0.)
+		return T(0.);
+
+	T rN = pParser_->get(Var::chmer_) * u / Physic::ni_w;
+	T cf = 0.075 / pow((log10(rN) - 2),2);
+	T rfr= 0.5 * Physic::rho_w * u * u * pParser_->get(Var::sr_) * cf;
+
+	// todo dtrimarchi : this form factor can be computed from the
+	// Rudder geometry (see DSYHS99) Ch.3.2.11
+	return rfr * pParser_->get(Var::ruddff_);
+}
+
+// Update the viscous resistance of the rudder
+template <class T>
+void ViscousResistanceRudderItem::updateScalar(const WindCondition& wc) {
+
+	// Call the parent class method to update the Froude number
+	ResistanceItem::updateScalar<T>(wc);
+
+	T& res= select<T>(res_,resD_);
+	res= getResistance(getState<T>(stateVars::u));
+	if(isNotValid(res)) throw VPPException(HERE,"res_ is Nan");
+}
+
+//=================================================================
+
+// Limit the computations to negative values. In this case
+// define negative resistance as v^3
+template <class T>
+T NegativeResistanceItem::getResistance(const T& u) const {
+
+	if(u<0.)
+		return u*u*u;
+
+	return T(0.);
+}
+
+// Update the negative resistance
+template <class T>
+void NegativeResistanceItem::updateScalar(const WindCondition& wc) {
+
+	// Call the parent class method to update the Froude number
+	ResistanceItem::updateScalar<T>(wc);
+
+	select<T>(res_,resD_)= getResistance(getState<T>(stateVars::u));
+}
@@ -32,7 +32,7 @@ std::shared_ptr<SailSet> VPPItem::getSailSet() const {
 
 // Update the items for the current step (wind velocity and angle),
 // the value of the state vector x computed by the optimizer
-void VPPItem::updateSolution(int vTW, int aTW, const double* x) {
+void VPPItem::updateSolution(const WindCondition& wc, const double* x) {
 
 	if(mathUtils::isNotValid(x[0])) throw VPPException(HERE,"x[0] is NAN!");
 	if(mathUtils::isNotValid(x[1])) throw VPPException(HERE,"x[1] is NAN!");
@@ -45,16 +45,16 @@ void VPPItem::updateSolution(int vTW, int aTW, const double* x) {
 	x_(stateVars::b)=  x[2];
 	x_(stateVars::f)=  x[3];
 
-	// Now call the implementation of the pure virtual update(int,int)
+	// Now call the implementation of the pure virtual update(const WindCondition&)
 	// for every child
-	update(vTW,aTW);
+	update(wc);
 
 }
 
 // Update the parent VPPItem for the current step (wind velocity and angle),
 // the value of the state vector x computed by the optimizer. Then, call the
 // update method for the children in the vppItems_ vector
-void VPPItem::updateSolution(int vTW, int aTW, Eigen::VectorXd& x) {
+void VPPItem::updateSolution(const WindCondition& wc, Eigen::VectorXd& x) {
 
 	for(size_t i=0; i<x.size(); i++)
 		if(mathUtils::isNotValid(x(i))) {
@@ -66,9 +66,23 @@ void VPPItem::updateSolution(int vTW, int aTW, Eigen::VectorXd& x) {
 	// Update the local copy of the state variables
 	x_=x;
 
-	// Now call the implementation of the pure virtual update(int,int)
+	// Now call the implementation of the pure virtual update(const WindCondition&)
 	// for every child
-	update(vTW,aTW);
+	update(wc);
+
+}
+
+// Update the derivatives of the item wrt the state variables for the
+// current step (forward-mode automatic differentiation)
+void VPPItem::updateDerivatives(const WindCondition& wc) {
+
+	// Seed the Duals of the state variables
+	for(size_t i=0; i<4; i++)
+		xD_[i]= i<x_.size() ? Dual(x_(i),i) : Dual(0.);
+
+	// Now call the implementation of the pure virtual updateDual(const WindCondition&)
+	// for every child
+	updateDual(wc);
 
 }
 
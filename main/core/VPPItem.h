@@ -2,11 +2,14 @@
 #define VPPITEM_H
 
 #include <vector>
+#include <memory>
 #include <Eigen/Core>
 
 #include "VariableFileParser.h"
 #include "SailSet.h"
 #include "Interpolator.h"
+#include "Dual.h"
+#include "WindCondition.h"
 
 using namespace std;
 using namespace Eigen;
@@ -35,12 +38,18 @@ class VPPItem {
 		/// Update the parent VPPItem for the current step (wind velocity and angle),
 		/// the value of the state vector x computed by the optimizer. Then, call the
 		/// update method for the children in the vppItems_ vector
-		void updateSolution(int vTW, int aTW, const double* x);
+		void updateSolution(const WindCondition& wc, const double* x);
 
 		/// Update the parent VPPItem for the current step (wind velocity and angle),
 		/// the value of the state vector x computed by the optimizer. Then, call the
 		/// update method for the children in the vppItems_ vector
-		void updateSolution(int vTW, int aTW, VectorXd& x);
+		void updateSolution(const WindCondition& wc, VectorXd& x);
+
+		/// Update the derivatives of the item wrt the state variables for the
+		/// current step (forward-mode automatic differentiation). The item must
+		/// have been updated with updateSolution, that sets the state vector
+		/// the derivatives are computed for
+		void updateDerivatives(const WindCondition& wc);
 
 		/// Returns a ptr to the parser
 		VariableFileParser* getParser() const;
@@ -53,6 +62,10 @@ class VPPItem {
 		/// State vector (v,phi,b,f)
 		VectorXd x_;
 
+		/// State vector seeded for the automatic differentiation: each
+		/// state variable has a unit derivative wrt itself
+		Dual xD_[4];
+
 		/// Size of the pb, or the number of state variables
 		size_t pbSize_;
 
@@ -62,13 +75,33 @@ class VPPItem {
 		/// Ptr to the SailSet with the sail related variables
 		std::shared_ptr<SailSet> pSailSet_;
 
+		/// Returns the state variable iVar for the scalar type T of the update :
+		/// its value for a double, its value and its derivatives for a Dual
+		template <class T>
+		const T& getState(size_t iVar) const;
+
+		/// Select the member that stores a quantity of the item for the scalar
+		/// type T of the update : the value for a double, the Dual for a Dual
+		template <class T>
+		static T& select(double& val, Dual& dual);
+
+		/// Same as select, to read a quantity of another item
+		template <class T>
+		static T select(double val, const Dual& dual);
+
 	private:
 
 		/// Update the items for the current step (wind velocity and angle),
 		/// the value of the state vector x computed by the optimizer
-		virtual void update(int vTW, int aTW)=0;
+		virtual void update(const WindCondition& wc)=0;
+
+		/// Update the derivatives of the item for the current step. The items
+		/// implement update and updateDual with a single body, templated on
+		/// the scalar type : double for the values, Dual for the derivatives
+		virtual void updateDual(const WindCondition& wc)=0;
 
 };
 
+#include "VPPItem_tpl.h"
 
 #endif
@@ -5,6 +5,7 @@
 
 #include "IOUtils.h"
 #include "NRSolver.h"
+#ifndef VPP_HEADLESS
 #include "VPPDialogs.h"
 #include "VppXYCustomPlotWidget.h"
 #include "MultiplePlotWidget.h"
@@ -96,14 +97,28 @@ ThreeDDataContainer& ThreeDDataContainer::operator=(const ThreeDDataContainer& r
 
 	return *this;
 }
+#endif
 
 ///////////////////////////////////////////////////
 
+// Ctor: all contributions are null
+ResidualComponents::ResidualComponents() :
+	fDrive_(0),
+	resistance_(0),
+	mHeel_(0),
+	mRight_(0) {
+}
+
 // Constructor
 VPPItemFactory::VPPItemFactory(VariableFileParser* pParser, std::shared_ptr<SailSet> pSailSet):
 pParser_(pParser),
 dF_(0),
-dM_(0) {
+dM_(0),
+cacheSize_(32),
+nextCacheEntry_(0),
+nCacheHits_(0),
+nCacheMisses_(0),
+compiled_(false) {
 
 	// -- INSTANTIATE THE AERO ITEMS
 
@@ -185,44 +200,130 @@ dM_(0) {
 
 }
 
+// Copy constructor used by clone: deep copy of the items,
+// rewired to their own sibling items
+VPPItemFactory::VPPItemFactory(const VPPItemFactory& rhs):
+pParser_(rhs.pParser_),
+dF_(rhs.dF_),
+dM_(rhs.dM_),
+components_(rhs.components_),
+cacheSize_(rhs.cacheSize_),
+nextCacheEntry_(0),
+nCacheHits_(0),
+nCacheMisses_(0),
+compiled_(rhs.compiled_) {
+
+	// The clone starts with an empty cache of the residuals, and
+	// builds its own compiled kernel on first use
+
+	// -- COPY THE AERO ITEMS, in the same order as the ctor
+
+	pWind_.reset( new WindItem(*rhs.pWind_) );
+	vppAeroItems_.push_back( pWind_ );
+
+	pSailCoeffItem_.reset( rhs.pSailCoeffItem_->clone(pWind_.get()) );
+	vppAeroItems_.push_back( pSailCoeffItem_ );
+
+	pAeroForcesItem_.reset( rhs.pAeroForcesItem_->clone(pSailCoeffItem_.get()) );
+	vppAeroItems_.push_back( pAeroForcesItem_ );
+
+	// -- COPY THE 10 RESISTANCE ITEMS, in the same order as the ctor
+
+	pViscousResistanceItem_.reset( new ViscousResistanceItem(*rhs.pViscousResistanceItem_) );
+	vppHydroItems_.push_back( pViscousResistanceItem_ );
+
+	pResiduaryResistanceItem_.reset( new ResiduaryResistanceItem(*rhs.pResiduaryResistanceItem_) );
+	vppHydroItems_.push_back( pResiduaryResistanceItem_ );
+
+	pDelta_ViscousResistance_HeelItem_.reset( new Delta_ViscousResistance_HeelItem(*rhs.pDelta_ViscousResistance_HeelItem_) );
+	vppHydroItems_.push_back( pDelta_ViscousResistance_HeelItem_ );
+
+	pDelta_ResiduaryResistance_HeelItem_.reset( new Delta_ResiduaryResistance_HeelItem(*rhs.pDelta_ResiduaryResistance_HeelItem_) );
+	vppHydroItems_.push_back( pDelta_ResiduaryResistance_HeelItem_ );
+
+	pViscousResistanceKeelItem_.reset( new ViscousResistanceKeelItem(*rhs.pViscousResistanceKeelItem_) );
+	vppHydroItems_.push_back( pViscousResistanceKeelItem_ );
+
+	pViscousResistanceRudderItem_.reset( new ViscousResistanceRudderItem(*rhs.pViscousResistanceRudderItem_) );
+	vppHydroItems_.push_back( pViscousResistanceRudderItem_ );
+
+	pResiduaryResistanceKeelItem_.reset( new ResiduaryResistanceKeelItem(*rhs.pResiduaryResistanceKeelItem_) );
+	vppHydroItems_.push_back( pResiduaryResistanceKeelItem_ );
+
+	pDelta_ResiduaryResistanceKeel_HeelItem_.reset( new Delta_ResiduaryResistanceKeel_HeelItem(*rhs.pDelta_ResiduaryResistanceKeel_HeelItem_) );
+	vppHydroItems_.push_back( pDelta_ResiduaryResistanceKeel_HeelItem_ );
+
+	pInducedResistanceItem_.reset( rhs.pInducedResistanceItem_->clone(pAeroForcesItem_.get()) );
+	vppHydroItems_.push_back( pInducedResistanceItem_ );
+
+	pNegativeResistance_.reset( new NegativeResistanceItem(*rhs.pNegativeResistance_) );
+	vppHydroItems_.push_back( pNegativeResistance_ );
+
+	// ----------
+
+	pRightingMomentItem_.reset( new RightingMomentItem(*rhs.pRightingMomentItem_) );
+
+}
+
 // Destructor
 VPPItemFactory::~VPPItemFactory(){
 
 }
 
+// Make an independent copy of this factory, with its own item states
+VPPItemFactory* VPPItemFactory::clone() const {
+	return new VPPItemFactory(*this);
+}
+
 // Update the VPPItems for the current step (wind velocity and angle),
 // the value of the state vector x computed by the optimizer
 // TODO dtrimarchi: definitely remove the old c-style signature
-void VPPItemFactory::update(int vTW, int aTW, Eigen::VectorXd& x) {
+void VPPItemFactory::update(const WindCondition& wc, Eigen::VectorXd& x) {
+
+	telemetry_.nUpdates_++;
+	TelemetryTimer timer(telemetry_.updateTime_);
 
 	// Update all of the aero items:
 	for(size_t iItem=0; iItem<vppAeroItems_.size(); iItem++)
-		vppAeroItems_[iItem]->updateSolution(vTW,aTW,x);
+		vppAeroItems_[iItem]->updateSolution(wc,x);
 
 	// Update all of the hydro items:
 	for(size_t iItem=0; iItem<vppHydroItems_.size(); iItem++)
-		vppHydroItems_[iItem]->VPPItem::updateSolution(vTW,aTW,x);
+		vppHydroItems_[iItem]->VPPItem::updateSolution(wc,x);
 
 	// Update of the righting moment item:
-	pRightingMomentItem_->VPPItem::updateSolution(vTW,aTW,x);
+	pRightingMomentItem_->VPPItem::updateSolution(wc,x);
 
 }
 
 // Update the VPPItems for the current step (wind velocity and angle),
 // the value of the state vector x computed by the optimizer
-void VPPItemFactory::update(int vTW, int aTW, const double* x) {
+void VPPItemFactory::update(const WindCondition& wc, const double* x) {
+
+	telemetry_.nUpdates_++;
+	TelemetryTimer timer(telemetry_.updateTime_);
 
 	// Update all of the aero items:
 	for(size_t iItem=0; iItem<vppAeroItems_.size(); iItem++)
-		vppAeroItems_[iItem]->updateSolution(vTW,aTW,x);
+		vppAeroItems_[iItem]->updateSolution(wc,x);
 
 	// Update all of the hydro items:
 	for(size_t iItem=0; iItem<vppHydroItems_.size(); iItem++)
-		vppHydroItems_[iItem]->VPPItem::updateSolution(vTW,aTW,x);
+		vppHydroItems_[iItem]->VPPItem::updateSolution(wc,x);
 
 	// Update of the righting moment item:
-	pRightingMomentItem_->VPPItem::updateSolution(vTW,aTW,x);
+	pRightingMomentItem_->VPPItem::updateSolution(wc,x);
+
+}
 
+// Update the VPPItems for the wind condition of the grid point (vTW, aTW)
+void VPPItemFactory::update(int vTW, int aTW, Eigen::VectorXd& x) {
+	update(pWind_->getWindCondition(vTW,aTW),x);
+}
+
+// Update the VPPItems for the wind condition of the grid point (vTW, aTW)
+void VPPItemFactory::update(int vTW, int aTW, const double* x) {
+	update(pWind_->getWindCondition(vTW,aTW),x);
 }
 
 // Returns a ptr to the variableFileParser
@@ -322,34 +423,143 @@ double VPPItemFactory::getResistance() {
 
 void VPPItemFactory::getResiduals(double& dF, double& dM) {
 
-	// compute deltaF = (Fdrive - Rtot)
-	dF_ = (pAeroForcesItem_->getFDrive() - getResistance());
+	computeResiduals();
 	dF=dF_;
-
-	// compute deltaM = (Mheel  - Mright)
-	dM_ = (pAeroForcesItem_->getMHeel()  - pRightingMomentItem_->get());
 	dM=dM_;
 
 	//std::cout<<"dF= "<<dF<<"  dM= "<<dM<<std::endl;
 
 }
 
-Eigen::VectorXd VPPItemFactory::getResiduals(int vTW, int aTW, Eigen::VectorXd& x) {
-
-	// Update the items with the state vector
-	update(vTW, aTW, x);
+Eigen::VectorXd VPPItemFactory::getResiduals(const WindCondition& wc, Eigen::VectorXd& x) {
 
-	// Compute deltaF = (Fdrive + Rtot). Remember that FDrive is supposedly
-	// positive, while the resistance is always negative
-	dF_ = (pAeroForcesItem_->getFDrive() - getResistance());
-
-	// Compute deltaM = (Mheel + Mright). Remember that mHeel is Positive,
-	// while righting moment is negative (right hand rule)
-	dM_ = (pAeroForcesItem_->getMHeel() - pRightingMomentItem_->get());
+	double dF, dM;
+	getResiduals(wc,x,dF,dM);
 
 	// Returns the results in a reasonable Eigen-style shape
 	return getResiduals();
+}
+
+// Compute the force/moment residuals for the state vector x, returned in dF and dM
+void VPPItemFactory::getResiduals(const WindCondition& wc, Eigen::VectorXd& x, double& dF, double& dM) {
+
+	telemetry_.nResiduals_++;
+
+	// Look for these residuals in the cache. In case of hit, we do not
+	// need to update the items
+	const ResidualCacheEntry* pEntry= findInCache(wc,x);
+	if(pEntry) {
+		nCacheHits_++;
+		dF= dF_= pEntry->dF_;
+		dM= dM_= pEntry->dM_;
+		components_= pEntry->components_;
+		return;
+	}
+	nCacheMisses_++;
+
+	// Evaluate the compiled kernel in place of the items
+	if(compiled_ && x.size()==4) {
 
+		telemetry_.nUpdates_++;
+		TelemetryTimer timer(telemetry_.updateTime_);
+
+		if(!pKernel_)
+			pKernel_.reset( new VPPResidualKernel(this) );
+		pKernel_->evaluate(wc,x.data(),dF_,dM_,components_);
+	}
+	else {
+
+		// Update the items with the state vector
+		update(wc, x);
+
+		computeResiduals();
+	}
+
+	storeInCache(wc,x);
+
+	dF= dF_;
+	dM= dM_;
+}
+
+Eigen::VectorXd VPPItemFactory::getResiduals(const WindCondition& wc, Eigen::VectorXd& x, Eigen::MatrixXd& dResiduals) {
+
+	telemetry_.nResiduals_++;
+
+	// Update the items with the state vector. The derivatives are computed
+	// from the values of the items, so this comes first. Do not use the
+	// cache here, the items must be updated in any case
+	update(wc, x);
+	computeResiduals();
+	storeInCache(wc,x);
+	Eigen::VectorXd residuals= getResiduals();
+
+	// Update the derivatives of the items, with the same order as per update
+	for(size_t iItem=0; iItem<vppAeroItems_.size(); iItem++)
+		vppAeroItems_[iItem]->updateDerivatives(wc);
+
+	for(size_t iItem=0; iItem<vppHydroItems_.size(); iItem++)
+		vppHydroItems_[iItem]->VPPItem::updateDerivatives(wc);
+
+	pRightingMomentItem_->VPPItem::updateDerivatives(wc);
+
+	// Compose the derivatives of deltaF = (Fdrive - Rtot)
+	Dual dF= pAeroForcesItem_->getFDriveDual();
+	for(size_t iItem=0; iItem<vppHydroItems_.size(); iItem++)
+		dF-= vppHydroItems_[iItem]->getDual();
+
+	// Compose the derivatives of deltaM = (Mheel - Mright)
+	Dual dM= pAeroForcesItem_->getMHeelDual() - pRightingMomentItem_->getDual();
+
+	dResiduals.resize(2,4);
+	dResiduals.row(0)= dF.d().transpose();
+	dResiduals.row(1)= dM.d().transpose();
+
+	for(size_t i=0; i<dResiduals.rows(); i++)
+		for(size_t j=0; j<dResiduals.cols(); j++)
+			if(mathUtils::isNotValid(dResiduals(i,j))) {
+				char msg[256];
+				sprintf(msg,"The derivative of the residual %zu wrt x(%zu) is NAN!",i,j);
+				throw VPPException(HERE,msg);
+			}
+
+	return residuals;
+
+}
+
+// Compute the force/moment residuals of a batch of independent state vectors
+ResidualBatch VPPItemFactory::getResiduals(const WindCondition& wc, const StateBatch& x) {
+
+	telemetry_.nResiduals_+= x.size();
+	telemetry_.nUpdates_++;
+	TelemetryTimer timer(telemetry_.updateTime_);
+
+	if(!pKernel_)
+		pKernel_.reset( new VPPResidualKernel(this) );
+
+	ResidualBatch residuals;
+	pKernel_->evaluate(wc,x,residuals);
+	return residuals;
+}
+
+// Compute the residuals for the wind condition of the grid point (vTW, aTW)
+Eigen::VectorXd VPPItemFactory::getResiduals(int vTW, int aTW, Eigen::VectorXd& x) {
+	return getResiduals(pWind_->getWindCondition(vTW,aTW),x);
+}
+
+// Compute the residuals for the wind condition of the grid point (vTW, aTW)
+void VPPItemFactory::getResiduals(int vTW, int aTW, Eigen::VectorXd& x, double& dF, double& dM) {
+	getResiduals(pWind_->getWindCondition(vTW,aTW),x,dF,dM);
+}
+
+// Compute the residuals and their derivatives for the wind condition of the
+// grid point (vTW, aTW)
+Eigen::VectorXd VPPItemFactory::getResiduals(int vTW, int aTW, Eigen::VectorXd& x, Eigen::MatrixXd& dResiduals) {
+	return getResiduals(pWind_->getWindCondition(vTW,aTW),x,dResiduals);
+}
+
+// Compute the residuals of a batch for the wind condition of the grid point (vTW, aTW)
+ResidualBatch VPPItemFactory::getResiduals(int vTW, int aTW, const StateBatch& x) {
+	return getResiduals(pWind_->getWindCondition(vTW,aTW),x);
 }
 
 // Get the current value for the optimizer constraint residuals dF=0 and dM=0
@@ -361,6 +571,110 @@ Eigen::VectorXd VPPItemFactory::getResiduals() {
 
 }
 
+// Get the contributions to the current residuals
+const ResidualComponents& VPPItemFactory::getResidualComponents() const {
+	return components_;
+}
+
+// Set the max number of entries of the cache of the residuals
+void VPPItemFactory::setCacheSize(size_t cacheSize) {
+	cacheSize_= cacheSize;
+	clearCache();
+}
+
+// Get the max number of entries of the cache of the residuals
+size_t VPPItemFactory::getCacheSize() const {
+	return cacheSize_;
+}
+
+// Empty the cache of the residuals and reset the hit/miss counters.
+// The compiled kernel is also dropped, as the model might have changed
+void VPPItemFactory::clearCache() {
+	pKernel_.reset();
+	cache_.clear();
+	nextCacheEntry_=0;
+	nCacheHits_=0;
+	nCacheMisses_=0;
+}
+
+// Get the number of calls to getResiduals answered by the cache
+size_t VPPItemFactory::getCacheHits() const {
+	return nCacheHits_;
+}
+
+// Get the number of calls to getResiduals that required to update the items
+size_t VPPItemFactory::getCacheMisses() const {
+	return nCacheMisses_;
+}
+
+// Evaluate the residuals with the compiled kernel rather than by updating the items
+void VPPItemFactory::setCompiled(bool compiled) {
+	compiled_= compiled;
+	clearCache();
+}
+
+// Are the residuals evaluated with the compiled kernel?
+bool VPPItemFactory::isCompiled() const {
+	return compiled_;
+}
+
+// Get the telemetry of the current wind point
+SolverTelemetry& VPPItemFactory::getTelemetry() {
+	return telemetry_;
+}
+
+// Compute the residuals and their components from the current state of the items
+void VPPItemFactory::computeResiduals() {
+
+	components_.fDrive_= pAeroForcesItem_->getFDrive();
+	components_.resistance_= getResistance();
+	components_.mHeel_= pAeroForcesItem_->getMHeel();
+	components_.mRight_= pRightingMomentItem_->get();
+
+	// Compute deltaF = (Fdrive + Rtot). Remember that FDrive is supposedly
+	// positive, while the resistance is always negative
+	dF_ = components_.fDrive_ - components_.resistance_;
+
+	// Compute deltaM = (Mheel + Mright). Remember that mHeel is Positive,
+	// while righting moment is negative (right hand rule)
+	dM_ = components_.mHeel_ - components_.mRight_;
+}
+
+// Look for the residuals of (wc,x) in the cache
+const ResidualCacheEntry* VPPItemFactory::findInCache(const WindCondition& wc, const VectorXd& x) const {
+
+	if(x.size()!=4)
+		return 0;
+
+	for(size_t iEntry=0; iEntry<cache_.size(); iEntry++)
+		if(cache_[iEntry].wc_==wc && cache_[iEntry].x_==x)
+			return &cache_[iEntry];
+
+	return 0;
+}
+
+// Store the current residuals in the cache, for the key (wc,x)
+void VPPItemFactory::storeInCache(const WindCondition& wc, const VectorXd& x) {
+
+	if(!cacheSize_ || x.size()!=4)
+		return;
+
+	ResidualCacheEntry entry;
+	entry.wc_= wc;
+	entry.x_= x;
+	entry.dF_= dF_;
+	entry.dM_= dM_;
+	entry.components_= components_;
+
+	// Fill the cache, then overwrite the oldest entry
+	if(cache_.size()<cacheSize_)
+		cache_.push_back(entry);
+	else
+		cache_[nextCacheEntry_]= entry;
+	nextCacheEntry_= (nextCacheEntry_+1) % cacheSize_;
+}
+
+#ifndef VPP_HEADLESS
 // Plot the total resistance over a fixed range Fn=0-1
 std::vector<VppXYCustomPlotWidget*> VPPItemFactory::plotTotalResistance(WindIndicesDialog* wd, StateVectorDialog* sd) {
 
@@ -385,21 +699,23 @@ std::vector<VppXYCustomPlotWidget*> VPPItemFactory::plotTotalResistance(WindIndi
 		// declare some tmp containers
 		QVector<double> fn, res;
 
-		// Loop on the velocities
+		// Fill a batch with the velocities
+		StateBatch states(nVelocities);
 		for(size_t v=0; v<nVelocities; v++){
 
 			// Set a fictitious velocity (Fn=-0.3-0.7)
 			stateVector(0)= ( -0.1 + ( 1./nVelocities * v ) ) * sqrt(Physic::g * pParser_->get(Var::lwl_));
+			states.set(v,stateVector);
 
-			// Update all the Items - not just the hydro as indRes requires up-to-date fHeel!
-			update(wd->getTWV(),wd->getTWA(),stateVector);
-
-			// Fill the vectors to be plot
 			fn.push_back( stateVector(0)/sqrt(Physic::g * pParser_->get(Var::lwl_) ) );
-			res.push_back( getResistance() );
-
 		}
 
+		// Evaluate the whole batch at once. All the items are considered,
+		// not just the hydro as indRes requires up-to-date fHeel!
+		ResidualBatch residuals= getResiduals(wd->getTWV(),wd->getTWA(),states);
+		for(size_t v=0; v<nVelocities; v++)
+			res.push_back( residuals.resistance_(v) );
+
 		fN.push_back(fn);
 		totRes.push_back(res);
 
@@ -539,3 +855,4 @@ vector<ThreeDDataContainer> VPPItemFactory::plotOptimizationSpace(WindIndicesDia
 
   return v;
 }
+#endif
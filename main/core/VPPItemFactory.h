@@ -6,6 +6,9 @@
 #include "VPPAeroItem.h"
 #include "VPPHydroItem.h"
 #include "VPPRightingMomentItem.h"
+#include "VPPResidualKernel.h"
+#include "SolverTelemetry.h"
+#ifndef VPP_HEADLESS
 #include "VPPDialogs.h"
 #include <QtDataVisualization/QSurfaceDataProxy>
 using namespace QtDataVisualization;
@@ -73,6 +76,42 @@ class ThreeDDataContainer {
 		double xStep_, zStep_;
 
 };
+#endif
+
+/// Contributions to the force/moment residuals dF = fDrive - resistance
+/// and dM = mHeel - mRight
+struct ResidualComponents {
+
+	/// Ctor: all contributions are null
+	ResidualComponents();
+
+	/// Driving force of the sails
+	double fDrive_;
+
+	/// Total resistance, summed up over the hydro items
+	double resistance_;
+
+	/// Heeling moment of the sails
+	double mHeel_;
+
+	/// Righting moment
+	double mRight_;
+};
+
+/// Entry of the cache of the residuals of the VPPItemFactory. The key
+/// is made of the wind condition and of the state vector
+struct ResidualCacheEntry {
+
+	/// True wind velocity and angle
+	WindCondition wc_;
+
+	/// State vector (u, phi, b, f)
+	Eigen::Matrix<double,4,1,Eigen::DontAlign> x_;
+
+	/// Residuals and their contributions computed for this key
+	double dF_, dM_;
+	ResidualComponents components_;
+};
 
 /// Factory class used to instantiate and own all
 /// of the VPPItems requested to compute the VPP run
@@ -86,14 +125,28 @@ class VPPItemFactory {
 		/// Destructor
 		~VPPItemFactory();
 
-		/// Update the VPPItems for the current step (wind velocity and angle),
-		/// the value of the state vector x computed by the optimizer
-		/// TODO dtrimarchi: definitely remove the old c-style signature
-		void update(int vTW, int aTW, Eigen::VectorXd& xv);
+		/// Make an independent copy of this factory, with its own item
+		/// states, so that the copy can be updated concurrently with
+		/// this factory. The copy shares the parser, the SailSet and the
+		/// interpolators of the items, that are only read while solving.
+		/// The caller owns the copy
+		VPPItemFactory* clone() const;
 
-		/// Update the VPPItems for the current step (wind velocity and angle),
-		/// the value of the state vector x computed by the optimizer
+		/// Update the VPPItems for the wind condition wc and the value of
+		/// the state vector x computed by the optimizer
+		void update(const WindCondition& wc, Eigen::VectorXd& xv);
+
+		/// Update the VPPItems for the wind condition wc and the value of
+		/// the state vector x computed by the optimizer
 		/// TODO dtrimarchi: definitely remove this old c-style signature
+		void update(const WindCondition& wc, const double* x);
+
+		/// Update the VPPItems for the wind condition of the grid point
+		/// (vTW, aTW) of the WindItem
+		void update(int vTW, int aTW, Eigen::VectorXd& xv);
+
+		/// Update the VPPItems for the wind condition of the grid point
+		/// (vTW, aTW) of the WindItem
 		void update(int vTW, int aTW, const double* x);
 
 		/// Returns a ptr to the variableFileParser
@@ -152,25 +205,107 @@ class VPPItemFactory {
 		void getResiduals(double& dF, double& dM);
 
 		/// Compute the force/moment residuals and also the residuals of the additional
-		/// equations c1=0 and c2=0. Do not require updates to be operated previously
+		/// equations c1=0 and c2=0. Do not require updates to be operated previously.
+		/// The residuals are looked up in a bounded cache first: in case of hit the
+		/// items are NOT updated, and only the residuals and their components are set
+		Eigen::VectorXd getResiduals(const WindCondition& wc, VectorXd& x);
+
+		/// Same as getResiduals(wc,x), but the residuals are returned in dF
+		/// and dM rather than in a new vector. Used by the fixed-size solvers, that
+		/// do not allocate in their inner loop
+		void getResiduals(const WindCondition& wc, VectorXd& x, double& dF, double& dM);
+
+		/// Compute the force/moment residuals as per getResiduals(wc,x), and
+		/// their derivatives wrt the state variables with forward-mode automatic
+		/// differentiation. dResiduals is a 2x4 matrix: (dF dM)^T / d(u phi b f)
+		Eigen::VectorXd getResiduals(const WindCondition& wc, VectorXd& x, Eigen::MatrixXd& dResiduals);
+
+		/// Compute the force/moment residuals of a batch of independent state vectors
+		/// with the compiled kernel, whether or not the compiled mode is set. The
+		/// cache is not used, and the items and the current residuals are NOT updated
+		ResidualBatch getResiduals(const WindCondition& wc, const StateBatch&);
+
+		/// Same as the getResiduals methods above, for the wind condition of the
+		/// grid point (vTW, aTW) of the WindItem
 		Eigen::VectorXd getResiduals(int vTW, int aTW, VectorXd& x);
+		void getResiduals(int vTW, int aTW, VectorXd& x, double& dF, double& dM);
+		Eigen::VectorXd getResiduals(int vTW, int aTW, VectorXd& x, Eigen::MatrixXd& dResiduals);
+		ResidualBatch getResiduals(int vTW, int aTW, const StateBatch&);
 
 		/// Get the current value for the optimizer constraint residuals dF=0 and dM=0
 		/// and for c1 and c2
 		Eigen::VectorXd getResiduals();
 
+		/// Get the contributions to the current residuals
+		const ResidualComponents& getResidualComponents() const;
+
+		/// Set the max number of entries of the cache of the residuals. The
+		/// oldest entry is overwritten when the cache is full. Zero disables
+		/// the cache. This also empties the cache
+		void setCacheSize(size_t);
+
+		/// Get the max number of entries of the cache of the residuals
+		size_t getCacheSize() const;
+
+		/// Empty the cache of the residuals and reset the hit/miss counters.
+		/// The compiled kernel is rebuilt on its next use. To be called every
+		/// time the model changes, i.e. when the sail coefficients are
+		/// re-interpolated
+		void clearCache();
+
+		/// Get the number of calls to getResiduals(wc,x) answered by the cache
+		size_t getCacheHits() const;
+
+		/// Get the number of calls to getResiduals(wc,x) that required
+		/// to update the items
+		size_t getCacheMisses() const;
+
+		/// Evaluate the residuals with the compiled kernel rather than by updating
+		/// the items. Only affects getResiduals(wc,x) : as per the cache hits,
+		/// the items are NOT updated. The items remain the reference implementation,
+		/// used by the plots and by the automatic differentiation
+		void setCompiled(bool);
+
+		/// Are the residuals evaluated with the compiled kernel?
+		bool isCompiled() const;
+
+		/// Get the telemetry of the current wind point. The factory counts
+		/// the updates and the residual evaluations, the solvers and the
+		/// Jacobian add their own counters
+		SolverTelemetry& getTelemetry();
+
+#ifndef VPP_HEADLESS
 		/// Plot the total resistance over a fixed range Fn=0-1
 		std::vector<VppXYCustomPlotWidget*> plotTotalResistance(WindIndicesDialog*, StateVectorDialog*);
 
 		/// Make a 3d plot of the optimization variables v, phi when varying the two opt
 		/// parameters flat and crew. Qt 3d surface plot
 		vector<ThreeDDataContainer> plotOptimizationSpace(WindIndicesDialog&, OptimVarsStateVectorDialog&);
+#endif
 
 		/// Declare the macro to allow for fixed size vector support
 		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 	private:
 
+		/// Copy constructor used by clone: deep copy of the items,
+		/// rewired to their own sibling items
+		VPPItemFactory(const VPPItemFactory&);
+
+		/// Disallow assignment
+		VPPItemFactory& operator=(const VPPItemFactory&);
+
+		/// Compute the residuals and their components from the current
+		/// state of the items
+		void computeResiduals();
+
+		/// Look for the residuals of (wc,x) in the cache. Returns
+		/// a null ptr if the key is not found
+		const ResidualCacheEntry* findInCache(const WindCondition& wc, const VectorXd& x) const;
+
+		/// Store the current residuals in the cache, for the key (wc,x)
+		void storeInCache(const WindCondition& wc, const VectorXd& x);
+
 		/// Ptr to the VariableFileParser
 		VariableFileParser* pParser_;
 
@@ -225,6 +360,32 @@ class VPPItemFactory {
 		/// Residuals on the residuals : dF, dM, c1 and c2
 		double dF_, dM_;
 
+		/// Contributions to the current residuals
+		ResidualComponents components_;
+
+		/// Cache of the residuals, used as a ring buffer. Keys are matched
+		/// exactly : the finite difference perturbations of the state vector
+		/// are too small to allow for a tolerance
+		std::vector<ResidualCacheEntry> cache_;
+
+		/// Max number of entries of the cache
+		size_t cacheSize_;
+
+		/// Index of the next entry to be written in the cache
+		size_t nextCacheEntry_;
+
+		/// Number of hits and misses of the cache
+		size_t nCacheHits_, nCacheMisses_;
+
+		/// Evaluate the residuals with the compiled kernel?
+		bool compiled_;
+
+		/// Compiled kernel, built on first use and dropped by clearCache
+		std::shared_ptr<VPPResidualKernel> pKernel_;
+
+		/// Telemetry of the current wind point
+		SolverTelemetry telemetry_;
+
 };
 
 #endif
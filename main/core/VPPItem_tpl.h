@@ -0,0 +1,31 @@
+// The value updates read the state vector
+template <>
+inline const double& VPPItem::getState<double>(size_t iVar) const {
+	return x_(iVar);
+}
+
+// The derivative updates read the seeded state vector
+template <>
+inline const Dual& VPPItem::getState<Dual>(size_t iVar) const {
+	return xD_[iVar];
+}
+
+template <>
+inline double& VPPItem::select<double>(double& val, Dual& dual) {
+	return val;
+}
+
+template <>
+inline Dual& VPPItem::select<Dual>(double& val, Dual& dual) {
+	return dual;
+}
+
+template <>
+inline double VPPItem::select<double>(double val, const Dual& dual) {
+	return val;
+}
+
+template <>
+inline Dual VPPItem::select<Dual>(double val, const Dual& dual) {
+	return dual;
+}
@@ -0,0 +1,285 @@
+#include "VPPResidualKernel.h"
+
+#include <cmath>
+#include "VPPItemFactory.h"
+#include "VPPException.h"
+#include "Physics.h"
+
+// Ctor, for n state vectors
+StateBatch::StateBatch(size_t n) {
+	resize(n);
+}
+
+// Resize the batch to n state vectors
+void StateBatch::resize(size_t n) {
+	u_.resize(n);
+	phi_.resize(n);
+	b_.resize(n);
+	f_.resize(n);
+}
+
+// Number of state vectors of the batch
+size_t StateBatch::size() const {
+	return u_.size();
+}
+
+// Set the state vector of the i-th lane
+void StateBatch::set(size_t i, const Eigen::VectorXd& x) {
+	u_(i)= x(stateVars::u);
+	phi_(i)= x(stateVars::phi);
+	b_(i)= x(stateVars::b);
+	f_(i)= x(stateVars::f);
+}
+
+// Get the state vector of the i-th lane
+Eigen::VectorXd StateBatch::get(size_t i) const {
+	Eigen::VectorXd x(4);
+	x << u_(i), phi_(i), b_(i), f_(i);
+	return x;
+}
+
+// Resize the batch to n residuals
+void ResidualBatch::resize(size_t n) {
+	dF_.resize(n);
+	dM_.resize(n);
+	fDrive_.resize(n);
+	resistance_.resize(n);
+	mHeel_.resize(n);
+	mRight_.resize(n);
+}
+
+//=================================================================
+
+// Ctor. Freeze the items of the factory for the current boat and SailSet
+VPPResidualKernel::VPPResidualKernel(VPPItemFactory* pFactory) {
+
+	VariableFileParser* pParser= pFactory->getParser();
+	SailCoefficientItem* pSailCoeffs= pFactory->getSailCoefficientItem();
+	std::shared_ptr<SailSet> ps= pSailCoeffs->getSailSet();
+
+	pWind_= pFactory->getWind();
+	pSailCoeffs_= pSailCoeffs;
+	pAeroForces_= pFactory->getAeroForcesItem();
+	pViscous_= pFactory->getViscousResistanceItem();
+	pResiduary_= pFactory->getResiduaryResistanceItem();
+	pViscousHeel_= pFactory->getDelta_ViscousResistance_HeelItem();
+	pResiduaryHeel_= pFactory->getDelta_ResiduaryResistance_HeelItem();
+	pViscousKeel_= pFactory->getViscousResistanceKeelItem();
+	pViscousRudder_= pFactory->getViscousResistanceRudderItem();
+	pResiduaryKeel_= pFactory->getResiduaryResistanceKeelItem();
+	pResiduaryKeelHeel_= pFactory->getDelta_ResiduaryResistanceKeel_HeelItem();
+	pInduced_= pFactory->getInducedResistanceItem();
+	pNegative_= pFactory->getNegativeResistanceItem();
+	pRightingMoment_= pFactory->getRightingMomentItem();
+
+	// -- SAIL COEFFICIENT ITEM : the active sails and cd0 are the ones of the item
+	kI_= 1. / (M_PI * pSailCoeffs->ar_) + 0.005;
+
+	// -- AERO FORCES ITEM
+
+	anForces_= ps->get(Var::an_);
+	zHeel_= 0.45 * pParser->get(Var::t_) + pParser->get(Var::avgfreb_) + ps->get(Var::zce_);
+
+	// -- RESISTANCE ITEMS
+
+	sqrtGLwl_= sqrt(Physic::g * pParser->get(Var::lwl_));
+
+	ViscousResistanceItem* pViscous= pFactory->getViscousResistanceItem();
+	rN0_= pViscous->rN0_;
+	rfh0_= pViscous->rfh0_;
+	sc_= pParser->get(Var::sc_);
+	hullff_= pParser->get(Var::hullff_);
+
+	rNk0_= pParser->get(Var::chmek_) / Physic::ni_w;
+	rfk0_= 0.5 * Physic::rho_w * pParser->get(Var::sk_);
+	keelff_= pParser->get(Var::keelff_);
+
+	rNr0_= pParser->get(Var::chmer_) / Physic::ni_w;
+	rfr0_= 0.5 * Physic::rho_w * pParser->get(Var::sr_);
+	ruddff_= pParser->get(Var::ruddff_);
+
+	ch_= pFactory->getDelta_ResiduaryResistanceKeel_HeelItem()->Ch_;
+
+	pRr_= pFactory->getResiduaryResistanceItem()->pInterpolator_;
+	pRrk_= pFactory->getResiduaryResistanceKeelItem()->pInterpolator_;
+	pRrh20_= pFactory->getDelta_ResiduaryResistance_HeelItem()->pInterpolator_;
+	pSCphi_= pFactory->getDelta_ViscousResistance_HeelItem()->pInterpolator_;
+
+	InducedResistanceItem* pInduced= pFactory->getInducedResistanceItem();
+	pTe0_= pInduced->pTe0_;
+	pTe1_= pInduced->pTe1_;
+	vf_= pInduced->vf_;
+	a_= pInduced->a_;
+	c_= pInduced->c_;
+	pSf_= pInduced->pSf_;
+
+	// -- RIGHTING MOMENT ITEM
+
+	m10_= pFactory->getRightingMomentItem()->m10_;
+	m20_= pFactory->getRightingMomentItem()->m20_;
+
+}
+
+// Dtor
+VPPResidualKernel::~VPPResidualKernel() {
+
+}
+
+// Compute the residuals in a single pass, with the formulas of the items.
+// The sequence of the operations is the one of VPPItemFactory::update
+void VPPResidualKernel::evaluate(const WindCondition& wc, const double* x,
+		double& dF, double& dM, ResidualComponents& components) const {
+
+	double vel= x[stateVars::u];
+	double heel= x[stateVars::phi];
+
+	// -- WIND : apparent wind velocity and angle
+	double awa, awv;
+	pWind_->getApparentWind(wc,vel,awa,awv);
+
+	// -- SAIL COEFFICIENTS
+	double cl, cd;
+	pSailCoeffs_->getCoefficients(awa,x[stateVars::f],cl,cd);
+
+	// -- AERO FORCES
+	double lift, drag, fSide;
+	pAeroForces_->getForces(awv,awa,heel,cl,cd,lift,drag,components.fDrive_,fSide,components.mHeel_);
+
+	// -- RESISTANCE, summed up in the order of the hydro items of the factory
+	double fN= pViscous_->getFroudeNumber(vel);
+	double resistance= 0;
+	resistance += pViscous_->getResistance(vel);
+	resistance += pResiduary_->getResistance(fN);
+	resistance += pViscousHeel_->getResistance(vel,heel);
+	resistance += pResiduaryHeel_->getResistance(fN,heel);
+	resistance += pViscousKeel_->getResistance(vel);
+	resistance += pViscousRudder_->getResistance(vel);
+	resistance += pResiduaryKeel_->getResistance(fN);
+	resistance += pResiduaryKeelHeel_->getResistance(fN,heel);
+	resistance += pInduced_->getResistance(vel,heel,fN,fSide);
+	resistance += pNegative_->getResistance(vel);
+	components.resistance_= resistance;
+
+	// -- RIGHTING MOMENT
+	components.mRight_= pRightingMoment_->getMoment(heel,x[stateVars::b]);
+
+	dF= components.fDrive_ - components.resistance_;
+	dM= components.mHeel_ - components.mRight_;
+
+	if(mathUtils::isNotValid(dF) || mathUtils::isNotValid(dM)) {
+		char msg[256];
+		sprintf(msg,"The residuals are NAN for x= %f %f %f %f",
+				x[stateVars::u],x[stateVars::phi],x[stateVars::b],x[stateVars::f]);
+		throw VPPException(HERE,msg);
+	}
+}
+
+// Compute the residuals of a batch of state vectors. Same sequence of
+// operations as per the formulas of the items, on arrays
+void VPPResidualKernel::evaluate(const WindCondition& wc, const StateBatch& x, ResidualBatch& res) const {
+
+	size_t n= x.size();
+	res.resize(n);
+
+	const Eigen::ArrayXd& vel= x.u_;
+	const Eigen::ArrayXd& heel= x.phi_;
+	Eigen::ArrayXd cosPhi= heel.cos();
+
+	// -- WIND : apparent wind velocity and angle. Only the x component
+	// of the apparent wind depends on the state vector
+	double twv= wc.twv_;
+	double twa= wc.twa_;
+	double awv1= twv * sin( twa );
+	if(awv1<0)
+		throw VPPException(HERE,"awv_(1) is Negative!");
+	Eigen::ArrayXd awv0= vel + twv * cos( twa );
+	Eigen::ArrayXd awa(n);
+	for(size_t i=0; i<n; i++)
+		awa(i)= atan2( awv1, awv0(i) );
+	Eigen::ArrayXd awv= ( awv0 * awv0 + awv1 * awv1 ).sqrt();
+
+	// -- SAIL COEFFICIENTS
+	const SailCoefficientItem* ps= pSailCoeffs_;
+	Eigen::ArrayXd cl= Eigen::ArrayXd::Zero(n);
+	for(size_t i=0; i<ps->clSails_.size(); i++)
+		cl += interpolate(ps->interpClVec_[ps->clSails_[i]].get(),awa) * ps->clAreas_[i];
+	cl /= ps->an_;
+	cl *= x.f_;
+
+	Eigen::ArrayXd cdp= Eigen::ArrayXd::Zero(n);
+	for(size_t i=0; i<ps->cdSails_.size(); i++)
+		cdp += interpolate(ps->interpCdVec_[ps->cdSails_[i]].get(),awa) * ps->cdAreas_[i];
+	cdp /= ps->an_;
+	Eigen::ArrayXd cd= cdp + ps->cd0_ + cl * cl * kI_;
+
+	// -- AERO FORCES
+	Eigen::ArrayXd qa= 0.5 * Physic::rho_a * awv * awv * anForces_ * cosPhi;
+	Eigen::ArrayXd lift= qa * cl;
+	Eigen::ArrayXd drag= qa * cd;
+	Eigen::ArrayXd sinAwa= awa.sin();
+	Eigen::ArrayXd cosAwa= awa.cos();
+	res.fDrive_= lift * sinAwa - drag * cosAwa;
+	Eigen::ArrayXd fSide= lift * cosAwa + drag * sinAwa;
+	res.mHeel_= fSide * zHeel_ * cosPhi;
+
+	// -- RESISTANCE, summed up in the order of the hydro items of the factory.
+	// The lanes that do not satisfy the limits of an item are selected out
+	Eigen::ArrayXd fN= vel / sqrtGLwl_;
+	Eigen::ArrayXd vel2= vel * vel;
+	Eigen::ArrayXd cF= frictionCoeff( rN0_ * vel );
+
+	Eigen::ArrayXd resistance= ( vel>0. ).select( rfh0_ * vel2 * cF * hullff_, 0. );
+	resistance += interpolate(pRr_.get(),fN);
+	resistance += ( vel>0. ).select(
+			0.5 * Physic::rho_w * vel2 * cF * ( interpolate(pSCphi_.get(),heel) - sc_ ) * hullff_, 0. );
+	resistance += ( fN>=0.25 ).select(
+			interpolate(pRrh20_.get(),fN) * 6. * heel.abs().pow(1.7), 0. );
+	resistance += ( vel>0. ).select( rfk0_ * vel2 * frictionCoeff( rNk0_ * vel ) * keelff_, 0. );
+	resistance += ( vel>0. ).select( rfr0_ * vel2 * frictionCoeff( rNr0_ * vel ) * ruddff_, 0. );
+	resistance += interpolate(pRrk_.get(),fN);
+	resistance += ch_ * fN * fN * heel;
+
+	// Induced resistance
+	Eigen::ArrayXd te= interpolate(pTe0_.get(),heel) + fN * interpolate(pTe1_.get(),heel);
+	Eigen::ArrayXd fHeel2= ( fSide / cosPhi ).square();
+	Eigen::ArrayXd v= ( vel<vf_ ).select( a_ * vel * vel + c_, vel );
+	Eigen::ArrayXd sf(n);
+	for(size_t i=0; i<n; i++)
+		sf(i)= pSf_->f( fN(i) );
+	resistance += ( vel>0. ).select(
+			fHeel2 / ( 0.5 * Physic::rho_w * M_PI * te * te * v * v) * sf,
+			pSf_->f( 0 ) * fHeel2 / ( 0.5 * Physic::rho_w * M_PI * te * te * c_ * c_) );
+
+	// Negative resistance
+	resistance += ( vel<0. ).select( vel * vel * vel, 0. );
+
+	res.resistance_= resistance;
+
+	// -- RIGHTING MOMENT
+	res.mRight_= m10_ * heel.sin() + m20_ * x.b_ * cosPhi;
+
+	res.dF_= res.fDrive_ - res.resistance_;
+	res.dM_= res.mHeel_ - res.mRight_;
+
+	for(size_t i=0; i<n; i++)
+		if(mathUtils::isNotValid(res.dF_(i)) || mathUtils::isNotValid(res.dM_(i))) {
+			char msg[256];
+			sprintf(msg,"The residuals are NAN for x= %f %f %f %f",
+					x.u_(i),x.phi_(i),x.b_(i),x.f_(i));
+			throw VPPException(HERE,msg);
+		}
+}
+
+// Compute the frictional coefficients given the Reynolds numbers
+Eigen::ArrayXd VPPResidualKernel::frictionCoeff(const Eigen::ArrayXd& rN) {
+	return 0.075 / ( rN.log10() - 2. ).square();
+}
+
+// Interpolate a spline for all the values of an array
+Eigen::ArrayXd VPPResidualKernel::interpolate(SplineInterpolator* pSpline, const Eigen::ArrayXd& vals) {
+
+	Eigen::ArrayXd ret(vals.size());
+	for(size_t i=0; i<vals.size(); i++)
+		ret(i)= pSpline->interpolate(vals(i));
+	return ret;
+}
@@ -0,0 +1,148 @@
+#ifndef VPPRESIDUALKERNEL_H
+#define VPPRESIDUALKERNEL_H
+
+#include <vector>
+#include <memory>
+#include <Eigen/Core>
+
+#include "Interpolator.h"
+#include "mathUtils.h"
+#include "WindCondition.h"
+#include "VPPAeroItem.h"
+#include "VPPHydroItem.h"
+#include "VPPRightingMomentItem.h"
+
+/// Forward declarations
+class VPPItemFactory;
+struct ResidualComponents;
+
+/// Batch of state vectors, stored as a structure of arrays : one array
+/// per state variable, one lane per state vector
+struct StateBatch {
+
+	/// Ctor, for n state vectors
+	StateBatch(size_t n=0);
+
+	/// Resize the batch to n state vectors
+	void resize(size_t n);
+
+	/// Number of state vectors of the batch
+	size_t size() const;
+
+	/// Set the state vector of the i-th lane
+	void set(size_t i, const Eigen::VectorXd& x);
+
+	/// Get the state vector of the i-th lane
+	Eigen::VectorXd get(size_t i) const;
+
+	/// Velocity [m/s], heel angle [rad], crew position [m] and flat [-]
+	Eigen::ArrayXd u_, phi_, b_, f_;
+};
+
+/// Residuals of a StateBatch, and their contributions, one lane per state vector
+struct ResidualBatch {
+
+	/// Resize the batch to n residuals
+	void resize(size_t n);
+
+	/// Force and moment residuals
+	Eigen::ArrayXd dF_, dM_;
+
+	/// Contributions to the residuals, see ResidualComponents
+	Eigen::ArrayXd fDrive_, resistance_, mHeel_, mRight_;
+};
+
+/// Compiled version of the item graph of a VPPItemFactory. The residuals
+/// are computed in a single pass, with no virtual calls and no copies of
+/// the state vector. A single state vector is evaluated with the formulas
+/// the items update themselves with. For the batches, the per-boat constants
+/// of the items (aspect ratio, cd0, the velocity-independent parts of the
+/// Reynolds numbers and of the viscous resistances, the righting moment
+/// constants...) are frozen into a flat set of members, and the formulas
+/// are mirrored on arrays. The kernel must be rebuilt every time the items
+/// change, i.e. when the sail coefficients are re-interpolated
+class VPPResidualKernel {
+
+	public:
+
+		/// Ctor. Freeze the items of the factory for the current boat and SailSet.
+		/// The kernel shares the interpolators of the items, that are only read
+		VPPResidualKernel(VPPItemFactory*);
+
+		/// Dtor
+		~VPPResidualKernel();
+
+		/// Compute the force/moment residuals dF and dM for the wind condition
+		/// wc and the state vector x=(u, phi, b, f). Also fills the
+		/// contributions to the residuals. Throws if the residuals are NaN
+		void evaluate(const WindCondition& wc, const double* x,
+				double& dF, double& dM, ResidualComponents&) const;
+
+		/// Compute the residuals of a batch of state vectors for the wind
+		/// condition wc. The trigonometric, logarithmic and power functions are
+		/// evaluated lane-wise on whole arrays, and only the splines are
+		/// interpolated lane by lane. Throws if any of the residuals is NaN
+		void evaluate(const WindCondition& wc, const StateBatch&, ResidualBatch&) const;
+
+	private:
+
+		/// Disallow default ctor
+		VPPResidualKernel();
+
+		/// Compute the frictional coefficients given the Reynolds numbers
+		static Eigen::ArrayXd frictionCoeff(const Eigen::ArrayXd& rN);
+
+		/// Interpolate a spline for all the values of an array
+		static Eigen::ArrayXd interpolate(SplineInterpolator*, const Eigen::ArrayXd&);
+
+		/// Items of the factory, whose formulas evaluate a single state vector
+		const WindItem* pWind_;
+		const SailCoefficientItem* pSailCoeffs_;
+		const AeroForcesItem* pAeroForces_;
+		const ViscousResistanceItem* pViscous_;
+		const ResiduaryResistanceItem* pResiduary_;
+		const Delta_ViscousResistance_HeelItem* pViscousHeel_;
+		const Delta_ResiduaryResistance_HeelItem* pResiduaryHeel_;
+		const ViscousResistanceKeelItem* pViscousKeel_;
+		const ViscousResistanceRudderItem* pViscousRudder_;
+		const ResiduaryResistanceKeelItem* pResiduaryKeel_;
+		const Delta_ResiduaryResistanceKeel_HeelItem* pResiduaryKeelHeel_;
+		const InducedResistanceItem* pInduced_;
+		const NegativeResistanceItem* pNegative_;
+		const RightingMomentItem* pRightingMoment_;
+
+		/// Aero constants : induced drag factor 1/(pi*AR)+0.005, nominal
+		/// area of the SailSet and heeling moment arm
+		double kI_, anForces_, zHeel_;
+
+		/// sqrt(g*lwl), used to convert the velocity to a Froude number
+		double sqrtGLwl_;
+
+		/// Viscous resistance of the bare hull : Reynolds number and resistance
+		/// per unit velocity, wetted surface and form factor of the hull
+		double rN0_, rfh0_, sc_, hullff_;
+
+		/// Reynolds number per unit velocity, viscous resistance per unit squared
+		/// velocity and form factor of the keel and of the rudder
+		double rNk0_, rfk0_, keelff_, rNr0_, rfr0_, ruddff_;
+
+		/// Resistance coefficient of the keel due to heel
+		double ch_;
+
+		/// Residuary resistance of the hull and of the keel vs Fn,
+		/// residuary resistance of the hull @PHI=20deg vs Fn and wetted
+		/// area of the heeled hull vs PHI
+		std::shared_ptr<SplineInterpolator> pRr_, pRrk_, pRrh20_, pSCphi_;
+
+		/// Induced resistance : effective span splines, smoothing of the velocity
+		/// (parabola in 0 -> vf) and smoothed step function in Fn
+		std::shared_ptr<SplineInterpolator> pTe0_, pTe1_;
+		double vf_, a_, c_;
+		std::shared_ptr<mathUtils::SmoothedStepFunction> pSf_;
+
+		/// Righting moment constants
+		double m10_, m20_;
+
+};
+
+#endif
@@ -27,17 +27,17 @@ const double RightingMomentItem::get() const {
 	return val_;
 }
 
+// Get the righting moment and its derivatives
+const Dual& RightingMomentItem::getDual() const {
+	return valD_;
+}
+
 // Implement the pure virtual update
-void RightingMomentItem::update(int vTW, int aTW) {
-
-	// Compute the righting moment
-	// M1 = phys.rho_w * phys.g * (geom.KM - geom.KG) * (geom.DIVCAN + geom.DVK) * sin(phi*pi/180);
-	// M2 = geom.MMVBLCRW .* phys.g .* b .* cos(phi*pi/180);
-	// Mright = M1+M2;
-	// TODO : this is a dirty fix for a mismatch in the sign of PHI. Normally PHI and
-	// the righting moment should be negative, here we fix the sign when computing the
-	// residuals.
-	val_ = m10_ * std::sin( x_(stateVars::phi) ) + m20_ * x_(stateVars::b) * std::cos( x_(stateVars::phi) ) ;
-	if(mathUtils::isNotValid(val_)) throw VPPException(HERE,"Righting moment is NAN");
+void RightingMomentItem::update(const WindCondition& wc) {
+	updateScalar<double>(wc);
+}
 
+// Update the derivatives of the righting moment for the current step
+void RightingMomentItem::updateDual(const WindCondition& wc) {
+	updateScalar<Dual>(wc);
 }
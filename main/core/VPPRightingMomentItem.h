@@ -18,16 +18,39 @@ class RightingMomentItem : public VPPItem {
 		/// Get the righting moment value
 		const double get() const;
 
+		/// Get the righting moment and its derivatives
+		const Dual& getDual() const;
+
+		/// Compute the righting moment for the heel angle phi and the crew
+		/// position b. Shared by the updates of the item and by the compiled kernel
+		template <class T>
+		T getMoment(const T& phi, const T& b) const;
+
 	private:
 
+		/// The compiled kernel reads the constants of this item
+		friend class VPPResidualKernel;
+
 		/// Update the item for the current step (wind velocity and angle),
 		/// the values of the state vector x computed by the optimizer have
 		/// already been treated by the parent
-		virtual void update(int vTW, int aTW);
+		virtual void update(const WindCondition& wc);
+
+		/// Update the derivatives of the righting moment for the current step
+		virtual void updateDual(const WindCondition& wc);
+
+		/// Body of update and updateDual
+		template <class T>
+		void updateScalar(const WindCondition& wc);
 
 		/// Constant parts of the two components of the righting moment, and
 		/// righting moment value
 		double m10_,m20_, val_;
+
+		/// Righting moment with its derivatives
+		Dual valD_;
 };
 
+#include "VPPRightingMomentItem_tpl.h"
+
 #endif
@@ -0,0 +1,23 @@
+#include "mathUtils.h"
+#include "VPPException.h"
+
+// Compute the righting moment
+// M1 = phys.rho_w * phys.g * (geom.KM - geom.KG) * (geom.DIVCAN + geom.DVK) * sin(phi*pi/180);
+// M2 = geom.MMVBLCRW .* phys.g .* b .* cos(phi*pi/180);
+// Mright = M1+M2;
+// TODO : this is a dirty fix for a mismatch in the sign of PHI. Normally PHI and
+// the righting moment should be negative, here we fix the sign when computing the
+// residuals.
+template <class T>
+T RightingMomentItem::getMoment(const T& phi, const T& b) const {
+	return m10_ * sin( phi ) + m20_ * b * cos( phi );
+}
+
+// Update the righting moment for the current step
+template <class T>
+void RightingMomentItem::updateScalar(const WindCondition& wc) {
+
+	T& val= select<T>(val_,valD_);
+	val= getMoment(getState<T>(stateVars::phi),getState<T>(stateVars::b));
+	if(mathUtils::isNotValid(val)) throw VPPException(HERE,"Righting moment is NAN");
+}
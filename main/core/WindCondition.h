@@ -0,0 +1,29 @@
+#ifndef WINDCONDITION_H
+#define WINDCONDITION_H
+
+/// True wind condition the VPP is evaluated for : true wind velocity [m/s]
+/// and true wind angle [rad]. The wind grid of the WindItem is only one
+/// producer of wind conditions : the items, the residuals and the solvers
+/// can be evaluated for any condition
+struct WindCondition {
+
+	/// Ctor
+	WindCondition(double twv=0, double twa=0) :
+		twv_(twv),
+		twa_(twa) {
+	}
+
+	/// Two wind conditions are the same if both their velocity and angle match
+	bool operator==(const WindCondition& rhs) const {
+		return twv_==rhs.twv_ && twa_==rhs.twa_;
+	}
+
+	bool operator!=(const WindCondition& rhs) const {
+		return !(*this==rhs);
+	}
+
+	/// True wind velocity [m/s] and angle [rad]
+	double twv_, twa_;
+};
+
+#endif
@@ -1,7 +1,9 @@
 #include "VPPException.h"
 #include <iostream>
 #include <sstream>
+#ifndef VPP_HEADLESS
 #include <QtWidgets/QMessageBox>
+#endif
 
 // Constructor using c_str()
 VPPException::VPPException(const char* inFile, int inLine, const char* inFunction, const char* message ) {
@@ -14,11 +16,13 @@ VPPException::VPPException(const char* inFile, int inLine, const char* inFunctio
 	std::cout<<msg_<<std::endl;
 	std::cout<<"\n-----------------------------------------\n";
 
+#ifndef VPP_HEADLESS
 	QMessageBox msgBox;
 	msgBox.setText(QString(what()));
 	msgBox.setIcon(QMessageBox::Critical);
 	msgBox.setWindowTitle("Error");
 	msgBox.exec();
+#endif
 }
 
 // Constructor using ostringstream
@@ -32,11 +36,13 @@ VPPException::VPPException(const char* inFile, int inLine, const char* inFunctio
 	std::cout<<msg_<<std::endl;
 	std::cout<<"\n-----------------------------------------\n";
 
+#ifndef VPP_HEADLESS
 	QMessageBox msgBox;
 	msgBox.setText(QString(what()));
 	msgBox.setIcon(QMessageBox::Critical);
 	msgBox.setWindowTitle("Error");
 	msgBox.exec();
+#endif
 
 }
 
@@ -89,10 +95,12 @@ NoPreviousConvergedException::NoPreviousConvergedException(const char* inFile, i
 	std::cout<<msg_<<std::endl;
 	std::cout<<"\n-----------------------------------------\n";
 
+#ifndef VPP_HEADLESS
 	QMessageBox msgBox;
 	msgBox.setText(QString(what()));
 	msgBox.setIcon(QMessageBox::Critical);
 	msgBox.exec();
+#endif
 
 }
 
@@ -1,6 +1,8 @@
 #include "Warning.h"
 #include <iostream>
+#ifndef VPP_HEADLESS
 #include <QMessageBox>
+#endif
 
 // Constructor
 Warning::Warning(string msg) {
@@ -8,11 +10,13 @@ Warning::Warning(string msg) {
 	cout<<"\n========== VPP WARNING : ==================="<<endl;
 	cout<<"---> "<<msg<<"\n"<<std::endl;
 
+#ifndef VPP_HEADLESS
 	QMessageBox msgBox;
 	msgBox.setText(QString(msg.c_str()));
 	msgBox.setIcon(QMessageBox::Warning);
 	msgBox.setWindowTitle("Warning");
 	msgBox.exec();
+#endif
 
 }
 
@@ -33,11 +33,9 @@ QVariant VppTableModel::data(const QModelIndex &index, int role) const {
 
 		if(pResultContainer_) {
 
-			// Get the result this index refers to
-			const Result& res= pResultContainer_->get(index.row());
-
+			// Read the entry from the columns of the results
 			return QString("%1").arg(
-					res.getTableEntry(index.column())
+					pResultContainer_->getTableEntry(index.row(),index.column())
 					);
 
 		} else
@@ -396,6 +396,9 @@ void MainWindow::run() {
 		case solverChoice::saoa :
 			pSolverFactory_.reset( 	new Optim::SAOASolverFactory(pVppItems_) );
 			break;
+		case solverChoice::nlOptSLSQP :
+			pSolverFactory_.reset( new Optim::NLOptSLSQPSolverFactory(pVppItems_) );
+			break;
 		default:
 			char msg[256];
 			sprintf(msg,"The value of solver: \"%d\" is not supported",pSd->getGeneralTab()->getSolver());
@@ -595,6 +598,9 @@ void MainWindow::importSailCoeffs() {
 	// Remember to refresh the spline interpolators with the new coefficient arrays
 	pSailCoeffItem->interpolateCoeffs();
 
+	// The residuals cached so far refer to the old coefficients
+	pVppItems_->clearCache();
+
 	return;
 
 }
@@ -123,6 +123,7 @@ GeneralTab::GeneralTab(QWidget *parent) :
 	pSolverComboBox_->addItem("ipOpt");
 	pSolverComboBox_->addItem("noOpt");
 	pSolverComboBox_->addItem("SAOA");
+	pSolverComboBox_->addItem("nlOpt SLSQP");
 
 	QFont font = pSolverComboBox_->font();
 	font.setPointSizeF(fontSize_);
@@ -7,6 +7,7 @@
 #include <QtCore/QXmlStreamWriter>
 #include "VppSettingsXmlWriter.h"
 #include "VppSettingsXmlReader.h"
+#include "VPPSettingsXmlParser.h"
 
 using namespace std;
 
@@ -14,14 +15,6 @@ using namespace std;
 class QFile;
 class GeneralTab;
 
-/// Enum expressing the solver choice made by the user
-enum solverChoice {
-	nlOpt,
-	ipOpt,
-	noOpt,
-	saoa
-};
-
 /// XML writer class, contains a QXmlStreamWriter that
 /// actually does the job of writing the XML file.
 /// See similitude with VppSettingsXmlWriter, from which
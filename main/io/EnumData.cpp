@@ -16,13 +16,52 @@ varData::varData(	const char* display,
 					display_(display), //> Display variable name
 					name_(name),		//> Internal variable name
 					unit_(unit),		//> Variable unit
-					tootip_(tooltip)	{};	//> Variable tooltip
+					tootip_(tooltip),	//> Variable tooltip
+					idx_(registerName(name)) {}; //> Slot in the dense store
 
 // Self cast operator, returns the underlying value
 varData::operator std::string() const {
 	return std::string(name_);
 }
 
+// Value returned by find for unknown names
+const size_t varData::npos= size_t(-1);
+
+// Get the number of slots registered so far
+size_t varData::size() {
+	return registry().size();
+}
+
+// Get the slot of a variable given its internal name
+size_t varData::find(const std::string& name) {
+
+	std::map<std::string,size_t>::const_iterator it= registry().find(name);
+	if(it==registry().end())
+		return npos;
+
+	return it->second;
+}
+
+// Assign a slot to a variable name
+size_t varData::registerName(const std::string& name) {
+
+	// If this name was already registered, share its slot
+	size_t idx= find(name);
+	if(idx!=npos)
+		return idx;
+
+	idx= registry().size();
+	registry()[name]= idx;
+	return idx;
+}
+
+// Map name->slot of all the registered variables. Use a function-local
+// static to make sure the map is built before the first static varData
+std::map<std::string,size_t>& varData::registry() {
+	static std::map<std::string,size_t> registry;
+	return registry;
+}
+
 varDataBounds::varDataBounds(	const char* display,
 		const char* name,
 		const char* unit,
@@ -35,6 +74,10 @@ varDataBounds::varDataBounds(	const char* display,
 	// name - with their suffixes
 	min_ += std::string("_MIN");
 	max_ += std::string("_MAX");
+
+	// Min and max are variables on their own: give them a slot
+	minIdx_= registerName(min_);
+	maxIdx_= registerName(max_);
 };
 
 
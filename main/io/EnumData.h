@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <string>
+#include <map>
 
 /// Generic container for index and label.
 /// This class is used as underlying container for
@@ -53,6 +54,32 @@ class varData {
 		const char* name_;		//> Internal variable name
 		const char* unit_;		//> Variable unit
 		const char* tootip_;		//> Variable tooltip
+
+		/// Slot of this variable in the dense variable store (see VarArray).
+		/// Slots are assigned once, when the static descriptors are built
+		size_t idx_;
+
+		/// Get the number of slots registered so far
+		static size_t size();
+
+		/// Get the slot of a variable given its internal name.
+		/// Returns varData::npos if the name is not registered
+		static size_t find(const std::string& name);
+
+		/// Value returned by find for unknown names
+		static const size_t npos;
+
+	protected:
+
+		/// Assign a slot to a variable name. Descriptors sharing
+		/// the same internal name share the same slot, consistently
+		/// with VarSet that is keyed on the name
+		static size_t registerName(const std::string& name);
+
+	private:
+
+		/// Map name->slot of all the registered variables
+		static std::map<std::string,size_t>& registry();
 };
 
 class varDataBounds : public varData {
@@ -66,6 +93,9 @@ class varDataBounds : public varData {
 		std::string min_; //> Display variable name for the min of the bound
 		std::string max_; //> Display variable name for the max of the bound
 
+		size_t minIdx_; //> Slot of the min of the bound in the dense variable store
+		size_t maxIdx_; //> Slot of the max of the bound in the dense variable store
+
 };
 
 
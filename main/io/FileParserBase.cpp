@@ -4,7 +4,9 @@
 #include "Warning.h"
 #include "VPPException.h"
 #include "mathUtils.h"
+#ifndef VPP_HEADLESS
 #include "VariableTreeModel.h"
+#endif
 
 // Constructor
 FileParserBase::FileParserBase() {
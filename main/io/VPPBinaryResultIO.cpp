@@ -0,0 +1,281 @@
+#include "VPPBinaryResultIO.h"
+#include "VPPResultIO.h"
+#include "VPPException.h"
+#include "Warning.h"
+#include <fstream>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+const char VPPBinaryResultIO::magic_[8]= {'V','P','P','R','E','S','B','\0'};
+const uint32_t VPPBinaryResultIO::version_= 1;
+
+// Ctor
+VPPBinaryResultIO::VPPBinaryResultIO(VariableFileParser* pParser, ResultContainer* pResults):
+pParser_(pParser),
+pResults_(pResults) {
+
+}
+
+// Dtor
+VPPBinaryResultIO::~VPPBinaryResultIO(){
+
+}
+
+// Write the results to a binary file
+void VPPBinaryResultIO::write(string fileName/*=string("vppResults.vppb")*/) {
+
+	if(!isLittleEndian())
+		throw VPPException(HERE,"The binary result files can only be written on little-endian machines");
+
+	std::cout<<"Saving the analysis results to binary file "<<fileName<<std::endl;
+
+	FILE* outFile= fopen(fileName.c_str(),"wb");
+	if(!outFile) {
+		char msg[256];
+		sprintf(msg,"Cannot write the result file \'%s\'",fileName.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	const WindItem* pWind= pResults_->getWind();
+
+	BinaryResultHeader header;
+	memset(&header,0,sizeof(header));
+	memcpy(header.magic_,magic_,sizeof(magic_));
+	header.version_= version_;
+	header.byteOrder_= 0x01020304;
+	header.settingsHash_= getSettingsHash(pParser_);
+	header.nWv_= pResults_->windVelocitySize();
+	header.nWa_= pResults_->windAngleSize();
+	header.nRows_= pResults_->size();
+	header.nColumns_= TableResultType::discard+1;
+	header.dataOffset_= sizeof(header) + (header.nWv_+header.nWa_)*sizeof(double);
+
+	// The grid, then the columns. An integer and a double take 8 bytes,
+	// so that the blocks share one buffer
+	std::vector<double> grid;
+	for(size_t iWv=0; iWv<header.nWv_; iWv++)
+		grid.push_back(pWind->getTWV(iWv));
+	for(size_t iWa=0; iWa<header.nWa_; iWa++)
+		grid.push_back(pWind->getTWA(iWa));
+
+	bool ok= fwrite(&header,sizeof(header),1,outFile)==1 &&
+			fwrite(grid.data(),sizeof(double),grid.size(),outFile)==grid.size();
+
+	std::vector<double> dBlock(header.nRows_);
+	std::vector<uint64_t> iBlock(header.nRows_);
+	for(size_t col=0; ok && col<header.nColumns_; col++) {
+
+		for(size_t idx=0; idx<header.nRows_; idx++) {
+
+			double entry= pResults_->getTableEntry(idx,col);
+			if(!isIntegerColumn(col)) {
+				dBlock[idx]= entry;
+				continue;
+			}
+
+			iBlock[idx]= uint64_t(entry);
+
+			// A refined result is off the angle of its grid index. The angles
+			// are stored exactly, so that the comparison is exact
+			if(col==TableResultType::discard) {
+				size_t itwa= pResults_->getTableEntry(idx,TableResultType::itwa);
+				if(pResults_->getTableEntry(idx,TableResultType::twa) != pWind->getTWA(itwa))
+					iBlock[idx] |= 2;
+			}
+		}
+
+		if(isIntegerColumn(col))
+			ok= fwrite(iBlock.data(),sizeof(uint64_t),iBlock.size(),outFile)==iBlock.size();
+		else
+			ok= fwrite(dBlock.data(),sizeof(double),dBlock.size(),outFile)==dBlock.size();
+	}
+
+	fclose(outFile);
+
+	if(!ok) {
+		char msg[256];
+		sprintf(msg,"Error while writing the result file \'%s\'",fileName.c_str());
+		throw VPPException(HERE,msg);
+	}
+}
+
+// Read the results from a binary file
+void VPPBinaryResultIO::read(string fileName) {
+
+	fileName_= fileName;
+
+	int fd= open(fileName.c_str(),O_RDONLY);
+	if(fd<0) {
+		char msg[256];
+		sprintf(msg,"==>> Result file: %s  not found! <<==", fileName.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	struct stat fileStat;
+	if(fstat(fd,&fileStat) || fileStat.st_size<(off_t)sizeof(BinaryResultHeader)) {
+		close(fd);
+		char msg[256];
+		sprintf(msg,"The file \'%s\' is not a binary result file",fileName.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	size_t size= fileStat.st_size;
+	void* pData= mmap(0,size,PROT_READ,MAP_PRIVATE,fd,0);
+	close(fd);
+	if(pData==MAP_FAILED) {
+		char msg[256];
+		sprintf(msg,"Cannot map the result file \'%s\'",fileName.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	// Make sure the file is unmapped whatever happens while reading
+	try {
+		read(static_cast<const char*>(pData),size);
+	} catch(...) {
+		munmap(pData,size);
+		throw;
+	}
+	munmap(pData,size);
+}
+
+// Read the results from a file mapped in memory
+void VPPBinaryResultIO::read(const char* pData, size_t size) {
+
+	const BinaryResultHeader* pHeader= reinterpret_cast<const BinaryResultHeader*>(pData);
+
+	char msg[256];
+	if(memcmp(pHeader->magic_,magic_,sizeof(magic_))) {
+		sprintf(msg,"The file \'%s\' is not a binary result file",fileName_.c_str());
+		throw VPPException(HERE,msg);
+	}
+	if(pHeader->version_!=version_) {
+		sprintf(msg,"The result file \'%s\' has version %u, only version %u is supported",
+				fileName_.c_str(),pHeader->version_,version_);
+		throw VPPException(HERE,msg);
+	}
+	if(pHeader->byteOrder_!=0x01020304 || !isLittleEndian())
+		throw VPPException(HERE,"The binary result files can only be read on little-endian machines");
+
+	// The sizes are checked before computing any offset out of them
+	uint64_t nWv= pHeader->nWv_, nWa= pHeader->nWa_, nRows= pHeader->nRows_;
+	if(nWv!=pResults_->windVelocitySize() || nWa!=pResults_->windAngleSize()) {
+		sprintf(msg,"The wind grid of the result file \'%s\' is %llu x %llu, expected %zu x %zu",
+				fileName_.c_str(),(unsigned long long)nWv,(unsigned long long)nWa,
+				pResults_->windVelocitySize(),pResults_->windAngleSize());
+		throw VPPException(HERE,msg);
+	}
+	if( pHeader->nColumns_!=TableResultType::discard+1 ||
+			pHeader->dataOffset_!=sizeof(BinaryResultHeader) + (nWv+nWa)*sizeof(double) ||
+			nRows > size/8 ||
+			size!=pHeader->dataOffset_ + pHeader->nColumns_*nRows*8 ) {
+		sprintf(msg,"The result file \'%s\' is truncated or corrupt",fileName_.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	// The grid must match the wind of the results
+	const WindItem* pWind= pResults_->getWind();
+	const double* pGrid= reinterpret_cast<const double*>(pData+sizeof(BinaryResultHeader));
+	for(size_t iWv=0; iWv<nWv; iWv++)
+		if(pGrid[iWv]!=pWind->getTWV(iWv)) {
+			sprintf(msg,"The wind velocities of the result file \'%s\' differ from the settings",fileName_.c_str());
+			throw VPPException(HERE,msg);
+		}
+	for(size_t iWa=0; iWa<nWa; iWa++)
+		if(pGrid[nWv+iWa]!=pWind->getTWA(iWa)) {
+			sprintf(msg,"The wind angles of the result file \'%s\' differ from the settings",fileName_.c_str());
+			throw VPPException(HERE,msg);
+		}
+
+	if(pHeader->settingsHash_!=getSettingsHash(pParser_)) {
+		sprintf(msg,"The results of \'%s\' have been computed with different settings",fileName_.c_str());
+		Warning(string(msg));
+	}
+
+	// Read the columns in place
+	const char* pColumns= pData + pHeader->dataOffset_;
+	const uint64_t* itwv= reinterpret_cast<const uint64_t*>(pColumns + TableResultType::itwv*nRows*8);
+	const uint64_t* itwa= reinterpret_cast<const uint64_t*>(pColumns + TableResultType::itwa*nRows*8);
+	const uint64_t* flags= reinterpret_cast<const uint64_t*>(pColumns + TableResultType::discard*nRows*8);
+	const double* twa= reinterpret_cast<const double*>(pColumns + TableResultType::twa*nRows*8);
+	const double* x[4], *res[2];
+	for(size_t i=0; i<4; i++)
+		x[i]= reinterpret_cast<const double*>(pColumns + (TableResultType::u+i)*nRows*8);
+	for(size_t i=0; i<2; i++)
+		res[i]= reinterpret_cast<const double*>(pColumns + (TableResultType::residual_f+i)*nRows*8);
+
+	// Clear the results before filling them
+	pResults_->initResultMatrix();
+
+	Eigen::VectorXd results(4), residuals(2);
+	for(size_t row=0; row<nRows; row++) {
+
+		results << x[0][row], x[1][row], x[2][row], x[3][row];
+		residuals << res[0][row], res[1][row];
+		bool discard= flags[row] & 1;
+
+		if(flags[row] & 2)
+			pResults_->insert(itwv[row],twa[row],results,residuals,discard);
+		else
+			pResults_->push_back(itwv[row],itwa[row],results,residuals,discard);
+	}
+}
+
+// Read the results from inFile and write them to outFile in the other format
+void VPPBinaryResultIO::convert(string inFile, string outFile) {
+
+	if(isBinary(inFile)) {
+		read(inFile);
+		VPPResultIO writer(pParser_,pResults_);
+		writer.write(outFile,"w");
+	}
+	else {
+		VPPResultIO reader(pParser_,pResults_);
+		reader.parse(inFile);
+		write(outFile);
+	}
+}
+
+// Does the file begin with the magic of the binary result files?
+bool VPPBinaryResultIO::isBinary(string fileName) {
+
+	std::ifstream infile(fileName.c_str(),std::ios::binary);
+	char magic[sizeof(magic_)];
+	if(!infile.read(magic,sizeof(magic)))
+		return false;
+
+	return !memcmp(magic,magic_,sizeof(magic_));
+}
+
+// Hash (FNV-1a, 64 bits) of the names and values of the variables of a parser.
+// The variables are sorted by name in their set
+uint64_t VPPBinaryResultIO::getSettingsHash(const VariableFileParser* pParser) {
+
+	uint64_t hash= 14695981039346656037ULL;
+	const VarSet* pVariables= pParser->getVariables();
+	for(VarSet::const_iterator it=pVariables->begin(); it!=pVariables->end(); it++) {
+
+		const unsigned char* pName= reinterpret_cast<const unsigned char*>(it->varName_.c_str());
+		for(size_t i=0; i<=it->varName_.size(); i++)
+			hash= (hash ^ pName[i]) * 1099511628211ULL;
+
+		const unsigned char* pVal= reinterpret_cast<const unsigned char*>(&it->val_);
+		for(size_t i=0; i<sizeof(double); i++)
+			hash= (hash ^ pVal[i]) * 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+// Is the column col of the file an integer column?
+bool VPPBinaryResultIO::isIntegerColumn(size_t col) {
+	return col==TableResultType::itwv || col==TableResultType::itwa || col==TableResultType::discard;
+}
+
+// Is this machine little-endian?
+bool VPPBinaryResultIO::isLittleEndian() {
+	uint16_t one= 1;
+	return *reinterpret_cast<const unsigned char*>(&one)==1;
+}
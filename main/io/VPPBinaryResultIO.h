@@ -0,0 +1,120 @@
+#ifndef VPP_BINARY_RESULT_IO_H
+#define VPP_BINARY_RESULT_IO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <iostream>
+#include "string.h"
+#include "Results.h"
+#include "VariableFileParser.h"
+
+using namespace std;
+using namespace Results;
+
+/// Header of a binary result file. All the fields are little-endian,
+/// and the size of the header is a multiple of 8 bytes, so that the
+/// grid and the column blocks that follow are aligned once mapped
+struct BinaryResultHeader {
+
+	/// Identifies a binary result file, see VPPBinaryResultIO::magic_
+	char magic_[8];
+
+	/// Version of the layout of the file
+	uint32_t version_;
+
+	/// Written as 0x01020304, tells the byte order of the writer
+	uint32_t byteOrder_;
+
+	/// Hash of the settings the results have been computed with
+	uint64_t settingsHash_;
+
+	/// Size of the wind grid
+	uint64_t nWv_, nWa_;
+
+	/// Number of results, grid and refined
+	uint64_t nRows_;
+
+	/// Number of column blocks
+	uint64_t nColumns_;
+
+	/// Offset of the first column block from the beginning of the file
+	uint64_t dataOffset_;
+};
+
+/// Class used to read and write VPP results from and to a binary file,
+/// the lossless and compact counterpart of the text format of VPPResultIO.
+/// The layout of the file, version 1, is :
+///
+///   BinaryResultHeader
+///   nWv_ doubles : the wind velocities of the grid [m/s]
+///   nWa_ doubles : the wind angles of the grid [rad]
+///   nColumns_ blocks of nRows_ entries of 8 bytes
+///
+/// The column blocks are the result fields in the order of TableResultType,
+/// itwv to discard. itwv, itwa and discard are uint64, the others doubles.
+/// The discard column holds flags : bit 0 if the result is discarded, bit 1
+/// if the result refines the wind grid. The results are sorted as in
+/// ResultContainer::get(idx). The file is read through mmap, with no
+/// parsing : the columns are read in place
+class VPPBinaryResultIO {
+
+	public:
+
+		/// Ctor
+		VPPBinaryResultIO(VariableFileParser* pParser, ResultContainer* pResults);
+
+		/// Dtor
+		~VPPBinaryResultIO();
+
+		/// Write the results to a binary file. The file is overwritten
+		void write(string fileName=string("vppResults.vppb"));
+
+		/// Read the results from a binary file. Throws if the file is not a
+		/// binary result file, or if its wind grid differs from the one of
+		/// the results. Warns if the results have been computed with
+		/// different settings
+		void read(string fileName);
+
+		/// Read the results from inFile and write them to outFile in the other
+		/// format : binary to text, or text to binary
+		void convert(string inFile, string outFile);
+
+		/// Does the file begin with the magic of the binary result files?
+		static bool isBinary(string fileName);
+
+		/// Hash (FNV-1a, 64 bits) of the names and values of the variables
+		/// of a parser
+		static uint64_t getSettingsHash(const VariableFileParser*);
+
+		/// Identifies a binary result file
+		static const char magic_[8];
+
+		/// Current version of the layout of the file
+		static const uint32_t version_;
+
+	private:
+
+		/// Disallow default ctor
+		VPPBinaryResultIO();
+
+		/// Read the results from a file mapped in memory
+		void read(const char* pData, size_t size);
+
+		/// Is the column col of the file an integer column?
+		static bool isIntegerColumn(size_t col);
+
+		/// Is this machine little-endian?
+		static bool isLittleEndian();
+
+		/// Ptr to the parser that knows all of the variables
+		VariableFileParser* pParser_;
+
+		/// Ptr to the result container
+		ResultContainer* pResults_;
+
+		/// Name of the file being read or written
+		string fileName_;
+
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "VPPResultIO.h"
 #include "VPPException.h"
+#include "mathUtils.h"
 #include <fstream>
 
 // Ctor
@@ -75,6 +76,18 @@ void VPPResultIO::parseLine(std::string& line) {
 			&itwv, &twv, &itwa, &twa, &v, &phi, &b, &f, &df, &dm, &discard) != 11 )
 		return;
 
+	// A result whose angle is not the grid angle itwa refines the wind grid.
+	// The angles are printed in degrees with 6 decimals
+	if( itwa < pResults_->windAngleSize() &&
+			fabs( twa - mathUtils::toDeg(pResults_->getWind()->getTWA(itwa)) ) > 1.e-5 ) {
+
+		Eigen::VectorXd results(4), residuals(2);
+		results << v, phi, b, f;
+		residuals << df, dm;
+		pResults_->insert( itwv, mathUtils::toRad(twa), results, residuals, discard );
+		return;
+	}
+
 	// Push the result to the stack
 	pResults_->push_back( itwv, itwa, v, phi, b, f, df, dm);
 
@@ -0,0 +1,125 @@
+#include "VPPSettingsXmlParser.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QXmlStreamReader>
+#include "VPPException.h"
+#include "mathUtils.h"
+#include "VppTags.h"
+
+// Ctor
+VPPSettingsXmlParser::VPPSettingsXmlParser(VariableFileParser* pParser) :
+	pParser_(pParser),
+	solver_(nlOpt) {
+
+}
+
+// Disallowed default Ctor
+VPPSettingsXmlParser::VPPSettingsXmlParser() :
+	pParser_(0),
+	solver_(nlOpt) {
+
+}
+
+// Dtor
+VPPSettingsXmlParser::~VPPSettingsXmlParser() {
+
+}
+
+// Parse the settings file
+void VPPSettingsXmlParser::parse(string fileName) {
+
+	QFile file(fileName.c_str());
+	if (!file.open(QFile::ReadOnly | QFile::Text)) {
+		char msg[256];
+		sprintf(msg,"Cannot read the settings file \'%s\'",fileName.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	QXmlStreamReader xml(&file);
+
+	// Verify this is suitable file (vppSettings v.1.0). Otherwise throw
+	if (!xml.readNextStartElement() ||
+			xml.name() != vppSettingsTag.c_str() ||
+			xml.attributes().value(vppSettingsVersionTag.c_str()) != vppSettingsVersion.c_str() ) {
+		char msg[256];
+		sprintf(msg,"The file \'%s\' is not a VppSettings version %s file",
+				fileName.c_str(),vppSettingsVersion.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	// Walk the items. The items of the settings tree hold the variables,
+	// while the item of the general settings holds the solver choice
+	bool isGeneralSettings=false;
+	while (!xml.atEnd()) {
+
+		xml.readNext();
+
+		if(xml.name() == vppGeneralSettingTag.c_str())
+			isGeneralSettings= xml.isStartElement();
+
+		else if(xml.isStartElement() && xml.name() == "Item") {
+			if(isGeneralSettings)
+				readSolver(xml.attributes());
+			else
+				readItem(xml.attributes());
+		}
+	}
+
+	if(xml.hasError()) {
+		char msg[256];
+		sprintf(msg,"Error reading \'%s\' at line %lld, column %lld: %s",
+				fileName.c_str(),xml.lineNumber(),xml.columnNumber(),
+				xml.errorString().toStdString().c_str());
+		throw VPPException(HERE,msg);
+	}
+}
+
+// Get the solver selected in the general settings
+solverChoice VPPSettingsXmlParser::getSolver() const {
+	return solver_;
+}
+
+// Store the value of an item of the settings tree in the parser
+void VPPSettingsXmlParser::readItem(const QXmlStreamAttributes& atts) {
+
+	// Groups and bounds have no variable name : their children do
+	QString varName( atts.value(Variable::variableNameTag_.c_str()).toString() );
+	if(varName.isEmpty())
+		return;
+
+	// We use a convention here that maps the active index of the
+	// combo-box to the value specified in SailConfig - see SailSet.h
+	bool ok=false;
+	double value;
+	if(atts.value(classNameTag.c_str()) == "SettingsItemComboBox")
+		value= atts.value("ActiveIndex").toInt(&ok);
+	else
+		value= atts.value(valueTag.c_str()).toDouble(&ok);
+
+	if(!ok) {
+		char msg[256];
+		sprintf(msg,"Cannot read the value of variable \'%s\'",varName.toStdString().c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	// Convert to SI unit (actually, we only convert deg -> rad)
+	if(atts.value(unitTag.c_str()) == "deg")
+		value= mathUtils::toRad(value);
+
+	pParser_->insert(varName,value);
+}
+
+// Read the solver choice from an item of the general settings
+void VPPSettingsXmlParser::readSolver(const QXmlStreamAttributes& atts) {
+
+	bool ok=false;
+	int index= atts.value("ActiveIndex").toInt(&ok);
+	if(!ok || index<nlOpt || index>nlOptSLSQP) {
+		char msg[256];
+		sprintf(msg,"The value of solver: \"%s\" is not supported",
+				atts.value("ActiveIndex").toString().toStdString().c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	solver_= static_cast<solverChoice>(index);
+}
@@ -0,0 +1,60 @@
+#ifndef VPP_SETTINGS_XML_PARSER_H
+#define VPP_SETTINGS_XML_PARSER_H
+
+#include <string>
+#include <QtCore/QXmlStreamAttributes>
+
+#include "VariableFileParser.h"
+
+using namespace std;
+
+/// Enum expressing the solver choice made by the user
+enum solverChoice {
+	nlOpt,
+	ipOpt,
+	noOpt,
+	saoa,
+	nlOptSLSQP
+};
+
+/// Parser used to read a VppSettings xml file without instantiating
+/// the settings window. The variables of the settings tree are stored
+/// into a VariableFileParser, converted to SI units the same way the
+/// settings window does (deg -> rad). Only relies on QtCore, so that
+/// it can be used by the headless batch program
+class VPPSettingsXmlParser {
+
+	public:
+
+		/// Ctor. The variables read from file will be stored in pParser
+		VPPSettingsXmlParser(VariableFileParser* pParser);
+
+		/// Dtor
+		~VPPSettingsXmlParser();
+
+		/// Parse the settings file. Throws if the file cannot be
+		/// read or if it is not a VppSettings file
+		void parse(string fileName);
+
+		/// Get the solver selected in the general settings
+		solverChoice getSolver() const;
+
+	private:
+
+		/// Disallow default ctor
+		VPPSettingsXmlParser();
+
+		/// Store the value of an item of the settings tree in the parser
+		void readItem(const QXmlStreamAttributes&);
+
+		/// Read the solver choice from an item of the general settings
+		void readSolver(const QXmlStreamAttributes&);
+
+		/// Ptr to the parser the variables are stored in. Not owned
+		VariableFileParser* pParser_;
+
+		/// Solver selected in the general settings
+		solverChoice solver_;
+};
+
+#endif
@@ -2,14 +2,17 @@
 #include <stdio.h>
 #include <cmath>
 
-#include "../gui/settingsWindow/GetItemVisitor.h"
 #include "Warning.h"
 #include "VPPException.h"
 #include "mathUtils.h"
+#ifndef VPP_HEADLESS
+#include "../gui/settingsWindow/GetItemVisitor.h"
 #include "TreeTab.h"
 #include "VPPSettingsDialog.h"
 #include "VariableTreeModel.h"
+#endif
 
+#ifndef VPP_HEADLESS
 // Ctor
 VariableParserGetVisitor::VariableParserGetVisitor(VariableFileParser* pParser):
 pParser_(pParser) {
@@ -50,6 +53,7 @@ void VariableParserGetVisitor::visit(SettingsItemRoot* pRoot) {
 		child->accept(*this);
 	}
 }
+#endif
 
 //---------------------------------------------------------
 
@@ -137,6 +141,7 @@ VariableFileParser::VariableFileParser() {
 
 }
 
+#ifndef VPP_HEADLESS
 // Constructor - the settingsDialog is in charge for
 // populating the parser
 VariableFileParser::VariableFileParser(VPPSettingsDialog* pSd) :
@@ -167,6 +172,7 @@ VariableFileParser::VariableFileParser(SettingsItemBase* pSettingsModelRoot) {
 	pSettingsModelRoot->accept(v);
 
 }
+#endif
 
 
 // Destructor
@@ -184,6 +190,7 @@ size_t VariableFileParser::preParse() {
 
 	// Make sure the variables_ set is empty
 	variables_.clear();
+	values_.clear();
 
 	return keepParsing::keep_going;
 }
@@ -215,7 +222,9 @@ void VariableFileParser::parseLine(string& line) {
 	ss >> newVariable.val_;
 	//std::cout<< "  -->> Read: "<<newVariable<<std::endl;
 
-	variables_.insert(newVariable);
+	// Mirror the value to the dense store only if the set accepted it
+	if(variables_.insert(newVariable).second)
+		values_.set(newVariable.varName_,newVariable.val_);
 
 }
 
@@ -273,7 +282,7 @@ void VariableFileParser::check() {
 }
 
 /// Get the value of a variable
-double VariableFileParser::get(std::string varName) {
+double VariableFileParser::get(const std::string& varName) const {
 	return variables_[varName];
 }
 
@@ -294,6 +303,7 @@ size_t VariableFileParser::getNumVars() {
 	return variables_.size();
 }
 
+#ifndef VPP_HEADLESS
 // Populate the tree model that will be used to
 // visualize the variables in the UI
 void VariableFileParser::populate(VariableTreeModel* pTreeModel) {
@@ -305,6 +315,7 @@ void VariableFileParser::populate(VariableTreeModel* pTreeModel) {
 	// in the tree model
 	variables_.populate(pTreeModel);
 }
+#endif
 
 // Comparison operator. Are the variables contained into
 // this parser equal to the variables of another parser?
@@ -319,7 +330,9 @@ void VariableFileParser::insert(QString variableName, double variableValue) {
 	newVariable.varName_= variableName.toStdString();
 	newVariable.val_= variableValue;
 
-	variables_.insert(newVariable);
+	// Mirror the value to the dense store only if the set accepted it
+	if(variables_.insert(newVariable).second)
+		values_.set(newVariable.varName_,newVariable.val_);
 
 }
 
@@ -9,6 +9,7 @@
 
 #include "FileParserBase.h"
 #include "Variables.h"
+#include <QString>
 
 using namespace std;
 
@@ -26,6 +27,7 @@ class SettingsItemComboBox;
 template <class TUnit>
 class SettingsItemBounds;
 
+#ifndef VPP_HEADLESS
 /// Visitor used to retrieve the variables from the
 /// SettingsModel and store them in the VariableFileParser
 class VariableParserGetVisitor {
@@ -64,6 +66,7 @@ class VariableParserGetVisitor {
 		/// Ptr to the parser
 		VariableFileParser* pParser_;
 };
+#endif
 
 ///---------------------------------------------------------
 
@@ -76,12 +79,14 @@ class VariableFileParser : public FileParserBase {
 		/// Constructor
 		VariableFileParser();
 
+#ifndef VPP_HEADLESS
 		/// Constructor - the settingsDialog is in charge for
 		/// populating the parser
 		VariableFileParser(VPPSettingsDialog*);
 
 		/// Constructor using directly the root of the variableTreeModel
 		VariableFileParser(SettingsItemBase*);
+#endif
 
 		/// Destructor
 		virtual ~VariableFileParser();
@@ -91,7 +96,13 @@ class VariableFileParser : public FileParserBase {
 		virtual void check();
 
 		/// Get the value of a variable by name
-		double get(std::string);
+		double get(const std::string&) const;
+
+		/// Get the value of a variable by descriptor. This is an
+		/// O(1) read of the dense store, use it on the hot path
+		inline double get(const varData& var) const {
+			return values_.get(var);
+		}
 
 		/// Get the variables contained in the parser
 		const VarSet* getVariables() const;
@@ -105,9 +116,11 @@ class VariableFileParser : public FileParserBase {
 		/// Get the number of variables that have been read in
 		size_t getNumVars();
 
+#ifndef VPP_HEADLESS
 		/// Populate the tree model that will be used to
 		/// visualize the variables in the UI
 		void populate(VariableTreeModel* pTreeModel);
+#endif
 
 		/// Comparison operator. Are the variables contained into
 		/// this parser equal to the variables of another parser?
@@ -136,12 +149,17 @@ class VariableFileParser : public FileParserBase {
 		/// Set of variables read from input file
 		VarSet variables_;
 
+		/// Same values of variables_, addressed by varData slot
+		VarArray values_;
+
 		/// Collection of all variables requested for the analysis
 		std::vector<std::string> requiredVariables_;
 
 };
 
+#ifndef VPP_HEADLESS
 #include "VariableFileParser_tpl.h"
+#endif
 
 #endif
 
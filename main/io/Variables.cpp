@@ -1,6 +1,8 @@
 #include "Variables.h"
 #include "VPPException.h"
 #include "utility"
+#include <limits>
+#include <algorithm>
 
 // Init static members
 // XML tag used to describe the internal name of an item
@@ -59,7 +61,7 @@ const string VarSet::headerBegin_=string("==VARIABLES==");
 const string VarSet::headerEnd_=string("==END VARIABLES==");
 
 // Overload operator [] - non const variety
-Variable& VarSet::operator [] (string varName){
+Variable& VarSet::operator [] (const string& varName){
 
 	VarSet::iterator it = find(varName);
 	if(it == VarSet::end() ) {
@@ -77,7 +79,7 @@ Variable& VarSet::operator [] (string varName){
 }
 
 // Overload operator [] - const variety
-const Variable& VarSet::operator [] (string varName) const {
+const Variable& VarSet::operator [] (const string& varName) const {
 	VarSet::iterator it = find(varName);
 	if(it == VarSet::end() ) {
 		char msg[256];
@@ -102,6 +104,7 @@ void VarSet::print(FILE* outStream/*=stdout*/) {
 
 }
 
+#ifndef VPP_HEADLESS
 // Populate the tree model that will be used to
 // visualize the variables in the UI
 void VarSet::populate(VariableTreeModel* pTreeModel) {
@@ -110,6 +113,7 @@ void VarSet::populate(VariableTreeModel* pTreeModel) {
 		pTreeModel->append(it->varName_.c_str(),it->val_);
 
 }
+#endif
 
 // Comparison operator
 bool VarSet::operator == (const VarSet& rhs) {
@@ -137,3 +141,37 @@ bool VarSet::operator != (const VarSet& rhs) {
 	return !(*this==rhs);
 }
 
+//=========================================
+
+// Ctor. Allocates one slot per registered varData
+VarArray::VarArray() :
+	vals_(varData::size(), std::numeric_limits<double>::quiet_NaN()) {
+
+}
+
+// Set the value of a variable given its name
+void VarArray::set(const string& varName, double val) {
+
+	size_t idx= varData::find(varName);
+	if(idx==varData::npos)
+		return;
+
+	vals_[idx]= val;
+}
+
+// Set the value of a variable given its descriptor
+void VarArray::set(const varData& var, double val) {
+	vals_[var.idx_]= val;
+}
+
+// Reset all the slots to undefined
+void VarArray::clear() {
+	std::fill(vals_.begin(), vals_.end(), std::numeric_limits<double>::quiet_NaN());
+}
+
+// Throw for a variable that was never set
+void VarArray::throwUndefined(const varData& var) const {
+	char msg[256];
+	sprintf(msg,"Cannot find variable named: %s",var.name_);
+	throw VPPException(HERE,msg);
+}
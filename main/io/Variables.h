@@ -7,7 +7,11 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <cmath>
+#ifndef VPP_HEADLESS
 #include "VariableTreeModel.h"
+#endif
+#include "EnumData.h"
 
 using namespace std;
 
@@ -63,17 +67,19 @@ class VarSet : public set<Variable> {
 	public:
 
 		/// Overload operator [] - non const variety
-		Variable& operator [] (string varName);
+		Variable& operator [] (const string& varName);
 
 		/// Overload operator [] - const variety
-		const Variable& operator [] (string varName) const;
+		const Variable& operator [] (const string& varName) const;
 
 		/// Iterate in the set and printout the variables
 		void print(FILE* outStream=stdout);
 
+#ifndef VPP_HEADLESS
 		/// Populate the tree model that will be used to
 		/// visualize the variables in the UI
 		void populate(VariableTreeModel*);
+#endif
 
 		/// Comparison operator
 		bool operator == (const VarSet&);
@@ -86,5 +92,46 @@ class VarSet : public set<Variable> {
 
 };
 
+/// Dense, index-addressed companion of a VarSet. Each value is
+/// stored in the slot of its varData descriptor, so that reading
+/// a variable on the hot path is an array access, with no string
+/// comparison and no allocation. The VarSet remains the container
+/// used for IO and for the UI
+class VarArray {
+
+	public:
+
+		/// Ctor. Allocates one slot per registered varData
+		VarArray();
+
+		/// Set the value of a variable given its name. Names that
+		/// do not belong to any varData are ignored
+		void set(const string& varName, double val);
+
+		/// Set the value of a variable given its descriptor
+		void set(const varData& var, double val);
+
+		/// Get the value of a variable given its descriptor.
+		/// Throws if the variable was never set
+		inline double get(const varData& var) const {
+			double val= vals_[var.idx_];
+			if(std::isnan(val))
+				throwUndefined(var);
+			return val;
+		}
+
+		/// Reset all the slots to undefined
+		void clear();
+
+	private:
+
+		/// Throw for a variable that was never set
+		void throwUndefined(const varData& var) const;
+
+		/// Values of the variables, one per slot
+		std::vector<double> vals_;
+
+};
+
 
 #endif
@@ -1,6 +1,7 @@
 #include "Results.h"
 #include "VPPException.h"
 #include "mathUtils.h"
+#include <algorithm>
 
 using namespace mathUtils;
 
@@ -129,12 +130,12 @@ void Result::print(FILE* outStream) const {
 }
 
 // How many columns for printing out this result?
-// 11 : iTWV  TWV  iTWa  TWA -- V  PHI  B  F -- dF dM -- discard
+// 20 : iTWV  TWV  iTWa  TWA -- V  PHI  B  F -- dF dM -- discard -- telemetry
 size_t Result::getTableCols() const {
 
-	// Discard is the last of the list, its value is 10. The number
-	// of rows of a table is 11.
-	return TableResultType::discard+1;
+	// The residual norm of the telemetry is the last of the list, its
+	// value is 19. The number of rows of a table is 20.
+	return TableResultType::residualNorm+1;
 }
 
 // Returns the header for the table view
@@ -167,6 +168,25 @@ QVariant Result::getColumnHeader(int col) const {
 		case TableResultType::discard :
 			return QString("Discard");
 			// --
+		case TableResultType::nResiduals :
+			return QString("nResiduals [-]");
+		case TableResultType::nUpdates :
+			return QString("nUpdates [-]");
+		case TableResultType::nIterations :
+			return QString("nIterations [-]");
+		case TableResultType::nJacobians :
+			return QString("nJacobians [-]");
+		case TableResultType::nEvaluations :
+			return QString("nEvaluations [-]");
+		case TableResultType::updateTime :
+			return QString("Update time [s]");
+		case TableResultType::linearAlgebraTime :
+			return QString("Lin. algebra time [s]");
+		case TableResultType::wallTime :
+			return QString("Wall time [s]");
+		case TableResultType::residualNorm :
+			return QString("|Residuals| [-]");
+			// --
 		default:
 			return QVariant();
 	}
@@ -205,6 +225,25 @@ double Result::getTableEntry(int col) const {
 		case TableResultType::discard :
 			return discard_;
 			// --
+		case TableResultType::nResiduals :
+			return telemetry_.nResiduals_;
+		case TableResultType::nUpdates :
+			return telemetry_.nUpdates_;
+		case TableResultType::nIterations :
+			return telemetry_.nIterations_;
+		case TableResultType::nJacobians :
+			return telemetry_.nJacobians_;
+		case TableResultType::nEvaluations :
+			return telemetry_.nEvaluations_;
+		case TableResultType::updateTime :
+			return telemetry_.updateTime_;
+		case TableResultType::linearAlgebraTime :
+			return telemetry_.linearAlgebraTime_;
+		case TableResultType::wallTime :
+			return telemetry_.wallTime_;
+		case TableResultType::residualNorm :
+			return telemetry_.residualNorm_;
+			// --
 		default:
 			return -1;
 	}
@@ -255,6 +294,16 @@ const bool Result::discard() const {
 	return discard_;
 }
 
+// Set the telemetry of the solver for this result
+void Result::setTelemetry( const SolverTelemetry& telemetry ) {
+	telemetry_= telemetry;
+}
+
+// Get the telemetry of the solver for this result
+const SolverTelemetry& Result::getTelemetry() const {
+	return telemetry_;
+}
+
 /// Comparison operator =
 bool Result::operator == (const Result& rhs) const{
 
@@ -300,13 +349,15 @@ bool Result::operator == (const Result& rhs) const{
 ResultContainer::ResultContainer():
 											nWv_(0),
 											nWa_(0),
-											pWind_(0) {
+											pWind_(0),
+											nDiscarded_(0) {
 
 }
 
 // Constructor using a windItem
 ResultContainer::ResultContainer(WindItem* pWindItem):
-												pWind_(pWindItem) {
+												pWind_(pWindItem),
+												nDiscarded_(0) {
 
 	// Get the parser
 	VariableFileParser* pParser = pWind_->getParser();
@@ -370,128 +421,211 @@ void ResultContainer::push_back(size_t iWv, size_t iWa,
 		throw VPPException(HERE,msg);
 	}
 
-	// Ask the wind to get the current wind velocity/angles. Note that this
-	// implies that the call must be in sync, which seems rather dangerous!
-	resMat_[iWv][iWa].reset(iWv, pWind_->getTWV(iWv), iWa, pWind_->getTWA(iWa), results, residuals, discard );
+	// The wind velocity/angle of the row have been set by initResultMatrix
+	setRow(iWv*nWa_+iWa, results, residuals, discard);
 
 }
 
 // Push a trivial result marked as to be discarded -> not plot
 void ResultContainer::remove(size_t iWv, size_t iWa){
-	resMat_[iWv][iWa].setDiscard(true);
+	setDiscard(getRow(iWv,iWa),true);
 }
 
-/// Get the result for a given wind velocity/angle
-const Result& ResultContainer::get(size_t iWv, size_t iWa) const {
+// Insert the result of a wind angle refining the wind grid for the velocity iWv
+void ResultContainer::insert(size_t iWv, double twa,
+		Eigen::VectorXd& results,
+		Eigen::VectorXd& residuals,
+		bool discard/*=false*/ ) {
 
-	if(iWv>=nWv_)
-		throw VPPException(HERE,"In OptResultContainer::get, requested out-of-bounds iWv!");
-	if(iWa>=nWa_)
-		throw VPPException(HERE,"In OptResultContainer::get(), requested out-of-bounds iWa!");
+	if(iWv>=nWv_){
+		char msg[256];
+		int v=iWv, n=nWv_;
+		sprintf(msg,"In OptResultContainer::insert, requested out-of-bounds iWv: %i on %i",v,n );
+		throw VPPException(HERE,msg);
+	}
 
-	return resMat_[iWv][iWa];
+	// Index of the grid angle the refined angle follows
+	size_t iWa=0;
+	while(iWa+1<nWa_ && pWind_->getTWA(iWa+1)<=twa)
+		iWa++;
+
+	// Append a row to the columns
+	size_t row= u_.size();
+	iTwv_.push_back(iWv);
+	iTwa_.push_back(iWa);
+	twv_.push_back(pWind_->getTWV(iWv));
+	twa_.push_back(twa);
+	u_.push_back(0);
+	phi_.push_back(0);
+	b_.push_back(0);
+	f_.push_back(0);
+	dF_.push_back(0);
+	dM_.push_back(0);
+	discard_.push_back(false);
+	telemetry_.push_back(SolverTelemetry());
+
+	setRow(row, results, residuals, discard);
+
+	// Keep the rows of the velocity sorted by twa
+	std::vector<size_t>& rows= velocityRows_[iWv];
+	std::vector<size_t>::iterator it= std::upper_bound(rows.begin(), rows.end(), twa,
+			[this](double a, size_t r) { return a < twa_[r]; } );
+	rows.insert(it,row);
+
+	// The results of the next velocities are shifted by one
+	for(size_t i=iWv+1; i<velocityOffset_.size(); i++)
+		velocityOffset_[i]++;
 }
 
-/// Get the result for a given wind velocity/angle - non const variety
-Result& ResultContainer::get(size_t iWv, size_t iWa) {
+// Copy the grid result (iWv, iWa) of another container with the same wind grid
+void ResultContainer::copy(size_t iWv, size_t iWa, const ResultContainer& rhs) {
 
-	if(iWv>=nWv_)
-		throw VPPException(HERE,"In OptResultContainer::get, requested out-of-bounds iWv!");
-	if(iWa>=nWa_)
-		throw VPPException(HERE,"In OptResultContainer::get(), requested out-of-bounds iWa!");
+	size_t row= getRow(iWv,iWa), rhsRow= rhs.getRow(iWv,iWa);
+
+	u_[row]= rhs.u_[rhsRow];
+	phi_[row]= rhs.phi_[rhsRow];
+	b_[row]= rhs.b_[rhsRow];
+	f_[row]= rhs.f_[rhsRow];
+	dF_[row]= rhs.dF_[rhsRow];
+	dM_[row]= rhs.dM_[rhsRow];
+	telemetry_[row]= rhs.telemetry_[rhsRow];
+	setDiscard(row, rhs.discard_[rhsRow]);
+}
+
+// Set the telemetry of the solver for the grid result (iWv, iWa)
+void ResultContainer::setTelemetry(size_t iWv, size_t iWa, const SolverTelemetry& telemetry) {
+	telemetry_[getRow(iWv,iWa)]= telemetry;
+}
 
-	return resMat_[iWv][iWa];
+/// Get the result for a given wind velocity/angle
+Result ResultContainer::get(size_t iWv, size_t iWa) const {
+	return getResult( getRow(iWv,iWa) );
 }
 
 // Get the result for a given wind velocity/angle. Assume
 // the results are shown (as in print) by WA first, and then
 // by WV
-const Result& ResultContainer::get(size_t idx) const {
+Result ResultContainer::get(size_t idx) const {
+	return getResult( getRow(idx) );
+}
 
-	if(idx >= size() )
-		throw VPPException(HERE,"In OptResultContainer::get(idx), requested out-of-bounds!");
+// Get the results of the wind velocity iWv, on the wind grid and
+// refining it, sorted by twa
+std::vector<Result> ResultContainer::getResultsForVelocity(size_t iWv) const {
 
-	// idx TWA  TWV
-	// 0    0    0
-	// 1    1    0
-	// 2    2    0
-	// 3    0    1
-	// 4    1    1
-	// 5    2    1
-	// 6 		0    2
-	// 7 		1    2
-	// 8 		2    2
+	if(iWv>=nWv_)
+		throw VPPException(HERE,"In OptResultContainer::getResultsForVelocity, requested out-of-bounds iWv!");
 
-	// idx = 2 => tWv = 0 ; tWa = 2
-	// nWa = 3
-	// tWv = idx / nWa_ = 2 / 3 = 0
-	// tWa = idx - tWv * nWa;
+	std::vector<Result> results;
+	results.reserve(velocityRows_[iWv].size());
+	for(size_t i=0; i<velocityRows_[iWv].size(); i++)
+		results.push_back( getResult(velocityRows_[iWv][i]) );
 
-	// idx = 3; tWa = 0 ; tWv = 1
-	// nWa = 3
-	// tWv = idx / nWa_ = 3 / 3  = 1
-	// tWa = idx - tWv * nWa = 3 - 1 * 3 = 0
+	return results;
+}
 
-	// idx = 7; tWa = 1 ; tWv = 2
-	// nWa = 3
-	// tWv = idx / nWa_ = 7 / 3  = 2
-	// tWa = idx - tWv * nWa = 7 - 2 * 3 = 1
-	size_t iWv= idx / nWa_;
-	size_t iWa= idx - iWv * nWa_;
+// Is the grid result for a given wind velocity/angle discarded?
+bool ResultContainer::discard(size_t iWv, size_t iWa) const {
+	return discard_[getRow(iWv,iWa)];
+}
 
-	if(iWv>=nWv_)
-		throw VPPException(HERE,"Requested out-of-bounds iWv!");
-	if(iWa>=nWa_)
-		throw VPPException(HERE,"Requested out-of-bounds iWa!");
+// Return a value of the idx-th result for filling the result table.
+// A table row looks like (see TableResultType)
+// iTWV  TWV  iTWa  TWA -- V  PHI  B  F -- dF dM -- discard -- telemetry
+double ResultContainer::getTableEntry(size_t idx, int col) const {
 
-	return resMat_[iWv][iWa];
+	size_t row= getRow(idx);
+	const SolverTelemetry& telemetry= telemetry_[row];
 
+	switch (col) {
+		case TableResultType::itwv :
+			return iTwv_[row];
+		case TableResultType::itwa :
+			return iTwa_[row];
+		case TableResultType::twv :
+		case TableResultType::twa :
+		case TableResultType::u :
+		case TableResultType::phi :
+		case TableResultType::crew :
+		case TableResultType::flat :
+		case TableResultType::residual_f :
+		case TableResultType::residual_m :
+			return getColumn(TableResultType(col))[row];
+			// --
+		case TableResultType::discard :
+			return discard_[row];
+			// --
+		case TableResultType::nResiduals :
+			return telemetry.nResiduals_;
+		case TableResultType::nUpdates :
+			return telemetry.nUpdates_;
+		case TableResultType::nIterations :
+			return telemetry.nIterations_;
+		case TableResultType::nJacobians :
+			return telemetry.nJacobians_;
+		case TableResultType::nEvaluations :
+			return telemetry.nEvaluations_;
+		case TableResultType::updateTime :
+			return telemetry.updateTime_;
+		case TableResultType::linearAlgebraTime :
+			return telemetry.linearAlgebraTime_;
+		case TableResultType::wallTime :
+			return telemetry.wallTime_;
+		case TableResultType::residualNorm :
+			return telemetry.residualNorm_;
+			// --
+		default:
+			return -1;
+	}
 }
 
-// How many results have been stored?
-const size_t ResultContainer::size() const {
-	return nWv_*nWa_;
-}
+// View on the column col of the grid results of the velocity iWv. The
+// angles of a velocity are contiguous
+ResultContainer::ColumnView ResultContainer::getVelocityView(TableResultType col, size_t iWv) const {
 
-// Count the number of results that must not be plotted
-// Note that the method is brute force, but it has the
-// advantage of assuring the sync
-const size_t ResultContainer::getNumDiscardedResultsForAngle(size_t iWa) const {
+	if(iWv>=nWv_)
+		throw VPPException(HERE,"In OptResultContainer::getVelocityView, requested out-of-bounds iWv!");
+
+	return ColumnView(getColumn(col).data() + iWv*nWa_, nWa_, Eigen::InnerStride<>(1));
+}
 
-	size_t numDiscarded=0;
+// View on the column col of the grid results of the angle iWa. The velocities
+// of an angle are nWa_ rows apart
+ResultContainer::ColumnView ResultContainer::getAngleView(TableResultType col, size_t iWa) const {
 
-	for(size_t iWv=0; iWv<nWv_; iWv++ )
-		if( resMat_[iWv][iWa].discard() )
-			numDiscarded++;
+	if(iWa>=nWa_)
+		throw VPPException(HERE,"In OptResultContainer::getAngleView, requested out-of-bounds iWa!");
 
-	return numDiscarded;
+	return ColumnView(getColumn(col).data() + iWa, nWv_, Eigen::InnerStride<>(nWa_));
 }
 
-// Count the number of results that must not be plotted
-// Note that the method is brute force, but it has the
-// advantage of assuring the sync
-const size_t ResultContainer::getNumDiscardedResultsForVelocity(size_t iWv) const {
+// How many results have been stored? Grid and refined results
+const size_t ResultContainer::size() const {
+	return u_.size();
+}
 
-	size_t numDiscarded=0;
+// How many results refine the wind grid for the velocity iWv?
+const size_t ResultContainer::getNumRefinedResults(size_t iWv) const {
 
-	for(size_t iWa=0; iWa<nWa_; iWa++ )
-		if( resMat_[iWv][iWa].discard() )
-			numDiscarded++;
+	if(iWv>=nWv_)
+		throw VPPException(HERE,"In OptResultContainer::getNumRefinedResults, requested out-of-bounds iWv!");
 
-	return numDiscarded;
+	return velocityRows_[iWv].size() - nWa_;
 }
 
-// Count the number of results that must not be plotted
-// Note that the method is brute force, but it has the
-// advantage of assuring the sync
-const size_t ResultContainer::getNumDiscardedResults() const{
-
-	size_t numDiscarded=0;
+// Count the number of grid results that must not be plotted for a given angle
+const size_t ResultContainer::getNumDiscardedResultsForAngle(size_t iWa) const {
+	return nDiscardedForAngle_.at(iWa);
+}
 
-	for(size_t iWa=0; iWa<nWa_; iWa++ )
-		numDiscarded+=getNumDiscardedResultsForAngle(iWa);
+// Count the number of grid results that must not be plotted for a given velocity
+const size_t ResultContainer::getNumDiscardedResultsForVelocity(size_t iWv) const {
+	return nDiscardedForVelocity_.at(iWv);
+}
 
-	return numDiscarded;
+// Count the number of grid results that must not be plotted
+const size_t ResultContainer::getNumDiscardedResults() const{
+	return nDiscarded_;
 }
 
 /// How many wind velocities?
@@ -532,36 +666,199 @@ void ResultContainer::print(FILE* outStream) {
 	fprintf(outStream,"%s\n",Result::headerBegin_.c_str());
 
 	for(size_t iWv=0; iWv<nWv_; iWv++)
-		for(size_t iWa=0; iWa<nWa_; iWa++)
-			resMat_[iWv][iWa].print(outStream);
+		for(size_t i=0; i<velocityRows_[iWv].size(); i++)
+			printRow(velocityRows_[iWv][i],outStream);
 
 	// Print the header end
 	fprintf(outStream,"%s\n",Result::headerEnd_.c_str());
 }
 
+// Printout the telemetry of the solver, arranged by twv-twa
+void ResultContainer::printTelemetry(FILE* outStream) {
+
+	fprintf(outStream,"%%  iTWV  iTWA  discard  ");
+	SolverTelemetry::printHeader(outStream);
+	fprintf(outStream,"\n");
+
+	for(size_t iWv=0; iWv<nWv_; iWv++)
+		for(size_t iWa=0; iWa<nWa_; iWa++) {
+			size_t row= iWv*nWa_+iWa;
+			fprintf(outStream,"%zu  %zu  %i  ", iWv, iWa, int(discard_[row]));
+			telemetry_[row].print(outStream);
+			fprintf(outStream,"\n");
+		}
+}
+
 // CLear the result vector
 void ResultContainer::initResultMatrix() {
 
-	// Reserve the space for the results
-	resMat_.clear();
-	resMat_.resize(nWv_);
+	// Allocate the columns for the grid results. Drop the refined results
+	size_t nRows= nWv_*nWa_;
+	iTwv_.resize(nRows);
+	iTwa_.resize(nRows);
+	twv_.resize(nRows);
+	twa_.resize(nRows);
+	u_.assign(nRows,0);
+	phi_.assign(nRows,0);
+	b_.assign(nRows,0);
+	f_.assign(nRows,0);
+	dF_.assign(nRows,0);
+	dM_.assign(nRows,0);
+	telemetry_.assign(nRows,SolverTelemetry());
+
+	velocityRows_.assign(nWv_,std::vector<size_t>(nWa_));
+	velocityOffset_.resize(nWv_+1);
+
+	// Init the counters itw and itwa for each result. All the results are
+	// marked as discarded because these are placeHolders for the results,
+	// not actual results yet
 	for(size_t iWv=0; iWv<nWv_; iWv++){
-		resMat_[iWv].reserve(nWa_);
+		for(size_t iWa=0; iWa<nWa_; iWa++){
+			size_t row= iWv*nWa_+iWa;
+			iTwv_[row]= iWv;
+			iTwa_[row]= iWa;
+			twv_[row]= pWind_->getTWV(iWv);
+			twa_[row]= pWind_->getTWA(iWa);
+			velocityRows_[iWv][iWa]= row;
+		}
+		velocityOffset_[iWv]= iWv*nWa_;
 	}
+	velocityOffset_[nWv_]= nRows;
 
-	// Init the counters itw and itwa for each result. The allocation
-	// should not take too much time because the space has been preallocated
-	// Set the optional argument bool discarde to true because this is a
-	// placeHolder for a result, not  an actual result yet
-	for(size_t iWv=0; iWv<nWv_; iWv++){
-		for(size_t iWa=0; iWa<nWa_; iWa++){
-			resMat_[iWv].push_back(
-					Result(iWv, pWind_->getTWV(iWv),iWa, pWind_->getTWA(iWa),true)
-			);
+	discard_.assign(nRows,true);
+	nDiscardedForVelocity_.assign(nWv_,nWa_);
+	nDiscardedForAngle_.assign(nWa_,nWv_);
+	nDiscarded_= nRows;
+}
+
+// Row of the grid result (iWv, iWa)
+size_t ResultContainer::getRow(size_t iWv, size_t iWa) const {
+
+	if(iWv>=nWv_)
+		throw VPPException(HERE,"In OptResultContainer::get, requested out-of-bounds iWv!");
+	if(iWa>=nWa_)
+		throw VPPException(HERE,"In OptResultContainer::get(), requested out-of-bounds iWa!");
+
+	return iWv*nWa_+iWa;
+}
+
+// Row of the idx-th result
+size_t ResultContainer::getRow(size_t idx) const {
+
+	if(idx >= size() )
+		throw VPPException(HERE,"In OptResultContainer::get(idx), requested out-of-bounds!");
+
+	// idx TWA  TWV
+	// 0    0    0
+	// 1    1    0
+	// 2    2    0
+	// 3    0    1
+	// 4    1    1
+	// 5    2    1
+	// 6 		0    2
+	// 7 		1    2
+	// 8 		2    2
+
+	// Without refined results, tWv = idx / nWa_ and tWa = idx - tWv * nWa_.
+	// Otherwise search the velocity idx falls into, then the angle
+	size_t iWv= std::upper_bound(velocityOffset_.begin(), velocityOffset_.end(), idx)
+					- velocityOffset_.begin() - 1;
+
+	return velocityRows_[iWv][idx - velocityOffset_[iWv]];
+}
+
+// Build a Result out of a row
+Result ResultContainer::getResult(size_t row) const {
+
+	Eigen::VectorXd results(4), residuals(2);
+	results << u_[row], phi_[row], b_[row], f_[row];
+	residuals << dF_[row], dM_[row];
+
+	Result result(iTwv_[row], twv_[row], iTwa_[row], twa_[row], results, residuals, discard_[row]);
+	result.setTelemetry(telemetry_[row]);
+
+	return result;
+}
+
+// Get the column col
+const std::vector<double>& ResultContainer::getColumn(TableResultType col) const {
+
+	switch (col) {
+		case TableResultType::twv :
+			return twv_;
+		case TableResultType::twa :
+			return twa_;
+		case TableResultType::u :
+			return u_;
+		case TableResultType::phi :
+			return phi_;
+		case TableResultType::crew :
+			return b_;
+		case TableResultType::flat :
+			return f_;
+		case TableResultType::residual_f :
+			return dF_;
+		case TableResultType::residual_m :
+			return dM_;
+		default: {
+			char msg[256];
+			sprintf(msg,"In OptResultContainer, no column of doubles for the table column %d",int(col));
+			throw VPPException(HERE,msg);
 		}
 	}
 }
 
+// Store the state vector, the residuals and the discard flag of a row
+void ResultContainer::setRow(size_t row, const Eigen::VectorXd& results,
+		const Eigen::VectorXd& residuals, bool discard) {
+
+	if(results.size()<4 || residuals.size()<2)
+		throw VPPException(HERE,"In OptResultContainer, the result requires 4 state variables and 2 residuals");
+
+	u_[row]= results(0);
+	phi_[row]= results(1);
+	b_[row]= results(2);
+	f_[row]= results(3);
+	dF_[row]= residuals(0);
+	dM_[row]= residuals(1);
+
+	setDiscard(row,discard);
+}
+
+// Set the discard flag of a row, and update the counters of the grid results
+void ResultContainer::setDiscard(size_t row, bool discard) {
+
+	if(discard_[row]==discard)
+		return;
+
+	discard_[row]= discard;
+
+	if(row>=nWv_*nWa_)
+		return;
+
+	if(discard) {
+		nDiscardedForVelocity_[iTwv_[row]]++;
+		nDiscardedForAngle_[iTwa_[row]]++;
+		nDiscarded_++;
+	} else {
+		nDiscardedForVelocity_[iTwv_[row]]--;
+		nDiscardedForAngle_[iTwa_[row]]--;
+		nDiscarded_--;
+	}
+}
+
+// Printout a row, with the format of Result::print
+void ResultContainer::printRow(size_t row, FILE* outStream) const {
+
+	fprintf(outStream,"%zu %8.6f %zu %8.6f  -- ", iTwv_[row], twv_[row], iTwa_[row], mathUtils::toDeg(twa_[row]));
+	fprintf(outStream,"  %8.6e  %8.6e  %8.6e  %8.6e", u_[row], phi_[row], b_[row], f_[row]);
+	fprintf(outStream,"  --  ");
+	fprintf(outStream,"  %8.6e  %8.6e", dF_[row], dM_[row]);
+	fprintf(outStream,"  --  %i\n", int(discard_[row]) );
+
+}
+
+#ifndef VPP_HEADLESS
 // Returns all is required to plot the polar plots
 std::vector<VppPolarCustomPlotWidget*> ResultContainer::plotPolars() {
 
@@ -577,12 +874,18 @@ std::vector<VppPolarCustomPlotWidget*> ResultContainer::plotPolars() {
 	// Loop on the wind velocities
 	for(size_t iWv=0; iWv<windVelocitySize(); iWv++) {
 
-		// Get the number of valid results for this velocity : all minus discarded
-		size_t numValidResults= windAngleSize() - getNumDiscardedResultsForVelocity(iWv);
+		// Rows of the results for this velocity, including the angles refining
+		// the wind grid, sorted by twa. Get the number of valid results : all
+		// minus discarded
+		const std::vector<size_t>& rows= velocityRows_[iWv];
+		size_t numValidResults= 0;
+		for(size_t i=0; i<rows.size(); i++)
+			if(!discard_[rows[i]])
+				numValidResults++;
 
 		// Store the wind velocity as a label for this curve
 		char windVelocityLabel[256];
-		sprintf(windVelocityLabel,"%3.1f", get(iWv,0).getTWV() );
+		sprintf(windVelocityLabel,"%3.1f", pWind_->getTWV(iWv) );
 
 		// Instantiate the series required to plot the polars
 		QVector<double> ux( numValidResults ), uy( numValidResults ),
@@ -590,11 +893,13 @@ std::vector<VppPolarCustomPlotWidget*> ResultContainer::plotPolars() {
 				crewBx( numValidResults ), crewBy( numValidResults ),
 				sailFlatx( numValidResults ), sailFlaty( numValidResults );
 
-		// Loop on the wind angles
+		// Loop on the wind angles, reading the columns in place
 		size_t idx=0;
-		for(size_t iWa=0; iWa<windAngleSize(); iWa++) {
+		for(size_t i=0; i<rows.size(); i++) {
 
-			if(!get(iWv,iWa).discard()){
+			size_t row= rows[i];
+
+			if(!discard_[row]){
 
 				//				transform to polar :
 				//					x = rho cos(theta)
@@ -602,23 +907,23 @@ std::vector<VppPolarCustomPlotWidget*> ResultContainer::plotPolars() {
 
 				// Compute the angle, considering that the angle 'zero' is on pi/2,
 				// and the direction is reversed..
-				double angle = M_PI/2 - get(iWv,iWa).getTWA();
+				double angle = M_PI/2 - twa_[row];
 
 				// Fill the boat velocity series and add to the plot
-				ux[idx]=	get(iWv,iWa).getX()->coeff(0) * cos(angle);
-				uy[idx]=	get(iWv,iWa).getX()->coeff(0) * sin(angle);
+				ux[idx]=	u_[row] * cos(angle);
+				uy[idx]=	u_[row] * sin(angle);
 
 				// Fill the boat heel
-				phix[idx]= mathUtils::toDeg(get(iWv,iWa).getX()->coeff(1)) * cos(angle);
-				phiy[idx]= mathUtils::toDeg(get(iWv,iWa).getX()->coeff(1)) * sin(angle);
+				phix[idx]= mathUtils::toDeg(phi_[row]) * cos(angle);
+				phiy[idx]= mathUtils::toDeg(phi_[row]) * sin(angle);
 
 				// Fill the crew position
-				crewBx[idx]= get(iWv,iWa).getX()->coeff(2) * cos(angle);
-				crewBy[idx]= get(iWv,iWa).getX()->coeff(2) * sin(angle);
+				crewBx[idx]= b_[row] * cos(angle);
+				crewBy[idx]= b_[row] * sin(angle);
 
 				// Fill the sail flat
-				sailFlatx[idx]= get(iWv,iWa).getX()->coeff(3) * cos(angle);
-				sailFlaty[idx]= get(iWv,iWa).getX()->coeff(3) * sin(angle);
+				sailFlatx[idx]= f_[row] * cos(angle);
+				sailFlaty[idx]= f_[row] * sin(angle);
 
 				// Increment the counter
 				idx++;
@@ -714,19 +1019,28 @@ std::vector<VppXYCustomPlotWidget*> ResultContainer::plotXY(WindIndicesDialog& w
 			dF(numValidResults),
 			dM(numValidResults);
 
+	// Views on the results of this angle, one entry per wind velocity
+	ColumnView twv= getAngleView(TableResultType::twv,iWa),
+			u= getAngleView(TableResultType::u,iWa),
+			phi= getAngleView(TableResultType::phi,iWa),
+			b= getAngleView(TableResultType::crew,iWa),
+			f= getAngleView(TableResultType::flat,iWa),
+			resF= getAngleView(TableResultType::residual_f,iWa),
+			resM= getAngleView(TableResultType::residual_m,iWa);
+
 	// Loop on all results but only plot the valid ones
 	size_t idx=0;
 	for(size_t iWv=0; iWv<windVelocitySize(); iWv++) {
 
-		if(!get(iWv,wd.getTWA()).discard()) {
+		if(!discard(iWv,iWa)) {
 
-			windSpeeds[idx]  = get(iWv,iWa).getTWV();
-			boatVelocity[idx]= get(iWv,iWa).getX()->coeff(0);
-			boatHeel[idx]    = mathUtils::toDeg( get(iWv,iWa).getX()->coeff(1));
-			boatB[idx]    	 = get(iWv,iWa).getX()->coeff(2);
-			boatFlat[idx]    = get(iWv,iWa).getX()->coeff(3);
-			dF[idx]          = get(iWv,iWa).getdF();
-			dM[idx]          = get(iWv,iWa).getdM();
+			windSpeeds[idx]  = twv(iWv);
+			boatVelocity[idx]= u(iWv);
+			boatHeel[idx]    = mathUtils::toDeg( phi(iWv) );
+			boatB[idx]    	 = b(iWv);
+			boatFlat[idx]    = f(iWv);
+			dF[idx]          = resF(iWv);
+			dM[idx]          = resM(iWv);
 			idx++;
 
 		}
@@ -754,30 +1068,21 @@ std::vector<VppXYCustomPlotWidget*> ResultContainer::plotXY(WindIndicesDialog& w
 	return retVec;
 
 }
+#endif
 
 // Printout the bounds of the Results for the whole run
 void ResultContainer::printBounds() {
 
-	double minV=1e22;
-	double maxV=-1e22;
-	double minPhi=1e22;
-	double maxPhi=-1e22;
+	if(!nWv_ || !nWa_)
+		return;
 
-	for(size_t iWv=0; iWv<nWv_; iWv++)
-		for(size_t iWa=0; iWa<nWa_; iWa++){
-
-			const Eigen::VectorXd* x( resMat_[iWv][iWa].getX() );
+	// Bounds of the grid results
+	Eigen::Map<const Eigen::ArrayXd> u(u_.data(),nWv_*nWa_), phi(phi_.data(),nWv_*nWa_);
 
-			if(x->coeff(0)>maxV)
-				maxV=x->coeff(0);
-			if(x->coeff(0)<minV)
-				minV=x->coeff(0);
-			if(x->coeff(1)>maxPhi)
-				maxPhi=x->coeff(1);
-			if(x->coeff(1)<minPhi)
-				minPhi=x->coeff(1);
-
-		}
+	double minV= u.minCoeff();
+	double maxV= u.maxCoeff();
+	double minPhi= phi.minCoeff();
+	double maxPhi= phi.maxCoeff();
 
 	std::cout<<"---------------------------------------------------------------"<<std::endl;
 	std::cout<<"\n MinV [m/s]    MaxV [m/s]  --   MinPhi [º]    MaxPhi [def]"<<std::endl;
@@ -7,7 +7,10 @@
 #include <math.h>
 
 #include "VPPItemFactory.h"
+#include <QVariant>
+#ifndef VPP_HEADLESS
 #include "VppPolarCustomPlotWidget.h"
+#endif
 
 using namespace std;
 
@@ -27,7 +30,16 @@ enum TableResultType {
 	flat,
 	residual_f,
 	residual_m,
-	discard
+	discard,
+	nResiduals,
+	nUpdates,
+	nIterations,
+	nJacobians,
+	nEvaluations,
+	updateTime,
+	linearAlgebraTime,
+	wallTime,
+	residualNorm
 };
 
 /// Struct containing the results of the current
@@ -78,7 +90,7 @@ class Result {
 		void print(FILE* outStream=stdout) const;
 
 		/// How many columns for printing out this result?
-		/// 11 : iTWV  TWV  iTWa  TWA -- V  PHI  B  F -- dF dM
+		/// 20 : iTWV  TWV  iTWa  TWA -- V  PHI  B  F -- dF dM -- discard -- telemetry
 		size_t getTableCols() const;
 
 		// Returns the header for the table view
@@ -114,6 +126,12 @@ class Result {
 		/// Discard this solution: do not plot it
 		const bool discard() const;
 
+		/// Set the telemetry of the solver for this result
+		void setTelemetry( const SolverTelemetry& telemetry );
+
+		/// Get the telemetry of the solver for this result
+		const SolverTelemetry& getTelemetry() const;
+
 		/// Comparison operator
 		bool operator == (const Result& ) const;
 
@@ -143,16 +161,28 @@ class Result {
 		/// Flag used to mark a result that must be discarded -> not plotted
 		bool discard_;
 
+		/// Work done by the solver to compute this result
+		SolverTelemetry telemetry_;
+
 };
 
-/// Container for VPPResult, which is a wrapper around
-/// vector<vector<VPPResults > >
-/// This utility class is used to store a result for each
-/// twv and twa
+/// Container for the results of a run, one result for each twv and
+/// twa of the wind grid. Each wind velocity can also store the results
+/// of the angles refining the wind grid, see VPPAngleRefiner.
+/// The results are stored by columns : one contiguous array per state
+/// variable and per residual, with one entry per result, a bitmap of the
+/// discard flags and the telemetry. The grid result (iWv, iWa) is the row
+/// iWv*nWa+iWa, the refined results follow in the order they have been
+/// inserted. The number of discarded grid results is maintained for each
+/// velocity and angle, and the columns can be viewed without copies.
+/// A Result is only built on request, as a copy of a row
 class ResultContainer {
 
 	public:
 
+		/// Zero-copy view on a column of the results
+		typedef Eigen::Map<const Eigen::ArrayXd, 0, Eigen::InnerStride<> > ColumnView;
+
 		/// Constructor using a windItem
 		ResultContainer(WindItem*);
 
@@ -178,33 +208,65 @@ class ResultContainer {
 		/// Push a trivial result marked as to be discarded -> not plot
 		void remove(size_t iWv, size_t iWa);
 
-		/// Get the result for a given wind velocity/angle
-		const Result& get(size_t iWv, size_t iWa) const;
+		/// Insert the result of a wind angle twa refining the wind grid for the
+		/// velocity iWv. The refined results are sorted by twa, and take the
+		/// index of the grid angle they follow
+		void insert(size_t iWv, double twa,
+										Eigen::VectorXd& results,
+										Eigen::VectorXd& residuals,
+										bool discard=false );
 
-		/// Get the result for a given wind velocity/angle - non const variety
-		Result& get(size_t iWv, size_t iWa);
+		/// Copy the grid result (iWv, iWa) of another container with the same
+		/// wind grid, telemetry included
+		void copy(size_t iWv, size_t iWa, const ResultContainer&);
+
+		/// Set the telemetry of the solver for the grid result (iWv, iWa)
+		void setTelemetry(size_t iWv, size_t iWa, const SolverTelemetry&);
+
+		/// Get the result for a given wind velocity/angle
+		Result get(size_t iWv, size_t iWa) const;
 
 		/// Get the result for a given wind velocity/angle. Assume
 		/// the results are shown (as in print) by WA first, and then
-		/// by WV
-		const Result& get(size_t idx) const;
+		/// by WV. The refined results of each velocity are shown
+		/// among the grid results, sorted by twa
+		Result get(size_t idx) const;
+
+		/// Get the results of the wind velocity iWv, on the wind grid and
+		/// refining it, sorted by twa
+		std::vector<Result> getResultsForVelocity(size_t iWv) const;
+
+		/// Is the grid result for a given wind velocity/angle discarded?
+		bool discard(size_t iWv, size_t iWa) const;
+
+		/// Return a value of the idx-th result for filling the result table,
+		/// see Result::getTableEntry and VppTableModel
+		double getTableEntry(size_t idx, int col) const;
+
+		/// View on the column col of the grid results of the velocity iWv, one
+		/// entry per wind angle. col is one of twv, twa, u, phi, crew, flat,
+		/// residual_f, residual_m. The view is valid until the next insert
+		ColumnView getVelocityView(TableResultType col, size_t iWv) const;
+
+		/// View on the column col of the grid results of the angle iWa, one
+		/// entry per wind velocity. See getVelocityView
+		ColumnView getAngleView(TableResultType col, size_t iWa) const;
 
-		/// How many results have been stored?
+		/// How many results have been stored? Grid and refined results
 		const size_t size() const;
 
-		/// Count the number of results that must not be plotted for
-		/// a given wind angle. Note that the method is brute force,
-		/// but it has the advantage of assuring the sync
+		/// How many results refine the wind grid for the velocity iWv?
+		const size_t getNumRefinedResults(size_t iWv) const;
+
+		/// Count the number of grid results that must not be plotted
+		/// for a given wind angle
 		const size_t getNumDiscardedResultsForAngle(size_t iWa) const;
 
-		/// Count the number of results that must not be plotted for
-		/// a given wind velocity. Note that the method is brute force,
-		/// but it has the advantage of assuring the sync
+		/// Count the number of grid results that must not be plotted
+		/// for a given wind velocity
 		const size_t getNumDiscardedResultsForVelocity(size_t iWv) const;
 
-		/// Count the number of results that must not be plotted for a
-		/// given angle. Note that the method is brute force, but it has
-		/// the advantage of assuring the sync
+		/// Count the number of grid results that must not be plotted
 		const size_t getNumDiscardedResults() const;
 
 		/// How many wind velocities?
@@ -213,8 +275,8 @@ class ResultContainer {
 		/// How many wind angles?
 		const size_t windAngleSize() const;
 
-		/// Return the total number of valid results: the results that have not
-		/// been discarded
+		/// Return the total number of valid grid results: the results that have
+		/// not been discarded
 		const size_t getNumValidResults() const;
 
 		/// Return the number of valid velocity-wise results for a given angle
@@ -223,34 +285,84 @@ class ResultContainer {
 		/// Get a ptr to the wind item
 		const WindItem* getWind() const;
 
-		/// Printout the list of Opt Results, arranged by twv-twa
+		/// Printout the list of Opt Results, arranged by twv-twa. The refined
+		/// results are printed among the grid results of their velocity
 		void print(FILE* outStream=stdout);
 
 		/// Printout the bounds of the state variables for the whole run
 		void printBounds();
 
+		/// Printout the telemetry of the solver, arranged by twv-twa
+		void printTelemetry(FILE* outStream=stdout);
+
 		/// CLear the result vector
 		void initResultMatrix();
 
+#ifndef VPP_HEADLESS
 		/// Returns all is required to plot the polar plots
 		std::vector<VppPolarCustomPlotWidget*> plotPolars();
 
 		/// Returns all is required to plot the XY result plots
 		std::vector<VppXYCustomPlotWidget*> plotXY(WindIndicesDialog&);
+#endif
 
 	private:
 
 		/// Default constructor
 		ResultContainer();
 
+		/// Row of the grid result (iWv, iWa). Throws if out of bounds
+		size_t getRow(size_t iWv, size_t iWa) const;
+
+		/// Row of the idx-th result, see get(idx)
+		size_t getRow(size_t idx) const;
+
+		/// Build a Result out of a row
+		Result getResult(size_t row) const;
+
+		/// Get the column col, see getVelocityView
+		const std::vector<double>& getColumn(TableResultType col) const;
+
+		/// Store the state vector, the residuals and the discard flag of a row
+		void setRow(size_t row, const Eigen::VectorXd& results,
+				const Eigen::VectorXd& residuals, bool discard);
+
+		/// Set the discard flag of a row, and update the counters
+		void setDiscard(size_t row, bool discard);
+
+		/// Printout a row, with the format of Result::print
+		void printRow(size_t row, FILE* outStream) const;
+
 		/// Number of true wind velocities/ angles
 		size_t nWv_, nWa_;
 
 		/// Ptr to the wind item
 		WindItem* pWind_;
 
-		/// Result matrix for each wind velocity/angle
-		vector<vector<Result> > resMat_;
+		/// Indices of wind velocity and angle of each result
+		std::vector<size_t> iTwv_, iTwa_;
+
+		/// Wind velocity and angle, state vector (u, phi, b, f) and force and
+		/// moment residuals of each result
+		std::vector<double> twv_, twa_, u_, phi_, b_, f_, dF_, dM_;
+
+		/// Discard flag of each result
+		std::vector<bool> discard_;
+
+		/// Work done by the solver to compute each result
+		std::vector<SolverTelemetry> telemetry_;
+
+		/// Rows of the results of each velocity, grid and refined, sorted by twa
+		std::vector< std::vector<size_t> > velocityRows_;
+
+		/// Index of the first result of each velocity, as per get(idx), and
+		/// total number of results as last entry
+		std::vector<size_t> velocityOffset_;
+
+		/// Number of discarded grid results, for each velocity, for each angle
+		/// and in total
+		std::vector<size_t> nDiscardedForVelocity_, nDiscardedForAngle_;
+		size_t nDiscarded_;
 
 };
 
@@ -5,32 +5,33 @@
 #include <fstream>
 #include "mathUtils.h"
 #include "VPPResultIO.h"
+#include "VPPJacobian.h"
 
 using namespace mathUtils;
 
 namespace Optim {
 
-// Init static member
-size_t NLOptSolver::maxIters_;
-int NLOptSolver::optIterations_;
-
 //// Optimizer class  //////////////////////////////////////////////
 
 // Constructor
-NLOptSolver::NLOptSolver(std::shared_ptr<VPPItemFactory> VPPItemFactory):
-								VPPSolverBase(VPPItemFactory){
-
-	// Instantiate a NLOpobject and set the COBYLA algorithm for
-	// nonlinearly-constrained local optimization
+NLOptSolver::NLOptSolver(std::shared_ptr<VPPItemFactory> VPPItemFactory,
+		nlopt::algorithm algorithm /*=nlopt::LN_COBYLA*/):
+								VPPSolverBase(VPPItemFactory),
+								maxIters_(4000),
+								optIterations_(0) {
+
+	// Instantiate a NLOpobject and set the algorithm for nonlinearly-constrained
+	// local optimization : COBYLA by default, or a gradient-based algorithm
 	// opt_.reset( new nlopt::opt(nlopt::GN_ISRES,dimension_) );
-	opt_.reset( new nlopt::opt(nlopt::LN_COBYLA,dimension_) );
+	opt_.reset( new nlopt::opt(algorithm,dimension_) );
 
 	// Set the bounds for the constraints
 	opt_->set_lower_bounds(lowerBounds_);
 	opt_->set_upper_bounds(upperBounds_);
 
-	// Set the objective function to be maximized (using set_max_objective)
-	opt_->set_max_objective(VPP_speed, NULL);
+	// Set the objective function to be maximized (using set_max_objective).
+	// Hand this solver to the objective to count the evaluations
+	opt_->set_max_objective(VPP_speed, this);
 
 	// Set the absolute tolerance on the state variables
 	//	opt_->set_xtol_abs(tol_);
@@ -41,7 +42,6 @@ NLOptSolver::NLOptSolver(std::shared_ptr<VPPItemFactory> VPPItemFactory):
 	opt_->set_ftol_rel(tol_);
 
 	// Set the max number of evaluations for a single run
-	maxIters_= 4000;
 	opt_->set_maxeval(maxIters_);
 
 }
@@ -62,14 +62,21 @@ void NLOptSolver::reset(std::shared_ptr<VPPItemFactory> VPPItemFactory) {
 // Set the objective function for tutorial g13
 double NLOptSolver::VPP_speed(unsigned n, const double* x, double *grad, void *my_func_data) {
 
-	// Increment the number of iterations for each call of the objective function
-	++optIterations_;
+	// Retrieve the solver with a c-style cast
+	NLOptSolver* pSolver = (NLOptSolver*)my_func_data;
 
-	if(grad)
-		throw VPPException(HERE,"VPP_speed can only be used for derivative-free algorithms!");
+	// Increment the number of iterations for each call of the objective function
+	++pSolver->optIterations_;
 
 	if(mathUtils::isNotValid(x[0])) throw VPPException(HERE,"x[0] is NAN!");
 
+	// The velocity is the first state variable, so that its gradient is (1, 0, 0, 0)
+	if(grad) {
+		grad[0]= 1;
+		for(size_t i=1; i<n; i++)
+			grad[i]= 0;
+	}
+
 	// Return x[0], or the velocity to be maximized
 	return x[0];
 
@@ -81,14 +88,29 @@ void NLOptSolver::VPPconstraint(unsigned m, double *result, unsigned n, const do
 	// Retrieve the loop data for this call with a c-style cast
 	Loop_data* d = (Loop_data*)loopData;
 
-	int twv= d-> twv_;
-	int twa= d-> twa_;
+	const WindCondition& wc= d->wc_;
+
+	// Gradient-based algorithms : compute the residuals and their exact derivatives
+	// wrt all the state variables in a single pass. This also leaves the items
+	// updated for x. NLOpt expects the derivatives row-wise : grad[i*n+j]= dc_i/dx_j
+	if(grad) {
+		Eigen::VectorXd xv(n);
+		for(size_t j=0; j<n; j++)
+			xv(j)= x[j];
+
+		VPPJacobian J(xv,d->pVppItems_,m,n,automaticDifferentiation);
+		J.run(wc);
 
-	// Now call update on the VPPItem container
-	pVppItemsContainer_->update(twv,twa,x);
+		for(size_t i=0; i<m; i++)
+			for(size_t j=0; j<n; j++)
+				grad[i*n+j]= J(i,j);
+	}
+	else
+		// Now call update on the VPPItem container
+		d->pVppItems_->update(wc,x);
 
 	// And compute the residuals for force and moment
-	pVppItemsContainer_->getResiduals(result[0],result[1]);
+	d->pVppItems_->getResiduals(result[0],result[1]);
 
 }
 
@@ -97,8 +119,72 @@ void NLOptSolver::run(int TWV, int TWA) {
 
 	std::cout<<"    "<<pWind_->getTWV(TWV)<<"    "<<toDeg(pWind_->getTWA(TWA))<<std::endl;
 
+	startTelemetry();
+
+	// For each wind velocity, reset the initial guess for the
+	// state variable vector to zero
+	resetInitialGuess(TWV,TWA);
+
+	// Refine the initial guess solving a sub-problem with no optimization variables
+	if(!solveInitialGuess(TWV,TWA)) {
+		discardNonConverged(TWV,TWA);
+		return;
+	}
+
+	Eigen::VectorXd residuals= optimize(pWind_->getWindCondition(TWV,TWA));
+
+	// Refine the solution from the optimizer with NR -> this is meant to fix the residuals
+	if(!solveInitialGuess(TWV,TWA)) {
+		discardNonConverged(TWV,TWA);
+		return;
+	}
+
+	// Push the result to the result container and mark this as a converged result
+	pResults_->push_back(TWV, TWA, xp_, residuals(0), residuals(1) );
+
+	// Make sure the result does not exceeds the bounds
+	for(size_t i=0; i<subPbSize_; i++)
+		if(xp_[i]<lowerBounds_[i] || xp_[i]>upperBounds_[i] ||
+				residuals.norm() > 100 ){
+			std::cout<<"WARNING: Optimizer result for tWv="<<TWV<<" and tWa="<<TWA<<" is out-of-bounds for variable "<<i<<std::endl;
+			pResults_->remove(TWV, TWA);
+		}
+
+	storeTelemetry(TWV,TWA);
+}
+
+// Solve the wind condition wc starting from x. The solution is not stored
+bool NLOptSolver::solve(const WindCondition& wc, Eigen::VectorXd& x) {
+
+	// NLOpt refuses an initial guess out of the bounds
+	xp_= x;
+	for(size_t i=0; i<dimension_; i++)
+		xp_[i]= std::min( std::max(xp_[i],lowerBounds_[i]), upperBounds_[i] );
+
+	// Equilibrate the initial guess, optimize, then refine the residuals with NR
+	if(!solveInitialGuess(wc))
+		return false;
+
+	Eigen::VectorXd residuals= optimize(wc);
+
+	if(!solveInitialGuess(wc))
+		return false;
+
+	for(size_t i=0; i<subPbSize_; i++)
+		if(xp_[i]<lowerBounds_[i] || xp_[i]>upperBounds_[i] ||
+				residuals.norm() > 100 )
+			return false;
+
+	x= xp_;
+	return true;
+}
+
+// Optimize the initial guess xp_ for the wind condition wc, and return the
+// residuals of the optimizer solution
+Eigen::VectorXd NLOptSolver::optimize(const WindCondition& wc) {
+
 	// Drive the loop info to the struct
-	Loop_data loopData={TWV,TWA};
+	Loop_data loopData={wc,pVppItemsContainer_.get()};
 
 	// Reset the iteration counter
 	optIterations_=0;
@@ -111,13 +197,6 @@ void NLOptSolver::run(int TWV, int TWA) {
 	opt_->remove_equality_constraints();
 	opt_->remove_inequality_constraints();
 
-	// For each wind velocity, reset the initial guess for the
-	// state variable vector to zero
-	resetInitialGuess(TWV,TWA);
-
-	// Refine the initial guess solving a sub-problem with no optimization variables
-	solveInitialGuess(TWV,TWA);
-
 	// Make a ptr to the non static member function VPPconstraint
 	opt_->add_equality_mconstraint(VPPconstraint, &loopData, tol);
 
@@ -126,10 +205,6 @@ void NLOptSolver::run(int TWV, int TWA) {
 
 	nlopt::result result;
 
-	// Init an arbitrarily high residuals vector
-	Eigen::VectorXd residuals(dimension_);
-	for(size_t i=0; i<dimension_; i++) residuals(i)=100;
-
 	// Declare a buffer vector xp. Declare it here so
 	// that is available to the invalid_argument exception
 	std::vector<double> xp(xp_.rows());
@@ -177,25 +252,14 @@ void NLOptSolver::run(int TWV, int TWA) {
 	}
 
 	printf("found maximum after %d evaluations\n", optIterations_);
+	pVppItemsContainer_->getTelemetry().nEvaluations_+= optIterations_;
 	printf("      at f(%g,%g,%g,%g)\n",
 			xp_(0),xp_(1),xp_(2),xp_(3) );
 
-	residuals= pVppItemsContainer_->getResiduals();
+	Eigen::VectorXd residuals= pVppItemsContainer_->getResiduals();
 	printf("      residuals: dF= %g, dM= %g\n\n",residuals(0),residuals(1) );
 
-	// Refine the solution from the optimizer with NR -> this is meant to fix the residuals
-	solveInitialGuess(TWV,TWA);
-
-	// Push the result to the result container and mark this as a converged result
-	pResults_->push_back(TWV, TWA, xp_, residuals(0), residuals(1) );
-
-	// Make sure the result does not exceeds the bounds
-	for(size_t i=0; i<subPbSize_; i++)
-		if(xp_[i]<lowerBounds_[i] || xp_[i]>upperBounds_[i] ||
-				residuals.norm() > 100 ){
-			std::cout<<"WARNING: Optimizer result for tWv="<<TWV<<" and tWa="<<TWA<<" is out-of-bounds for variable "<<i<<std::endl;
-			pResults_->remove(TWV, TWA);
-		}
+	return residuals;
 }
 
 } // End namespace Optim
@@ -8,8 +8,9 @@ using namespace std;
 
 namespace Optim {
 
-// Forward declaration
+// Forward declarations
 class NLOptSolverFactory;
+class NLOptSLSQPSolverFactory;
 
 /// Wrapper class around NLOPT non-linear optimization library
 class NLOptSolver : public VPPSolverBase {
@@ -26,34 +27,52 @@ class NLOptSolver : public VPPSolverBase {
 		/// in the abstract base class
 		virtual void run(int TWV, int TWA);
 
+		/// Optimize the wind condition wc starting from x. The solution is not
+		/// stored. Returns false if the NRSolver does not converge or if the
+		/// solution is out of bounds
+		virtual bool solve(const WindCondition& wc, Eigen::VectorXd& x);
+
 	private:
 
 		/// This class is to be instantiated using a NLOptSolverFactory.
 		/// The friendship allows the factory to call the private constructor
 		friend class NLOptSolverFactory;
+		friend class NLOptSLSQPSolverFactory;
 
 		/// Private constructor - the class can only be instantiated using
-		/// a VPPSolverFactory
-		NLOptSolver(std::shared_ptr<VPPItemFactory>);
+		/// a VPPSolverFactory. The algorithm defaults to the derivative-free
+		/// COBYLA. Gradient-based algorithms such as LD_SLSQP are handed the
+		/// exact derivatives of the objective and of the constraints
+		NLOptSolver(std::shared_ptr<VPPItemFactory>, nlopt::algorithm algorithm=nlopt::LN_COBYLA);
 
-		/// Boat velocity objective function
+		/// Boat velocity objective function. If requested, grad is filled
+		/// with the gradient of the velocity : (1, 0, 0, 0)
 		static double VPP_speed(unsigned n, const double *x, double *grad, void *my_func_data);
 
-		/// Set the constraint: dF=0 and dM=0
+		/// Set the constraint: dF=0 and dM=0. If requested, grad is filled
+		/// row-wise with the derivatives of dF and dM wrt the n state variables,
+		/// computed by automatic differentiation
 		static void VPPconstraint(unsigned m, double *result, unsigned n, const double* x, double* grad, void* f_data);
 
-		// Struct used to drive twv and twa into the update methods of the VPPItems
+		/// Optimize the initial guess xp_ for the wind condition wc. Returns
+		/// the residuals of the solution of the optimizer
+		Eigen::VectorXd optimize(const WindCondition& wc);
+
+		// Struct used to drive the wind condition and the items of this solver
+		// into the update methods of the VPPItems
 		typedef struct {
-				int twv_, twa_;
+				WindCondition wc_;
+				VPPItemFactory* pVppItems_;
 		} Loop_data;
 
 		/// Shared ptr holding the underlying optimizer
 		std::shared_ptr<nlopt::opt> opt_;
 
 		/// max iters allowed for the optimizer
-		static size_t maxIters_;
+		size_t maxIters_;
 
-		static int optIterations_;
+		/// Number of evaluations of the objective function for the current run
+		int optIterations_;
 
 };
 };// namespace optimizer
@@ -8,6 +8,44 @@
 
 using namespace mathUtils;
 
+//// NRStatus struct  //////////////////////////////////////////////
+
+// Ctor: a converged status with no iterations
+NRStatus::NRStatus():
+reason_(nrConverged),
+nIters_(0),
+nJacobians_(0),
+residualNorm_(0) {
+
+}
+
+// Returns the number of Jacobian matrices not computed with respect
+// to the Newton method, that computes one per iteration
+size_t NRStatus::getJacobiansSaved() const {
+	return nIters_>nJacobians_ ? nIters_-nJacobians_ : 0;
+}
+
+// Returns true if the solver has converged
+bool NRStatus::converged() const {
+	return reason_==nrConverged;
+}
+
+// Returns a readable description of the reason
+const char* NRStatus::reasonString() const {
+
+	switch(reason_) {
+	case nrConverged :
+		return "converged";
+	case nrMaxIterations :
+		return "max iterations reached";
+	case nrNotFinite :
+		return "non-finite residuals";
+	case nrStepTooSmall :
+		return "continuation step too small";
+	}
+	return "unknown";
+}
+
 //// NRSolver class  //////////////////////////////////////////////
 
 // Constructor
@@ -15,14 +53,17 @@ NRSolver::NRSolver(VPPItemFactory* pVPPItemFactory,
 		size_t dimension, size_t subPbSize ):
 dimension_(dimension),
 subPbSize_(subPbSize),
-tol_(1.e-6),
+tol_(1.e-5),
+it_(0),
 maxIters_(100),
-it_(0){
+mode_(nrNewton),
+jacMode_(finiteDifferences) {
 
 	// Resize the state vectors. Note that xp_ == xFull if the optimizer is
 	// not used. If NR is the sub-problem solver for the otpimizer, xp_ is a
 	// local subset of the full solution xFull, featuring optimization vars
 	xp_.resize(dimension_);
+	xEps_.resize(dimension_);
 
 	// Init the STATIC member vppItemsContainer
 	pVppItemsContainer_= pVPPItemFactory;
@@ -75,8 +116,12 @@ void NRSolver::reset(VPPItemFactory* pVPPItemFactory) {
 	// Init the ResultContainer that will be filled while running the results
 	pResults_.reset(new ResultContainer(pWind_));
 
-	// Reset the iteration counter
+	// Reset the iteration counter and the status
 	it_=0;
+	status_= NRStatus();
+
+	// The Jacobian of the previous items cannot be reused
+	B_.resize(0,0);
 }
 
 // This is similar to a reset, but it is used to change the subPbSize only.
@@ -85,6 +130,7 @@ void NRSolver::reset(VPPItemFactory* pVPPItemFactory) {
 // but 2 for the other derivatives
 void NRSolver::setSubPbSize(size_t subPbSize) {
 	subPbSize_= subPbSize;
+	B_.resize(0,0);
 }
 
 // The caller is the Optimizer, that resolves a larger problem with
@@ -92,10 +138,8 @@ void NRSolver::setSubPbSize(size_t subPbSize) {
 // and we try to solve a std sub-problem with no optimization vars
 Eigen::VectorXd NRSolver::run(int twv, int twa, Eigen::VectorXd& xp ) {
 
-	// Copy the optimizer solution into the local solution and to a local buffer, to be used
-	// if the solver cannot converge
+	// Copy the optimizer solution into the local solution
 	xp_= xp;
-	xpBuf_=xp;
 
 	// now run std
 	run(twv, twa);
@@ -107,100 +151,270 @@ Eigen::VectorXd NRSolver::run(int twv, int twa, Eigen::VectorXd& xp ) {
 
 }
 
+// Same as run(twv,twa,xp), for the wind condition wc that does not need to
+// lie on the wind grid. The solution is not saved to the result container
+Eigen::VectorXd NRSolver::run(const WindCondition& wc, Eigen::VectorXd& xp ) {
+
+	xp_= xp;
+	run(wc);
+
+	return xp_;
+}
+
 void NRSolver::run(int twv, int twa) {
+	run(pWind_->getWindCondition(twv,twa));
+}
+
+void NRSolver::run(const WindCondition& wc) {
+
+	if( !iterate(wc).converged() ) {
+		char msg[256];
+		sprintf(msg,"VPP Solver could not converge: %s after %zu iterations, residual norm %g",
+				status_.reasonString(), status_.nIters_, status_.residualNorm_);
+		throw NonConvergedException(HERE,msg);
+	}
+}
 
-	std::cout.precision(15);
+// Same as run, but the non-convergence is returned with the status
+// rather than thrown
+const NRStatus& NRSolver::solve(int twv, int twa, Eigen::VectorXd& xp ) {
+
+	xp_= xp;
 
-	// std::cout<<"    "<<pWind_->getTWV(twv)<<"    "<<toDeg( pWind_->getTWA(twa) )<<std::endl;
+	if( iterate(pWind_->getWindCondition(twv,twa)).converged() ) {
+		printAndSave(twv, twa);
+		xp= xp_;
+	}
+
+	return status_;
+}
+
+// Same as solve, for a wind condition that does not need to lie on the
+// wind grid. The solution is not saved to the result container
+const NRStatus& NRSolver::solve(const WindCondition& wc, Eigen::VectorXd& xp ) {
+
+	xp_= xp;
+
+	if( iterate(wc).converged() )
+		xp= xp_;
+
+	return status_;
+}
+
+// Newton loop on xp_. If the loop does not converge xp_ is restored to
+// the initial guess. Never blocks and never throws on non-convergence
+const NRStatus& NRSolver::iterate(const WindCondition& wc) {
+
+	// std::cout<<"    "<<wc.twv_<<"    "<<toDeg( wc.twa_ )<<std::endl;
 	// std::cout<<"\n Entering NR with first guess: "<<xp_.transpose()<<std::endl;
 
+	// Buffer the initial guess, to be restored if the solver cannot converge
+	xpBuf_= xp_;
+	status_= NRStatus();
+
 	try{
-		// Launch the optimization; negative retVal implies failure
 
-		std::vector<double> velocityResiduals;
-		std::vector<double> PhiResiduals;
+		// The sub-problems of the full state vector are solved with
+		// the fixed-size instantiations of the Newton loop
+		if(mode_==nrBroyden)
+			broydenLoop(wc);
+		else if(xp_.size()==4 && subPbSize_==2)
+			fixedNewtonLoop<2>(wc);
+		else if(xp_.size()==4 && subPbSize_==1)
+			fixedNewtonLoop<1>(wc);
+		else
+			newtonLoop(wc);
+
+	}
+	catch (std::exception& e) {
+		throw VPPException(HERE,e.what());
+	}
+	catch (...) {
+		throw VPPException(HERE,"Unknown exception catched!\n");
+	}
+
+	if( !status_.converged() ) {
+
+// TODO dtrimarchi : shall we provide a way to automatically pop-up a plot
+// of the residuals and some Jacobian diagnostics on divergence..?
+
+		std::cout<<"WARNING: NR-Solver could not converge: "<<status_.reasonString()
+				<<" after "<<status_.nIters_<<" iterations, residual norm "<<status_.residualNorm_<<std::endl;
+
+		// Restore the buffer, and do not reuse the Jacobian of a failed run
+		xp_=xpBuf_;
+		B_.resize(0,0);
+	}
+
+	return status_;
+}
+
+// Newton loop, the Jacobian is computed at each iteration
+void NRSolver::newtonLoop(const WindCondition& wc) {
+
+	// instantiate a Jacobian
+	VPPJacobian J(xp_,pVppItemsContainer_,subPbSize_,jacMode_);
+
+	// Newton loop
+	for( it_=0; ; it_++ ) {
 
-		// instantiate a Jacobian
-		VPPJacobian J(xp_,pVppItemsContainer_,subPbSize_);
+		// Compute the residuals vector - here only the part relative to the subproblem
+		Eigen::VectorXd residuals= pVppItemsContainer_->getResiduals(wc,xp_);
+		//std::cout<<"NR it: "<<it_<<", residuals= "<<residuals.transpose()<<"   \n";
 
-		// Newton loop
-		for( it_=0; it_<=maxIters_; it_++ ) {
+		if( stop(residuals.block(0,0,subPbSize_,1).norm()) )
+			return;
 
-			// throw if the solution was not found within the max number of iterations
-			if(it_==maxIters_){
+		// Count the Newton steps actually taken
+		pVppItemsContainer_->getTelemetry().nIterations_++;
 
-// TODO dtrimarchi : shall we provide a way to automatically pop-up this plot on
-// divergence..?
-//				// Plot the velocity residuals and throw
-//				VPPPlotter vResPlot;
-//				vResPlot.plot(velocityResiduals,"V_residuals");
+		// Compute the Jacobian matrix
+		J.run(wc);
+		status_.nJacobians_++;
+		//std::cout<<"  in NRSolver: J= \n"<<J<<std::endl;
+
+		// A * x = residuals --  J * deltas = residuals
+		// where deltas are also equal to f(x_i) / f'(x_i)
+		VectorXd deltas;
+		{
+			TelemetryTimer timer(pVppItemsContainer_->getTelemetry().linearAlgebraTime_);
+			deltas = J.colPivHouseholderQr().solve(residuals.block(0,0,subPbSize_,1));
+		}
+
+		// A singular Jacobian gives a meaningless step
+		if( !deltas.allFinite() ) {
+			status_.reason_= nrNotFinite;
+			return;
+		}
+
+		// compute the new state vector
+		//  x_(i+1) = x_i - f(x_i) / f'(x_i)
+		xp_.block(0,0,subPbSize_,1) -= deltas;
+
+		//std::cout<<"  In NRSolver: xp_= "<<xp_.transpose()<<std::endl;
+
+	}
+}
+
+// Quasi-Newton loop. The Jacobian is only computed when there is no
+// approximation to start from, or when the step of the approximation
+// does not reduce the residuals. Otherwise the approximation is corrected
+// with the rank-one Broyden update
 //
-//				// Plot the angular residuals and throw
-//				VPPPlotter phiResPlot;
-//				phiResPlot.plot(PhiResiduals,"PHI_residuals");
+//   B_(i+1) = B_i + (dr - B_i dx) dx^T / (dx^T dx)
 //
-//				// Also plot some Jacobian diagnostics
-//				J.testPlot(twv,twa);
+// where dx is the step and dr the change of the residuals
+void NRSolver::broydenLoop(const WindCondition& wc) {
 
-				std::cout<<"\n\nWARNING: NR-Solver could not converge. Please press a key to continue"<<std::endl;
-				string s;
-				std::cin>>s;
+	// Max number of halvings of the step before the approximation of
+	// the Jacobian is considered stale
+	const size_t maxHalvings=4;
 
-				// Restore the buffer and throw
-				xp_=xpBuf_;
+	// instantiate a Jacobian, only computed when the approximation is refreshed
+	VPPJacobian J(xp_,pVppItemsContainer_,subPbSize_,jacMode_);
 
-				throw NonConvergedException(HERE,"VPP Solver could not converge");
+	// Compute the residuals vector - here only the part relative to the subproblem
+	Eigen::VectorXd residuals= pVppItemsContainer_->getResiduals(wc,xp_).block(0,0,subPbSize_,1);
 
-			}
+	// Trial state vector and its residuals
+	Eigen::VectorXd xTrial, trialResiduals;
 
-			// Build a state vector with the size of the outer vector
+	for( it_=0; ; it_++ ) {
 
-			// Compute the residuals vector - here only the part relative to the subproblem
-			Eigen::VectorXd residuals= pVppItemsContainer_->getResiduals(twv,twa,xp_);
-			//std::cout<<"NR it: "<<it_<<", residuals= "<<residuals.transpose()<<"   \n";
+		if( stop(residuals.norm()) )
+			return;
 
-			if(it_>1) {
-				velocityResiduals.push_back( residuals(0) );
-				PhiResiduals.push_back(residuals(1) );
-			}
-
-			//  break if converged. TODO dtrimarchi: this condition is way too simple!
-			if( residuals.block(0,0,subPbSize_,1).norm()<1e-5 && it_>0 )
-				break;
+		// Count the Newton steps actually taken
+		pVppItemsContainer_->getTelemetry().nIterations_++;
 
-			// Compute the Jacobian matrix
-			J.run(twv,twa);
-			//std::cout<<"  in NRSolver: J= \n"<<J<<std::endl;
+		// Start from the Jacobian of the last converged run, if any
+		bool fresh=false;
+		if(B_.rows()!=subPbSize_) {
+			J.run(wc);
+			B_= J;
+			fresh= true;
+			status_.nJacobians_++;
+		}
 
-			// A * x = residuals --  J * deltas = residuals
-			// where deltas are also equal to f(x_i) / f'(x_i)
-			VectorXd deltas = J.colPivHouseholderQr().solve(residuals.block(0,0,subPbSize_,1));
+		// Backtracking: halve the step until the residuals decrease. If they
+		// do not, refresh the approximation and retry. With a fresh Jacobian
+		// that does not reduce the residuals either, take the full Newton step
+		bool accepted=false;
+		while(!accepted) {
 
-			// compute the new state vector
-			//  x_(i+1) = x_i - f(x_i) / f'(x_i)
-			xp_.block(0,0,subPbSize_,1) -= deltas;
+			VectorXd deltas;
+			{
+				TelemetryTimer timer(pVppItemsContainer_->getTelemetry().linearAlgebraTime_);
+				deltas = B_.colPivHouseholderQr().solve(residuals);
+			}
 
-			//std::cout<<"  In NRSolver: xp_= "<<xp_.transpose()<<std::endl;
+			if( deltas.allFinite() ) {
+
+				double lambda=1;
+				for(size_t iHalving=0; iHalving<=maxHalvings && !accepted; iHalving++, lambda*=0.5) {
+					xTrial= xp_;
+					xTrial.block(0,0,subPbSize_,1) -= lambda * deltas;
+					trialResiduals= pVppItemsContainer_->getResiduals(wc,xTrial).block(0,0,subPbSize_,1);
+					accepted= trialResiduals.allFinite() &&
+							trialResiduals.norm() < (1 - 1.e-4 * lambda) * residuals.norm();
+				}
+
+				if(!accepted && fresh) {
+					xTrial= xp_;
+					xTrial.block(0,0,subPbSize_,1) -= deltas;
+					trialResiduals= pVppItemsContainer_->getResiduals(wc,xTrial).block(0,0,subPbSize_,1);
+					accepted= true;
+				}
+			}
+			else if(fresh) {
+				// A singular Jacobian gives a meaningless step
+				status_.reason_= nrNotFinite;
+				return;
+			}
 
+			// The approximation is stale : refresh it
+			if(!accepted) {
+				J.run(wc);
+				B_= J;
+				fresh= true;
+				status_.nJacobians_++;
+			}
 		}
 
-//		string s;
-//		std::cout<<"Please press a key to continue"<<std::endl;
-//		while(cin >> s){
-//			break;
-//		}
+		// Broyden update with the step actually taken
+		Eigen::VectorXd dx= xTrial.block(0,0,subPbSize_,1) - xp_.block(0,0,subPbSize_,1);
+		double dx2= dx.squaredNorm();
+		if(dx2>0)
+			B_+= (trialResiduals - residuals - B_*dx) * dx.transpose() / dx2;
 
+		xp_= xTrial;
+		residuals= trialResiduals;
 	}
-	catch(NonConvergedException& e ){
-		std::cout<<"Catching NonConvergedexception in NRSolver..."<<std::endl;
-		throw NonConvergedException( HERE,e.what() );
-	}
-	catch (std::exception& e) {
-		throw VPPException(HERE,e.what());
+}
+
+// Fill the status with the norm of the residuals of the current iteration
+// and returns true if the Newton loop must stop
+bool NRSolver::stop(double residualNorm) {
+
+	status_.nIters_= it_;
+	status_.residualNorm_= residualNorm;
+
+	if( isNotValid(status_.residualNorm_) ) {
+		status_.reason_= nrNotFinite;
+		return true;
 	}
-	catch (...) {
-		throw VPPException(HERE,"Unknown exception catched!\n");
+
+	//  break if converged. TODO dtrimarchi: this condition is way too simple!
+	if( status_.residualNorm_<tol_ && it_>0 )
+		return true;
+
+	// Stop if the solution was not found within the max number of iterations
+	if( it_==maxIters_ ) {
+		status_.reason_= nrMaxIterations;
+		return true;
 	}
+
+	return false;
 }
 
 // Print the result to screen and save it to the result container
@@ -234,11 +448,75 @@ void NRSolver::printAndSave(int twv, int twa) {
 
 }
 
+// Returns the status of the last run
+const NRStatus& NRSolver::getStatus() const {
+	return status_;
+}
+
 // Returns the current number of iterations for the last run
 size_t NRSolver::getNumIters(){
 	return it_;
 }
 
+// Set the max number of Newton iterations
+void NRSolver::setMaxIters(size_t maxIters) {
+	maxIters_= maxIters;
+}
+
+// Get the max number of Newton iterations
+size_t NRSolver::getMaxIters() const {
+	return maxIters_;
+}
+
+// Set the tolerance on the norm of the residuals of the sub-problem
+void NRSolver::setTolerance(double tol) {
+	if(tol<=0) {
+		char msg[256];
+		sprintf(msg,"The tolerance of the NRSolver must be positive, got: %g",tol);
+		throw VPPException(HERE,msg);
+	}
+	tol_= tol;
+}
+
+// Get the tolerance on the norm of the residuals of the sub-problem
+double NRSolver::getTolerance() const {
+	return tol_;
+}
+
+// Forget the Jacobian of the previous runs
+void NRSolver::resetJacobian() {
+	B_.resize(0,0);
+}
+
+// Set the method used to update the Jacobian
+void NRSolver::setMode(nrMode mode) {
+	mode_= mode;
+	B_.resize(0,0);
+}
+
+// Get the method used to update the Jacobian
+nrMode NRSolver::getMode() const {
+	return mode_;
+}
+
+// Set the method used to compute the derivatives of the Jacobian
+void NRSolver::setJacobianMode(jacobianMode mode) {
+	jacMode_= mode;
+}
+
+// Get the method used to compute the derivatives of the Jacobian
+jacobianMode NRSolver::getJacobianMode() const {
+	return jacMode_;
+}
+
+// Copy the modes, the tolerance and the max number of iterations of another solver
+void NRSolver::copySettings(const NRSolver& other) {
+	setMode(other.mode_);
+	setJacobianMode(other.jacMode_);
+	setTolerance(other.tol_);
+	setMaxIters(other.maxIters_);
+}
+
 
 // Make a printout of the results for this run
 void NRSolver::printResults() {
@@ -8,11 +8,56 @@
 
 #include "IOUtils.h"
 #include "VPPItemFactory.h"
+#include "VPPJacobian.h"
 #include "Results.h"
 
 using namespace std;
 using namespace Results;
 
+/// Reason the Newton loop of the NRSolver has exited
+enum nrExitReason {
+	nrConverged,			//< The norm of the residuals is below the tolerance
+	nrMaxIterations,	//< The max number of iterations was reached
+	nrNotFinite,			//< The residuals or the Newton step are NaN or infinite
+	nrStepTooSmall		//< The continuation step was halved below its min size
+};
+
+/// Method used by the NRSolver to get the Jacobian at each iteration
+enum nrMode {
+	nrNewton,		//< Compute the Jacobian at each iteration
+	nrBroyden		//< Rank-one updates of the Jacobian of the last converged run
+};
+
+/// Outcome of a run of the NRSolver. Non-convergence is an expected outcome
+/// for the hard wind points, so it is returned rather than thrown
+struct NRStatus {
+
+	/// Ctor: a converged status with no iterations
+	NRStatus();
+
+	/// Returns true if the solver has converged
+	bool converged() const;
+
+	/// Returns a readable description of the reason, i.e. "converged"
+	const char* reasonString() const;
+
+	/// Returns the number of Jacobian matrices not computed with respect
+	/// to the Newton method, that computes one per iteration
+	size_t getJacobiansSaved() const;
+
+	/// Reason the Newton loop has exited
+	nrExitReason reason_;
+
+	/// Number of Newton iterations
+	size_t nIters_;
+
+	/// Number of Jacobian matrices computed
+	size_t nJacobians_;
+
+	/// Norm of the residuals of the sub-problem at the last iteration
+	double residualNorm_;
+};
+
 /// Newton-Raphson solver class.
 /// TODO dtrimarchi: this class is to be inserted in
 /// a class hierarchy with its brother class Optimizer
@@ -35,15 +80,72 @@ class NRSolver {
 		/// but 2 for the other derivatives
 		void setSubPbSize(size_t subPbSize);
 
-		/// Run the solver
+		/// Run the solver. Throws a NonConvergedException if the solver
+		/// does not converge
 		void run(int TWV, int TWA);
 
-		/// Run the solver with an external initial guess
+		/// Run the solver for the wind condition wc. Throws a
+		/// NonConvergedException if the solver does not converge
+		void run(const WindCondition& wc);
+
+		/// Run the solver with an external initial guess. Throws a
+		/// NonConvergedException if the solver does not converge
 		Eigen::VectorXd run(int twv, int twa, Eigen::VectorXd& xp );
 
+		/// Same as run(twv,twa,xp), for the wind condition wc that does not
+		/// need to lie on the wind grid. The solution is not saved
+		Eigen::VectorXd run(const WindCondition& wc, Eigen::VectorXd& xp );
+
+		/// Run the solver with an external initial guess, that is replaced by
+		/// the solution. Never throws on non-convergence: the initial guess
+		/// is left untouched, no result is saved and the returned status
+		/// tells why the solver has stopped
+		const NRStatus& solve(int twv, int twa, Eigen::VectorXd& xp );
+
+		/// Same as solve(twv,twa,xp), for the wind condition wc that does not
+		/// need to lie on the wind grid. The solution is not saved
+		const NRStatus& solve(const WindCondition& wc, Eigen::VectorXd& xp );
+
+		/// Returns the status of the last run
+		const NRStatus& getStatus() const;
+
 		/// Returns the current number of iterations for the last run
 		size_t getNumIters();
 
+		/// Set the max number of Newton iterations
+		void setMaxIters(size_t maxIters);
+
+		/// Get the max number of Newton iterations
+		size_t getMaxIters() const;
+
+		/// Set the tolerance on the norm of the residuals of the sub-problem
+		void setTolerance(double tol);
+
+		/// Get the tolerance on the norm of the residuals of the sub-problem
+		double getTolerance() const;
+
+		/// Set the method used to update the Jacobian. With nrBroyden, the
+		/// Jacobian of a converged run is reused as the starting approximation
+		/// of the next run, typically the neighbouring wind point
+		void setMode(nrMode);
+
+		/// Get the method used to update the Jacobian
+		nrMode getMode() const;
+
+		/// Forget the Jacobian of the previous runs, so that the next Broyden
+		/// run starts from a computed Jacobian
+		void resetJacobian();
+
+		/// Set the method used to compute the derivatives of the Jacobian :
+		/// finite differences (default) or automatic differentiation
+		void setJacobianMode(jacobianMode);
+
+		/// Get the method used to compute the derivatives of the Jacobian
+		jacobianMode getJacobianMode() const;
+
+		/// Copy the modes, the tolerance and the max number of iterations of another solver
+		void copySettings(const NRSolver&);
+
 		/// Make a printout of the results for this run
 		void printResults();
 
@@ -53,6 +155,13 @@ class NRSolver {
 		/// Print the result to screen and save it to the result container
 		void printAndSave(int twv, int twa);
 
+		/// Solve J * deltas = residuals for the N*N Jacobian of a fixed-size
+		/// sub-problem, with the closed-form inverse of J. Returns false if J
+		/// is singular or if the step is not finite
+		template <int N>
+		static bool solveFixedStep(const Eigen::Matrix<double,N,N>& J,
+				const Eigen::Matrix<double,N,1>& residuals, Eigen::Matrix<double,N,1>& deltas);
+
 		/// Declare the macro to allow for fixed size vector support
 		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -63,6 +172,34 @@ class NRSolver {
 				int twv_, twa_;
 		} Loop_data;
 
+		/// Newton loop on xp_. Fills the status and returns it, never throws
+		/// on non-convergence
+		const NRStatus& iterate(const WindCondition& wc);
+
+		/// Newton loop, the Jacobian is computed at each iteration
+		void newtonLoop(const WindCondition& wc);
+
+		/// Newton loop on a sub-problem of fixed size N, for a state vector of
+		/// size 4. No heap allocation and no QR decomposition in the loop
+		template <int N>
+		void fixedNewtonLoop(const WindCondition& wc);
+
+		/// Compute the first N residuals for the state vector x
+		template <int N>
+		Eigen::Matrix<double,N,1> fixedResiduals(const WindCondition& wc, Eigen::VectorXd& x);
+
+		/// Compute the N*N Jacobian around xp_, by centered finite differences
+		/// or by automatic differentiation as per the Jacobian mode
+		template <int N>
+		void fixedJacobian(const WindCondition& wc, Eigen::Matrix<double,N,N>& J);
+
+		/// Quasi-Newton loop, with Broyden updates of the Jacobian and backtracking
+		void broydenLoop(const WindCondition& wc);
+
+		/// Fill the status with the norm of the residuals of the current iteration
+		/// and returns true if the Newton loop must stop
+		bool stop(double residualNorm);
+
 		/// Size of the problem this NRSolver is handling
 		size_t dimension_; // --> v, phi, reef, flat
 
@@ -82,13 +219,21 @@ class NRSolver {
 		/// Vector with the initial guess/NRSolver subset results
 		Eigen::VectorXd xp_, xpBuf_;
 
+		/// Perturbed state vector of the fixed-size finite differences,
+		/// allocated once
+		Eigen::VectorXd xEps_;
+
+		/// Derivatives of the residuals of the fixed-size automatic
+		/// differentiation, allocated once
+		Eigen::MatrixXd dResiduals_;
+
 		/// Matrix of results, one result per wind velocity/angle
 		std::shared_ptr<ResultContainer> pResults_;
 
 		/// Ptr to the wind item, used to retrieve the current twv, twa
 		WindItem* pWind_;
 
-		/// tolerance
+		/// Tolerance on the norm of the residuals of the sub-problem
 		double tol_;
 
 		/// Current number of iterations -- number of iters the last
@@ -97,6 +242,21 @@ class NRSolver {
 
 		/// max iterations allowed for the Newton loop
 		size_t maxIters_;
+
+		/// Status of the last run
+		NRStatus status_;
+
+		/// Method used to update the Jacobian
+		nrMode mode_;
+
+		/// Method used to compute the derivatives of the Jacobian
+		jacobianMode jacMode_;
+
+		/// Approximation of the Jacobian of the Broyden mode. Empty if there is
+		/// no converged Jacobian to start from
+		Eigen::MatrixXd B_;
 };
 
+#include "NRSolver_tpl.h"
+
 #endif
@@ -0,0 +1,104 @@
+#include <limits>
+#include <Eigen/LU>
+
+// Newton loop on the first N variables of a state vector of size 4. The
+// Jacobian is computed as per VPPJacobian, and the N*N linear system is
+// solved in closed form. All the vectors and matrices have a fixed size,
+// so nothing is allocated in the loop
+template <int N>
+void NRSolver::fixedNewtonLoop(const WindCondition& wc) {
+
+	Eigen::Matrix<double,N,1> residuals, deltas;
+	Eigen::Matrix<double,N,N> J;
+
+	// Newton loop
+	for( it_=0; ; it_++ ) {
+
+		// Compute the residuals vector - here only the part relative to the subproblem
+		residuals= fixedResiduals<N>(wc,xp_);
+
+		if( stop(residuals.norm()) )
+			return;
+
+		// Count the Newton steps actually taken
+		pVppItemsContainer_->getTelemetry().nIterations_++;
+
+		// Compute the Jacobian matrix
+		fixedJacobian<N>(wc,J);
+		status_.nJacobians_++;
+
+		// J * deltas = residuals. A singular Jacobian gives no step : stop the loop
+		bool solved;
+		{
+			TelemetryTimer timer(pVppItemsContainer_->getTelemetry().linearAlgebraTime_);
+			solved= solveFixedStep<N>(J,residuals,deltas);
+		}
+		if( !solved ) {
+			status_.reason_= nrNotFinite;
+			return;
+		}
+
+		// compute the new state vector
+		//  x_(i+1) = x_i - f(x_i) / f'(x_i)
+		xp_.template head<N>() -= deltas;
+	}
+}
+
+// Solve J * deltas = residuals with the closed-form inverse of J. Returns
+// false if J is singular, or if the step overflows
+template <int N>
+bool NRSolver::solveFixedStep(const Eigen::Matrix<double,N,N>& J,
+		const Eigen::Matrix<double,N,1>& residuals, Eigen::Matrix<double,N,1>& deltas) {
+
+	Eigen::Matrix<double,N,N> invJ;
+	double det;
+	bool invertible;
+	J.computeInverseAndDetWithCheck(invJ,det,invertible,0.);
+	if(!invertible)
+		return false;
+
+	deltas= invJ * residuals;
+	return deltas.allFinite();
+}
+
+// Compute the first N residuals for the state vector x
+template <int N>
+Eigen::Matrix<double,N,1> NRSolver::fixedResiduals(const WindCondition& wc, Eigen::VectorXd& x) {
+
+	Eigen::Vector2d residuals;
+	pVppItemsContainer_->getResiduals(wc,x,residuals(0),residuals(1));
+	return residuals.template head<N>();
+}
+
+// Compute the N*N Jacobian around xp_. Unlike VPPJacobian, the items are not
+// updated back to xp_ by the finite differences : the loop computes the
+// residuals of the next state vector anyway
+template <int N>
+void NRSolver::fixedJacobian(const WindCondition& wc, Eigen::Matrix<double,N,N>& J) {
+
+	pVppItemsContainer_->getTelemetry().nJacobians_++;
+
+	// Exact derivatives of the first N residuals wrt the first N variables
+	if(jacMode_==automaticDifferentiation) {
+		pVppItemsContainer_->getResiduals(wc,xp_,dResiduals_);
+		J= dResiduals_.template topLeftCorner<N,N>();
+		return;
+	}
+
+	for(int iVar=0; iVar<N; iVar++) {
+
+		// Compute the optimum eps for this variable
+		double eps=std::sqrt( std::numeric_limits<double>::epsilon() );
+		if(xp_(iVar)) eps *= std::fabs(xp_(iVar));
+
+		// Residuals for x + eps and x - eps
+		xEps_= xp_;
+		xEps_(iVar)= xp_(iVar) + eps;
+		J.col(iVar)= fixedResiduals<N>(wc,xEps_);
+
+		xEps_(iVar)= xp_(iVar) - eps;
+		J.col(iVar)-= fixedResiduals<N>(wc,xEps_);
+
+		J.col(iVar)/= ( 2 * eps );
+	}
+}
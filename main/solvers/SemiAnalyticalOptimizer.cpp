@@ -5,21 +5,25 @@
 #include <fstream>
 #include "mathUtils.h"
 #include "VPPResultIO.h"
+#include <thread>
+#include <limits>
 
 using namespace mathUtils;
 
 namespace Optim {
 
-// Init static member
-size_t SemiAnalyticalOptimizer::maxIters_;
-int SemiAnalyticalOptimizer::optIterations_=0;
-
 //// SemiAnalyticalOptimizer class  //////////////////////////////////////////////
 
 // Constructor
 SemiAnalyticalOptimizer::SemiAnalyticalOptimizer(std::shared_ptr<VPPItemFactory> VPPItemFactory):
 		VPPSolverBase(VPPItemFactory),
-		saPbSize_(dimension_-subPbSize_) {
+		saPbSize_(dimension_-subPbSize_),
+		maxIters_(4000),
+		optIterations_(0),
+		sampling_(saoaFullGrid),
+		nThreads_(1),
+		maxRefinements_(4),
+		sampleTol_(1.e-2) {
 
 	// Compute the size of the Semi-Analytical-Optimization-Approach problem size. This is
 	// the size of the problem that will be handed to the optimizer. See explanation below
@@ -50,7 +54,6 @@ SemiAnalyticalOptimizer::SemiAnalyticalOptimizer(std::shared_ptr<VPPItemFactory>
 	opt_->set_ftol_rel(tol_);
 
 	// Set the max number of evaluations for a single run
-	maxIters_= 4000;
 	opt_->set_maxeval(maxIters_);
 
 }
@@ -73,11 +76,43 @@ void SemiAnalyticalOptimizer::reset(std::shared_ptr<VPPItemFactory> VPPItemFacto
 	opt_->set_lower_bounds(lowerSAbounds);
 	opt_->set_upper_bounds(upperSAbounds);
 
+	// The items of the threads are clones of the old items
+	pThreadItems_.clear();
+	threadSolvers_.clear();
+}
+
+// Set the sampling of the optimization space
+void SemiAnalyticalOptimizer::setSampling(saoaSampling sampling) {
+	sampling_= sampling;
+}
+
+// Returns the sampling of the optimization space
+saoaSampling SemiAnalyticalOptimizer::getSampling() const {
+	return sampling_;
+}
+
+// Set the number of threads the samples are solved on
+void SemiAnalyticalOptimizer::setNumThreads(size_t nThreads) {
+	if(!nThreads)
+		throw VPPException(HERE,"The SAOA requires at least one thread");
+	nThreads_= nThreads;
+}
+
+// Returns the number of threads the samples are solved on
+size_t SemiAnalyticalOptimizer::getNumThreads() const {
+	return nThreads_;
+}
+
+// Returns the number of samples solved with the NRSolver in the last run
+size_t SemiAnalyticalOptimizer::getNumSamples() const {
+	return u_.size();
 }
 
 // Struct holding the coefficients of the regression polynomial
+// and the evaluation counter of the optimizer that uses them
 typedef struct {
 		Eigen::VectorXd coeffs;
+		int* pOptIterations;
 } regression_coeffs;
 
 // Set the function to be optimized and its gradient
@@ -87,7 +122,7 @@ double SemiAnalyticalOptimizer::VPP_speed(unsigned n, const double* x, double *g
 	regression_coeffs* c = (regression_coeffs *) my_func_data;
     
 	// Increment the number of iterations for each call of the objective function
-	++optIterations_;
+	++(*c->pOptIterations);
 
 	// Fill the coordinate vector: x^2, xy, y^2, x, y, 1;
 	// --> 	Note that in this case x <- x[2] ; y <- x[3]
@@ -118,6 +153,8 @@ void SemiAnalyticalOptimizer::run(int TWV, int TWA) {
 
 	std::cout<<"    "<<pWind_->getTWV(TWV)<<"    "<<toDeg(pWind_->getTWA(TWA))<<std::endl;
 
+	startTelemetry();
+
 	// For each wind velocity, reset the initial guess for the
 	// state variable vector to zero. This is x0
 	resetInitialGuess(TWV,TWA);
@@ -125,145 +162,444 @@ void SemiAnalyticalOptimizer::run(int TWV, int TWA) {
 	// Refine the initial guess solving a sub-problem with no
 	// optimization variables. This is x1
 	std::cout<<"SAOA, solveInitialGuess: "<<std::endl;
-	solveInitialGuess(TWV,TWA);
+	if(!solveInitialGuess(TWV,TWA)) {
+		discardNonConverged(TWV,TWA);
+		return;
+	}
 	std::cout<<"-------------------------"<<std::endl;
 
+	if(!optimize(pWind_->getWindCondition(TWV,TWA))) {
+		discardNonConverged(TWV,TWA);
+		return;
+	}
+
+	// Get and print the final residuals
+	Eigen::VectorXd residuals= pVppItemsContainer_->getResiduals();
+	printf("      residuals: dF= %g, dM= %g\n\n",residuals(0),residuals(1) );
+
+	// Push the result to the result container
+	pResults_->push_back(TWV, TWA, xp_, residuals(0), residuals(1) );
+
+	storeTelemetry(TWV,TWA);
+}
+
+// Optimize the wind condition wc starting from x. The solution is not stored
+bool SemiAnalyticalOptimizer::solve(const WindCondition& wc, Eigen::VectorXd& x) {
+
+	// The samples are only taken within the bounds
+	xp_= x;
+	for(size_t i=0; i<dimension_; i++)
+		xp_[i]= std::min( std::max(xp_[i],lowerBounds_[i]), upperBounds_[i] );
+
+	if(!solveInitialGuess(wc) || !optimize(wc))
+		return false;
+
+	x= xp_;
+	return true;
+}
+
+// Sample the optimization space around the equilibrated initial guess xp_,
+// find the optimum of the regression and equilibrate it
+bool SemiAnalyticalOptimizer::optimize(const WindCondition& wc) {
+
 	// Buffer initial guess before entering the regression loop
 	Eigen::VectorXd xpBuf= xp_;
 
-	// Declare a buffer vector xp for the optimizer. Declare it here so
-	// that is available to the invalid_argument exception
-	std::vector<double> xp(saPbSize_);
+	// Clear the samples of the previous run
+	crew_.clear();
+	flat_.clear();
+	u_.clear();
+	phi_.clear();
+	valid_.clear();
+
+	// Reset the number of iterations
+	optIterations_ = 0;
+
+	// Beginning of the outer try-catch block used to stop the algorithm for this step
+	// when the optimizer fails. The NR solver returns its failures instead
+	try{
+
+		// Sample the optimization space, and find the optimum of the regression
+		bool sampled= (sampling_==saoaFullGrid) ?
+				sampleFullGrid(wc,xpBuf) : sampleAdaptive(wc,xpBuf);
+		if(!sampled)
+			return false;
+
+		printf("found maximum after %d evaluations and %zu samples\n", optIterations_, u_.size());
+		pVppItemsContainer_->getTelemetry().nEvaluations_+= optIterations_;
+		printf("      at f(%g,%g,%g,%g)\n",
+				xp_(0),xp_(1),xp_(2),xp_(3) );
+
+		// We have now tuned the optimization variables. Re-run NR to assure that the solution
+		// is indeed an equilibrium state. We must be very close to the solution already
+		return solveInitialGuess(wc);
+	}
+	catch(std::invalid_argument& e){
+		std::cout<<"\nThe optimizer returned an invalid argument exception."<<std::endl;
+		std::cout<<"This often happens if the specified initial guess exceeds the variable bounds."<<std::endl;
+		std::cout<<"Initial guess: ";
+		for(size_t i=0; i<saPbSize_; i++) std::cout<<xp_(subPbSize_+i)<<", ";
+		std::cout<<"\n\n";
+		char msg[256];
+		sprintf(msg,"%s",e.what());
+		throw VPPException(HERE,msg);
+	}
+	catch (std::exception& e) {
+
+		// throw exceptions catched by NLOpt
+		char msg[256];
+		sprintf(msg,"%s\n",e.what());
+		throw VPPException(HERE,msg);
+	}
+	catch (...) {
+		throw VPPException(HERE,"nlopt unknown exception catched!\n");
+	}
+}
+
+// Sample the optimization space on the full 5x5 grid
+bool SemiAnalyticalOptimizer::sampleFullGrid(const WindCondition& wc, const Eigen::VectorXd& xpBuf) {
 
 	// Declare the number of evaluations in the optimization space
 	// Remember the state vector x={v phi b f}
 	size_t nCrew=5, nFlat=5;
 
-	// Declare a matrix that stores the velocity values in the opt space
-	Eigen::MatrixXd x(nCrew,nFlat), y(nCrew,nFlat), u(nCrew,nFlat);
+	// Loop on the optimization space
+	for(size_t iFlat=0; iFlat<nFlat; iFlat++)
+		for(size_t iCrew=0; iCrew<nCrew; iCrew++)
+			addSample(
+					lowerBounds_[subPbSize_] + double(iCrew) / (nCrew-1) * (upperBounds_[subPbSize_]-lowerBounds_[subPbSize_]),
+					lowerBounds_[subPbSize_+1] + double(iFlat) / (nFlat-1) * (upperBounds_[subPbSize_+1]-lowerBounds_[subPbSize_+1]) );
 
-	// Beginning of the outer try-catch block used to stop the algorithm for this step
-	// when the NR solver cannot converge
-	try{
+	if(!solveSamples(wc,0,xpBuf))
+		return false;
 
-		// Loop on the optimization space
-		for(size_t iFlat=0; iFlat<nFlat; iFlat++){
+	// Restore the value of xp_ prior to the regression loop
+	xp_= xpBuf;
 
-			// Set the value of Flat in the state vector
-			xp_(3)= lowerBounds_[saPbSize_+1] + double(iFlat) / (nFlat-1) * (upperBounds_[saPbSize_+1]-lowerBounds_[saPbSize_+1]);
+	// Instantiate a Regression based on the samples, so to express u(crew,flat),
+	// and maximize it within the bounds. The samples are arranged by crew, as
+	// the regression always summed them
+	std::vector<double> lower(lowerBounds_.begin()+subPbSize_, lowerBounds_.end());
+	std::vector<double> upper(upperBounds_.begin()+subPbSize_, upperBounds_.end());
+	maximize( fit(getOptVars(xp_),0,nCrew), lower, upper );
 
-			for(size_t iCrew=0; iCrew<nCrew; iCrew++){
+	return true;
+}
 
-				// Set the value of b in the state vector
-				xp_(2)= lowerBounds_[saPbSize_] + double(iCrew) / (nCrew-1) * (upperBounds_[saPbSize_]-lowerBounds_[saPbSize_]);
+// Sample the optimization space on a 3x3 grid, then refine around the
+// optimum of the regression
+bool SemiAnalyticalOptimizer::sampleAdaptive(const WindCondition& wc, const Eigen::VectorXd& xpBuf) {
+
+	Eigen::Vector2d lower(lowerBounds_[subPbSize_],lowerBounds_[subPbSize_+1]);
+	Eigen::Vector2d upper(upperBounds_[subPbSize_],upperBounds_[subPbSize_+1]);
+	Eigen::Vector2d range= upper-lower;
+
+	// Initial design : 3x3 grid spanning the bounds. This is the smallest
+	// grid the six coefficients of the regression are well posed on. The
+	// crew is swept back and forth so that each sample is warm-started from
+	// a neighbour
+	for(size_t iFlat=0; iFlat<3; iFlat++)
+		for(size_t iCrew=0; iCrew<3; iCrew++)
+			addSample(lower(0)+0.5*(iFlat%2 ? 2-iCrew : iCrew)*range(0), lower(1)+0.5*iFlat*range(1));
+
+	if(!solveSamples(wc,0,xpBuf))
+		return false;
+
+	xp_= xpBuf;
+	std::vector<double> lowerBox(2), upperBox(2);
+	for(size_t i=0; i<2; i++) {
+		lowerBox[i]= lower(i);
+		upperBox[i]= upper(i);
+	}
+	maximize( fit(getOptVars(xp_),0,u_.size()), lowerBox, upperBox );
 
-				// Store the coordinates of this point in the optimization space
-				x(iCrew,iFlat)= xp_(2);
-				y(iCrew,iFlat)= xp_(3);
+	// Half-width of the refinements, relative to the bounds
+	double h=0.25;
 
-				// Solve this opt configuration with the Newton solver.
-				// Store x(0) into the buffer matrix u
-				//std::cout<<"\n-->> Running nrSolver for : iCrew= "<<iCrew<<"  iFlat= "<<iFlat<<std::endl;
-				xp_= nrSolver_->run(TWV,TWA,xp_);
+	for(size_t iRefine=0; iRefine<maxRefinements_; iRefine++, h*=0.5) {
 
-				// store u
-				u(iCrew,iFlat)= xp_(0);
-			}
+		Eigen::Vector2d opt= getOptVars(xp_);
+
+		// Sample the optimum, and its neighbours along crew and flat
+		size_t first= u_.size();
+		addSample(opt(0),opt(1));
+		for(size_t i=0; i<2; i++) {
+			Eigen::Vector2d dx( Eigen::Vector2d::Zero() );
+			dx(i)= h*range(i);
+			addSample(opt(0)+dx(0),opt(1)+dx(1));
+			addSample(opt(0)-dx(0),opt(1)-dx(1));
 		}
 
-		// Restore the value of xp_ prior to the regression loop
-		xp_= xpBuf;
+		// Start the new samples from the solution of the closest sample
+		Eigen::VectorXd xpStart= getClosestSample(opt,first,xpBuf);
+
+		if(!solveSamples(wc,first,xpStart))
+			return false;
+
+		// Center the trust region on the fastest sample : this is the optimum
+		// unless the regression was misleading
+		size_t best=0;
+		for(size_t iSample=1; iSample<u_.size(); iSample++)
+			if(valid_[iSample] && (!valid_[best] || u_[iSample]>u_[best]))
+				best= iSample;
+		Eigen::Vector2d center(crew_[best],flat_[best]);
+
+		// Maximize the local regression in the trust region, starting from its center
+		xp_(subPbSize_)= center(0);
+		xp_(subPbSize_+1)= center(1);
+		for(size_t i=0; i<2; i++) {
+			lowerBox[i]= std::max(lower(i), center(i)-2*h*range(i));
+			upperBox[i]= std::min(upper(i), center(i)+2*h*range(i));
+		}
+		maximize( fit(center,h,u_.size()), lowerBox, upperBox );
 
-		// At this point I have three arrays: x <- flat ; y <- crew ; u
-		// that describes the change of velocity for each opt parameter.
-		// The heeling angle is free to change but we do not care about its value
+		// Stop when the optimum does not move
+		if( (getOptVars(xp_)-opt).cwiseQuotient(range).cwiseAbs().maxCoeff() < sampleTol_ )
+			break;
+	}
 
-		// Instantiate a Regression based on the computational points contained in u,
-		// so to express u(flat,crew)
-		Regression regr(x,y,u);
-		Eigen::VectorXd polynomial= regr.compute();
-		//std::cout<<" POLYNOMIAL: \n"<<polynomial<<std::endl;
+	// Start the final solution from the state variables of the closest sample
+	xp_.block(0,0,subPbSize_,1)=
+			getClosestSample(getOptVars(xp_),u_.size(),xpBuf).block(0,0,subPbSize_,1);
 
-		// ====== Set NLOPT ============================================
+	return true;
+}
 
-		// Reset the number of iterations
-		optIterations_ = 0;
+// Returns xpBuf with the state variables of the sample closest to (crew, flat)
+// among the first nSamples
+Eigen::VectorXd SemiAnalyticalOptimizer::getClosestSample(const Eigen::Vector2d& optVars,
+		size_t nSamples, const Eigen::VectorXd& xpBuf) const {
+
+	Eigen::Vector2d range(upperBounds_[subPbSize_]-lowerBounds_[subPbSize_],
+			upperBounds_[subPbSize_+1]-lowerBounds_[subPbSize_+1]);
+
+	Eigen::VectorXd x(xpBuf);
+	double dMin=std::numeric_limits<double>::max();
+	for(size_t iSample=0; iSample<nSamples; iSample++) {
+		double d= (Eigen::Vector2d(crew_[iSample],flat_[iSample])-optVars).cwiseQuotient(range).norm();
+		if(valid_[iSample] && d<dMin) {
+			dMin= d;
+			x(0)= u_[iSample];
+			x(1)= phi_[iSample];
+		}
+	}
+	return x;
+}
 
-		try{
+// Add a sample (crew, flat), unless it was already added or lies out of the bounds
+void SemiAnalyticalOptimizer::addSample(double crew, double flat) {
 
-			// Launch the optimization; negative retVal implies failure
-			std::cout<<"Entering the SemiAnalyticalOptimizer with: ";
-			printf("%8.6f,%8.6f,%8.6f,%8.6f \n", xp_(0),xp_(1),xp_(2),xp_(3));
+	double tol= 1.e-9 * std::max( upperBounds_[subPbSize_]-lowerBounds_[subPbSize_],
+			upperBounds_[subPbSize_+1]-lowerBounds_[subPbSize_+1] );
 
-			// convert to standard vector
-			for(size_t i=0; i<saPbSize_; i++)
-				xp[i]=xp_(subPbSize_+i);
+	if( crew < lowerBounds_[subPbSize_]-tol || crew > upperBounds_[subPbSize_]+tol ||
+			flat < lowerBounds_[subPbSize_+1]-tol || flat > upperBounds_[subPbSize_+1]+tol )
+		return;
 
-			// Place the regression polynomial into an object to be sent to nlOpt
-			// todo dtrimarchi : improve the init of the regression_coeffs struct!
-			regression_coeffs c;
-			c.coeffs= polynomial;
+	for(size_t i=0; i<crew_.size(); i++)
+		if( std::fabs(crew_[i]-crew)<tol && std::fabs(flat_[i]-flat)<tol )
+			return;
 
-			// Set the objective function to be maximized using the regression coeffs
-			opt_->set_max_objective(VPP_speed, &c);
+	crew_.push_back(crew);
+	flat_.push_back(flat);
+	u_.push_back(0);
+	phi_.push_back(0);
+	valid_.push_back(0);
+}
 
-			// Instantiate the maximum objective value, upon return
-			double maxf;
+// Solve the sub-problem of the samples from first on, and store their velocity
+bool SemiAnalyticalOptimizer::solveSamples(const WindCondition& wc, size_t first, const Eigen::VectorXd& xpBuf) {
 
-			// Launch the optimization
-			nlopt::result result = opt_->optimize(xp, maxf);
+	size_t nSamples= u_.size()-first;
+	size_t nThreads= std::min(nThreads_,nSamples);
 
-			//store the results back to the member state vector
-			for(size_t i=0; i<saPbSize_; i++)
-				xp_(subPbSize_+i)=xp[i];
-		}
-		catch( nlopt::roundoff_limited& e ){
-			std::cout<<"Roundoff limited result"<<std::endl;
-			// do nothing because the result of roundoff-limited exception
-			// is meant to be still a meaningful result
-		}
+	// Serial run : each sample is warm-started from the previous one
+	if(nThreads<2) {
+		xp_= xpBuf;
+		for(size_t iSample=first; iSample<u_.size(); iSample++)
+			if(!solveSample(wc,iSample,xpBuf))
+				return false;
+		return true;
+	}
 
-		printf("found maximum after %d evaluations\n", optIterations_);
-		printf("      at f(%g,%g,%g,%g)\n",
-				xp_(0),xp_(1),xp_(2),xp_(3) );
+	// Make sure each additional thread has its own items and NRSolver
+	while(pThreadItems_.size()<nThreads-1) {
+		std::shared_ptr<VPPItemFactory> pItems( pVppItemsContainer_->clone() );
+		std::shared_ptr<NRSolver> pSolver( new NRSolver(pItems.get(),dimension_,subPbSize_) );
+		pSolver->copySettings(*nrSolver_);
+		pThreadItems_.push_back(pItems);
+		threadSolvers_.push_back(pSolver);
+	}
 
-		// We have now tuned the optimization variables. Re-run NR to assure that the solution
-		// is indeed an equilibrium state. We must be very close to the solution already
-		solveInitialGuess(TWV, TWA);
+	// Each thread solves a contiguous chunk of the samples, warm-starting each
+	// sample from the previous one of its chunk. Thread 0 is this thread, that
+	// solves with the NRSolver of the solver. The samples that fail, or throw,
+	// are left to the serial recovery below
+	std::vector<char> converged(nSamples,0);
+	auto solveChunk= [&](NRSolver* pSolver, size_t iThread) {
+		Eigen::VectorXd x(xpBuf);
+		for(size_t i=iThread*nSamples/nThreads; i<(iThread+1)*nSamples/nThreads; i++) {
+			x(2)= crew_[first+i];
+			x(3)= flat_[first+i];
+			try {
+				if(pSolver->solve(wc,x).converged() && isValidSample(x)) {
+					u_[first+i]= x(0);
+					phi_[first+i]= x(1);
+					valid_[first+i]= 1;
+					converged[i]= 1;
+					continue;
+				}
+			} catch(...) {
+				// recovered below
+			}
+			x= xpBuf;
+		}
+	};
 
-		// Get and print the final residuals
-		Eigen::VectorXd residuals= pVppItemsContainer_->getResiduals();
-		printf("      residuals: dF= %g, dM= %g\n\n",residuals(0),residuals(1) );
+	std::vector<std::thread> threads;
+	for(size_t iThread=1; iThread<nThreads; iThread++) {
+		pThreadItems_[iThread-1]->getTelemetry().reset();
+		threads.push_back( std::thread(solveChunk, threadSolvers_[iThread-1].get(), iThread) );
+	}
+	solveChunk(nrSolver_.get(),0);
 
-		// Push the result to the result container
-		pResults_->push_back(TWV, TWA, xp_, residuals(0), residuals(1) );
+	for(size_t iThread=1; iThread<nThreads; iThread++) {
+		threads[iThread-1].join();
+		pVppItemsContainer_->getTelemetry().add( pThreadItems_[iThread-1]->getTelemetry() );
 	}
-	catch( NonConvergedException& e ){
-		std::cout<<"Catching NonConvergedException in SAOA"<<std::endl;
-		// Push to the result container a result to be discarded -> that won't be plot
-		pResults_->remove(TWV, TWA);
 
+	// Recover the samples the threads could not solve, starting from
+	// the closest sample solved so far
+	for(size_t i=0; i<nSamples; i++) {
+		if(converged[i])
+			continue;
+		xp_= getClosestSample(Eigen::Vector2d(crew_[first+i],flat_[first+i]),u_.size(),xpBuf);
+		if(!solveSample(wc,first+i,xpBuf))
+			return false;
 	}
-	catch(std::invalid_argument& e){
-		std::cout<<"\nThe optimizer returned an invalid argument exception."<<std::endl;
-		std::cout<<"This often happens if the specified initial guess exceeds the variable bounds."<<std::endl;
-		std::cout<<"Initial guess: ";
-		for(size_t i=0; i<xp.size(); i++) std::cout<<xp[i]<<", ";
-		std::cout<<"\n\n";
-		char msg[256];
-		sprintf(msg,"%s",e.what());
-		throw VPPException(HERE,msg);
+
+	return true;
+}
+
+// Solve the sub-problem of a sample with solveNR, warm-started from xp_
+bool SemiAnalyticalOptimizer::solveSample(const WindCondition& wc, size_t iSample, const Eigen::VectorXd& xpBuf) {
+
+	// Set the values of b and f in the state vector
+	xp_(2)= crew_[iSample];
+	xp_(3)= flat_[iSample];
+
+	// Solve this opt configuration with the Newton solver
+	if(!solveNR(wc,xp_))
+		return false;
+
+	// A velocity or a heel out of the bounds is a spurious root the warm
+	// start led to. Solve again from the initial guess
+	if(!isValidSample(xp_)) {
+		Eigen::VectorXd x(xpBuf);
+		x(2)= crew_[iSample];
+		x(3)= flat_[iSample];
+		if(solveNR(wc,x) && isValidSample(x))
+			xp_= x;
 	}
-	catch (std::exception& e) {
 
-		// throw exceptions catched by NLOpt
-		char msg[256];
-		sprintf(msg,"%s\n",e.what());
-		throw VPPException(HERE,msg);
+	// store u and phi
+	u_[iSample]= xp_(0);
+	phi_[iSample]= xp_(1);
+	valid_[iSample]= isValidSample(xp_);
+
+	// Do not warm-start the next sample from a spurious root
+	if(!valid_[iSample])
+		xp_.block(0,0,subPbSize_,1)= xpBuf.block(0,0,subPbSize_,1);
+
+	return true;
+}
+
+// A sample is valid if its velocity is within the bounds, and if it does
+// not heel more than the max heel to either side. The sub-problem does not
+// enforce the lower bound of the heel. The full grid retains all of its
+// samples, so that its results do not change
+bool SemiAnalyticalOptimizer::isValidSample(const Eigen::VectorXd& x) const {
+	if(sampling_==saoaFullGrid)
+		return true;
+	return x(0)>=lowerBounds_[0] && x(0)<=upperBounds_[0] &&
+			std::fabs(x(1))<=upperBounds_[1];
+}
+
+// Compute the regression of the samples, weighted around center
+Eigen::VectorXd SemiAnalyticalOptimizer::fit(const Eigen::Vector2d& center, double h, size_t nRows) {
+
+	// Arrange the samples in nRows rows, column by column
+	size_t nSamples= u_.size(), nCols= nSamples/nRows;
+	Eigen::MatrixXd x= Eigen::Map<Eigen::MatrixXd>(crew_.data(),nRows,nCols);
+	Eigen::MatrixXd y= Eigen::Map<Eigen::MatrixXd>(flat_.data(),nRows,nCols);
+	Eigen::MatrixXd u= Eigen::Map<Eigen::MatrixXd>(u_.data(),nRows,nCols);
+	Eigen::MatrixXd w( Eigen::MatrixXd::Ones(nRows,nCols) );
+
+	Eigen::Vector2d range(upperBounds_[subPbSize_]-lowerBounds_[subPbSize_],
+			upperBounds_[subPbSize_+1]-lowerBounds_[subPbSize_+1]);
+
+	for(size_t i=0; i<nSamples; i++) {
+		if(!valid_[i])
+			w(i)= 0;
+		else if(h>0) {
+			double d2= (Eigen::Vector2d(crew_[i],flat_[i])-center).cwiseQuotient(range).squaredNorm();
+			w(i)= std::exp( -d2/(4*h*h) );
+		}
 	}
-	catch (...) {
-		throw VPPException(HERE,"nlopt unknown exception catched!\n");
+
+	// Instantiate a Regression based on the samples, so to express u(crew,flat)
+	Regression regr(x,y,u,w);
+	return regr.compute();
+}
+
+// Maximize the regression polynomial within the box lower-upper
+void SemiAnalyticalOptimizer::maximize(const Eigen::VectorXd& polynomial,
+		std::vector<double> lower, std::vector<double> upper) {
+
+	// ====== Set NLOPT ============================================
+
+	opt_->set_lower_bounds(lower);
+	opt_->set_upper_bounds(upper);
+
+	// Declare a buffer vector xp for the optimizer, and start within the box
+	std::vector<double> xp(saPbSize_);
+	for(size_t i=0; i<saPbSize_; i++)
+		xp[i]= std::min( std::max(xp_(subPbSize_+i),lower[i]), upper[i] );
+
+	try{
+
+		// Launch the optimization; negative retVal implies failure
+		std::cout<<"Entering the SemiAnalyticalOptimizer with: ";
+		printf("%8.6f,%8.6f,%8.6f,%8.6f \n", xp_(0),xp_(1),xp[0],xp[1]);
+
+		// Place the regression polynomial into an object to be sent to nlOpt
+		regression_coeffs c;
+		c.coeffs= polynomial;
+		c.pOptIterations= &optIterations_;
+
+		// Set the objective function to be maximized using the regression coeffs
+		opt_->set_max_objective(VPP_speed, &c);
+
+		// Instantiate the maximum objective value, upon return
+		double maxf;
+
+		// Launch the optimization
+		nlopt::result result = opt_->optimize(xp, maxf);
 	}
+	catch( nlopt::roundoff_limited& e ){
+		std::cout<<"Roundoff limited result"<<std::endl;
+		// do nothing because the result of roundoff-limited exception
+		// is meant to be still a meaningful result
+	}
+
+	//store the results back to the member state vector
+	for(size_t i=0; i<saPbSize_; i++)
+		xp_(subPbSize_+i)=xp[i];
+}
+
+// Returns the crew and flat of the state vector x
+Eigen::Vector2d SemiAnalyticalOptimizer::getOptVars(const Eigen::VectorXd& x) const {
+	return Eigen::Vector2d(x(subPbSize_),x(subPbSize_+1));
 }
 
 } // end namespace Optim
@@ -11,6 +11,13 @@ namespace Optim {
 // forward declaration
 class SAOASolverFactory;
 
+/// Sampling of the optimization space (crew, flat) the regression
+/// of the SemiAnalyticalOptimizer is computed on
+enum saoaSampling {
+	saoaFullGrid,		//< Fixed 5x5 grid spanning the bounds
+	saoaAdaptive		//< 3x3 grid, then refined around the optimum of the regression
+};
+
 /// This class implements the SAOA (Semi-Analytical Optimization Approach)
 /// which is used to improve the performance of the underlying optimizer NLOpt.
 /// The idea is to use the NRSolver to find a series of solutions in the
@@ -32,6 +39,27 @@ class SemiAnalyticalOptimizer : public VPPSolverBase {
 		/// Execute a VPP-like analysis - implements the pure virtual method
 		virtual void run(int TWV, int TWA);
 
+		/// Optimize the wind condition wc starting from x. The solution is not
+		/// stored. Returns false if a sample or the optimum cannot be solved
+		virtual bool solve(const WindCondition& wc, Eigen::VectorXd& x);
+
+		/// Set the sampling of the optimization space. Default : saoaFullGrid
+		void setSampling(saoaSampling);
+
+		/// Returns the sampling of the optimization space
+		saoaSampling getSampling() const;
+
+		/// Set the number of threads the samples are solved on. Each additional
+		/// thread solves its share of the samples on its own clone of the items.
+		/// Default : 1
+		void setNumThreads(size_t nThreads);
+
+		/// Returns the number of threads the samples are solved on
+		size_t getNumThreads() const;
+
+		/// Returns the number of samples solved with the NRSolver in the last run
+		size_t getNumSamples() const;
+
 	private:
 
 		/// This class is to be instantiated using a NLOptSolverFactory.
@@ -50,6 +78,64 @@ class SemiAnalyticalOptimizer : public VPPSolverBase {
 				int twv_, twa_;
 		} Loop_data;
 
+		/// Sample the optimization space around the equilibrated initial guess
+		/// xp_ for the wind condition wc, and store in xp_ the optimum of the
+		/// regression, equilibrated with the NRSolver. Returns false if a sample
+		/// or the optimum cannot be solved
+		bool optimize(const WindCondition& wc);
+
+		/// Sample the optimization space on the full 5x5 grid, and store the
+		/// optimum of the regression in xp_. Returns false if a sample cannot
+		/// be solved
+		bool sampleFullGrid(const WindCondition& wc, const Eigen::VectorXd& xpBuf);
+
+		/// Sample the optimization space on a 3x3 grid, then refine around the
+		/// optimum of the regression, trust-region fashion : each refinement adds
+		/// the optimum and its neighbours along crew and flat, fits the regression
+		/// with weights decaying away from the optimum and searches the new
+		/// optimum in a box around it. The refinements stop when the optimum
+		/// does not move. Store the optimum in xp_, returns false if a sample
+		/// cannot be solved
+		bool sampleAdaptive(const WindCondition& wc, const Eigen::VectorXd& xpBuf);
+
+		/// Add a sample (crew, flat), unless it was already added or lies out
+		/// of the bounds
+		void addSample(double crew, double flat);
+
+		/// Solve the sub-problem of the samples from first on, and store their
+		/// velocity. The samples are distributed on nThreads_ threads. Returns
+		/// false if a sample cannot be solved
+		bool solveSamples(const WindCondition& wc, size_t first, const Eigen::VectorXd& xpBuf);
+
+		/// Solve the sub-problem of sample iSample with solveNR, warm-started from xp_.
+		/// If the solution is out of the velocity bounds, solve again from xpBuf.
+		/// Store the solution in xp_. Returns false if the sample cannot be solved
+		bool solveSample(const WindCondition& wc, size_t iSample, const Eigen::VectorXd& xpBuf);
+
+		/// Returns true if the velocity and the heel of the state vector x are
+		/// within the bounds, false for the spurious roots of the sub-problem.
+		/// Always true for the full grid
+		bool isValidSample(const Eigen::VectorXd& x) const;
+
+		/// Compute the regression of the samples, arranged column by column in
+		/// nRows rows. The weights decay with the distance from center, scaled
+		/// with the bounds, as exp(-d^2/(4 h^2)). The weights are all one if h
+		/// is not positive. The invalid samples are not accounted for
+		Eigen::VectorXd fit(const Eigen::Vector2d& center, double h, size_t nRows);
+
+		/// Maximize the regression polynomial within the box lower-upper, starting
+		/// from the optimization variables of xp_. The optimum is stored into xp_
+		void maximize(const Eigen::VectorXd& polynomial,
+				std::vector<double> lower, std::vector<double> upper);
+
+		/// Returns xpBuf with the velocity and the heel of the valid sample closest
+		/// to optVars=(crew, flat), among the first nSamples
+		Eigen::VectorXd getClosestSample(const Eigen::Vector2d& optVars,
+				size_t nSamples, const Eigen::VectorXd& xpBuf) const;
+
+		/// Returns the crew and flat of the state vector x
+		Eigen::Vector2d getOptVars(const Eigen::VectorXd& x) const;
+
 		/// Size of the sub-problem to be pre-solved with the NRSolver
 		size_t saPbSize_; // --> v, phi
 
@@ -57,9 +143,33 @@ class SemiAnalyticalOptimizer : public VPPSolverBase {
 		std::shared_ptr<nlopt::opt> opt_;
 
 		/// max iters allowed for the SemiAnalyticalOptimizer
-		static size_t maxIters_;
+		size_t maxIters_;
+
+		/// Number of evaluations of the objective function for the current run
+		int optIterations_;
+
+		/// Sampling of the optimization space
+		saoaSampling sampling_;
+
+		/// Number of threads the samples are solved on
+		size_t nThreads_;
+
+		/// Max number of refinements of the adaptive sampling
+		size_t maxRefinements_;
+
+		/// Tolerance on the displacement of the optimum between two refinements
+		/// of the adaptive sampling, relative to the bounds
+		double sampleTol_;
+
+		/// Crew, flat, velocity and heel of the samples of the current run
+		std::vector<double> crew_, flat_, u_, phi_;
+
+		/// Whether each sample is valid, see isValidSample
+		std::vector<char> valid_;
 
-		static int optIterations_;
+		/// Items and NRSolvers the additional threads solve the samples with
+		std::vector< std::shared_ptr<VPPItemFactory> > pThreadItems_;
+		std::vector< std::shared_ptr<NRSolver> > threadSolvers_;
 
 };
 };// namespace SemiAnalyticalOptimizer
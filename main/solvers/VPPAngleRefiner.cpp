@@ -0,0 +1,152 @@
+#include "VPPAngleRefiner.h"
+#include "VPPException.h"
+#include <algorithm>
+
+// Ctor
+VPPAngleRefiner::VPPAngleRefiner(VPPSolverFactoryBase* pSf, double tol/*=0.01*/,
+		double minInterval/*=toRad(0.5)*/, size_t maxPasses/*=6*/):
+		pSf_(pSf),
+		tol_(tol),
+		minInterval_(minInterval),
+		maxPasses_(maxPasses) {
+
+}
+
+// Dtor
+VPPAngleRefiner::~VPPAngleRefiner() {
+
+}
+
+// Refine the wind angles of all the wind velocities
+size_t VPPAngleRefiner::run() {
+
+	size_t nInserted=0;
+	for(size_t iWv=0; iWv<pSf_->get()->getResults()->windVelocitySize(); iWv++) {
+
+		size_t n= run(iWv);
+		std::cout<<"vTW="<<iWv<<"  refined with "<<n<<" wind angles"<<std::endl;
+		nInserted+= n;
+	}
+
+	return nInserted;
+}
+
+// Refine the wind angles of the wind velocity iWv
+size_t VPPAngleRefiner::run(size_t iWv) {
+
+	ResultContainer* pResults= pSf_->get()->getResults();
+	VPPItemFactory* pVppItems= pSf_->getVppItems();
+	double twv= pResults->getWind()->getTWV(iWv);
+
+	size_t nInserted=0;
+	for(size_t iPass=0; iPass<maxPasses_; iPass++) {
+
+		std::vector<Result> results= pResults->getResultsForVelocity(iWv);
+
+		// Collect the mid angles of the intervals to bisect, and the interpolation
+		// of the states at their ends. Nothing is inserted until the sweep is
+		// done, as inserting shifts the results of the velocity
+		std::vector<double> twa;
+		std::vector<Eigen::VectorXd> x;
+		for(size_t i=0; i+1<results.size(); i++) {
+
+			// Nothing to interpolate from a discarded result
+			if(results[i].discard() || results[i+1].discard())
+				continue;
+
+			// The halves of the interval would be narrower than allowed
+			if(results[i+1].getTWA() - results[i].getTWA() < 2*minInterval_)
+				continue;
+
+			if(getInterpolationError(results,i) <= tol_)
+				continue;
+
+			twa.push_back( 0.5 * ( results[i].getTWA() + results[i+1].getTWA() ) );
+			x.push_back( 0.5 * ( *results[i].getX() + *results[i+1].getX() ) );
+		}
+
+		// The tolerance is met everywhere
+		if(twa.empty())
+			break;
+
+		for(size_t i=0; i<twa.size(); i++) {
+
+			WindCondition wc(twv,twa[i]);
+
+			bool converged=false;
+			Eigen::VectorXd residuals(2);
+			try {
+				try {
+					converged= pSf_->solve(wc,x[i]);
+				} catch(NonConvergedException& e) {
+					std::cout<<"A NonConvergedException was catched..."<<std::endl;
+					std::cout<<e.what()<<std::endl;
+				}
+
+				pVppItems->getResiduals(wc,x[i],residuals(0),residuals(1));
+
+			} catch(VPPException& e) {
+				// The model cannot be evaluated at this angle, e.g. NaN forces :
+				// insert it as discarded, with zero residuals
+				std::cout<<"A VPPException was catched..."<<std::endl;
+				std::cout<<e.what()<<std::endl;
+				converged=false;
+				residuals.setZero();
+			}
+
+			// The angles that did not converge are inserted as discarded, so that
+			// the intervals they split are not bisected again
+			pResults->insert(iWv,twa[i],x[i],residuals,!converged);
+			nInserted++;
+		}
+	}
+
+	return nInserted;
+}
+
+// Estimate the error of the linear interpolation of the boat speed and of
+// the VMG between the results i and i+1 of a velocity
+double VPPAngleRefiner::getInterpolationError(const std::vector<Result>& results, size_t i) {
+
+	// Take the largest second derivatives of the triples centred on the
+	// ends of the interval
+	double d2Max=0;
+	for(size_t j=i; j<i+2; j++) {
+
+		double d2u, d2vmg;
+		if(getSecondDerivatives(results,j,d2u,d2vmg))
+			d2Max= std::max( d2Max, std::max(fabs(d2u),fabs(d2vmg)) );
+	}
+
+	double h= results[i+1].getTWA() - results[i].getTWA();
+
+	return d2Max * h * h / 8;
+}
+
+// Compute the second divided differences of the boat speed and of the VMG
+// over the results i-1, i, i+1
+bool VPPAngleRefiner::getSecondDerivatives(const std::vector<Result>& results, size_t i,
+		double& d2u, double& d2vmg) {
+
+	if(i==0 || i+1>=results.size())
+		return false;
+
+	double twa[3], u[3], vmg[3];
+	for(size_t k=0; k<3; k++) {
+
+		const Result& res= results[i-1+k];
+		if(res.discard())
+			return false;
+
+		twa[k]= res.getTWA();
+		u[k]= res.getX()->coeff(0);
+		vmg[k]= u[k] * cos(twa[k]);
+	}
+
+	double h0= twa[1]-twa[0], h1= twa[2]-twa[1];
+
+	d2u= 2 * ( (u[2]-u[1])/h1 - (u[1]-u[0])/h0 ) / (h0+h1);
+	d2vmg= 2 * ( (vmg[2]-vmg[1])/h1 - (vmg[1]-vmg[0])/h0 ) / (h0+h1);
+
+	return true;
+}
@@ -0,0 +1,78 @@
+#ifndef VPPANGLEREFINER_H
+#define VPPANGLEREFINER_H
+
+#include <vector>
+#include <Eigen/Core>
+
+#include "VPPSolverFactoryBase.h"
+#include "mathUtils.h"
+
+using namespace Optim;
+
+/// Adaptive refinement of the wind angles of a solved wind grid. For each
+/// wind velocity, the boat speed and the VMG are interpolated linearly
+/// along twa between consecutive results. The error of the interpolation
+/// over an interval of width h is estimated as
+///
+///   e = max|q''| * h^2 / 8
+///
+/// with q'' the second divided differences of the results around the
+/// interval, and the intervals where e exceeds the tolerance are bisected :
+/// the mid angle is solved with VPPSolverFactoryBase::solve, starting from
+/// the interpolation of the states at the ends of the interval, and is
+/// inserted in the result container. The sweeps are repeated until the
+/// tolerance is met or the intervals reach their minimum width. The angles
+/// get denser where the polars bend - the beat and run angles, the sail
+/// crossovers - while the coarse grid is retained elsewhere.
+/// The refinement is serial, and runs on the results of a solved grid
+class VPPAngleRefiner {
+
+	public:
+
+		/// Ctor. tol [m/s] is the error allowed on the boat speed and on the
+		/// VMG interpolated between two angles. The intervals are not bisected
+		/// below minInterval [rad], and each wind velocity is swept at most
+		/// maxPasses times
+		VPPAngleRefiner(VPPSolverFactoryBase* pSf, double tol=0.01,
+				double minInterval=mathUtils::toRad(0.5), size_t maxPasses=6);
+
+		/// Dtor
+		~VPPAngleRefiner();
+
+		/// Refine the wind angles of all the wind velocities. Returns the
+		/// number of angles inserted in the result container
+		size_t run();
+
+		/// Refine the wind angles of the wind velocity iWv. Returns the
+		/// number of angles inserted in the result container
+		size_t run(size_t iWv);
+
+		/// Estimate the error of the linear interpolation of the boat speed and
+		/// of the VMG between the results i and i+1 of a velocity, sorted by twa.
+		/// Returns 0 if the interval has no valid neighbour to estimate q'' from
+		static double getInterpolationError(const std::vector<Result>& results, size_t i);
+
+	private:
+
+		/// Disallow default ctor
+		VPPAngleRefiner();
+
+		/// Compute in d2u and d2vmg the second divided differences of the boat
+		/// speed and of the VMG over the results i-1, i, i+1. Returns false if
+		/// any of them is discarded
+		static bool getSecondDerivatives(const std::vector<Result>& results, size_t i,
+				double& d2u, double& d2vmg);
+
+		/// Ptr to the solver factory the grid has been solved with
+		VPPSolverFactoryBase* pSf_;
+
+		/// Error allowed on the interpolation [m/s] and minimum width of the
+		/// intervals [rad]
+		double tol_, minInterval_;
+
+		/// Maximum number of bisection sweeps for each velocity
+		size_t maxPasses_;
+
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "VPPContinuation.h"
+#include "VPPException.h"
+#include "mathUtils.h"
+#include <Eigen/Dense>
+#include <limits>
+
+using namespace mathUtils;
+
+// Constructor
+VPPContinuation::VPPContinuation(VPPItemFactory* pVppItemsContainer, size_t subPbSize/*=2*/,
+		const NRSolver* pNRSolver/*=0*/):
+pVppItemsContainer_(pVppItemsContainer),
+subPbSize_(subPbSize),
+pNRSolver_(pNRSolver),
+tol_(1.e-5),
+maxCorrectorIters_(8),
+minStep_(1./64),
+nSteps_(0),
+nHalvings_(0) {
+
+}
+
+// Destructor
+VPPContinuation::~VPPContinuation() {
+	// make nothing
+}
+
+// First order prediction of the solution at wc from the solution x0 at wc0
+Eigen::VectorXd VPPContinuation::predict(const WindCondition& wc0, const WindCondition& wc, const Eigen::VectorXd& x0) {
+
+	Eigen::VectorXd x(x0);
+
+	try {
+
+		setPath(wc0,wc,x);
+
+		// A full step along the tangent at the origin of the path
+		Eigen::VectorXd t= tangent(0,x);
+		if(t.allFinite())
+			x.block(0,0,subPbSize_,1)+= t;
+
+	} catch(std::exception& e) {
+		// The model cannot be evaluated here, keep x0
+		x= x0;
+	}
+
+	return x;
+}
+
+// First order prediction of the solution at the grid point (vTW,aTW) from
+// the solution x0 at the grid point (vTW0,aTW0)
+Eigen::VectorXd VPPContinuation::predict(int vTW0, int aTW0, int vTW, int aTW, const Eigen::VectorXd& x0) {
+
+	WindItem* pWind= pVppItemsContainer_->getWind();
+	return predict(pWind->getWindCondition(vTW0,aTW0),pWind->getWindCondition(vTW,aTW),x0);
+}
+
+// March from the solution of wc0 in x to the solution of wc
+const NRStatus& VPPContinuation::solve(const WindCondition& wc0, const WindCondition& wc, Eigen::VectorXd& x) {
+
+	status_= NRStatus();
+	nSteps_=0;
+	nHalvings_=0;
+
+	// Current point of the path
+	Eigen::VectorXd xc(x);
+	double lambda=0, step=1;
+
+	try {
+		setPath(wc0,wc,xc);
+	} catch(std::exception& e) {
+		status_.reason_= nrNotFinite;
+		return status_;
+	}
+
+	while(lambda<1) {
+
+		double next= (step>=1-lambda) ? 1. : lambda+step;
+
+		// Predict along the tangent, then correct
+		Eigen::VectorXd xTrial(xc);
+		size_t nIters=0;
+		bool converged=false;
+		try {
+			xTrial.block(0,0,subPbSize_,1)+= (next-lambda) * tangent(lambda,xc);
+			converged= correct(next,xTrial,nIters);
+		} catch(std::exception& e) {
+			// The predictor has left the domain of the model
+			converged= false;
+		}
+
+		if(converged) {
+			xc= xTrial;
+			lambda= next;
+			nSteps_++;
+
+			// Fast convergence : try a longer step
+			if(nIters<=2)
+				step*= 2;
+		}
+		else {
+			step/= 2;
+			nHalvings_++;
+			if(step<minStep_) {
+				status_.reason_= nrStepTooSmall;
+				return status_;
+			}
+		}
+	}
+
+	// Leave the items with the residuals of the solution
+	pVppItemsContainer_->getResiduals(wc_,xc);
+
+	x= xc;
+	return status_;
+}
+
+// March from the solution of the grid point (vTW0,aTW0) in x to the solution
+// of the grid point (vTW,aTW)
+const NRStatus& VPPContinuation::solve(int vTW0, int aTW0, int vTW, int aTW, Eigen::VectorXd& x) {
+
+	WindItem* pWind= pVppItemsContainer_->getWind();
+	return solve(pWind->getWindCondition(vTW0,aTW0),pWind->getWindCondition(vTW,aTW),x);
+}
+
+// Set the two wind conditions of the path, and its origin x0
+void VPPContinuation::setPath(const WindCondition& wc0, const WindCondition& wc, Eigen::VectorXd& x0) {
+
+	wc0_= wc0;
+	wc_= wc;
+
+	r0_= pVppItemsContainer_->getResiduals(wc0_,x0).block(0,0,subPbSize_,1);
+}
+
+// Wind condition of the path for the parameter lambda. The ends of the
+// path are exactly wc0 and wc
+WindCondition VPPContinuation::getWindCondition(double lambda) const {
+	return WindCondition( (1-lambda) * wc0_.twv_ + lambda * wc_.twv_,
+			(1-lambda) * wc0_.twa_ + lambda * wc_.twa_ );
+}
+
+// Compute the residuals H(x,lambda) of the current path
+Eigen::VectorXd VPPContinuation::pathResiduals(double lambda, Eigen::VectorXd& x) {
+
+	return pVppItemsContainer_->getResiduals(getWindCondition(lambda),x).block(0,0,subPbSize_,1) -
+			(1-lambda) * r0_;
+}
+
+// Compute dH/dx with the Jacobian mode of the NRSolver, as per VPPJacobian
+Eigen::MatrixXd VPPContinuation::jacobian(double lambda, Eigen::VectorXd& x) {
+
+	pVppItemsContainer_->getTelemetry().nJacobians_++;
+	status_.nJacobians_++;
+
+	// The fade term (1-lambda) * R(x0,wc0) does not depend on x : dH/dx is
+	// the sub-block of dR/dx at the wind condition of the path
+	if(pNRSolver_ && pNRSolver_->getJacobianMode()==automaticDifferentiation) {
+		Eigen::MatrixXd dResiduals;
+		pVppItemsContainer_->getResiduals(getWindCondition(lambda),x,dResiduals);
+		return dResiduals.block(0,0,subPbSize_,subPbSize_);
+	}
+
+	Eigen::MatrixXd J(subPbSize_,subPbSize_);
+	for(size_t iVar=0; iVar<subPbSize_; iVar++) {
+
+		// Compute the optimum eps for this variable
+		double eps=std::sqrt( std::numeric_limits<double>::epsilon() );
+		if(x(iVar)) eps *= std::fabs(x(iVar));
+
+		Eigen::VectorXd xp(x);
+		xp(iVar)= x(iVar) + eps;
+		J.col(iVar)= pathResiduals(lambda,xp);
+
+		xp(iVar)= x(iVar) - eps;
+		J.col(iVar)-= pathResiduals(lambda,xp);
+
+		J.col(iVar)/= ( 2 * eps );
+	}
+
+	return J;
+}
+
+// Compute the tangent dx/dlambda of the path at (x,lambda)
+Eigen::VectorXd VPPContinuation::tangent(double lambda, Eigen::VectorXd& x) {
+
+	// dH/dlambda = dR/dwc * (wc-wc0) + R(x0,wc0). The derivative of the
+	// residuals along the path is computed by centered finite differences
+	// of the wind condition, that does not need to lie on the wind grid
+	double eps=std::sqrt( std::numeric_limits<double>::epsilon() );
+	Eigen::VectorXd dHdLambda=
+			pVppItemsContainer_->getResiduals(getWindCondition(lambda+eps),x).block(0,0,subPbSize_,1) -
+			pVppItemsContainer_->getResiduals(getWindCondition(lambda-eps),x).block(0,0,subPbSize_,1);
+	dHdLambda/= ( 2 * eps );
+	dHdLambda+= r0_;
+
+	Eigen::MatrixXd J= jacobian(lambda,x);
+
+	TelemetryTimer timer(pVppItemsContainer_->getTelemetry().linearAlgebraTime_);
+	return - J.colPivHouseholderQr().solve(dHdLambda);
+}
+
+// Newton iterations on H(x,lambda)=0
+bool VPPContinuation::correct(double lambda, Eigen::VectorXd& x, size_t& nIters) {
+
+	for(nIters=0; ; nIters++) {
+
+		Eigen::VectorXd h= pathResiduals(lambda,x);
+		status_.residualNorm_= h.norm();
+
+		if( isNotValid(status_.residualNorm_) )
+			return false;
+
+		if( status_.residualNorm_<tol_ )
+			return true;
+
+		if( nIters==maxCorrectorIters_ )
+			return false;
+
+		// Count the Newton steps actually taken
+		pVppItemsContainer_->getTelemetry().nIterations_++;
+		status_.nIters_++;
+
+		Eigen::MatrixXd J= jacobian(lambda,x);
+
+		Eigen::VectorXd deltas;
+		{
+			TelemetryTimer timer(pVppItemsContainer_->getTelemetry().linearAlgebraTime_);
+			deltas= J.colPivHouseholderQr().solve(h);
+		}
+
+		if( !deltas.allFinite() )
+			return false;
+
+		x.block(0,0,subPbSize_,1)-= deltas;
+	}
+}
+
+// Returns the status of the last run
+const NRStatus& VPPContinuation::getStatus() const {
+	return status_;
+}
+
+// Returns the number of steps of the last run
+size_t VPPContinuation::getNumSteps() const {
+	return nSteps_;
+}
+
+// Returns the number of times the step was halved in the last run
+size_t VPPContinuation::getNumHalvings() const {
+	return nHalvings_;
+}
+
+// Set the tolerance on the norm of the residuals of the sub-problem
+void VPPContinuation::setTolerance(double tol) {
+	if(tol<=0) {
+		char msg[256];
+		sprintf(msg,"The tolerance of the continuation must be positive, got: %g",tol);
+		throw VPPException(HERE,msg);
+	}
+	tol_= tol;
+}
+
+// Set the max number of Newton iterations of each corrector
+void VPPContinuation::setMaxCorrectorIters(size_t maxIters) {
+	maxCorrectorIters_= maxIters;
+}
+
+// Set the min step of the path parameter, the march fails below it
+void VPPContinuation::setMinStep(double minStep) {
+	minStep_= minStep;
+}
@@ -0,0 +1,129 @@
+#ifndef VPPCONTINUATION_H
+#define VPPCONTINUATION_H
+
+#include <Eigen/Core>
+
+#include "VPPItemFactory.h"
+#include "NRSolver.h"
+
+/// Predictor-corrector continuation of the equilibrium dF=0, dM=0 between
+/// two wind conditions : from the solution x0 of the wind condition wc0,
+/// march to the solution of the wind condition wc. The two conditions are
+/// usually neighbours along the true wind velocity or along the true wind
+/// angle, on the wind grid or not. The path is parametrized by the wind
+/// condition itself, that moves from wc0 to wc
+///
+///   wc(lambda) = (1-lambda) * wc0 + lambda * wc
+///   H(x,lambda) = R(x,wc(lambda)) - (1-lambda) * R(x0,wc0)
+///
+/// where R are the residuals. The second term vanishes if x0 is an exact
+/// solution, and otherwise puts x0 on the path. The solution of H(x,1)=0
+/// is the one we look for. Each step predicts along the tangent of the path
+///
+///   dx/dlambda = - (dR/dx)^-1 * ( dR/dwc * (wc-wc0) + R(x0,wc0) )
+///
+/// and corrects with Newton iterations on H. The step is doubled when the
+/// corrector converges quickly, and halved when it does not converge.
+/// dH/dx is computed with the Jacobian mode of the NRSolver the continuation
+/// is built from, or by finite differences if none
+class VPPContinuation {
+
+	public:
+
+		/// Constructor. The Jacobian mode is read from the NRSolver, if any,
+		/// at each Jacobian : the mode set to the solver after this call applies
+		VPPContinuation(VPPItemFactory*, size_t subPbSize=2, const NRSolver* pNRSolver=0);
+
+		/// Destructor
+		~VPPContinuation();
+
+		/// First order prediction of the solution at wc from the solution x0
+		/// at wc0 : a single step along the tangent of the path. Only the
+		/// variables of the sub-problem are predicted. Returns x0 if the tangent
+		/// cannot be computed
+		Eigen::VectorXd predict(const WindCondition& wc0, const WindCondition& wc, const Eigen::VectorXd& x0);
+
+		/// Same as predict, between the grid points (vTW0,aTW0) and (vTW,aTW)
+		Eigen::VectorXd predict(int vTW0, int aTW0, int vTW, int aTW, const Eigen::VectorXd& x0);
+
+		/// March from the solution of wc0 in x to the solution of wc. On
+		/// convergence x is replaced by the solution, otherwise it is unchanged
+		const NRStatus& solve(const WindCondition& wc0, const WindCondition& wc, Eigen::VectorXd& x);
+
+		/// Same as solve, between the grid points (vTW0,aTW0) and (vTW,aTW)
+		const NRStatus& solve(int vTW0, int aTW0, int vTW, int aTW, Eigen::VectorXd& x);
+
+		/// Returns the status of the last run
+		const NRStatus& getStatus() const;
+
+		/// Returns the number of steps of the last run
+		size_t getNumSteps() const;
+
+		/// Returns the number of times the step was halved in the last run
+		size_t getNumHalvings() const;
+
+		/// Set the tolerance on the norm of the residuals of the sub-problem
+		void setTolerance(double tol);
+
+		/// Set the max number of Newton iterations of each corrector
+		void setMaxCorrectorIters(size_t maxIters);
+
+		/// Set the min step of the path parameter, the march fails below it
+		void setMinStep(double minStep);
+
+	private:
+
+		/// Disallow default constructor
+		VPPContinuation();
+
+		/// Set the two wind conditions of the path, and its origin x0
+		void setPath(const WindCondition& wc0, const WindCondition& wc, Eigen::VectorXd& x0);
+
+		/// Wind condition of the path for the parameter lambda
+		WindCondition getWindCondition(double lambda) const;
+
+		/// Compute the residuals H(x,lambda) of the current path
+		Eigen::VectorXd pathResiduals(double lambda, Eigen::VectorXd& x);
+
+		/// Compute dH/dx with the Jacobian mode of the NRSolver
+		Eigen::MatrixXd jacobian(double lambda, Eigen::VectorXd& x);
+
+		/// Compute the tangent dx/dlambda of the path at (x,lambda)
+		Eigen::VectorXd tangent(double lambda, Eigen::VectorXd& x);
+
+		/// Newton iterations on H(x,lambda)=0. Returns false if the corrector
+		/// does not converge within the max number of iterations
+		bool correct(double lambda, Eigen::VectorXd& x, size_t& nIters);
+
+		/// Ptr to the VPPItemFactory the residuals are computed with
+		VPPItemFactory* pVppItemsContainer_;
+
+		/// Size of the sub-problem : u, phi
+		size_t subPbSize_;
+
+		/// Ptr to the NRSolver the Jacobian mode is read from, NULL if none
+		const NRSolver* pNRSolver_;
+
+		/// Wind conditions of the origin and of the end of the path
+		WindCondition wc0_, wc_;
+
+		/// Residuals of the origin of the path R(x0,wc0), usually null
+		Eigen::VectorXd r0_;
+
+		/// Tolerance on the norm of the residuals of the sub-problem
+		double tol_;
+
+		/// Max number of Newton iterations of each corrector
+		size_t maxCorrectorIters_;
+
+		/// Min step of the path parameter
+		double minStep_;
+
+		/// Status of the last run
+		NRStatus status_;
+
+		/// Number of steps and of halvings of the step of the last run
+		size_t nSteps_, nHalvings_;
+};
+
+#endif
@@ -1,13 +1,16 @@
 #include "VPPGradient.h"
+#include "VPPJacobian.h"
 #include "mathUtils.h"
 #include "math.h"
 
 // Constructor - square pb
-VPPGradient::VPPGradient(const VectorXd& x,VPPItemFactory* pVppItemsContainer):
+VPPGradient::VPPGradient(const VectorXd& x,VPPItemFactory* pVppItemsContainer,
+		gradientMode mode/*=newtonFiniteDifferences*/):
 x_(x),
 xp0_(x),
 pVppItemsContainer_(pVppItemsContainer),
-size_(4) {
+size_(4),
+mode_(mode) {
 
 	// Resize this Jacobian to the size of the state vector
 	resize(size_);
@@ -20,17 +23,26 @@ size_(4) {
 }
 
 // Set the operation point and run to compute the derivatives
-void VPPGradient::run(const VectorXd& x, int twv, int twa) {
+void VPPGradient::run(const VectorXd& x, const WindCondition& wc) {
 
 	// Set the operation point x
 	x_=x;
 
 	// Run to compute the derivatives
-	run(twv,twa);
+	run(wc);
 }
 
 // Compute this Gradient
-void VPPGradient::run(int twv, int twa) {
+void VPPGradient::run(const WindCondition& wc) {
+
+	if(mode_==implicitFunctionTheorem)
+		runImplicitFunction(wc);
+	else
+		runNewton(wc);
+}
+
+// Compute this Gradient by finite differences of Newton solves
+void VPPGradient::runNewton(const WindCondition& wc) {
 
 	// Set cout precision
 	// std::cout.precision(5);
@@ -68,13 +80,13 @@ void VPPGradient::run(int twv, int twa) {
 		xp(iVar) = x_(iVar) + eps;
 
 		// Compute du/(dx(iVar)+eps) s.t: dF=0, dM=0 (iVar=2,3)
-		xp= pSolver_->run(twv,twa,xp);
+		xp= pSolver_->run(wc,xp);
 
 		// set x= x - eps
 		xm(iVar) = x_(iVar) - eps;
 
 		// Compute du/(dx(iVar)-eps) s.t: dF=0, dM=0 (iVar=2,3)
-		xm= pSolver_->run(twv,twa,xm);
+		xm= pSolver_->run(wc,xm);
 
 		// Compute the component of the Gradient
 		// du / dVar = ( u_p - u_m ) / ( 2 * eps )
@@ -82,10 +94,55 @@ void VPPGradient::run(int twv, int twa) {
 	}
 
 	// Update the items with the initial state vector
-	pVppItemsContainer_->update(twv,twa,x_);
+	pVppItemsContainer_->update(wc,x_);
+
+}
+
+// Compute this Gradient with the implicit function theorem
+void VPPGradient::runImplicitFunction(const WindCondition& wc) {
+
+	// Compute the Jacobian of the residuals (dF, dM) wrt (u, Phi, b, f) at the
+	// current point. This also leaves the items updated with x_
+	VPPJacobian J(x_,pVppItemsContainer_,2,size_,automaticDifferentiation);
+	J.run(wc);
+
+	// Compute du/du = 1
+	coeffRef(0) = 1;
 
+	// The derivatives are deemed null or singular relative to their own scale,
+	// so that a nearly singular equilibrium does not return a huge gradient
+	double tol= std::sqrt( std::numeric_limits<double>::epsilon() );
+
+	// Phi is enforced and we only require dF=0:
+	// dF/du * du + dF/dPhi * dPhi = 0
+	if( fabs(J(0,0)) <= tol * J.row(0).norm() )
+		throw VPPException(HERE,"dF/du is null, cannot compute du/dPhi");
+	coeffRef(1) = - J(0,1) / J(0,0);
+
+	// u and Phi are free and we require dF=0, dM=0 while b, f vary:
+	// J(:,u:Phi) * d(u,Phi) + J(:,b:f) * d(b,f) = 0
+	Eigen::Matrix2d Js= J.block(0,0,2,2);
+	Eigen::FullPivLU<Eigen::Matrix2d> lu(Js);
+	if( lu.rcond() < tol )
+		throw VPPException(HERE,"The Jacobian of the equilibrium is singular");
+
+	Eigen::Matrix2d sensitivity= lu.solve( J.block(0,2,2,2) );
+	coeffRef(2) = - sensitivity(0,0);
+	coeffRef(3) = - sensitivity(0,1);
+
+}
+
+// Set the operation point and run for the wind condition of the grid point (twv, twa)
+void VPPGradient::run(const VectorXd& x, int twv, int twa) {
+	run(x,pVppItemsContainer_->getWind()->getWindCondition(twv,twa));
+}
+
+// Compute this Gradient for the wind condition of the grid point (twv, twa)
+void VPPGradient::run(int twv, int twa) {
+	run(pVppItemsContainer_->getWind()->getWindCondition(twv,twa));
 }
 
+#ifndef VPP_HEADLESS
 // Produces a plot for a range of values of the state variables
 // in order to test for the coherence of the values that have been computed
 std::vector<VppXYCustomPlotWidget*> VPPGradient::plot(WindIndicesDialog& wd,FullStateVectorDialog& sd) {
@@ -260,6 +317,7 @@ std::vector<VppXYCustomPlotWidget*> VPPGradient::plot(WindIndicesDialog& wd,Full
 	return retVector;
 
 }
+#endif
 
 // Destructor
 VPPGradient::~VPPGradient(){
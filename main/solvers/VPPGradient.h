@@ -8,6 +8,12 @@ using namespace Eigen;
 #include "VPPItemFactory.h"
 #include "NRSolver.h"
 
+/// Method used to compute the derivatives of the Gradient vector
+enum gradientMode {
+	newtonFiniteDifferences,	//< Centered finite differences of Newton solves
+	implicitFunctionTheorem		//< Linear solve with the Jacobian at the current point
+};
+
 // Compute the Gradient vector:
 //
 // Grad(u) = | du/du du/dPhi  du/db  du/df  | =
@@ -15,29 +21,53 @@ using namespace Eigen;
 //
 // where the derivatives in the Gradient matrix are computed by
 // centered finite differences:
+// du/dx = ( u(x+eps) - u(x-eps) ) / 2eps, u being solved by a NRSolver
+// s.t. dF=0 (x=Phi) or dF=0, dM=0 (x=b,f). That is 6 Newton solves.
+//
+// Or by the implicit function theorem, differentiating the equilibrium
+// with the Jacobian J of the residuals at the current point:
+// du/dPhi = - (dF/dPhi) / (dF/du)
+// [ du/db du/df ]  = - first row of ( J(:,u:Phi)^-1 * J(:,b:f) )
+// which is exact at an equilibrium point, and costs one Jacobian
 
 class VPPGradient : public Eigen::VectorXd {
 
 	public:
 
 		/// Constructor
-		VPPGradient(const VectorXd& x,VPPItemFactory* pVppItemsContainer );
+		VPPGradient(const VectorXd& x,VPPItemFactory* pVppItemsContainer,
+				gradientMode mode=newtonFiniteDifferences );
 
 		/// Set the operation point and run to compute the derivatives
+		/// for the wind condition wc
+		void run(const VectorXd& x, const WindCondition& wc);
+
+		/// Compute this Gradient for the wind condition wc
+		void run(const WindCondition& wc);
+
+		/// Same as run(x,wc), for the wind condition of the grid point (twv, twa)
 		void run(const VectorXd& x, int twv, int twa);
 
-		/// Compute this Gradient
+		/// Same as run(wc), for the wind condition of the grid point (twv, twa)
 		void run(int twv, int twa);
 
+#ifndef VPP_HEADLESS
 		/// Produces a plot for a range of values of the state variables
 		/// in order to test for the coherence of the values that have been computed
 		std::vector<VppXYCustomPlotWidget*> plot(WindIndicesDialog&,FullStateVectorDialog&);
+#endif
 
 		/// Destructor
 		~VPPGradient();
 
 	private:
 
+		/// Compute this Gradient by finite differences of Newton solves
+		void runNewton(const WindCondition& wc);
+
+		/// Compute this Gradient with the implicit function theorem
+		void runImplicitFunction(const WindCondition& wc);
+
 		/// Const reference to the VPP state vector
 		VectorXd x_;
 
@@ -61,6 +91,9 @@ class VPPGradient : public Eigen::VectorXd {
 		/// Size of the complete optimization problem : u, phi, b, f.
 		size_t size_;
 
+		/// Method used to compute the derivatives
+		gradientMode mode_;
+
 };
 
 #endif
@@ -0,0 +1,76 @@
+#include "VPPHessian.h"
+#include "VPPException.h"
+#include "mathUtils.h"
+
+// Constructor
+VPPHessian::VPPHessian(VectorXd& x,VPPItemFactory* pVppItemsContainer):
+		x_(x),
+		pVppItemsContainer_(pVppItemsContainer),
+		size_(x.size()),
+		hessians_(2, Eigen::MatrixXd::Zero(x.size(),x.size())) {
+
+}
+
+// Destructor
+VPPHessian::~VPPHessian() {
+
+}
+
+// Compute the Hessians
+void VPPHessian::run(const WindCondition& wc) {
+
+	// Buffers for the derivatives of the residuals at x+eps and x-eps
+	Eigen::MatrixXd dResPlus, dResMinus;
+
+	// loop on the state variables
+	for(size_t jVar=0; jVar<size_; jVar++) {
+
+		// The derivatives are exact, so the optimum eps of the centered
+		// differences scales with the cubic root of the machine precision
+		double eps=std::cbrt( std::numeric_limits<double>::epsilon() );
+		if(x_(jVar)) eps *= std::fabs(x_(jVar));
+
+		// Init a buffer of the state vector xp
+		VectorXd xp(x_);
+
+		// Derivatives of the residuals for x= x + eps
+		xp(jVar) = x_(jVar) + eps;
+		pVppItemsContainer_->getResiduals(wc,xp,dResPlus);
+
+		// Derivatives of the residuals for x= x - eps
+		xp(jVar) = x_(jVar) - eps;
+		pVppItemsContainer_->getResiduals(wc,xp,dResMinus);
+
+		// The j-th column of each Hessian is the derivative of the
+		// gradient of the corresponding residual wrt x_j
+		for(size_t iRes=0; iRes<hessians_.size(); iRes++)
+			hessians_[iRes].col(jVar)= ( dResPlus.row(iRes) - dResMinus.row(iRes) ).transpose() / ( 2 * eps );
+	}
+
+	// The finite differences are only symmetric to truncation error
+	for(size_t iRes=0; iRes<hessians_.size(); iRes++) {
+		Eigen::MatrixXd h(hessians_[iRes]);
+		hessians_[iRes]= 0.5 * ( h + h.transpose() );
+	}
+
+	// Update the items with the initial state vector
+	pVppItemsContainer_->update(wc,x_);
+
+}
+
+// Compute the Hessians for the wind condition of the grid point (twv, twa)
+void VPPHessian::run(int twv, int twa) {
+	run(pVppItemsContainer_->getWind()->getWindCondition(twv,twa));
+}
+
+// Get the Hessian of the iRes-th residual : 0 for dF, 1 for dM
+const Eigen::MatrixXd& VPPHessian::get(size_t iRes) const {
+
+	if(iRes>=hessians_.size()) {
+		char msg[256];
+		sprintf(msg,"The residual index %zu exceeds the number of residuals %zu",iRes,hessians_.size());
+		throw VPPException(HERE,msg);
+	}
+
+	return hessians_[iRes];
+}
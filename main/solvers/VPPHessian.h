@@ -0,0 +1,65 @@
+#ifndef VPPHESSIAN_H
+#define VPPHESSIAN_H
+
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Dense>
+using namespace Eigen;
+
+#include "VPPItemFactory.h"
+
+/// Compute the Hessian matrices of the force and moment residuals
+/// wrt the state variables (u, phi, b, f):
+///
+/// H_dF = | d2dF/du2     d2dF/dudPhi  ... |
+///        | d2dF/dPhidu  d2dF/dPhi2   ... |
+///        | ...                           |
+///
+/// and the same for dM. The Duals only carry first derivatives, so the
+/// Hessians are computed by centered finite differences of the exact
+/// first derivatives obtained by automatic differentiation (see Dual.h):
+///
+/// d2dF/dx_i dx_j = ( ddF/dx_i(x+eps_j) - ddF/dx_i(x-eps_j) ) / 2eps_j
+///
+/// that is 8 evaluations of the residuals and of their derivatives.
+/// The matrices are symmetrized. Used to feed ipOpt with the Hessian
+/// of the Lagrangian
+class VPPHessian {
+
+	public:
+
+		/// Constructor
+		VPPHessian(VectorXd& x,VPPItemFactory* pVppItemsContainer);
+
+		/// Compute the Hessians for the wind condition wc
+		void run(const WindCondition& wc);
+
+		/// Compute the Hessians for the wind condition of the grid point (twv, twa)
+		void run(int twv, int twa);
+
+		/// Get the Hessian of the iRes-th residual : 0 for dF, 1 for dM
+		const Eigen::MatrixXd& get(size_t iRes) const;
+
+		/// Destructor
+		~VPPHessian();
+
+	private:
+
+		/// Disallow default ctor
+		VPPHessian();
+
+		/// Const reference to the VPP state vector
+		VectorXd& x_;
+
+		/// Ptr to the vppItemContainer, to be called to update the items
+		/// when computing the derivatives
+		VPPItemFactory* pVppItemsContainer_;
+
+		/// Size of the complete optimization problem : u, phi, b, f.
+		size_t size_;
+
+		/// Hessians of dF and dM
+		std::vector<Eigen::MatrixXd> hessians_;
+};
+
+#endif
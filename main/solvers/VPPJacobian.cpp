@@ -3,12 +3,13 @@
 
 // Constructor - square pb
 VPPJacobian::VPPJacobian(VectorXd& x,VPPItemFactory* pVppItemsContainer,
-		size_t subProblemSize):
+		size_t subProblemSize, jacobianMode mode/*=finiteDifferences*/):
 		x_(x),
 		xp0_(x),
 		pVppItemsContainer_(pVppItemsContainer),
 		subPbSize_(subProblemSize),
-		size_(subProblemSize) {
+		size_(subProblemSize),
+		mode_(mode) {
 
 	// Resize this Jacobian to the size of the state vector
 	resize(subPbSize_,size_);
@@ -17,23 +18,41 @@ VPPJacobian::VPPJacobian(VectorXd& x,VPPItemFactory* pVppItemsContainer,
 
 // Constructor - non square pb
 VPPJacobian::VPPJacobian(VectorXd& x,VPPItemFactory* pVppItemsContainer,
-		size_t subProblemSize, size_t size):
+		size_t subProblemSize, size_t size, jacobianMode mode/*=finiteDifferences*/):
 		x_(x),
 		xp0_(x),
 		pVppItemsContainer_(pVppItemsContainer),
 		subPbSize_(subProblemSize),
-		size_(size) {
+		size_(size),
+		mode_(mode) {
 
 	// Resize this Jacobian to the size of the state vector
 	resize(subPbSize_,size_);
 
 }
 
-void VPPJacobian::run(int twv, int twa) {
+void VPPJacobian::run(const WindCondition& wc) {
 
 	// Note that we do not need to update x_, because x_ is a reference to the
 	// state vector of the class calling the constructor of this!
 
+	pVppItemsContainer_->getTelemetry().nJacobians_++;
+
+	// Compute the residuals and their exact derivatives in a single pass. This
+	// also leaves the items updated with the initial state vector
+	if(mode_==automaticDifferentiation) {
+		Eigen::MatrixXd dResiduals;
+		pVppItemsContainer_->getResiduals(wc,x_,dResiduals);
+		block(0,0,subPbSize_,size_)= dResiduals.block(0,0,subPbSize_,size_);
+		return;
+	}
+
+	// With the compiled kernel, all the perturbed states are evaluated in a single batch
+	if(pVppItemsContainer_->isCompiled() && x_.size()==4) {
+		runBatch(wc);
+		return;
+	}
+
 	// loop on the state variables
 	for(size_t iVar=0; iVar<size_; iVar++) {
 
@@ -49,14 +68,14 @@ void VPPJacobian::run(int twv, int twa) {
 
 		// Compile the i-th column of the Jacobian matrix with the
 		// residuals for x_plus_epsilon: ( dF/dvar(i) dM/dvar(i) )^T
-		col(iVar) = pVppItemsContainer_->getResiduals(twv,twa,xp).block(0,0,subPbSize_,1);
+		col(iVar) = pVppItemsContainer_->getResiduals(wc,xp).block(0,0,subPbSize_,1);
 
 		// set x= x - eps
 		xp(iVar) = x_(iVar) - eps;
 
 		// compile the i-th column of the Jacobian matrix subtracting the
 		// residuals for x_minus_epsilon
-		col(iVar) -= pVppItemsContainer_->getResiduals(twv,twa,xp).block(0,0,subPbSize_,1);
+		col(iVar) -= pVppItemsContainer_->getResiduals(wc,xp).block(0,0,subPbSize_,1);
 
 		// divide the column of the Jacobian by 2*eps
 		col(iVar) /= ( 2 * eps );
@@ -64,10 +83,46 @@ void VPPJacobian::run(int twv, int twa) {
 	}
 
 	// Update the items with the initial state vector
-	pVppItemsContainer_->update(twv,twa,x_);
+	pVppItemsContainer_->update(wc,x_);
 
 }
 
+// Compute the finite differences from a single batch with the 2*size_ perturbed
+// states : x+eps in the even lanes, x-eps in the odd ones
+void VPPJacobian::runBatch(const WindCondition& wc) {
+
+	StateBatch xp(2*size_);
+	Eigen::VectorXd eps(size_);
+	for(size_t iVar=0; iVar<size_; iVar++) {
+
+		// Compute the optimum eps for this variable
+		eps(iVar)=std::sqrt( std::numeric_limits<double>::epsilon() );
+		if(x_(iVar)) eps(iVar) *= std::fabs(x_(iVar));
+
+		Eigen::VectorXd x(x_);
+		x(iVar) = x_(iVar) + eps(iVar);
+		xp.set(2*iVar,x);
+		x(iVar) = x_(iVar) - eps(iVar);
+		xp.set(2*iVar+1,x);
+	}
+
+	ResidualBatch res= pVppItemsContainer_->getResiduals(wc,xp);
+
+	for(size_t iVar=0; iVar<size_; iVar++) {
+		Eigen::Vector2d dRes( res.dF_(2*iVar) - res.dF_(2*iVar+1), res.dM_(2*iVar) - res.dM_(2*iVar+1) );
+		col(iVar) = dRes.head(subPbSize_) / ( 2 * eps(iVar) );
+	}
+
+	// Update the items with the initial state vector
+	pVppItemsContainer_->update(wc,x_);
+
+}
+
+// Compute this Jacobian for the wind condition of the grid point (twv, twa)
+void VPPJacobian::run(int twv, int twa) {
+	run(pVppItemsContainer_->getWind()->getWindCondition(twv,twa));
+}
+
 /// Compute my conditioning number
 double VPPJacobian::conditioning() const {
 
@@ -78,6 +133,7 @@ double VPPJacobian::conditioning() const {
 
 }
 
+#ifndef VPP_HEADLESS
 // Produces a plot for a range of values of the state variables
 // in order to test for the coherence of the values that have been computed
 std::vector<VppXYCustomPlotWidget*> VPPJacobian::plot(WindIndicesDialog& wd,FullStateVectorDialog& sd) {
@@ -206,6 +262,7 @@ std::vector<VppXYCustomPlotWidget*> VPPJacobian::plot(WindIndicesDialog& wd,Full
 
 	return retVector;
 }
+#endif
 
 // Destructor
 VPPJacobian::~VPPJacobian(){
@@ -7,13 +7,21 @@ using namespace Eigen;
 
 #include "VPPItemFactory.h"
 
+/// Method used to compute the derivatives of the Jacobian matrix
+enum jacobianMode {
+	finiteDifferences,				//< Centered finite differences
+	automaticDifferentiation	//< Forward-mode automatic differentiation
+};
+
 /// Compute the Jacobian matrix:
 ///
 /// J = | dF/du dF/dPhi |	|du	 | 	 |dF |    |0|
 ///	    | dM/du dM/dPhi |	|dPhi| = |dM | -> |0|
 ///
 /// where the derivatives in the Jacobian matrix are computed by
-/// centered finite differences
+/// centered finite differences, or by forward-mode automatic differentiation
+/// of the items (see Dual.h). The latter evaluates the residuals and their
+/// exact derivatives in a single pass
 /// It is possible to compute a non-diagonal Jacobian used to feed ipOpt
 ///
 /// J = | dF/du dF/dPhi dF/db dF/df |
@@ -24,17 +32,24 @@ class VPPJacobian : public Eigen::MatrixXd {
 	public:
 
 		/// Constructor
-		VPPJacobian(VectorXd& x,VPPItemFactory* pVppItemsContainer, size_t subProblemSize);
+		VPPJacobian(VectorXd& x,VPPItemFactory* pVppItemsContainer, size_t subProblemSize,
+				jacobianMode mode=finiteDifferences);
 
 		/// Constructor for non square Jacobian
-		VPPJacobian(VectorXd& x,VPPItemFactory* pVppItemsContainer, size_t subProblemSize, size_t nVars);
+		VPPJacobian(VectorXd& x,VPPItemFactory* pVppItemsContainer, size_t subProblemSize, size_t nVars,
+				jacobianMode mode=finiteDifferences);
+
+		/// Compute this Jacobian for the wind condition wc
+		void run(const WindCondition& wc);
 
-		/// Compute this Jacobian
+		/// Compute this Jacobian for the wind condition of the grid point (twv, twa)
 		void run(int twv, int twa);
 
+#ifndef VPP_HEADLESS
 		/// Produces a plot for a range of values of the state variables
 		/// in order to test for the coherence of the values that have been computed
 		std::vector<VppXYCustomPlotWidget*> plot(WindIndicesDialog&,FullStateVectorDialog&);
+#endif
 
 		/// Compute my conditioning number
 		double conditioning() const;
@@ -45,6 +60,10 @@ class VPPJacobian : public Eigen::MatrixXd {
 
 	private:
 
+		/// Compute the finite differences evaluating all the perturbed
+		/// states in a single batch. Used with the compiled kernel
+		void runBatch(const WindCondition& wc);
+
 		/// Const reference to the VPP state vector
 		VectorXd& x_;
 
@@ -62,6 +81,9 @@ class VPPJacobian : public Eigen::MatrixXd {
 
 		/// Size of the complete optimization problem : u, phi, b, f.
 		size_t size_;
+
+		/// Method used to compute the derivatives
+		jacobianMode mode_;
 };
 
 #endif
@@ -1,13 +1,25 @@
 #include "VPPJobRunner.h"
+#include <thread>
+#ifndef VPP_HEADLESS
 #include "MainWindow.h"
 #include <QObject>
+#endif
 
+#ifndef VPP_HEADLESS
 // Ctor
 VPPJobRunner::VPPJobRunner(VPPSolverFactoryBase* pSf,
 		size_t nta, size_t ntw, MainWindow* ui/*=0*/):
 		pSf_(pSf),
 		nta_(nta),
-		ntw_(ntw) {
+		ntw_(ntw),
+		deterministic_(true),
+		nAnglesLeft_(0),
+		nDone_(0),
+		nRunning_(0),
+		canceled_(false) {
+
+	// Set the precision of the output of the solvers once, before they run
+	std::cout.precision(15);
 
 	// If we have a UI, we instantiate and initialize a progress
 	// dialog
@@ -16,17 +28,67 @@ VPPJobRunner::VPPJobRunner(VPPSolverFactoryBase* pSf,
 		pProgress_->setRange(0,nta_*ntw_);
 		pProgress_->setCancelButtonText(QObject::tr("&Cancel"));
 		pProgress_->setWindowTitle(QObject::tr("Running VPP analysis..."));
+
+		// Report the progress to the dialog
+		progress_= [this](size_t nDone, size_t nPoints) -> bool {
+
+			// Refresh the UI -> update the progress bar and the log
+			QCoreApplication::processEvents();
+
+			pProgress_->setValue(nDone);
+			pProgress_->setLabelText(QObject::tr("_ Solving case number %1 of %n...", 0, nPoints).arg(nDone));
+
+			// Stop if the user pressed the 'cancel' button
+			return !pProgress_->wasCanceled();
+		};
 	}
 
-	int statusProgress=0;
+	runSerial();
+}
+#endif
+
+// Ctor
+VPPJobRunner::VPPJobRunner(VPPSolverFactoryBase* pSf, size_t nta, size_t ntw,
+		size_t nThreads, bool deterministic/*=true*/,
+		ProgressCallback progress/*=ProgressCallback()*/):
+		pSf_(pSf),
+		nta_(nta),
+		ntw_(ntw),
+		deterministic_(deterministic),
+		progress_(progress),
+		nAnglesLeft_(0),
+		nDone_(0),
+		nRunning_(0),
+		canceled_(false) {
+
+	// Set the precision of the output of the solvers once, before the threads
+	// start : the stream state of std::cout is shared by the threads
+	std::cout.precision(15);
+
+	if(nThreads>1)
+		runParallel(nThreads);
+	else
+		runSerial();
+}
+
+// Dtor
+VPPJobRunner::~VPPJobRunner() {
+
+}
+
+// Loop on the wind angles and velocities with the solver factory pSf_
+void VPPJobRunner::runSerial() {
 
 	// Loop on the wind ANGLES and VELOCITIES
 	for(size_t aTW=0; aTW<nta_; aTW++){
 
-		// exit the outer loop if the user pressed the 'cancel' button
-		if (pProgress_ && pProgress_->wasCanceled())
+		// exit the outer loop if the analysis was canceled
+		if (canceled_)
 			break;
 
+		// Each angle starts from a computed Jacobian, as in the parallel run
+		pSf_->get()->getNRSolver()->resetJacobian();
+
 		for(size_t vTW=0; vTW<ntw_; vTW++){
 
 			try{
@@ -36,16 +98,14 @@ VPPJobRunner::VPPJobRunner(VPPSolverFactoryBase* pSf,
 				// Run the optimizer for the current wind speed/angle
 				pSf_->run(vTW,aTW);
 
-				if(pProgress_) {
-
-					// Refresh the UI -> update the progress bar and the log
-					QCoreApplication::processEvents();
+				// The point was given up, do nothing and keep going
+				if(!hasConverged(pSf_))
+					continue;
 
-					pProgress_->setValue(statusProgress);
-					pProgress_->setLabelText(QObject::tr("_ Solving case number %1 of %n...", 0, nta_*ntw_).arg(statusProgress));
-
-				}
-				statusProgress++;
+				// Report the progress
+				nDone_++;
+				if(progress_ && !progress_(nDone_,nta_*ntw_))
+					canceled_= true;
 
 			} catch(VPPException& e){
 				// Print the message and keep going...
@@ -65,7 +125,219 @@ VPPJobRunner::VPPJobRunner(VPPSolverFactoryBase* pSf,
 	}
 }
 
-// Dtor
-VPPJobRunner::~VPPJobRunner() {
+// Distribute the wind angles on the threads and wait for the completion
+void VPPJobRunner::runParallel(size_t nThreads) {
+
+	// Instantiate a solver for each thread, each with its own items. If the
+	// solver does not support concurrent runs, fall back to the serial run
+	std::vector<std::shared_ptr<VPPSolverFactoryBase> > solvers;
+	for(size_t iThread=0; iThread<nThreads; iThread++){
+
+		std::shared_ptr<VPPSolverFactoryBase> pSf( pSf_->clone() );
+		if(!pSf) {
+			std::cout<<"This solver does not support concurrent runs, running serially"<<std::endl;
+			runSerial();
+			return;
+		}
+		solvers.push_back(pSf);
+	}
+
+	// Init the scheduler
+	queues_.assign(nThreads,std::deque<size_t>());
+	released_.assign(nta_,false);
+	published_.assign(nta_*ntw_,false);
+	nAnglesLeft_= nta_;
+	nRunning_= nThreads;
+
+	// In deterministic mode, only the first angle is ready : the others are released
+	// when the points they are warm-started from are published. Otherwise, deal all
+	// of the angles to the threads
+	for(size_t aTW=0; aTW<nta_; aTW++) {
+		release(aTW % nThreads, aTW);
+		if(deterministic_)
+			break;
+	}
+
+	std::vector<std::thread> threads;
+	for(size_t iThread=0; iThread<nThreads; iThread++)
+		threads.push_back( std::thread(&VPPJobRunner::work, this, iThread, solvers[iThread].get()) );
+
+	// Report the progress from this thread, so that the callback does not
+	// need to be thread-safe
+	size_t nReported=0;
+	std::unique_lock<std::mutex> lock(mutex_);
+	while(nRunning_ || nReported!=nDone_) {
+
+		cond_.wait(lock, [&]{ return !nRunning_ || nReported!=nDone_; });
+
+		if(nReported!=nDone_) {
+			nReported= nDone_;
+			if(progress_) {
+				lock.unlock();
+				bool goOn= progress_(nReported,nta_*ntw_);
+				lock.lock();
+				if(!goOn) {
+					canceled_= true;
+					cond_.notify_all();
+				}
+			}
+		}
+	}
+	lock.unlock();
+
+	for(size_t iThread=0; iThread<threads.size(); iThread++)
+		threads[iThread].join();
+}
+
+// Loop executed by each thread of the pool : fetch an angle and solve it
+void VPPJobRunner::work(size_t iThread, VPPSolverFactoryBase* pSf) {
+
+	size_t aTW;
+	while(fetch(iThread,aTW))
+		runAngle(iThread,pSf,aTW);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	nRunning_--;
+	cond_.notify_all();
+}
+
+// Get the next angle to solve, from the thread own queue or stolen from
+// the queue of another thread
+bool VPPJobRunner::fetch(size_t iThread, size_t& aTW) {
+
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	while(true) {
+
+		if(canceled_ || !nAnglesLeft_)
+			return false;
+
+		// Own queue first, oldest angle first
+		if(!queues_[iThread].empty()) {
+			aTW= queues_[iThread].front();
+			queues_[iThread].pop_front();
+			return true;
+		}
+
+		// Then steal the most recent angle from the queue of another thread
+		for(size_t i=1; i<queues_.size(); i++) {
+			std::deque<size_t>& queue= queues_[ (iThread+i) % queues_.size() ];
+			if(!queue.empty()) {
+				aTW= queue.back();
+				queue.pop_back();
+				return true;
+			}
+		}
+
+		// Nothing ready : wait for an angle to be released
+		cond_.wait(lock);
+	}
+}
+
+// Solve all the velocities of a wind angle with the given solver factory.
+// The exception handling is the same as for the serial run
+void VPPJobRunner::runAngle(size_t iThread, VPPSolverFactoryBase* pSf, size_t aTW) {
+
+	// The Broyden Jacobian of the angle the thread solved last is not
+	// the one the serial run would reuse : start from a computed Jacobian
+	pSf->get()->getNRSolver()->resetJacobian();
+
+	for(size_t vTW=0; vTW<ntw_; vTW++){
+
+		// The first two velocities are warm-started from the previous angle
+		if(aTW && vTW<2)
+			importResult(pSf,vTW,aTW-1);
+
+		bool converged=false, goOn=true;
+
+		try{
+
+			std::cout<<"vTW="<<vTW<<"  "<<"aTW="<<aTW<<std::endl;
+
+			// Run the optimizer for the current wind speed/angle
+			pSf->run(vTW,aTW);
+			converged= hasConverged(pSf);
+
+		} catch(VPPException& e){
+			std::cout<<"A VPPException was catched..."<<std::endl;
+			std::cout<<e.what()<<std::endl;
+			goOn= false;
+		}
+		catch(NonConvergedException& e) {
+			std::cout<<"A NonConvergedException was catched..."<<std::endl;
+			std::cout<<e.what()<<std::endl;
+		} catch(...){
+			std::cout<<"An unknown exception was catched..."<<std::endl;
+			goOn= false;
+		}
+
+		// Publish the point, converged or not, as the serial run would
+		// warm-start the next angle from it anyway
+		publishResult(pSf,vTW,aTW,converged);
+
+		// The next angle can now start
+		if(vTW==1)
+			release(iThread,aTW+1);
+
+		if(!goOn)
+			break;
+	}
+
+	// Make sure the next angle is released if this one stopped early
+	release(iThread,aTW+1);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	nAnglesLeft_--;
+	cond_.notify_all();
+}
+
+// Returns true if the NRSolver has converged for the last wind point run by
+// pSf, otherwise print why it did not
+bool VPPJobRunner::hasConverged(VPPSolverFactoryBase* pSf) {
+
+	const NRStatus& status= pSf->get()->getNRStatus();
+	if(status.converged())
+		return true;
+
+	std::cout<<"The NR-Solver could not converge: "<<status.reasonString()
+			<<" after "<<status.nIters_<<" iterations, residual norm "<<status.residualNorm_<<std::endl;
+	return false;
+}
+
+// Copy a result from the results of pSf_ to the ones of pSf, if it has
+// been published
+void VPPJobRunner::importResult(VPPSolverFactoryBase* pSf, size_t vTW, size_t aTW) {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if(published_[aTW*ntw_+vTW])
+		pSf->get()->getResults()->copy(vTW,aTW,*pSf_->get()->getResults());
+}
+
+// Copy the result computed by pSf to the results of pSf_, then mark it as
+// published for the points warm-started from it
+void VPPJobRunner::publishResult(VPPSolverFactoryBase* pSf, size_t vTW, size_t aTW, bool converged) {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	pSf_->get()->getResults()->copy(vTW,aTW,*pSf->get()->getResults());
+	published_[aTW*ntw_+vTW]= true;
+
+	if(converged)
+		nDone_++;
+
+	cond_.notify_all();
+}
+
+// Queue angle aTW in the queue of thread iThread, if not done yet
+void VPPJobRunner::release(size_t iThread, size_t aTW) {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if(aTW>=nta_ || released_[aTW])
+		return;
 
+	released_[aTW]= true;
+	queues_[iThread].push_back(aTW);
+	cond_.notify_all();
 }
@@ -1,6 +1,11 @@
 #ifndef __JOB_RUNNER__
 #define __JOB_RUNNER__
 
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
 # include "VPPSolverFactoryBase.h"
 
 using namespace Optim;
@@ -9,29 +14,121 @@ using namespace Optim;
 class MainWindow;
 
 /// Class used to run jobs. The advantage of this class is -by now-
-/// simply to centralize the exception handling
+/// simply to centralize the exception handling.
+/// The runner can also process the wind grid on a pool of threads.
+/// Each point (twv,twa) is warm-started from (twv-1,twa) or (twv,twa-1)
+/// for twv<=1 and from the previous velocities of the same angle otherwise.
+/// The wind angles are then the units of work: an angle is solved by a
+/// single thread, velocity after velocity, and the next angle becomes
+/// ready as soon as its first two velocities have been published.
+/// Idle threads steal the ready angles queued by the busy ones.
 class VPPJobRunner {
 
 	public:
 
-		/// Ctor
+		/// Callback used to report the progress of the analysis. It is
+		/// handed the number of points processed and the total number of
+		/// points, and returns false to cancel the analysis. The callback
+		/// is always called from the thread that instantiated the runner
+		typedef std::function<bool(size_t,size_t)> ProgressCallback;
+
+#ifndef VPP_HEADLESS
+		/// Ctor : serial run. If a UI is given, a QProgressDialog shows the
+		/// progress and allows to cancel the analysis
 		VPPJobRunner(VPPSolverFactoryBase* pSf, size_t nta, size_t ntw, MainWindow* ui=Q_NULLPTR);
+#endif
+
+		/// Ctor : run on nThreads threads. If deterministic, each angle waits for
+		/// the points of the previous angle it is warm-started from, and the results
+		/// are identical to the serial run. Otherwise all angles start at once and
+		/// are warm-started from the neighbour points already available.
+		/// Falls back to the serial run if the solver does not support concurrent runs
+		VPPJobRunner(VPPSolverFactoryBase* pSf, size_t nta, size_t ntw,
+				size_t nThreads, bool deterministic=true,
+				ProgressCallback progress=ProgressCallback() );
 
 		/// Dtor
 		virtual ~VPPJobRunner();
 
 	private:
 
+		/// Loop on the wind angles and velocities with the solver factory pSf_
+		void runSerial();
+
+		/// Distribute the wind angles on the threads and wait for the completion
+		void runParallel(size_t nThreads);
+
+		/// Loop executed by each thread of the pool : fetch an angle and solve it
+		void work(size_t iThread, VPPSolverFactoryBase* pSf);
+
+		/// Get the next angle to solve, from the thread own queue or stolen from
+		/// the queue of another thread. Blocks until an angle is ready, and returns
+		/// false when there is nothing left to do
+		bool fetch(size_t iThread, size_t& aTW);
+
+		/// Solve all the velocities of a wind angle with the given solver factory
+		void runAngle(size_t iThread, VPPSolverFactoryBase* pSf, size_t aTW);
+
+		/// Returns true if the NRSolver has converged for the last wind point
+		/// run by pSf, otherwise print why it did not
+		bool hasConverged(VPPSolverFactoryBase* pSf);
+
+		/// Copy a result from the results of pSf_ to the ones of pSf, if it has
+		/// been published
+		void importResult(VPPSolverFactoryBase* pSf, size_t vTW, size_t aTW);
+
+		/// Copy the result computed by pSf to the results of pSf_, then mark it as
+		/// published for the points warm-started from it. Converged points are
+		/// counted as processed
+		void publishResult(VPPSolverFactoryBase* pSf, size_t vTW, size_t aTW, bool converged);
+
+		/// Queue angle aTW in the queue of thread iThread, if not done yet
+		void release(size_t iThread, size_t aTW);
+
 		/// Ptr to the Solver
 		VPPSolverFactoryBase* pSf_;
 
 		/// Number of points to process
 		size_t nta_, ntw_;
 
+		/// Does the parallel run need to reproduce the serial results?
+		bool deterministic_;
+
+		/// Callback used to report the progress
+		ProgressCallback progress_;
+
+#ifndef VPP_HEADLESS
 		/// For the version called by the UI, issue a QProgressDialog
 		/// in charge for showing at what point of the analysis we are
 		/// at
 		std::shared_ptr<QProgressDialog> pProgress_;
+#endif
+
+		/// Mutex and condition protecting the scheduler data below
+		std::mutex mutex_;
+		std::condition_variable cond_;
+
+		/// Queue of the wind angles ready to be solved, one per thread
+		std::vector<std::deque<size_t> > queues_;
+
+		/// Flag the angles already queued
+		std::vector<bool> released_;
+
+		/// Flag the points that have been published, stored by twa first
+		std::vector<bool> published_;
+
+		/// Number of angles still to be completed
+		size_t nAnglesLeft_;
+
+		/// Number of points processed
+		size_t nDone_;
+
+		/// Number of threads still running
+		size_t nRunning_;
+
+		/// Set when the progress callback asked to stop the analysis
+		bool canceled_;
+
 };
 
 #endif
@@ -52,12 +52,17 @@ void VPPSolver::run(int TWV, int TWA) {
 
 	std::cout<<"    "<<pWind_->getTWV(TWV)<<"    "<<toDeg(pWind_->getTWA(TWA))<<std::endl;
 
+	startTelemetry();
+
 	// For each wind velocity, reset the initial guess for the
 	// state variable vector to zero
 	resetInitialGuess(TWV,TWA);
 
 	// Refine the initial guess solving a sub-problem with no optimization variables
-	solveInitialGuess(TWV,TWA);
+	if(!solveInitialGuess(TWV,TWA)) {
+		discardNonConverged(TWV,TWA);
+		return;
+	}
 
 	// Do nothing else, the solution is already found
 	Eigen::VectorXd residuals= pVppItemsContainer_->getResiduals();
@@ -73,7 +78,22 @@ void VPPSolver::run(int TWV, int TWA) {
 			pResults_->remove(TWV, TWA);
 		}
 
+	storeTelemetry(TWV,TWA);
+
 }
 
+// Solve the wind condition wc starting from x, with the fixed optimization vars
+bool VPPSolver::solve(const WindCondition& wc, Eigen::VectorXd& x) {
+
+	Eigen::VectorXd xs(x);
+	xs[2]= fixedB_;
+	xs[3]= fixedF_;
+
+	if(!VPPSolverBase::solve(wc,xs))
+		return false;
+
+	x= xs;
+	return true;
+}
 
 } // End namespace VPPSolver
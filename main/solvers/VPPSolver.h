@@ -27,6 +27,10 @@ class VPPSolver : public VPPSolverBase {
 		/// in the abstract base class
 		virtual void run(int TWV, int TWA);
 
+		/// Solve the wind condition wc starting from x, with the crew position
+		/// and the flat of x fixed as per the run. The solution is not stored
+		virtual bool solve(const WindCondition& wc, Eigen::VectorXd& x);
+
 	private:
 
 		/// This class is to be instantiated using a NLOptSolverFactory.
@@ -4,21 +4,22 @@
 #include <fstream>
 #include "mathUtils.h"
 #include "VPPResultIO.h"
+#include "VPPBinaryResultIO.h"
 
 using namespace mathUtils;
 
 //// VPPSolverBase class  //////////////////////////////////////////////
 // Init static member
-std::shared_ptr<VPPItemFactory> VPPSolverBase::pVppItemsContainer_;
 const Eigen::VectorXd VPPSolverBase::xp0_((Eigen::VectorXd(4) << .5, 0., 0., 1.).finished());
 
 // Constructor
 VPPSolverBase::VPPSolverBase(std::shared_ptr<VPPItemFactory> VPPItemFactory):
 																				dimension_(xp0_.size()),
 																				subPbSize_(2),
+																				gradientMode_(newtonFiniteDifferences),
 																				tol_(1.e-4) {
 
-	// Init the STATIC member vppItemsContainer
+	// Init the vppItemsContainer
 	pVppItemsContainer_= VPPItemFactory;
 
 	// Set the parser
@@ -39,9 +40,13 @@ VPPSolverBase::VPPSolverBase(std::shared_ptr<VPPItemFactory> VPPItemFactory):
 	// without optimization variables
 	nrSolver_.reset( new NRSolver(VPPItemFactory.get(),dimension_,subPbSize_) );
 
+	// Instantiate the continuation used to predict the initial guess and to
+	// recover the points the NRSolver cannot solve
+	pContinuation_.reset( new VPPContinuation(VPPItemFactory.get(),subPbSize_,nrSolver_.get()) );
+
 	// Instantiate a VPPGradient that will be used to compute the gradient
 	// of the objective function : the vector [ du/du du/dPhi du/db du/df ]
-	pGradient_.reset(new VPPGradient(xp0_,pVppItemsContainer_.get()) );
+	pGradient_.reset(new VPPGradient(xp0_,pVppItemsContainer_.get(),gradientMode_) );
 
 	// Resize the bound containers
 	lowerBounds_.resize(dimension_);
@@ -62,6 +67,7 @@ VPPSolverBase::VPPSolverBase(std::shared_ptr<VPPItemFactory> VPPItemFactory):
 VPPSolverBase::VPPSolverBase():
 						dimension_(xp0_.size()),
 						subPbSize_(2),
+						gradientMode_(newtonFiniteDifferences),
 						tol_(1.e-3),
 						pParser_(0),
 						pWind_(0){
@@ -75,7 +81,7 @@ VPPSolverBase::~VPPSolverBase() {
 // Reset the optimizer when reloading the initial data
 void VPPSolverBase::reset(std::shared_ptr<VPPItemFactory> VPPItemFactory) {
 
-	// Init the STATIC member vppItemsContainer
+	// Init the vppItemsContainer
 	pVppItemsContainer_= VPPItemFactory;
 
 	// Set the parser
@@ -88,58 +94,41 @@ void VPPSolverBase::reset(std::shared_ptr<VPPItemFactory> VPPItemFactory) {
 	// Init the ResultContainer that will be filled while running the results
 	pResults_.reset(new ResultContainer(pWind_));
 
+	// The NRSolver and the VPPGradient must operate on the new
+	// container, as the previous one might be destroyed. The settings of
+	// the NRSolver are kept
+	std::shared_ptr<NRSolver> pOldSolver= nrSolver_;
+	nrSolver_.reset( new NRSolver(pVppItemsContainer_.get(),dimension_,subPbSize_) );
+	nrSolver_->copySettings(*pOldSolver);
+	pContinuation_.reset( new VPPContinuation(pVppItemsContainer_.get(),subPbSize_,nrSolver_.get()) );
+	pGradient_.reset(new VPPGradient(xp0_,pVppItemsContainer_.get(),gradientMode_) );
+
 }
 
 // Set the initial guess for the state variable vector
 void VPPSolverBase::resetInitialGuess(int TWV, int TWA) {
 
 	// In it to something small to start the evals at each velocity
-	if(TWV==0) {
-
-		// This is the very first solution, so we must guess a solution
-		// but have nothing to establish our guess
-		if(TWA==0){
-			std::cout<<"==>> RE-INIT the solution to xp0_= "<<xp0_.transpose()<<std::endl;
-			xp_= xp0_;
-		}
-		else
-
-			if(!pResults_->get(TWV,TWA-1).discard())// In this case we have a solution at a previous angle we can use
-				// to set the guess
-				xp_ = *(pResults_->get(TWV,TWA-1).getX());
-			else
-				xp_= xp0_;
+	if(TWV<=1) {
 
-	}
-	else if( TWV==1 ) {
+		size_t vTW0, aTW0;
 
-		///////////////////
-
-		// IF twv==1 and twa==0, just take the solution of twv-1, 0
-		// if this is acceptable. Otherwise restart from x0
-		if(TWA==0){
-			if(!pResults_->get(TWV-1,TWA).discard())
-				xp_= *(pResults_->get(TWV-1,TWA).getX());
-			else
-				xp_= xp0_;
+		// This is the very first solution, or there is no converged neighbour
+		// to establish our guess : restart from x0
+		if(!getGuessNeighbour(TWV,TWA,vTW0,aTW0)) {
+			if(TWV==0 && TWA==0)
+				std::cout<<"==>> RE-INIT the solution to xp0_= "<<xp0_.transpose()<<std::endl;
+			xp_= xp0_;
 		}
-		// twv_==1 and twa_ > 0. Do as for twv_==0 : use the previous converged solution
-		else {
 
-			// If we have a result at the same speed and the previous angle, this should be the closest
-			// guess
-			if(!pResults_->get(TWV,TWA-1).discard())// In this case we have a solution at a previous angle we can use
-				xp_ = *(pResults_->get(TWV,TWA-1).getX());
+		// IF twv==1 and twa==0, predict from the solution of twv-1, 0
+		else if(TWA==0)
+			xp_= pContinuation_->predict(vTW0,aTW0,TWV,TWA,*pResults_->get(vTW0,aTW0).getX());
 
-			// ...otherwise, use the previous solution for the same angle
-			else if(!pResults_->get(TWV-1,TWA).discard())// In this case we have a solution at a previous angle we can use
-				xp_ = *(pResults_->get(TWV-1,TWA).getX());
+		// Otherwise use the converged solution of the neighbour
+		else
+			xp_ = *(pResults_->get(vTW0,aTW0).getX());
 
-			// ... If we have really nothing, just init with the first guess
-			else
-				xp_= xp0_;
-		}
-		///////////////////
 	}
 	else if( TWV>1 ) {
 
@@ -153,11 +142,16 @@ void VPPSolverBase::resetInitialGuess(int TWV, int TWA) {
 			size_t tmOne=getPreviousConverged(TWV,TWA);
 			size_t tmTwo=getPreviousConverged(tmOne,TWA);
 
+			// The extrapolator holds ptrs to the state vectors, keep the
+			// results alive while it is used
+			Result resTwo= pResults_->get(tmTwo,TWA);
+			Result resOne= pResults_->get(tmOne,TWA);
+
 			Extrapolator extrapolator(
-					pResults_->get(tmTwo,TWA).getTWV(),
-					pResults_->get(tmTwo,TWA).getX(),
-					pResults_->get(tmOne,TWA).getTWV(),
-					pResults_->get(tmOne,TWA).getX()
+					resTwo.getTWV(),
+					resTwo.getX(),
+					resOne.getTWV(),
+					resOne.getX()
 			);
 
 			// Extrapolate the state vector for the current wind
@@ -185,13 +179,46 @@ void VPPSolverBase::resetInitialGuess(int TWV, int TWA) {
 
 }
 
+// Returns the converged neighbour the initial guess of resetInitialGuess is built from
+bool VPPSolverBase::getGuessNeighbour(int TWV, int TWA, size_t& vTW0, size_t& aTW0) {
+
+	// For twv> 1 the guess is extrapolated from the previous converged
+	// velocities : the closest is the neighbour
+	if(TWV>1) {
+		try {
+			vTW0= getPreviousConverged(TWV,TWA);
+			aTW0= TWA;
+			return true;
+		} catch( NoPreviousConvergedException& e){
+			return false;
+		}
+	}
+
+	// If we have a result at the same speed and the previous angle, this should be the closest
+	// guess. Note that for twv==1 and twa==0 this is the solution of twv-1, 0
+	if(TWA>0 && !pResults_->discard(TWV,TWA-1)) {
+		vTW0= TWV;
+		aTW0= TWA-1;
+		return true;
+	}
+
+	// ...otherwise, use the previous solution for the same angle
+	if(TWV==1 && !pResults_->discard(TWV-1,TWA)) {
+		vTW0= TWV-1;
+		aTW0= TWA;
+		return true;
+	}
+
+	return false;
+}
+
 // Returns the index of the previous velocity-wise (twv) result that is marked as
 // converged (discard==false). It starts from 'current', so it can be used recursively
 size_t VPPSolverBase::getPreviousConverged(size_t idx, size_t TWA) {
 
 	while(idx){
 		idx--;
-		if(!pResults_->get(idx,TWA).discard())
+		if(!pResults_->discard(idx,TWA))
 			return idx;
 	}
 
@@ -200,10 +227,32 @@ size_t VPPSolverBase::getPreviousConverged(size_t idx, size_t TWA) {
 
 // Ask the NRSolver to solve a sub-problem without the optimization variables
 // this makes the initial guess an equilibrated solution
-void VPPSolverBase::solveInitialGuess(int TWV, int TWA) {
+bool VPPSolverBase::solveInitialGuess(int TWV, int TWA) {
+
+	// Solve a copy of the state vector, and only retain the sub-problem
+	Eigen::VectorXd xp(xp_);
+	if(!solveNR(TWV,TWA,xp))
+		return false;
+
+	setInitialGuess(xp);
+	return true;
+}
+
+// Same as solveInitialGuess(TWV,TWA), for the wind condition wc
+bool VPPSolverBase::solveInitialGuess(const WindCondition& wc) {
+
+	Eigen::VectorXd xp(xp_);
+	if(!solveNR(wc,xp))
+		return false;
 
-	// Get
-	xp_.block(0,0,2,1)= nrSolver_->run(TWV,TWA,xp_).block(0,0,2,1);
+	setInitialGuess(xp);
+	return true;
+}
+
+// Retain the sub-problem of the equilibrated state vector xp in the initial guess
+void VPPSolverBase::setInitialGuess(const Eigen::VectorXd& xp) {
+
+	xp_.block(0,0,2,1)= xp.block(0,0,2,1);
 
 	// Make sure the initial guess does not exceeds the bounds
 	for(size_t i=0; i<subPbSize_; i++) {
@@ -216,7 +265,83 @@ void VPPSolverBase::solveInitialGuess(int TWV, int TWA) {
 			xp_[i]=upperBounds_[i];
 		}
 	}
+}
+
+// Solve the sub-problem of x with the NRSolver for the grid point (TWV, TWA)
+bool VPPSolverBase::solveNR(int TWV, int TWA, Eigen::VectorXd& x) {
+	return solveNR(pWind_->getWindCondition(TWV,TWA),x);
+}
+
+// Solve the sub-problem of x with the NRSolver. If it does not converge and
+// wc is a point of the wind grid, march to the solution by continuation from
+// the closest converged neighbour
+bool VPPSolverBase::solveNR(const WindCondition& wc, Eigen::VectorXd& x) {
+
+	nrStatus_= nrSolver_->solve(wc,x);
+	if(nrStatus_.converged())
+		return true;
+
+	// The converged neighbours are only known on the wind grid
+	size_t TWV, TWA;
+	if(!pWind_->getWindIndices(wc,TWV,TWA))
+		return false;
+
+	// The closest converged neighbour : the previous velocity for the same
+	// angle, otherwise the previous angle for the same velocity. As for the
+	// initial guess, the previous angle is only used for twv<2 : these are
+	// the only points of the previous angle a parallel run imports
+	int vTW0=-1, aTW0=TWA;
+	try {
+		vTW0= getPreviousConverged(TWV,TWA);
+	} catch( NoPreviousConvergedException& e){
+		if(TWV<2 && TWA>0 && !pResults_->discard(TWV,TWA-1)) {
+			vTW0= TWV;
+			aTW0= TWA-1;
+		}
+	}
+	if(vTW0<0)
+		return false;
+
+	// Start from the solution of the neighbour, with the optimization variables of x
+	Eigen::VectorXd x0(x);
+	x0.block(0,0,subPbSize_,1)= pResults_->get(vTW0,aTW0).getX()->block(0,0,subPbSize_,1);
 
+	nrStatus_= pContinuation_->solve(pWind_->getWindCondition(vTW0,aTW0),wc,x0);
+	if(!nrStatus_.converged())
+		return false;
+
+	std::cout<<"NR-Solver recovered by continuation from tWv="<<vTW0<<" tWa="<<aTW0
+			<<" in "<<pContinuation_->getNumSteps()<<" steps"<<std::endl;
+
+	x= x0;
+	return true;
+}
+
+// Solve the wind condition wc starting from x. The solution is not stored
+bool VPPSolverBase::solve(const WindCondition& wc, Eigen::VectorXd& x) {
+
+	Eigen::VectorXd xs(x);
+	if(!solveNR(wc,xs))
+		return false;
+
+	// Reject the solutions out of the bounds rather than clipping them
+	for(size_t i=0; i<subPbSize_; i++)
+		if(xs[i]<lowerBounds_[i] || xs[i]>upperBounds_[i])
+			return false;
+
+	x= xs;
+	return true;
+}
+
+// Give up the current wind point because the NRSolver did not converge
+void VPPSolverBase::discardNonConverged(int TWV, int TWA) {
+
+	std::cout<<"WARNING: giving up tWv="<<TWV<<" and tWa="<<TWA<<", the NR-Solver did not converge"<<std::endl;
+
+	// Push to the result container a result to be discarded -> that won't be plot
+	pResults_->remove(TWV, TWA);
+
+	storeTelemetry(TWV,TWA);
 }
 
 // Returns the state vector for a given wind configuration
@@ -241,9 +366,16 @@ void VPPSolverBase::saveResults(string fileName) {
 
 }
 
-// Read results from file and places them in the current results
+// Read results from file and places them in the current results. The
+// format, binary or text, is detected from the file
 void VPPSolverBase::importResults(string fileName) {
 
+	if(VPPBinaryResultIO::isBinary(fileName)) {
+		VPPBinaryResultIO reader(pParser_,pResults_.get());
+		reader.read(fileName);
+		return;
+	}
+
 	VPPResultIO reader(pParser_,pResults_.get());
 	reader.parse(fileName);
 
@@ -256,6 +388,47 @@ void VPPSolverBase::printResultBounds() {
 
 }
 
+// Write the telemetry of the solver for each wind point to file
+void VPPSolverBase::exportTelemetry(string fileName) {
+
+	FILE* outStream= fopen(fileName.c_str(),"w");
+	if(!outStream) {
+		char msg[256];
+		sprintf(msg,"Cannot write the telemetry file \'%s\'",fileName.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	pResults_->printTelemetry(outStream);
+
+	fclose(outStream);
+}
+
+// Reset the telemetry of the items and start the wall clock
+void VPPSolverBase::startTelemetry() {
+	pVppItemsContainer_->getTelemetry().reset();
+	nrStatus_= NRStatus();
+	telemetryStart_= std::chrono::steady_clock::now();
+}
+
+// Store the telemetry of the wind point with its result
+void VPPSolverBase::storeTelemetry(int TWV, int TWA) {
+
+	SolverTelemetry& telemetry= pVppItemsContainer_->getTelemetry();
+	telemetry.wallTime_= std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - telemetryStart_).count();
+
+	// A wind point given up has no result, use the residuals of the NRSolver
+	if(nrStatus_.converged()) {
+		Result result= pResults_->get(TWV,TWA);
+		telemetry.residualNorm_= std::sqrt( result.getdF()*result.getdF() + result.getdM()*result.getdM() );
+	}
+	else
+		telemetry.residualNorm_= nrStatus_.residualNorm_;
+
+	pResults_->setTelemetry(TWV,TWA,telemetry);
+}
+
+#ifndef VPP_HEADLESS
 // Plot the polar plots for the state variables
 void VPPSolverBase::plotPolars(MultiplePlotWidget* pMultiPlotWidget) {
 
@@ -286,6 +459,7 @@ void VPPSolverBase::plotXY(MultiplePlotWidget* pMultiPlotWidget, WindIndicesDial
         }
     }
 }
+#endif
 
 // Returns the dimensionality of this problem (the size of the state vector)
 size_t VPPSolverBase::getDimension() const {
@@ -296,6 +470,37 @@ ResultContainer* VPPSolverBase::getResults() {
 	return pResults_.get();
 }
 
+// Returns the NRSolver used to refine the initial guess
+NRSolver* VPPSolverBase::getNRSolver() const {
+	return nrSolver_.get();
+}
+
+// Returns the status of the Newton-Raphson solutions of the last wind point
+const NRStatus& VPPSolverBase::getNRStatus() const {
+	return nrStatus_;
+}
+
+// Set the method used to compute the derivatives of the Jacobians
+void VPPSolverBase::setJacobianMode(jacobianMode mode) {
+	nrSolver_->setJacobianMode(mode);
+}
+
+// Get the method used to compute the derivatives of the Jacobians
+jacobianMode VPPSolverBase::getJacobianMode() const {
+	return nrSolver_->getJacobianMode();
+}
+
+// Set the method used to compute the gradient of the objective function
+void VPPSolverBase::setGradientMode(gradientMode mode) {
+	gradientMode_= mode;
+	pGradient_.reset(new VPPGradient(xp0_,pVppItemsContainer_.get(),gradientMode_) );
+}
+
+// Get the method used to compute the gradient of the objective function
+gradientMode VPPSolverBase::getGradientMode() const {
+	return gradientMode_;
+}
+
 
 
 
@@ -9,6 +9,7 @@
 #include "VPPItemFactory.h"
 #include "Results.h"
 #include "NRSolver.h"
+#include "VPPContinuation.h"
 #include "VPPGradient.h"
 
 using namespace std;
@@ -27,6 +28,14 @@ class VPPSolverBase {
 		/// Pure virtual used to execute a VPP-like analysis
 		virtual void run(int TWV, int TWA) =0;
 
+		/// Solve the wind condition wc, on the wind grid or not, starting from the
+		/// state vector x : typically the solution of a neighbouring condition.
+		/// On convergence x is replaced by the solution and true is returned,
+		/// otherwise x is unchanged. The solution is NOT stored in the result
+		/// container. The base implementation solves the equilibrium for the
+		/// optimization variables of x, the optimizers also optimize them
+		virtual bool solve(const WindCondition& wc, Eigen::VectorXd& x);
+
 		/// Returns the state vector for a given wind configuration
 		const Eigen::VectorXd getResult(int TWV, int TWA);
 
@@ -36,17 +45,23 @@ class VPPSolverBase {
 		/// Save the current results to file
 		void saveResults(string fileName);
 
-		/// Read results from file and places them in the current results
+		/// Read results from file and places them in the current results.
+		/// The file can be a text or a binary result file
 		void importResults(string fileName);
 
 		/// Make a printout of the result bounds for this run
 		void printResultBounds();
 
+		/// Write the telemetry of the solver for each wind point to file
+		void exportTelemetry(string fileName);
+
+#ifndef VPP_HEADLESS
 		/// Plot the polar plots for the state variables
 		void plotPolars(MultiplePlotWidget*);
 
 		/// Plot the XY results
 		void plotXY(MultiplePlotWidget*, WindIndicesDialog&);
+#endif
 
 		/// Returns the dimensionality of this problem (the size of the state vector)
 		size_t getDimension() const;
@@ -54,6 +69,30 @@ class VPPSolverBase {
 		/// Return a ptr to the results.
 		ResultContainer* getResults();
 
+		/// Returns the NRSolver used to refine the initial guess, i.e. to
+		/// change its mode or its tolerance
+		NRSolver* getNRSolver() const;
+
+		/// Returns the status of the Newton-Raphson solutions of the last
+		/// wind point. Not converged if the wind point was given up
+		const NRStatus& getNRStatus() const;
+
+		/// Set the method used to compute the derivatives of the Jacobians :
+		/// the ones of the NRSolver and, for ipOpt, the one of the constraints.
+		/// Stored by the NRSolver, so that it is copied with its settings
+		void setJacobianMode(jacobianMode);
+
+		/// Get the method used to compute the derivatives of the Jacobians
+		jacobianMode getJacobianMode() const;
+
+		/// Set the method used to compute the gradient of the objective function,
+		/// used by ipOpt : finite differences of Newton solves, or the implicit
+		/// function theorem. The gradient is rebuilt with the new mode
+		void setGradientMode(gradientMode);
+
+		/// Get the method used to compute the gradient of the objective function
+		gradientMode getGradientMode() const;
+
 		/// Declare the macro to allow for fixed size vector support
 		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -65,13 +104,46 @@ class VPPSolverBase {
 		/// Set the initial guess for the state variable vector
 		virtual void resetInitialGuess(int TWV, int TWA);
 
+		/// Returns in vTW0, aTW0 the converged neighbour the initial guess of
+		/// resetInitialGuess is built from : the previous converged velocity for
+		/// twv>1, otherwise the previous angle, or the previous velocity for twv==1.
+		/// Returns false if there is no such neighbour
+		bool getGuessNeighbour(int TWV, int TWA, size_t& vTW0, size_t& aTW0);
+
 		/// Returns the index of the previous velocity-wise (twv) result that is marked as
 		/// converged (discarde==false). It starts from 'current', so it can be used recursively
 		size_t getPreviousConverged(size_t current, size_t TWA);
 
 		/// Ask the NRSolver to solve a sub-problem without the optimization variables
-		/// this makes the initial guess an equilibrated solution
-		virtual void solveInitialGuess(int TWV, int TWA);
+		/// this makes the initial guess an equilibrated solution. Returns false
+		/// if the NRSolver did not converge, in which case xp_ is unchanged
+		virtual bool solveInitialGuess(int TWV, int TWA);
+
+		/// Same as solveInitialGuess(TWV,TWA), for the wind condition wc
+		bool solveInitialGuess(const WindCondition& wc);
+
+		/// Solve the sub-problem of x with the NRSolver for the grid point (TWV, TWA),
+		/// see solveNR(wc,x)
+		bool solveNR(int TWV, int TWA, Eigen::VectorXd& x);
+
+		/// Solve the sub-problem of x with the NRSolver for the wind condition wc.
+		/// If it does not converge and wc is a point of the wind grid, march to the
+		/// solution by continuation from the closest converged neighbour : the
+		/// neighbours are only known on the grid. Returns false if both fail, in
+		/// which case x is unchanged
+		bool solveNR(const WindCondition& wc, Eigen::VectorXd& x);
+
+		/// Give up the current wind point because the NRSolver did not converge:
+		/// discard its result and store the telemetry
+		void discardNonConverged(int TWV, int TWA);
+
+		/// Reset the telemetry of the items and start the wall clock.
+		/// To be called when starting to solve a wind point
+		void startTelemetry();
+
+		/// Store the telemetry of the wind point with its result. To be
+		/// called once the result has been pushed to the result container
+		void storeTelemetry(int TWV, int TWA);
 
 		/// Disallow default constructor
 		VPPSolverBase();
@@ -86,15 +158,25 @@ class VPPSolverBase {
 		/// initial guess to be handed to the optimizer
 		std::shared_ptr<NRSolver> nrSolver_;
 
-		/// VPPGradient used to compute the gradient by finite differences
+		/// Continuation used to predict the initial guess from the converged
+		/// neighbours, and to recover the points the NRSolver cannot solve
+		std::shared_ptr<VPPContinuation> pContinuation_;
+
+		/// VPPGradient used to compute the gradient of the objective function
 		std::shared_ptr<VPPGradient> pGradient_;
 
+		/// Method used by pGradient_ to compute the derivatives. Kept when
+		/// the gradient is rebuilt on reset
+		gradientMode gradientMode_;
+
 		/// lower and upper bounds for the state variables
 		std::vector<double> lowerBounds_,upperBounds_;
 
 		/// Ptr to the VPPItemFactory that contains all of the ingredients
-		/// required to compute the optimization constraints
-		static std::shared_ptr<VPPItemFactory> pVppItemsContainer_;
+		/// required to compute the optimization constraints. Each solver
+		/// owns its own, so that solvers built on different clones of the
+		/// factory can run concurrently
+		std::shared_ptr<VPPItemFactory> pVppItemsContainer_;
 
 		/// Ptr to the variableFileParser
 		VariableFileParser* pParser_;
@@ -111,8 +193,18 @@ class VPPSolverBase {
 		/// tolerance
 		double tol_;
 
+		/// Time the solution of the current wind point was started at
+		std::chrono::steady_clock::time_point telemetryStart_;
+
+		/// Status of the last Newton-Raphson solution of the current wind point
+		NRStatus nrStatus_;
+
 	private:
 
+		/// Retain the sub-problem of the equilibrated state vector xp in the
+		/// initial guess xp_, clipped to the bounds
+		void setInitialGuess(const Eigen::VectorXd& xp);
+
 		/// Declare a static const initial guess state vector
 		static const Eigen::VectorXd xp0_;
 
@@ -19,6 +19,21 @@ VPPSolverFactoryBase::~VPPSolverFactoryBase() {
 
 }
 
+// Solve the wind condition wc with the underlying solver
+bool VPPSolverFactoryBase::solve(const WindCondition& wc, Eigen::VectorXd& x) {
+	return get()->solve(wc,x);
+}
+
+// Returns a ptr to the items the solver is built on
+VPPItemFactory* VPPSolverFactoryBase::getVppItems() const {
+	return pVppItems_.get();
+}
+
+// By default a solver does not support concurrent runs
+VPPSolverFactoryBase* VPPSolverFactoryBase::clone() const {
+	return 0;
+}
+
 //////////////////////////////////////////////////////////////
 
 // Ctor
@@ -45,6 +60,14 @@ void SolverFactory::run(int TWV, int TWA) {
 	pSolver_->run(TWV,TWA);
 }
 
+// Returns a new SolverFactory built on a clone of the items, with the
+// same settings of the NRSolver
+SolverFactory* SolverFactory::clone() const {
+	SolverFactory* pClone= new SolverFactory( std::shared_ptr<VPPItemFactory>(pVppItems_->clone()) );
+	pClone->get()->getNRSolver()->copySettings( *pSolver_->getNRSolver() );
+	return pClone;
+}
+
 //////////////////////////////////////////////////////////////
 
 // Ctor
@@ -69,6 +92,46 @@ void NLOptSolverFactory::run(int TWV, int TWA) {
 	pSolver_->run(TWV,TWA);
 }
 
+// Returns a new NLOptSolverFactory built on a clone of the items, with the
+// same settings of the NRSolver
+NLOptSolverFactory* NLOptSolverFactory::clone() const {
+	NLOptSolverFactory* pClone= new NLOptSolverFactory( std::shared_ptr<VPPItemFactory>(pVppItems_->clone()) );
+	pClone->get()->getNRSolver()->copySettings( *pSolver_->getNRSolver() );
+	return pClone;
+}
+
+//////////////////////////////////////////////////////////////
+
+// Ctor
+NLOptSLSQPSolverFactory::NLOptSLSQPSolverFactory(std::shared_ptr<VPPItemFactory> pVppItems) :
+		VPPSolverFactoryBase(pVppItems),
+		pSolver_(new NLOptSolver(pVppItems,nlopt::LD_SLSQP) ){
+}
+
+// Virtual Dtor
+NLOptSLSQPSolverFactory::~NLOptSLSQPSolverFactory() {
+
+}
+
+// Implement pure virtual declared in the mother class
+// Returns a reference to the underlying problem representation
+NLOptSolver* NLOptSLSQPSolverFactory::get() const {
+	return pSolver_.get();
+}
+
+// Implement pure virtual used to execute a VPP-like analysis
+void NLOptSLSQPSolverFactory::run(int TWV, int TWA) {
+	pSolver_->run(TWV,TWA);
+}
+
+// Returns a new NLOptSLSQPSolverFactory built on a clone of the items, with the
+// same settings of the NRSolver
+NLOptSLSQPSolverFactory* NLOptSLSQPSolverFactory::clone() const {
+	NLOptSLSQPSolverFactory* pClone= new NLOptSLSQPSolverFactory( std::shared_ptr<VPPItemFactory>(pVppItems_->clone()) );
+	pClone->get()->getNRSolver()->copySettings( *pSolver_->getNRSolver() );
+	return pClone;
+}
+
 //////////////////////////////////////////////////////////////
 
 // Ctor
@@ -94,13 +157,24 @@ void SAOASolverFactory::run(int TWV, int TWA) {
 	pSolver_->run(TWV,TWA);
 }
 
+// Returns a new SAOASolverFactory built on a clone of the items, with the
+// same settings of the NRSolver and of the sampling
+SAOASolverFactory* SAOASolverFactory::clone() const {
+	SAOASolverFactory* pClone= new SAOASolverFactory( std::shared_ptr<VPPItemFactory>(pVppItems_->clone()) );
+	pClone->get()->getNRSolver()->copySettings( *pSolver_->getNRSolver() );
+	pClone->get()->setSampling( pSolver_->getSampling() );
+	pClone->get()->setNumThreads( pSolver_->getNumThreads() );
+	return pClone;
+}
+
 //////////////////////////////////////////////////////////////
 
 // Ctor
 IpOptSolverFactory::IpOptSolverFactory(std::shared_ptr<VPPItemFactory> pVppItems) :
 		VPPSolverFactoryBase(pVppItems),
 		pApp_(IpoptApplicationFactory()),
-		pSolver_(new VPP_NLP(pVppItems)) {
+		pSolver_(new VPP_NLP(pVppItems)),
+		numericalHessian_(false) {
 
 	pApp_->Options()->SetNumericValue("tol", 1e-3);
 	pApp_->Options()->SetStringValue("mu_strategy", "adaptive");
@@ -139,16 +213,65 @@ VPP_NLP* IpOptSolverFactory::get() const {
 	return &(*pSolver_);
 }
 
+// Use the Hessian of the Lagrangian of VPPHessian rather than the limited-memory
+// approximation. The options are read by ipOpt at each optimization
+void IpOptSolverFactory::setNumericalHessian(bool numericalHessian) {
+	numericalHessian_= numericalHessian;
+	pApp_->Options()->SetStringValue("hessian_approximation",
+			numericalHessian_ ? "exact" : "limited-memory");
+}
+
+// Returns true if ipOpt uses the Hessian of the Lagrangian of VPPHessian
+bool IpOptSolverFactory::getNumericalHessian() const {
+	return numericalHessian_;
+}
+
+// Dereference the smart ptr and return the ipOpt application
+IpoptApplication* IpOptSolverFactory::getApplication() const {
+	return &(*pApp_);
+}
+
+// Note that IpOptSolverFactory does not override clone : the linear
+// solver used by ipOpt is not re-entrant, so ipOpt runs are serial
+
 // Implement pure virtual used to execute a VPP-like analysis
 void IpOptSolverFactory::run(int vTW, int aTW) {
 
 	// Set the wind indexes
 	pSolver_->run(vTW,aTW);
 
+	// Start from the primal-dual solution of the neighbour, if any, with
+	// a small barrier parameter and small pushes off the bounds. The
+	// options are read by ipOpt at each optimization
+	if(pSolver_->isWarmStarted()) {
+		pApp_->Options()->SetStringValue("warm_start_init_point", "yes");
+		pApp_->Options()->SetNumericValue("mu_init", 1e-6);
+		pApp_->Options()->SetNumericValue("warm_start_bound_push", 1e-6);
+		pApp_->Options()->SetNumericValue("warm_start_mult_bound_push", 1e-6);
+	}
+	else {
+		pApp_->Options()->SetStringValue("warm_start_init_point", "no");
+		pApp_->Options()->SetNumericValue("mu_init", 0.1);
+	}
+
 	ApplicationReturnStatus status= pApp_->OptimizeTNLP(pSolver_);
 
 	if ( status != Solve_Succeeded )
 		throw NonConvergedException(HERE,"ipOpt failed to find the solution!");
 }
 
+// Optimize the wind condition wc with ipOpt, starting from x. Off the wind
+// grid the runs are never warm started
+bool IpOptSolverFactory::solve(const WindCondition& wc, Eigen::VectorXd& x) {
+
+	pSolver_->run(wc,x);
+
+	pApp_->Options()->SetStringValue("warm_start_init_point", "no");
+	pApp_->Options()->SetNumericValue("mu_init", 0.1);
+
+	pApp_->OptimizeTNLP(pSolver_);
+
+	return pSolver_->getOffGridSolution(x);
+}
+
 } // End namespace Optim
@@ -42,6 +42,19 @@ class VPPSolverFactoryBase {
 		/// Pure virtual used to execute a VPP-like analysis
 		virtual void run(int TWV, int TWA) =0;
 
+		/// Solve the wind condition wc, on the wind grid or not, starting from
+		/// the state vector x. On convergence x is replaced by the solution and
+		/// true is returned. The solution is not stored, see VPPSolverBase::solve
+		virtual bool solve(const WindCondition& wc, Eigen::VectorXd& x);
+
+		/// Returns a ptr to the items the solver is built on
+		VPPItemFactory* getVppItems() const;
+
+		/// Returns a new factory of the same type, built on a clone of the
+		/// items, that can be run concurrently with this one. Returns 0 if
+		/// the solver does not support concurrent runs. Caller owns
+		virtual VPPSolverFactoryBase* clone() const;
+
 	protected:
 
 		/// Disallow default constructor
@@ -72,6 +85,10 @@ class SolverFactory : public VPPSolverFactoryBase {
 		/// Implement pure virtual used to execute a VPP-like analysis
 		virtual void run(int TWV, int TWA);
 
+		/// Returns a new SolverFactory built on a clone of the items, with the
+		/// same settings of the NRSolver
+		virtual SolverFactory* clone() const;
+
 	private:
 
 		/// Ptr to the problem representation
@@ -99,6 +116,10 @@ class NLOptSolverFactory : public VPPSolverFactoryBase {
 		/// Implement pure virtual used to execute a VPP-like analysis
 		virtual void run(int TWV, int TWA);
 
+		/// Returns a new NLOptSolverFactory built on a clone of the items, with the
+		/// same settings of the NRSolver
+		virtual NLOptSolverFactory* clone() const;
+
 	private:
 
 		/// Ptr to the problem representation
@@ -107,6 +128,40 @@ class NLOptSolverFactory : public VPPSolverFactoryBase {
 };
 
 
+//////////////////////////////////////////////////////////////
+
+/// Wraps up the nlOpt optimizer with the gradient-based SLSQP algorithm.
+/// The constraints are handed their exact derivatives wrt all the state
+/// variables, so that each wind point requires far fewer evaluations of
+/// the items than with the derivative-free COBYLA
+class NLOptSLSQPSolverFactory : public VPPSolverFactoryBase {
+
+	public:
+
+		/// Ctor
+		NLOptSLSQPSolverFactory(std::shared_ptr<VPPItemFactory>);
+
+		/// Virtual Dtor
+		virtual ~NLOptSLSQPSolverFactory();
+
+		/// Implement pure virtual declared in the mother class
+		/// Returns a reference to the underlying problem representation
+		NLOptSolver* get() const;
+
+		/// Implement pure virtual used to execute a VPP-like analysis
+		virtual void run(int TWV, int TWA);
+
+		/// Returns a new NLOptSLSQPSolverFactory built on a clone of the items, with
+		/// the same settings of the NRSolver
+		virtual NLOptSLSQPSolverFactory* clone() const;
+
+	private:
+
+		/// Ptr to the problem representation
+		std::shared_ptr<NLOptSolver> pSolver_;
+
+};
+
 //////////////////////////////////////////////////////////////
 
 /// Wraps up the nlOpt optimizer
@@ -127,6 +182,10 @@ class SAOASolverFactory : public VPPSolverFactoryBase {
 		/// Implement pure virtual used to execute a VPP-like analysis
 		virtual void run(int TWV, int TWA);
 
+		/// Returns a new SAOASolverFactory built on a clone of the items, with the
+		/// same settings of the NRSolver and of the sampling
+		virtual SAOASolverFactory* clone() const;
+
 	private:
 
 		/// Ptr to the problem representation
@@ -154,6 +213,22 @@ class IpOptSolverFactory : public VPPSolverFactoryBase {
 		/// Implement pure virtual used to execute a VPP-like analysis
 		virtual void run(int TWV, int TWA);
 
+		/// Optimize the wind condition wc with ipOpt, starting from x. The
+		/// solution is not stored in the results
+		virtual bool solve(const WindCondition& wc, Eigen::VectorXd& x);
+
+		/// Hand ipOpt the Hessian of the Lagrangian computed by VPPHessian, by
+		/// finite differences of the AD gradients, rather than the limited-memory
+		/// quasi-Newton approximation of ipOpt. Default : false
+		void setNumericalHessian(bool);
+
+		/// Returns true if ipOpt uses the Hessian of the Lagrangian of VPPHessian
+		bool getNumericalHessian() const;
+
+		/// Returns the ipOpt application, to change its options. The output
+		/// file is only opened when the application is initialized
+		IpoptApplication* getApplication() const;
+
 	private:
 
 		/// Ptr to the problem representation
@@ -162,6 +237,9 @@ class IpOptSolverFactory : public VPPSolverFactoryBase {
 		/// Ptr to the ipOpt solver
 		SmartPtr<IpoptApplication> pApp_;
 
+		/// Use the Hessian of VPPHessian rather than the limited-memory approximation
+		bool numericalHessian_;
+
 };
 } // End namespace optim
 
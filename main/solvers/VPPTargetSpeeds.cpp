@@ -0,0 +1,273 @@
+#include "VPPTargetSpeeds.h"
+#include "VPPException.h"
+#include <limits>
+
+const string VPPTargetSpeeds::headerBegin_=string("==TARGET SPEEDS==");
+const string VPPTargetSpeeds::headerEnd_=string("==END TARGET SPEEDS==");
+
+// Ctor
+VMGOptimum::VMGOptimum():
+		twa_(0),
+		vmg_(0),
+		nSolves_(0),
+		valid_(false) {
+
+}
+
+// Ctor
+VPPTargetSpeeds::VPPTargetSpeeds(VPPSolverFactoryBase* pSf, double tol/*=toRad(0.1)*/):
+		pSf_(pSf),
+		tol_(tol),
+		maxIters_(30),
+		nSolves_(0) {
+
+}
+
+// Dtor
+VPPTargetSpeeds::~VPPTargetSpeeds() {
+
+}
+
+// Solve the beat and run angles of all the wind velocities
+void VPPTargetSpeeds::run() {
+
+	for(size_t iWv=0; iWv<pSf_->get()->getResults()->windVelocitySize(); iWv++)
+		run(iWv);
+}
+
+// Solve the beat and run angles of the wind velocity iWv
+void VPPTargetSpeeds::run(size_t iWv) {
+
+	ResultContainer* pResults= pSf_->get()->getResults();
+	targets_.resize(pResults->windVelocitySize());
+
+	TargetSpeed& target= targets_.at(iWv);
+	target.twv_= pResults->getWind()->getTWV(iWv);
+	target.beat_= optimize(iWv,1);
+	target.run_= optimize(iWv,-1);
+
+	std::cout<<"vTW="<<iWv<<"  beat: "<<target.beat_.nSolves_<<" solves,"
+			<<"  run: "<<target.run_.nSolves_<<" solves"<<std::endl;
+}
+
+// Number of wind velocities in the target speed table
+size_t VPPTargetSpeeds::size() const {
+	return targets_.size();
+}
+
+// Get the target speeds of the wind velocity iWv
+const TargetSpeed& VPPTargetSpeeds::get(size_t iWv) const {
+
+	if(iWv>=targets_.size())
+		throw VPPException(HERE,"In VPPTargetSpeeds::get, requested out-of-bounds iWv!");
+
+	return targets_[iWv];
+}
+
+// Compute the optimum VMG of the wind velocity iWv, upwind or downwind
+VMGOptimum VPPTargetSpeeds::optimize(size_t iWv, double sign) {
+
+	ResultContainer* pResults= pSf_->get()->getResults();
+	const WindItem* pWind= pResults->getWind();
+	double twv= pWind->getTWV(iWv);
+
+	VMGOptimum optimum;
+
+	// Best converged grid angle on the side of the optimum : cos(twa)>0 upwind,
+	// cos(twa)<0 downwind. The objective is -VMG, to be minimized. The boat speeds
+	// of the grid results are read from the columns of the container
+	ResultContainer::ColumnView twaGrid= pResults->getVelocityView(TableResultType::twa,iWv);
+	ResultContainer::ColumnView uGrid= pResults->getVelocityView(TableResultType::u,iWv);
+	size_t nWa= pResults->windAngleSize(), iBest=nWa;
+	double fx= std::numeric_limits<double>::max();
+	for(size_t iWa=0; iWa<nWa; iWa++) {
+
+		if(pResults->discard(iWv,iWa) || sign*cos(twaGrid(iWa))<=0)
+			continue;
+
+		double f= -sign * uGrid(iWa) * cos(twaGrid(iWa));
+		if(f<fx) {
+			fx= f;
+			iBest= iWa;
+		}
+	}
+
+	if(iBest==nWa)
+		return optimum;
+
+	// The optimum is bracketed by the neighbours of the best grid angle
+	double a= pWind->getTWA( iBest ? iBest-1 : iBest );
+	double b= pWind->getTWA( iBest+1<nWa ? iBest+1 : iBest );
+	double x= pWind->getTWA(iBest);
+	Eigen::VectorXd xBest= *pResults->get(iWv,iBest).getX();
+
+	// The grid result is the first warm start
+	trialTwa_.assign(1,x);
+	trialX_.assign(1,xBest);
+	nSolves_=0;
+
+	// Brent's method : parabolic interpolation through the three best
+	// points x, w, v, with golden-section steps when the parabola cannot
+	// be trusted. See Brent, Algorithms for minimization without derivatives
+	const double cGold= 0.5 * (3. - sqrt(5.));
+	double w=x, v=x, fw=fx, fv=fx, d=0, e=0;
+
+	for(size_t iter=0; iter<maxIters_; iter++) {
+
+		double xm= 0.5 * (a+b);
+		double tol1= tol_ + std::numeric_limits<double>::epsilon() * fabs(x);
+		double tol2= 2 * tol1;
+
+		// Converged : the bracket is narrower than the tolerance
+		if(fabs(x-xm) <= tol2 - 0.5*(b-a))
+			break;
+
+		bool golden= true;
+		if(fabs(e) > tol1) {
+
+			// Fit a parabola
+			double r= (x-w) * (fx-fv);
+			double q= (x-v) * (fx-fw);
+			double p= (x-v)*q - (x-w)*r;
+			q= 2 * (q-r);
+			if(q>0)
+				p= -p;
+			q= fabs(q);
+			double eTemp= e;
+			e= d;
+
+			// Accept the parabolic step if it falls within the bracket and
+			// is smaller than half the step before last
+			if(fabs(p) < fabs(0.5*q*eTemp) && p > q*(a-x) && p < q*(b-x)) {
+				d= p/q;
+				double u= x+d;
+				if(u-a < tol2 || b-u < tol2)
+					d= xm-x >= 0 ? tol1 : -tol1;
+				golden= false;
+			}
+		}
+
+		if(golden) {
+			e= x>=xm ? a-x : b-x;
+			d= cGold * e;
+		}
+
+		// Never evaluate closer than tol1 to x
+		double u= fabs(d)>=tol1 ? x+d : x + (d>=0 ? tol1 : -tol1);
+		double fu= evaluate(twv,u,sign);
+
+		if(fu<=fx) {
+			if(u>=x)
+				a= x;
+			else
+				b= x;
+			v= w; fv= fw;
+			w= x; fw= fx;
+			x= u; fx= fu;
+			xBest= trialX_.back();
+		} else {
+			if(u<x)
+				a= u;
+			else
+				b= u;
+			if(fu<=fw || w==x) {
+				v= w; fv= fw;
+				w= u; fw= fu;
+			} else if(fu<=fv || v==x || v==w) {
+				v= u; fv= fu;
+			}
+		}
+	}
+
+	optimum.twa_= x;
+	optimum.vmg_= -fx;
+	optimum.x_= xBest;
+	optimum.nSolves_= nSolves_;
+	optimum.valid_= true;
+
+	return optimum;
+}
+
+// Solve the wind angle twa starting from the closest converged trial
+double VPPTargetSpeeds::evaluate(double twv, double twa, double sign) {
+
+	size_t iClosest=0;
+	for(size_t i=1; i<trialTwa_.size(); i++)
+		if(fabs(trialTwa_[i]-twa) < fabs(trialTwa_[iClosest]-twa))
+			iClosest= i;
+
+	Eigen::VectorXd x= trialX_[iClosest];
+	nSolves_++;
+
+	bool converged=false;
+	try {
+		converged= pSf_->solve(WindCondition(twv,twa),x);
+	} catch(NonConvergedException& e) {
+		std::cout<<"A NonConvergedException was catched..."<<std::endl;
+		std::cout<<e.what()<<std::endl;
+	} catch(VPPException& e) {
+		// The model cannot be evaluated at this angle, e.g. NaN forces :
+		// the search treats it as a non converged trial
+		std::cout<<"A VPPException was catched..."<<std::endl;
+		std::cout<<e.what()<<std::endl;
+	}
+
+	if(!converged)
+		return std::numeric_limits<double>::max();
+
+	trialTwa_.push_back(twa);
+	trialX_.push_back(x);
+
+	return -sign * x(0) * cos(twa);
+}
+
+// Printout the target speed table
+void VPPTargetSpeeds::print(FILE* outStream) const {
+
+	fprintf(outStream,"\n%%  TWV   --  BEAT: TWA    V    VMG    PHI  nSolves valid  --  RUN: TWA    V    VMG    PHI  nSolves valid \n");
+	fprintf(outStream,  "%%---------------------------------------------------------------------------------------------------------\n");
+	fprintf(outStream,  "%% [m/s]  --        [º]  [m/s] [m/s]  [º]    [-]    [-]   --       [º]  [m/s] [m/s]  [º]    [-]    [-]   \n");
+	fprintf(outStream,  "%%---------------------------------------------------------------------------------------------------------\n");
+
+	fprintf(outStream,"%s\n",headerBegin_.c_str());
+
+	for(size_t iWv=0; iWv<targets_.size(); iWv++) {
+		fprintf(outStream,"%8.6f  --", targets_[iWv].twv_);
+		print(outStream,targets_[iWv].beat_);
+		fprintf(outStream,"  --");
+		print(outStream,targets_[iWv].run_);
+		fprintf(outStream,"\n");
+	}
+
+	fprintf(outStream,"%s\n",headerEnd_.c_str());
+}
+
+// Printout the columns of an optimum
+void VPPTargetSpeeds::print(FILE* outStream, const VMGOptimum& optimum) {
+
+	double u=0, phi=0;
+	if(optimum.x_.size()) {
+		u= optimum.x_(0);
+		phi= optimum.x_(1);
+	}
+
+	fprintf(outStream,"  %8.6f  %8.6e  %8.6e  %8.6f  %zu  %i",
+			mathUtils::toDeg(optimum.twa_), u, optimum.vmg_, mathUtils::toDeg(phi),
+			optimum.nSolves_, optimum.valid_ );
+}
+
+// Write the target speed table to file
+void VPPTargetSpeeds::write(string fileName) const {
+
+	FILE* outFile= fopen(fileName.c_str(),"w");
+	if(!outFile) {
+		char msg[256];
+		sprintf(msg,"Cannot write the target speed file \'%s\'",fileName.c_str());
+		throw VPPException(HERE,msg);
+	}
+
+	std::cout<<"Saving the target speeds to file "<<fileName<<std::endl;
+
+	print(outFile);
+	fclose(outFile);
+}
@@ -0,0 +1,122 @@
+#ifndef VPPTARGETSPEEDS_H
+#define VPPTARGETSPEEDS_H
+
+#include <stdio.h>
+#include <vector>
+#include <Eigen/Core>
+
+#include "VPPSolverFactoryBase.h"
+#include "mathUtils.h"
+
+using namespace Optim;
+
+/// Optimum VMG sailing angle for a wind velocity, upwind or downwind
+struct VMGOptimum {
+
+	/// Ctor
+	VMGOptimum();
+
+	/// True wind angle [rad] and VMG [m/s] of the optimum. The VMG is
+	/// positive both upwind and downwind
+	double twa_, vmg_;
+
+	/// State vector of the optimum
+	Eigen::VectorXd x_;
+
+	/// Number of equilibrium solves required to find the optimum
+	size_t nSolves_;
+
+	/// False if the optimum could not be computed
+	bool valid_;
+};
+
+/// Target speeds for a wind velocity : optimum beat and run
+struct TargetSpeed {
+
+	/// True wind velocity [m/s]
+	double twv_;
+
+	/// Optimum upwind and downwind VMG
+	VMGOptimum beat_, run_;
+};
+
+/// Direct solution of the optimum VMG angles, for each wind velocity. The
+/// beat angle maximizes u*cos(twa) and the run angle maximizes -u*cos(twa)
+/// over a continuous twa, so their accuracy does not depend on the number of
+/// wind angles of the grid. The grid results only bracket the optima : the
+/// best grid angle of each side and its neighbours. Brent's method then
+/// locates the optimum within the bracket, each trial angle being solved with
+/// VPPSolverFactoryBase::solve starting from the closest angle already solved.
+/// A coarse grid is thus enough, and each optimum takes 10-15 solves
+class VPPTargetSpeeds {
+
+	public:
+
+		/// Ctor. The optimum angles are located within tol [rad]
+		VPPTargetSpeeds(VPPSolverFactoryBase* pSf, double tol=mathUtils::toRad(0.1));
+
+		/// Dtor
+		~VPPTargetSpeeds();
+
+		/// Solve the beat and run angles of all the wind velocities
+		void run();
+
+		/// Solve the beat and run angles of the wind velocity iWv
+		void run(size_t iWv);
+
+		/// Number of wind velocities in the target speed table
+		size_t size() const;
+
+		/// Get the target speeds of the wind velocity iWv
+		const TargetSpeed& get(size_t iWv) const;
+
+		/// Printout the target speed table. Use stdout as default stream
+		void print(FILE* outStream=stdout) const;
+
+		/// Write the target speed table to file
+		void write(string fileName) const;
+
+		/// Header of the target speed section in a file
+		static const string headerBegin_, headerEnd_;
+
+	private:
+
+		/// Disallow default ctor
+		VPPTargetSpeeds();
+
+		/// Compute the optimum VMG of the wind velocity iWv upwind (sign=1) or
+		/// downwind (sign=-1). Invalid if there is no converged grid result
+		/// on that side
+		VMGOptimum optimize(size_t iWv, double sign);
+
+		/// Solve the wind angle twa of the wind velocity twv, starting from the
+		/// closest converged trial, and return -sign*VMG. Returns
+		/// std::numeric_limits<double>::max() if the solver does not converge
+		double evaluate(double twv, double twa, double sign);
+
+		/// Printout the columns of an optimum
+		static void print(FILE* outStream, const VMGOptimum&);
+
+		/// Ptr to the solver factory the grid has been solved with
+		VPPSolverFactoryBase* pSf_;
+
+		/// Tolerance on the optimum angles [rad]
+		double tol_;
+
+		/// Maximum number of iterations of Brent's method
+		size_t maxIters_;
+
+		/// Angles solved while locating the current optimum, and their solutions.
+		/// Only the converged trials are retained
+		std::vector<double> trialTwa_;
+		std::vector<Eigen::VectorXd> trialX_;
+
+		/// Number of solves for the current optimum
+		size_t nSolves_;
+
+		/// Target speeds, one per wind velocity
+		std::vector<TargetSpeed> targets_;
+
+};
+
+#endif
@@ -10,8 +10,10 @@
 
 #include <cassert>
 #include <iostream>
+#include <algorithm>
 #include "VPPException.h"
 #include "VPPJacobian.h"
+#include "VPPHessian.h"
 #include "VPPException.h"
 #include "VPPResultIO.h"
 
@@ -20,21 +22,38 @@ using namespace Eigen;
 
 namespace Optim {
 
-// Declare and init static members
-size_t VPP_NLP::twa_=0, VPP_NLP::twv_=0;
-
 //////////////
 
 // Disallowed default constructor
 VPP_NLP::VPP_NLP():
-		nEqualityConstraints_(0) {
+		nEqualityConstraints_(0),
+		twa_(0),
+		twv_(0),
+		onGrid_(true),
+		offGridConverged_(false),
+		isGCurrent_(false),
+		isJacCurrent_(false),
+		isGradCurrent_(false),
+		isHessCurrent_(false),
+		warmStart_(false),
+		pWarmStart_(0) {
 
 }
 
 // Constructor with ptr to then VPPItemFactory
 VPP_NLP::VPP_NLP(std::shared_ptr<VPPItemFactory> pVppItemsContainer):
 		VPPSolverBase(pVppItemsContainer),
-				nEqualityConstraints_(2) {
+				nEqualityConstraints_(2),
+				twa_(0),
+				twv_(0),
+				onGrid_(true),
+				offGridConverged_(false),
+				isGCurrent_(false),
+				isJacCurrent_(false),
+				isGradCurrent_(false),
+				isHessCurrent_(false),
+				warmStart_(false),
+				pWarmStart_(0) {
 
 }
 
@@ -43,6 +62,16 @@ VPP_NLP::~VPP_NLP(){
 
 }
 
+// Decorator for the mother class method reset. The multipliers of the
+// previous data must not warm start the new run
+void VPP_NLP::reset(std::shared_ptr<VPPItemFactory> pVppItemsContainer) {
+
+	VPPSolverBase::reset(pVppItemsContainer);
+
+	multipliers_.clear();
+	pWarmStart_= 0;
+}
+
 // Returns the size of the problem
 bool VPP_NLP::get_nlp_info(int& dimension, int& nEqualityConstraints, int& nnz_jac_g,
 		int& nnz_h_lag, IndexStyleEnum& int_style) {
@@ -67,10 +96,10 @@ bool VPP_NLP::get_nlp_info(int& dimension, int& nEqualityConstraints, int& nnz_j
 	// compute the full jacobian then!
 	nnz_jac_g = dimension_ * nEqualityConstraints_;
 
-	// The hessian is also dense and has 16 total non-zeros, but
-	// a priori we do not need it because we have set
-	// hessian_approximation","limited-memory"
-	nnz_h_lag = 10;
+	// The hessian of the Lagrangian is also dense and has 16 total non-zeros.
+	// It is symmetric, so only the 10 entries of the lower triangle are given.
+	// Only requested if hessian_approximation is "exact"
+	nnz_h_lag = dimension_ * (dimension_+1) / 2;
 
 	// Use the C style Ipopt::Indexing (0-based)
 	int_style = TNLP::C_STYLE;
@@ -142,12 +171,11 @@ bool VPP_NLP::get_starting_point(int n, bool init_x, double* x,
 		int m, bool init_lambda,
 		double* lambda) {
 
-	// Here, we assume we only have starting values for x, if you code
-	// your own NLP, you can provide starting values for the dual variables
-	// if you wish
+	// We always have starting values for x. Ipopt only asks for the
+	// dual variables when warm starting from a neighbour
 	assert(init_x == true);
-	assert(init_z == false);
-	assert(init_lambda == false);
+	assert(pWarmStart_ || init_z == false);
+	assert(pWarmStart_ || init_lambda == false);
 
 	///////////// Transfer the code of VPPSolverBase::resetInitialGuess ///////////////
 	// Use an Eigen::Map to manipulate the solution buffer x
@@ -156,8 +184,13 @@ bool VPP_NLP::get_starting_point(int n, bool init_x, double* x,
 	// Update the value of the current state vector
 	xp_=xp;
 
-	// Call the parent class method to make a guess of the solution
-	resetInitialGuess(twv_, twa_);
+	// Call the parent class method to make a guess of the solution. Off the
+	// wind grid, start from the state vector handed to run, within the bounds
+	if(onGrid_)
+		resetInitialGuess(twv_, twa_);
+	else
+		for(size_t i=0; i<dimension_; i++)
+			xp_[i]= std::min( std::max(xOffGrid_[i],lowerBounds_[i]), upperBounds_[i] );
 
 	// Do NOT use the NR solve to make the guess more realistic
 	// For some reason, attemtping to use the solver leads Newton
@@ -170,6 +203,18 @@ bool VPP_NLP::get_starting_point(int n, bool init_x, double* x,
 	for(size_t i=0; i<xp_.size(); i++)
 		x[i]=xp_(i);
 
+	// Start from the multipliers of the neighbour. The primal guess above is
+	// extrapolated from the same neighbour, so the two are consistent
+	if(init_z)
+		for(size_t i=0; i<n; i++) {
+			z_L[i]= pWarmStart_->zL_(i);
+			z_U[i]= pWarmStart_->zU_(i);
+		}
+
+	if(init_lambda)
+		for(size_t i=0; i<m; i++)
+			lambda[i]= pWarmStart_->lambda_(i);
+
 	return true;
 }
 
@@ -178,6 +223,10 @@ bool VPP_NLP::eval_f(int n, const double* x, bool new_x, double& obj_value) {
 
 	assert(n == dimension_);
 
+	setNewX(new_x);
+
+	pVppItemsContainer_->getTelemetry().nEvaluations_++;
+
 	// Maximize speed
 	obj_value = x[0];
 
@@ -188,6 +237,75 @@ bool VPP_NLP::eval_f(int n, const double* x, bool new_x, double& obj_value) {
 void VPP_NLP::run(int twv, int twa) {
 	twa_= twa;
 	twv_= twv;
+	wc_= pWind_->getWindCondition(twv,twa);
+	onGrid_= true;
+
+	// The stored values refer to the previous wind
+	setNewX(true);
+
+	// Pick the multipliers of the neighbour the initial guess is built from
+	pWarmStart_= 0;
+	size_t vTW0, aTW0;
+	if(warmStart_ && getGuessNeighbour(twv,twa,vTW0,aTW0)) {
+		std::map< std::pair<size_t,size_t>, Multipliers >::const_iterator it=
+				multipliers_.find( std::make_pair(vTW0,aTW0) );
+		if(it!=multipliers_.end())
+			pWarmStart_= &(it->second);
+	}
+
+	startTelemetry();
+}
+
+// Set the wind condition wc, on the wind grid or not, and the initial guess x
+// for this run. The solution is not stored in the results
+void VPP_NLP::run(const WindCondition& wc, const Eigen::VectorXd& x) {
+	wc_= wc;
+	onGrid_= false;
+	xOffGrid_= x;
+	offGridConverged_= false;
+
+	// The stored values refer to the previous wind, and the multipliers
+	// are only stored for the grid points
+	setNewX(true);
+	pWarmStart_= 0;
+}
+
+// Returns the solution of the last off-grid run, see run(wc,x)
+bool VPP_NLP::getOffGridSolution(Eigen::VectorXd& x) const {
+	if(!offGridConverged_)
+		return false;
+	x= xOffGrid_;
+	return true;
+}
+
+// Off the wind grid, ipOpt is run by the IpOptSolverFactory
+bool VPP_NLP::solve(const WindCondition& wc, Eigen::VectorXd& x) {
+	throw VPPException(HERE,"VPP_NLP cannot run ipOpt, use IpOptSolverFactory::solve");
+}
+
+// Start each wind point from the multipliers of the converged neighbour
+void VPP_NLP::setWarmStart(bool warmStart) {
+	warmStart_= warmStart;
+}
+
+// Returns true if the wind points are warm started
+bool VPP_NLP::getWarmStart() const {
+	return warmStart_;
+}
+
+// Returns true if the current wind point has the multipliers of a neighbour to start from
+bool VPP_NLP::isWarmStarted() const {
+	return pWarmStart_;
+}
+
+// Invalidate the stored constraints, Jacobian and gradient if x changed
+void VPP_NLP::setNewX(bool new_x) {
+	if(new_x) {
+		isGCurrent_= false;
+		isJacCurrent_= false;
+		isGradCurrent_= false;
+		isHessCurrent_= false;
+	}
 }
 
 // Return the gradient of the objective function grad_{x} f(x)
@@ -195,11 +313,18 @@ bool VPP_NLP::eval_grad_f(int n, const double* x, bool new_x, double* grad_f) {
 
 	assert(n == dimension_);
 
-	// Map the solution x to an Eigen object
-	Eigen::Map<const Eigen::VectorXd> xMap(x,n);
+	setNewX(new_x);
 
-	// Run the Gradient to compute the derivatives
-	pGradient_->run(xMap,twv_,twa_);
+	// Run the Gradient to compute the derivatives, unless this has
+	// already been done for this x
+	if(!isGradCurrent_) {
+
+		// Map the solution x to an Eigen object
+		Eigen::Map<const Eigen::VectorXd> xMap(x,n);
+
+		pGradient_->run(xMap,wc_);
+		isGradCurrent_= true;
+	}
 
 	// Copy the values of the gradient to the c-style array
 	for(size_t iVar=0; iVar<n; iVar++)
@@ -215,11 +340,19 @@ bool VPP_NLP::eval_g(int n, const double* x0, bool new_x, int m, double* g) {
 	assert(n == dimension_);
 	assert(m == subPbSize_);
 
-	// Update the items
-	pVppItemsContainer_->update(twv_,twa_,x0);
+	setNewX(new_x);
+
+	// Compute the residuals, unless this has already been done for this x
+	if(!isGCurrent_) {
+		Map<const VectorXd>x(x0,dimension_);
+		Eigen::VectorXd xTmp(x);
+		g_= pVppItemsContainer_->getResiduals(wc_,xTmp);
+		isGCurrent_= true;
+	}
 
 	// Push the residuals to the ipOpt residual vector g
-	pVppItemsContainer_->getResiduals(g[0],g[1]);
+	g[0]=g_(0);
+	g[1]=g_(1);
 
 	return true;
 }
@@ -232,6 +365,8 @@ bool VPP_NLP::eval_jac_g(int n, const double* x0, bool new_x,
 	assert(n == dimension_);
 	assert(m == nEqualityConstraints_);
 
+	setNewX(new_x);
+
 	if (values == NULL) {
 
 		// return the structure of the jacobian of the constraint
@@ -258,20 +393,27 @@ bool VPP_NLP::eval_jac_g(int n, const double* x0, bool new_x,
 		//  	// Return the values of the jacobian of the constraints
 		//  	// the structure of which has been specified below
 
-		// Transform the c-style container into an Eigen container
-		Map<const VectorXd>x(x0,dimension_);
-		Eigen::VectorXd xTmp(x);
+		// Compute the Jacobian, unless this has already been done for this x
+		if(!isJacCurrent_) {
+
+			// Transform the c-style container into an Eigen container
+			Map<const VectorXd>x(x0,dimension_);
+			Eigen::VectorXd xTmp(x);
 
-		// Instantiate a VPPJacobian
-		VPPJacobian J(xTmp,pVppItemsContainer_.get(), subPbSize_, dimension_);
+			// Instantiate a VPPJacobian
+			VPPJacobian J(xTmp,pVppItemsContainer_.get(), subPbSize_, dimension_, getJacobianMode());
 
-		// Run the VPPJacobian and compute the derivatives
-		J.run(twv_, twa_);
+			// Run the VPPJacobian and compute the derivatives
+			J.run(wc_);
+
+			jac_= J;
+			isJacCurrent_= true;
+		}
 
 		// Copy the values of the derivatives into the buffer values
 		for(size_t iCmp=0; iCmp<dimension_; iCmp++){
-			values[iCmp]=J(0,iCmp);
-			values[iCmp+dimension_]=J(1,iCmp);
+			values[iCmp]=jac_(0,iCmp);
+			values[iCmp+dimension_]=jac_(1,iCmp);
 		}
 	}
 
@@ -284,9 +426,54 @@ bool VPP_NLP::eval_h(int n, const double* x, bool new_x,
 		bool new_lambda, int nele_hess, int* iRow,
 		int* jCol, double* values) {
 
-	// Main sets the flag "hessian_approximation" to "limited-memory", so it should
-	// not require the hessian matrix
-	throw VPPException(HERE, "The hessian should not be requested!");
+	assert(n == dimension_);
+	assert(m == nEqualityConstraints_);
+
+	setNewX(new_x);
+
+	if (values == NULL) {
+
+		// return the structure of the lower triangle of the hessian,
+		// row by row. The hessian is dense
+		size_t iEle=0;
+		for(size_t iVar=0; iVar<n; iVar++)
+			for(size_t jVar=0; jVar<=iVar; jVar++) {
+				iRow[iEle] = iVar;
+				jCol[iEle] = jVar;
+				iEle++;
+			}
+	}
+	else {
+
+		// Compute the Hessians of the constraints, unless this has
+		// already been done for this x
+		if(!isHessCurrent_) {
+
+			// Transform the c-style container into an Eigen container
+			Map<const VectorXd>xMap(x,dimension_);
+			Eigen::VectorXd xTmp(xMap);
+
+			VPPHessian H(xTmp,pVppItemsContainer_.get());
+			H.run(wc_);
+
+			hessG_.resize(nEqualityConstraints_);
+			for(size_t iCon=0; iCon<nEqualityConstraints_; iCon++)
+				hessG_[iCon]= H.get(iCon);
+
+			isHessCurrent_= true;
+		}
+
+		// The objective function x[0] is linear, so obj_factor does not contribute
+		// and the hessian of the Lagrangian is lambda_dF * H_dF + lambda_dM * H_dM
+		size_t iEle=0;
+		for(size_t iVar=0; iVar<n; iVar++)
+			for(size_t jVar=0; jVar<=iVar; jVar++) {
+				values[iEle]= 0;
+				for(size_t iCon=0; iCon<m; iCon++)
+					values[iEle]+= lambda[iCon] * hessG_[iCon](iVar,jVar);
+				iEle++;
+			}
+	}
 
 	return true;
 }
@@ -321,9 +508,29 @@ void VPP_NLP::finalize_solution(SolverReturn status,
 			discard=true;
 	}
 
+	// Off the wind grid, only retain the solution
+	if(!onGrid_) {
+		xOffGrid_= solution;
+		offGridConverged_= status==SUCCESS && !discard;
+		return;
+	}
+
 	// Push the solution to the result container
 	pResults_->push_back(twv_, twa_, solution, residuals, discard);
 
+	// Store the multipliers, used to warm start the neighbours. A wind point
+	// solved again without converging drops the multipliers of a previous run
+	if(status==SUCCESS && !discard) {
+		Multipliers& s= multipliers_[ std::make_pair(twv_,twa_) ];
+		s.zL_= Eigen::Map<const Eigen::VectorXd>(z_L,n);
+		s.zU_= Eigen::Map<const Eigen::VectorXd>(z_U,n);
+		s.lambda_= Eigen::Map<const Eigen::VectorXd>(lambda,m);
+	}
+	else
+		multipliers_.erase( std::make_pair(twv_,twa_) );
+
+	storeTelemetry(twv_,twa_);
+
 
 //	std::cout << std::endl << std::endl << "Solution of the bound multipliers, z_L and z_U" << std::endl;
 //	for (int i=0; i<n; i++) {
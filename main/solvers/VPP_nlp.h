@@ -9,6 +9,7 @@
 #ifndef VPP_NLP_H__
 #define VPP_NLP_H__
 
+#include <map>
 #include "IpTNLP.hpp"
 using namespace Ipopt;
 
@@ -46,6 +47,10 @@ class VPP_NLP : public TNLP, public VPPSolverBase {
 		/// Default destructor
 		virtual ~VPP_NLP();
 
+		/// Reset the solver when reloading the initial data. The stored
+		/// multipliers refer to the previous data and are cleared
+		virtual void reset(std::shared_ptr<VPPItemFactory>);
+
 		/// Method to return some info about the nlp
 		virtual bool get_nlp_info(Ipopt::Index& n, Ipopt::Index& m, Ipopt::Index& nnz_jac_g,
 				Ipopt::Index& nnz_h_lag, IndexStyleEnum& Index_style);
@@ -110,11 +115,42 @@ class VPP_NLP : public TNLP, public VPPSolverBase {
 				const IpoptData* ip_data,
 				IpoptCalculatedQuantities* ip_cq);
 
-		/// Set twv and twa for this run
+		/// Set twv and twa for this run. With the warm start, also pick the
+		/// multipliers of the neighbour the initial guess is built from
 		void run(int twv, int twa);
 
+		/// Set the wind condition wc, that does not need to lie on the wind grid,
+		/// and the initial guess x for this run. The solution is not stored in
+		/// the results, see getOffGridSolution. The run is not warm started
+		void run(const WindCondition& wc, const Eigen::VectorXd& x);
+
+		/// Get the solution of the last run(wc,x). Returns false if ipOpt did
+		/// not succeed or if the solution is out of the bounds
+		bool getOffGridSolution(Eigen::VectorXd& x) const;
+
+		/// The NLP cannot run ipOpt by itself : throws. Use IpOptSolverFactory::solve
+		virtual bool solve(const WindCondition& wc, Eigen::VectorXd& x);
+
+		/// Start each wind point from the bound multipliers z_L, z_U and from the
+		/// constraint multipliers lambda of the converged neighbour, rather than
+		/// from cold duals. Default : false
+		void setWarmStart(bool);
+
+		/// Returns true if the wind points are warm started
+		bool getWarmStart() const;
+
+		/// Returns true if the current wind point has the multipliers of a
+		/// neighbour to start from. Set by run(twv,twa)
+		bool isWarmStarted() const;
+
 	private:
 
+		/// Multipliers of the bounds and of the constraints of a converged
+		/// wind point. Its state vector is stored by the results
+		struct Multipliers {
+				Eigen::VectorXd zL_, zU_, lambda_;
+		};
+
 		/// This class is to be instantiated using a NLOptSolverFactory.
 		/// The friendship allows the factory to call the private constructor
 		friend class IpOptSolverFactory;
@@ -138,11 +174,49 @@ class VPP_NLP : public TNLP, public VPPSolverBase {
 		/// Copy constructor
 		VPP_NLP(const VPP_NLP&);
 
+		/// Ipopt tells with new_x if x changed since the last evaluation.
+		/// If so, invalidate the stored constraints, Jacobian, gradient and Hessians
+		void setNewX(bool new_x);
+
 		/// Number of equality constraints: dF=0, dM=0
 		const size_t nEqualityConstraints_; // --> v, phi
 
-		/// Wind angle and velocity Ipopt::Indexes. Set with setWind(size_t, size_t)
-		static size_t twa_, twv_;
+		/// Wind angle and velocity Ipopt::Indexes. Set with run(int, int)
+		size_t twa_, twv_;
+
+		/// Wind condition the residuals are evaluated for, and false if it
+		/// was set with run(wc,x) rather than from the wind grid
+		WindCondition wc_;
+		bool onGrid_;
+
+		/// Initial guess, then solution of the last off-grid run, and true
+		/// if that run succeeded
+		Eigen::VectorXd xOffGrid_;
+		bool offGridConverged_;
+
+		/// Constraints and Jacobian of the constraints computed for the
+		/// current x. Returned as they are until Ipopt changes x
+		Eigen::VectorXd g_;
+		Eigen::MatrixXd jac_;
+
+		/// Hessians of the constraints dF and dM computed for the current x.
+		/// Only the multipliers change until Ipopt changes x
+		std::vector<Eigen::MatrixXd> hessG_;
+
+		/// Flags telling if the constraints, their Jacobian, the gradient of the
+		/// objective function and the Hessians of the constraints have been
+		/// computed for the current x
+		bool isGCurrent_, isJacCurrent_, isGradCurrent_, isHessCurrent_;
+
+		/// Warm start the wind points from the multipliers of their neighbour
+		bool warmStart_;
+
+		/// Multipliers of the converged wind points, stored by
+		/// finalize_solution and indexed by (twv, twa)
+		std::map< std::pair<size_t,size_t>, Multipliers > multipliers_;
+
+		/// Multipliers the current wind point is warm started from, NULL if none
+		const Multipliers* pWarmStart_;
 
 };
 }
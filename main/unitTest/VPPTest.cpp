@@ -4,19 +4,25 @@
 #include "SailSet.h"
 #include "VPPItemFactory.h"
 #include "NRSolver.h"
+#include "VPPContinuation.h"
 #include <nlopt.hpp>
 #include "VPPJacobian.h"
 #include "VPPGradient.h"
+#include "VPPHessian.h"
 #include "SemiAnalyticalOptimizer.h"
 #include "VPPSolver.h"
 #include "mathUtils.h"
 #include "VPPResultIO.h"
+#include "VPPBinaryResultIO.h"
 #include "IpIpoptApplication.hpp"
 
 #include "VPPSolverFactoryBase.h"
 #include "hs071_nlp.h"
 
 #include "VPPJobRunner.h"
+#include "VPPAngleRefiner.h"
+#include "VPPTargetSpeeds.h"
+#include "VPPSettingsXmlParser.h"
 
 namespace Test {
 
@@ -108,6 +114,11 @@ void TVPPTest::variableParseTest() {
 	// CREW
 	CPPUNIT_ASSERT_EQUAL( parser.get("MMVBLCRW"), 228. );
 
+	// The dense store addressed by descriptor must mirror the named lookup
+	CPPUNIT_ASSERT_EQUAL( parser.get(Var::lwl_), parser.get("LWL") );
+	CPPUNIT_ASSERT_EQUAL( parser.get(Var::mmvblcrw_), parser.get("MMVBLCRW") );
+	CPPUNIT_ASSERT_EQUAL( parser.get(Var::sailSet_), parser.get("SAILSET") );
+
 }
 
 
@@ -266,6 +277,16 @@ void TVPPTest::xmlIOTest() {
    // Compare the variables contained in the two parsers
 	CPPUNIT_ASSERT( *pVariableFileParserTwo == *pVariableFileParser );
 
+	// Read the xml again without the settings items, as the batch program does.
+	// The variables must be the same, converted to SI units
+	VariableFileParser headlessParser;
+	VPPSettingsXmlParser headlessXmlParser(&headlessParser);
+	headlessXmlParser.parse(xmlFileName.toStdString());
+	CPPUNIT_ASSERT( headlessParser == *pVariableFileParser );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( mathUtils::toRad(85), headlessParser.get(Var::heelBounds_.max_), 1.e-12 );
+
+	// No general settings in this file : fall back to the default solver
+	CPPUNIT_ASSERT_EQUAL( solverChoice::nlOpt, headlessXmlParser.getSolver() );
 }
 
 /// Test the variables we get when reading xml in the variablefile
@@ -644,6 +665,57 @@ void TVPPTest::jacobianTest() {
 
 }
 
+// Test the Jacobian matrix computed by automatic differentiation
+void TVPPTest::jacobianADTest() {
+
+	std::cout<<"=== Testing the Jacobian matrix computed by automatic differentiation === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	// Define a state vector: v, phi, crew, flat
+	Eigen::VectorXd x(4);
+	x << 2, 0.4, 2, .9;
+
+	Eigen::VectorXd residuals= pVppItems->getResiduals(3,6,x);
+
+	// Compute the full Jacobian matrix by finite differences and by automatic
+	// differentiation
+	VPPJacobian Jfd(x, pVppItems.get(), 2, 4);
+	Jfd.run(3,6);
+
+	VPPJacobian Jad(x, pVppItems.get(), 2, 4, automaticDifferentiation);
+	Jad.run(3,6);
+
+	// The derivatives only differ by the noise of the finite differences
+	for(size_t i=0; i<Jfd.rows(); i++)
+		for(size_t j=0; j<Jfd.cols(); j++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( Jfd(i,j), Jad(i,j), 1.e-5 * std::max(1., std::fabs(Jfd(i,j))) );
+
+	// The items are left updated with the initial state vector
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( residuals(0), pVppItems->getResiduals()(0), 1.e-12);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( residuals(1), pVppItems->getResiduals()(1), 1.e-12);
+
+	// Same for the square Jacobian used by the NR solver
+	VPPJacobian J(x, pVppItems.get(), 2, automaticDifferentiation);
+	J.run(3,6);
+
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( -171.797570228577, J(0,0), 1.e-3);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(  340.33544921875, J(1,0), 1.e-2);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( -29.4818544387817,  J(0,1), 1.e-3);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( -31634.528503418, J(1,1), 1.e-1);
+
+}
+
 // Test the computation of the Gradient vector
 void TVPPTest::gradientTest() {
 
@@ -1493,8 +1565,1572 @@ void TVPPTest::vppResultIOTest() {
 }
 
 
-} // namespace Test
+// Check the effective span of the induced resistance, combined out of the
+// splines built in the ctor, against the spline rebuilt at each call
+void TVPPTest::inducedResistanceSpanTest() {
+
+	std::cout<<"=== Testing the effective span of the induced resistance === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+	InducedResistanceItem* pInduced= pVppItems->getInducedResistanceItem();
+
+	// Effective span as computed at each update before the splines were
+	// built in the ctor. See DSYHS99 ch4 p128
+	Eigen::MatrixXd coeffA(4,4), coeffB(4,2);
+	coeffA << 	3.7455,	-3.6246,	0.0589,	-0.0296,
+			4.4892,	-4.8454,	0.0294,	-0.0176,
+			3.9592,	-3.9804,	0.0283,	-0.0075,
+			3.4891,	-2.9577,	0.0250,	-0.0272;
+	coeffB << 	1.2306,	-0.7256,
+			1.4231,	-1.2971,
+			1.545,	-1.5622,
+			1.4744,	-1.3499;
+
+	Eigen::ArrayXd phiD(4);
+	phiD << 0, 10, 20, 30;
+	phiD *= ( M_PI / 180.0);
+
+	double tCan= parser.get(Var::tcan_), t= parser.get(Var::t_);
+	Eigen::VectorXd vectA(4);
+	vectA << tCan/t, (tCan/t)*(tCan/t), parser.get(Var::bwl_)/tCan,
+			parser.get(Var::chtpk_)/parser.get(Var::chrtk_);
+	Eigen::ArrayXd Tegeo= (coeffA * vectA).array();
+
+	double phi[]= {0, 0.05, 0.2, 0.37, 0.5};
+	double fN[]= {0, 0.1, 0.35, 0.6};
+	for(size_t iPhi=0; iPhi<5; iPhi++)
+		for(size_t iFn=0; iFn<4; iFn++) {
+
+			Eigen::VectorXd vectB(2);
+			vectB << 1, fN[iFn];
+			Eigen::ArrayXd TeFn= coeffB * vectB;
+			Eigen::ArrayXd Teffective= t * Tegeo * TeFn;
+			SplineInterpolator interpolator(phiD,Teffective);
+
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( interpolator.interpolate(phi[iPhi]),
+					pInduced->getEffectiveSpan(phi[iPhi],fN[iFn]), 1.e-12 );
+		}
+
+	// Same baseline value as in itemComponentTest
+	Eigen::VectorXd x(4);
+	x << 5, 0.9, 0.8, 3;
+	pVppItems->update(5,5,x);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 215.616683502611, pInduced->get(), 1.e-6 );
+
+}
+
+// Compare the Gradient computed with the implicit function theorem
+// against the finite differences of Newton solves
+void TVPPTest::gradientImplicitFunctionTest() {
+
+	std::cout<<"=== Testing the Gradient vector with the implicit function theorem === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	// Solve for the equilibrium dF=0, dM=0 from the state vector of gradientTest:
+	// the implicit function theorem is exact at an equilibrium point
+	Eigen::VectorXd x(4);
+	x << 2, 0.4, 2, .9;
+	NRSolver solver(pVppItems.get(),4,2);
+	x= solver.run(3,6,x);
+
+	VPPGradient Gfd( x,pVppItems.get() );
+	VPPGradient Gift( x,pVppItems.get(),implicitFunctionTheorem );
+
+	Gfd.run(3,6);
+	Gift.run(3,6);
+
+	for(size_t i=0; i<Gfd.size(); i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( Gfd(i), Gift(i), 1.e-6 );
+
+	// The solvers default to the Newton solves, and keep the mode when reset
+	Optim::SolverFactory solverFactory(pVppItems);
+	CPPUNIT_ASSERT_EQUAL( newtonFiniteDifferences, solverFactory.get()->getGradientMode() );
+	solverFactory.get()->setGradientMode(implicitFunctionTheorem);
+	solverFactory.get()->reset(pVppItems);
+	CPPUNIT_ASSERT_EQUAL( implicitFunctionTheorem, solverFactory.get()->getGradientMode() );
+
+}
+
+// Clone a VPPItemFactory and verify the clone computes the same
+// residuals while its state stays independent from the original
+void TVPPTest::itemFactoryCloneTest() {
+
+	std::cout<<"=== Testing the clone of the VPPItemFactory === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items and clone them
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+	std::shared_ptr<VPPItemFactory> pClone( pVppItems->clone() );
+
+	// The clone must compute the same residuals as the original
+	Eigen::VectorXd x(4);
+	x << 5, 0.9, 0.8, 3;
+	Eigen::VectorXd res= pVppItems->getResiduals(5,5,x);
+	Eigen::VectorXd cloneRes= pClone->getResiduals(5,5,x);
+	for(size_t i=0; i<2; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( res(i), cloneRes(i), 1.e-12 );
+
+	// The induced resistance of the clone is wired to its own items
+	CPPUNIT_ASSERT( pClone->getInducedResistanceItem() != pVppItems->getInducedResistanceItem() );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 215.616683502611, pClone->getInducedResistanceItem()->get(), 1.e-6 );
+
+	// Updating the clone on a different state must leave the original untouched
+	Eigen::VectorXd y(4);
+	y << 3, 0.2, 0.1, 0.9;
+	pClone->getResiduals(2,3,y);
+	Eigen::VectorXd resAfter= pVppItems->getResiduals();
+	for(size_t i=0; i<2; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( res(i), resAfter(i), 1.e-12 );
+
+}
+
+// Verify the cache of the residuals of the VPPItemFactory returns the
+// residuals of the items, counts hits and misses and stays bounded
+void TVPPTest::residualCacheTest() {
+
+	std::cout<<"=== Testing the cache of the residuals === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	Eigen::VectorXd x(4);
+	x << 5, 0.9, 0.8, 3;
+
+	// Compute the reference residuals from the items
+	pVppItems->update(5,5,x);
+	double dF, dM;
+	pVppItems->getResiduals(dF,dM);
+	ResidualComponents components= pVppItems->getResidualComponents();
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( dF, components.fDrive_ - components.resistance_, 1.e-12 );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( dM, components.mHeel_ - components.mRight_, 1.e-12 );
+
+	// First call : miss. Second call : hit, with the same residuals
+	Eigen::VectorXd res= pVppItems->getResiduals(5,5,x);
+	CPPUNIT_ASSERT_EQUAL( size_t(0), pVppItems->getCacheHits() );
+	CPPUNIT_ASSERT_EQUAL( size_t(1), pVppItems->getCacheMisses() );
+	CPPUNIT_ASSERT_EQUAL( dF, res(0) );
+	CPPUNIT_ASSERT_EQUAL( dM, res(1) );
+
+	// Move the items to another state, then ask again for x
+	Eigen::VectorXd y(4);
+	y << 3, 0.2, 0.1, 0.9;
+	pVppItems->getResiduals(5,5,y);
+	Eigen::VectorXd cachedRes= pVppItems->getResiduals(5,5,x);
+	CPPUNIT_ASSERT_EQUAL( size_t(1), pVppItems->getCacheHits() );
+	CPPUNIT_ASSERT_EQUAL( size_t(2), pVppItems->getCacheMisses() );
+	CPPUNIT_ASSERT_EQUAL( res(0), cachedRes(0) );
+	CPPUNIT_ASSERT_EQUAL( res(1), cachedRes(1) );
+	CPPUNIT_ASSERT_EQUAL( components.fDrive_, pVppItems->getResidualComponents().fDrive_ );
+	CPPUNIT_ASSERT_EQUAL( components.mRight_, pVppItems->getResidualComponents().mRight_ );
+
+	// The key includes the wind indices
+	pVppItems->getResiduals(5,4,x);
+	CPPUNIT_ASSERT_EQUAL( size_t(3), pVppItems->getCacheMisses() );
+
+	// Fill a small cache : the oldest entries are overwritten
+	pVppItems->setCacheSize(3);
+	for(size_t i=0; i<4; i++) {
+		x(0)= 1 + i;
+		pVppItems->getResiduals(5,5,x);
+	}
+	CPPUNIT_ASSERT_EQUAL( size_t(4), pVppItems->getCacheMisses() );
+	x(0)= 1;
+	pVppItems->getResiduals(5,5,x);
+	CPPUNIT_ASSERT_EQUAL( size_t(5), pVppItems->getCacheMisses() );
+	x(0)= 4;
+	pVppItems->getResiduals(5,5,x);
+	CPPUNIT_ASSERT_EQUAL( size_t(1), pVppItems->getCacheHits() );
+
+	// Clearing the cache resets the counters and forces a miss
+	pVppItems->clearCache();
+	pVppItems->getResiduals(5,5,x);
+	CPPUNIT_ASSERT_EQUAL( size_t(0), pVppItems->getCacheHits() );
+	CPPUNIT_ASSERT_EQUAL( size_t(1), pVppItems->getCacheMisses() );
+
+	// A null size disables the cache
+	pVppItems->setCacheSize(0);
+	pVppItems->getResiduals(5,5,x);
+	pVppItems->getResiduals(5,5,x);
+	CPPUNIT_ASSERT_EQUAL( size_t(0), pVppItems->getCacheHits() );
+	CPPUNIT_ASSERT_EQUAL( size_t(2), pVppItems->getCacheMisses() );
+
+}
+
+// Solve a wind point and verify the telemetry of the solver is
+// stored with the result and exported
+void TVPPTest::solverTelemetryTest() {
+
+	std::cout<<"=== Testing the telemetry of the solver === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_small_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
 
+	// Solve two wind points with the Newton solver
+	Optim::SolverFactory solverFactory(pVppItems);
+	solverFactory.run(0,0);
+	solverFactory.run(0,1);
 
+	ResultContainer* pResults= solverFactory.get()->getResults();
+	for(size_t iWa=0; iWa<2; iWa++) {
 
+		const Result& res= pResults->get(0,iWa);
+		const SolverTelemetry& telemetry= res.getTelemetry();
+
+		// Each Newton step builds a Jacobian, which requires residual evaluations
+		CPPUNIT_ASSERT( telemetry.nIterations_>0 );
+		CPPUNIT_ASSERT_EQUAL( telemetry.nIterations_, telemetry.nJacobians_ );
+		CPPUNIT_ASSERT( telemetry.nResiduals_>telemetry.nJacobians_ );
+		CPPUNIT_ASSERT( telemetry.nUpdates_>0 );
+
+		// No optimizer here
+		CPPUNIT_ASSERT_EQUAL( size_t(0), telemetry.nEvaluations_ );
+
+		// The timers are nested in the wall time
+		CPPUNIT_ASSERT( telemetry.updateTime_>0 );
+		CPPUNIT_ASSERT( telemetry.wallTime_ >= telemetry.updateTime_ + telemetry.linearAlgebraTime_ );
+
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( std::sqrt(res.getdF()*res.getdF() + res.getdM()*res.getdM()),
+				telemetry.residualNorm_, 1.e-12 );
+
+		// The telemetry is also shown in the result table
+		CPPUNIT_ASSERT_EQUAL( double(telemetry.nIterations_), res.getTableEntry(TableResultType::nIterations) );
+		CPPUNIT_ASSERT_EQUAL( telemetry.wallTime_, res.getTableEntry(TableResultType::wallTime) );
+	}
+
+	// Export the telemetry : one header line plus a line per wind point
+	solverFactory.get()->exportTelemetry("telemetry_test.txt");
+	std::ifstream telemetryFile("telemetry_test.txt");
+	size_t nLines=0;
+	string line;
+	while(std::getline(telemetryFile,line))
+		nLines++;
+	CPPUNIT_ASSERT_EQUAL( size_t(1 + parser.get(Var::ntw_) * parser.get(Var::nta_)), nLines );
+
+}
+
+// Run the wind grid on a pool of threads in deterministic mode and
+// compare with the serial run
+void TVPPTest::parallelJobRunnerTest() {
+
+	std::cout<<"=== Testing the parallel job runner === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_small_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	size_t nta= parser.get(Var::nta_), ntw= parser.get(Var::ntw_);
+
+	// Serial run
+	Optim::NLOptSolverFactory serialFactory(pVppItems);
+	VPPJobRunner(&serialFactory,nta,ntw);
+
+	// Parallel run on the clone of the items, counting the progress reports
+	Optim::NLOptSolverFactory parallelFactory( std::shared_ptr<VPPItemFactory>(pVppItems->clone()) );
+	size_t nReports=0, nDone=0;
+	bool monotonic=true;
+	VPPJobRunner(&parallelFactory,nta,ntw,4,true,
+			[&](size_t done, size_t nPoints) -> bool {
+				monotonic = monotonic && done>nDone && nPoints==nta*ntw;
+				nDone= done;
+				nReports++;
+				return true;
+			});
+	CPPUNIT_ASSERT( nReports>0 );
+	CPPUNIT_ASSERT( monotonic );
+
+	// The results must be identical
+	ResultContainer* pSerial= serialFactory.get()->getResults();
+	ResultContainer* pParallel= parallelFactory.get()->getResults();
+	for(size_t iWv=0; iWv<ntw; iWv++)
+		for(size_t iWa=0; iWa<nta; iWa++) {
+			CPPUNIT_ASSERT_EQUAL( pSerial->get(iWv,iWa).discard(), pParallel->get(iWv,iWa).discard() );
+			for(size_t iCmp=0; iCmp<serialFactory.get()->getDimension(); iCmp++)
+				CPPUNIT_ASSERT_EQUAL(
+						pSerial->get(iWv,iWa).getX()->coeff(iCmp),
+						pParallel->get(iWv,iWa).getX()->coeff(iCmp) );
+		}
+}
+
+// Verify the compiled kernel of the VPPItemFactory computes the same
+// residuals as the items, for all the sail configurations
+void TVPPTest::compiledKernelTest() {
+
+	std::cout<<"=== Testing the compiled residual kernel === \n"<<std::endl;
+
+	// Write a copy of the test variable file for each sail configuration
+	for(int sailSet=mainOnly; sailSet<=mainJibAndSpi; sailSet++) {
+
+		char fileName[256];
+		sprintf(fileName,"variableFile_sailSet%d_test.txt",sailSet);
+		{
+			std::ifstream in("testFiles/variableFile_test.txt");
+			std::ofstream out(fileName);
+			std::string line;
+			while(std::getline(in,line))
+				if(line.compare(0,7,"SAILSET"))
+					out<<line<<"\n";
+				else
+					out<<"SAILSET "<<sailSet<<"\n";
+		}
+
+		VariableFileParser parser;
+		parser.parse(fileName);
+		std::remove(fileName);
+		std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+		CPPUNIT_ASSERT_EQUAL( size_t(sailSet), pSails->getType() );
+
+		// The reference factory evaluates the items, the other one the kernel.
+		// Disable the caches, so that each call is a genuine evaluation
+		VPPItemFactory items(&parser,pSails);
+		items.setCacheSize(0);
+		VPPItemFactory compiled(&parser,pSails);
+		compiled.setCacheSize(0);
+		compiled.setCompiled(true);
+		CPPUNIT_ASSERT( compiled.isCompiled() );
+
+		// States spanning negative, small and large velocities, negative heel angles
+		Eigen::MatrixXd states(6,4);
+		states <<	 5,    0.9,  0.8, 3,
+							 3,    0.2,  0.1, 0.9,
+							 0.5,  0.1,  0.5, 1,
+							 0,    0,    0,   1,
+							-0.5, -0.1,  0.2, 0.8,
+							 8,   -0.3,  1.2, 0.6;
+
+		for(int vTW=0; vTW<items.getWind()->getWVSize(); vTW+=11)
+			for(int aTW=0; aTW<items.getWind()->getWASize(); aTW+=3)
+				for(size_t iState=0; iState<states.rows(); iState++) {
+
+					Eigen::VectorXd x= states.row(iState).transpose();
+
+					Eigen::VectorXd ref= items.getResiduals(vTW,aTW,x);
+					ResidualComponents refCmp= items.getResidualComponents();
+
+					Eigen::VectorXd res= compiled.getResiduals(vTW,aTW,x);
+					ResidualComponents cmp= compiled.getResidualComponents();
+
+					// The kernel is not bit-identical : some of the per-boat
+					// constants are pre-multiplied
+					for(size_t i=0; i<2; i++)
+						CPPUNIT_ASSERT_DOUBLES_EQUAL( ref(i), res(i), 1.e-10 * (1 + std::fabs(ref(i))) );
+					CPPUNIT_ASSERT_DOUBLES_EQUAL( refCmp.fDrive_, cmp.fDrive_, 1.e-10 * (1 + std::fabs(refCmp.fDrive_)) );
+					CPPUNIT_ASSERT_DOUBLES_EQUAL( refCmp.resistance_, cmp.resistance_, 1.e-10 * (1 + std::fabs(refCmp.resistance_)) );
+					CPPUNIT_ASSERT_DOUBLES_EQUAL( refCmp.mHeel_, cmp.mHeel_, 1.e-10 * (1 + std::fabs(refCmp.mHeel_)) );
+					CPPUNIT_ASSERT_DOUBLES_EQUAL( refCmp.mRight_, cmp.mRight_, 1.e-10 * (1 + std::fabs(refCmp.mRight_)) );
+				}
+
+		// The compiled factory never updated its items
+		CPPUNIT_ASSERT_EQUAL( 0., compiled.getAeroForcesItem()->getFDrive() );
+
+		// A clone inherits the compiled mode
+		std::shared_ptr<VPPItemFactory> pClone( compiled.clone() );
+		CPPUNIT_ASSERT( pClone->isCompiled() );
+		Eigen::VectorXd x= states.row(0).transpose();
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( items.getResiduals(5,5,x)(0), pClone->getResiduals(5,5,x)(0), 1.e-8 );
+	}
+}
+
+// Verify the residuals of a batch of state vectors are the ones computed by
+// the items state by state, and use them for the finite difference Jacobian
+void TVPPTest::batchResidualsTest() {
+
+	std::cout<<"=== Testing the residuals of a batch of state vectors === \n"<<std::endl;
+
+	VariableFileParser parser;
+	parser.parse("testFiles/variableFile_test.txt");
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+	VPPItemFactory items(&parser,pSails);
+	items.setCacheSize(0);
+
+	// Sweep velocities, including negative and small ones, and heel angles
+	StateBatch states(60);
+	for(size_t i=0; i<states.size(); i++) {
+		Eigen::VectorXd x(4);
+		x << -1 + 0.15 * i, 0.3 * std::sin(0.37 * i), 0.1 * (i % 7), 0.5 + 0.01 * i;
+		states.set(i,x);
+		CPPUNIT_ASSERT( states.get(i)==x );
+	}
+
+	int vTW=5, aTW=5;
+	ResidualBatch batch= items.getResiduals(vTW,aTW,states);
+	CPPUNIT_ASSERT_EQUAL( states.size(), size_t(batch.dF_.size()) );
+
+	for(size_t i=0; i<states.size(); i++) {
+
+		Eigen::VectorXd x= states.get(i);
+		Eigen::VectorXd ref= items.getResiduals(vTW,aTW,x);
+		ResidualComponents cmp= items.getResidualComponents();
+
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( ref(0), batch.dF_(i), 1.e-10 * (1 + std::fabs(ref(0))) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( ref(1), batch.dM_(i), 1.e-10 * (1 + std::fabs(ref(1))) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( cmp.fDrive_, batch.fDrive_(i), 1.e-10 * (1 + std::fabs(cmp.fDrive_)) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( cmp.resistance_, batch.resistance_(i), 1.e-10 * (1 + std::fabs(cmp.resistance_)) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( cmp.mHeel_, batch.mHeel_(i), 1.e-10 * (1 + std::fabs(cmp.mHeel_)) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( cmp.mRight_, batch.mRight_(i), 1.e-10 * (1 + std::fabs(cmp.mRight_)) );
+	}
+
+	// The batch does not touch the current residuals
+	Eigen::VectorXd x(4);
+	x << 5, 0.1, 0.5, 0.9;
+	Eigen::VectorXd res= items.getResiduals(vTW,aTW,x);
+	items.getResiduals(vTW,aTW,states);
+	CPPUNIT_ASSERT( items.getResiduals()==res );
+
+	// The finite difference Jacobian of the compiled factory is computed
+	// from a single batch : compare with the Jacobian of the items
+	VPPItemFactory compiled(&parser,pSails);
+	compiled.setCompiled(true);
+
+	Eigen::VectorXd xJ(x);
+	VPPJacobian jRef(xJ,&items,2,4);
+	jRef.run(vTW,aTW);
+	VPPJacobian jBatch(xJ,&compiled,2,4);
+	jBatch.run(vTW,aTW);
+	for(size_t i=0; i<2; i++)
+		for(size_t j=0; j<4; j++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( jRef(i,j), jBatch(i,j), 1.e-5 * (1 + std::fabs(jRef(i,j))) );
+
+}
+
+// Verify the NRSolver returns the status of a non-converged run
+// rather than blocking, and that its limits can be set
+void TVPPTest::nrSolverStatusTest() {
+
+	std::cout<<"=== Testing the status of the NRSolver === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	NRSolver solver(pVppItems.get(),4,2);
+	CPPUNIT_ASSERT_EQUAL( solver.getMaxIters(), size_t(100) );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( solver.getTolerance(), 1.e-5, 1.e-20 );
+
+	// Converged run : solve and run find the same solution
+	Eigen::VectorXd x0(4);
+	x0 << 2, 0.4, 2, .9;
+	Eigen::VectorXd x(x0);
+	NRStatus status= solver.solve(3,6,x);
+	CPPUNIT_ASSERT( status.converged() );
+	CPPUNIT_ASSERT( status.nIters_>1 );
+	CPPUNIT_ASSERT( status.residualNorm_<solver.getTolerance() );
+	size_t nIters= status.nIters_;
+
+	Eigen::VectorXd xRun(x0);
+	xRun= solver.run(3,6,xRun);
+	for(size_t i=0; i<4; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( x(i), xRun(i), 1.e-12 );
+
+	// A single iteration is not enough. The initial guess is left untouched
+	// and the status tells where the solver has stopped
+	solver.setMaxIters(1);
+	x= x0;
+	status= solver.solve(3,6,x);
+	CPPUNIT_ASSERT( !status.converged() );
+	CPPUNIT_ASSERT_EQUAL( status.reason_, nrMaxIterations );
+	CPPUNIT_ASSERT_EQUAL( status.nIters_, size_t(1) );
+	CPPUNIT_ASSERT( status.residualNorm_>solver.getTolerance() );
+	CPPUNIT_ASSERT( !mathUtils::isNotValid(status.residualNorm_) );
+	for(size_t i=0; i<4; i++)
+		CPPUNIT_ASSERT_EQUAL( x(i), x0(i) );
+
+	// run still throws on non-convergence
+	CPPUNIT_ASSERT_THROW( solver.run(3,6,x), NonConvergedException );
+
+	// A looser tolerance requires fewer iterations
+	solver.setMaxIters(100);
+	solver.setTolerance(1.);
+	x= x0;
+	NRStatus looseStatus= solver.solve(3,6,x);
+	CPPUNIT_ASSERT( looseStatus.converged() );
+	CPPUNIT_ASSERT( looseStatus.nIters_<=nIters );
+
+	CPPUNIT_ASSERT_THROW( solver.setTolerance(0), VPPException );
+
+}
+
+// Solve a sequence of wind points with the Broyden mode of the NRSolver
+// and compare with the Newton mode
+void TVPPTest::broydenSolverTest() {
+
+	std::cout<<"=== Testing the Broyden mode of the NRSolver === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	NRSolver newton(pVppItems.get(),4,2);
+	NRSolver broyden(pVppItems.get(),4,2);
+	broyden.setMode(nrBroyden);
+	CPPUNIT_ASSERT_EQUAL( broyden.getMode(), nrBroyden );
+
+	// Solve the wind velocities of an angle, each warm-started from
+	// the solution of the previous one
+	Eigen::VectorXd xNewton(4), xBroyden(4);
+	xNewton << 2, 0.4, 2, .9;
+	xBroyden= xNewton;
+
+	size_t newtonJacobians=0, broydenJacobians=0, saved=0;
+	for(int twv=1; twv<6; twv++) {
+
+		NRStatus newtonStatus= newton.solve(twv,6,xNewton);
+		NRStatus broydenStatus= broyden.solve(twv,6,xBroyden);
+		printf("twv= %i, Newton: %zu iterations %zu Jacobians, Broyden: %zu iterations %zu Jacobians\n",
+				twv, newtonStatus.nIters_, newtonStatus.nJacobians_, broydenStatus.nIters_, broydenStatus.nJacobians_);
+
+		CPPUNIT_ASSERT( newtonStatus.converged() );
+		CPPUNIT_ASSERT( broydenStatus.converged() );
+		CPPUNIT_ASSERT_EQUAL( newtonStatus.getJacobiansSaved(), size_t(0) );
+		CPPUNIT_ASSERT( broydenStatus.residualNorm_<broyden.getTolerance() );
+
+		// Same equilibrium, to the tolerance of the solvers
+		for(size_t i=0; i<4; i++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( xNewton(i), xBroyden(i), 1.e-5 );
+
+		newtonJacobians+= newtonStatus.nJacobians_;
+		broydenJacobians+= broydenStatus.nJacobians_;
+		saved+= broydenStatus.getJacobiansSaved();
+	}
+
+	// The Jacobian of the first point is reused by the next ones
+	CPPUNIT_ASSERT( broydenJacobians<newtonJacobians );
+	CPPUNIT_ASSERT( saved>0 );
+
+	// The settings are copied to another solver
+	NRSolver copy(pVppItems.get(),4,2);
+	broyden.setMaxIters(20);
+	copy.copySettings(broyden);
+	CPPUNIT_ASSERT_EQUAL( copy.getMode(), nrBroyden );
+	CPPUNIT_ASSERT_EQUAL( copy.getMaxIters(), size_t(20) );
+
+}
+
+// Compare the fixed-size Newton loop of the NRSolver with a Newton
+// loop built on VPPJacobian, for the 2x2 and 1x1 sub-problems
+void TVPPTest::fixedSizeSolverTest() {
+
+	std::cout<<"=== Testing the fixed-size NRSolver === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	NRSolver solver(pVppItems.get(),4,2);
+
+	for(size_t subPbSize=2; subPbSize>0; subPbSize--) {
+
+		solver.setSubPbSize(subPbSize);
+
+		Eigen::VectorXd x0(4);
+		x0 << 2, 0.4, 2, .9;
+
+		// Reference : Newton loop with VPPJacobian and a QR decomposition
+		Eigen::VectorXd xRef(x0);
+		VPPJacobian J(xRef,pVppItems.get(),subPbSize);
+		for(size_t it=0; it<100; it++) {
+			Eigen::VectorXd res= pVppItems->getResiduals(3,6,xRef).head(subPbSize);
+			if(it && res.norm()<solver.getTolerance())
+				break;
+			J.run(3,6);
+			xRef.head(subPbSize)-= J.colPivHouseholderQr().solve(res);
+		}
+
+		Eigen::VectorXd x(x0);
+		NRStatus status= solver.solve(3,6,x);
+		CPPUNIT_ASSERT( status.converged() );
+		CPPUNIT_ASSERT_EQUAL( status.nJacobians_, status.nIters_ );
+
+		for(size_t i=0; i<4; i++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( xRef(i), x(i), 1.e-6 );
+
+		// The residuals of the sub-problem are null at the solution
+		Eigen::VectorXd res= pVppItems->getResiduals(3,6,x);
+		CPPUNIT_ASSERT( res.head(subPbSize).norm()<solver.getTolerance() );
+	}
+
+	// A singular Jacobian gives no step, for both sizes
+	Eigen::Matrix<double,1,1> J1, res1, deltas1;
+	J1 << 0;
+	res1 << 1;
+	CPPUNIT_ASSERT( !NRSolver::solveFixedStep<1>(J1,res1,deltas1) );
+
+	Eigen::Matrix2d J2;
+	Eigen::Vector2d res2, deltas2;
+	J2 << 1, 2,
+			2, 4;
+	res2 << 1, 1;
+	CPPUNIT_ASSERT( !NRSolver::solveFixedStep<2>(J2,res2,deltas2) );
+
+	// While a regular one is solved
+	J2 << 2, 1,
+			1, 3;
+	CPPUNIT_ASSERT( NRSolver::solveFixedStep<2>(J2,res2,deltas2) );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.4, deltas2(0), 1.e-12 );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.2, deltas2(1), 1.e-12 );
+
+}
+
+void TVPPTest::continuationTest() {
+
+	std::cout<<"=== Testing the continuation between wind points === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	NRSolver solver(pVppItems.get(),4,2);
+	VPPContinuation continuation(pVppItems.get(),2);
+
+	// Origin of the paths : the solution at twv=2, twa=6
+	Eigen::VectorXd x0(4);
+	x0 << 2, 0.4, 2, .9;
+	CPPUNIT_ASSERT( solver.solve(2,6,x0).converged() );
+
+	// Reference solutions along the wind velocity and the wind angle
+	Eigen::VectorXd xV(x0), xA(x0);
+	CPPUNIT_ASSERT( solver.solve(5,6,xV).converged() );
+	CPPUNIT_ASSERT( solver.solve(2,8,xA).converged() );
+
+	// The prediction is closer to the solution than the origin
+	Eigen::VectorXd xPred= continuation.predict(2,6,5,6,x0);
+	CPPUNIT_ASSERT( (xPred-xV).norm() < (x0-xV).norm() );
+
+	// March along the wind velocity
+	Eigen::VectorXd x(x0);
+	CPPUNIT_ASSERT( continuation.solve(2,6,5,6,x).converged() );
+	CPPUNIT_ASSERT( continuation.getNumSteps()>0 );
+	for(size_t i=0; i<4; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( xV(i), x(i), 1.e-6 );
+
+	// March along the wind angle
+	x= x0;
+	CPPUNIT_ASSERT( continuation.solve(2,6,2,8,x).converged() );
+	for(size_t i=0; i<4; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( xA(i), x(i), 1.e-6 );
+
+	// March to a wind condition off the grid, along both the velocity and the angle
+	WindItem* pWind= pVppItems->getWind();
+	WindCondition wc0= pWind->getWindCondition(2,6), wc1= pWind->getWindCondition(5,8);
+	WindCondition wc( 0.5*(wc0.twv_+wc1.twv_), 0.5*(wc0.twa_+wc1.twa_) );
+	Eigen::VectorXd xOff(x0);
+	CPPUNIT_ASSERT( solver.solve(wc,xOff).converged() );
+	x= x0;
+	CPPUNIT_ASSERT( continuation.solve(wc0,wc,x).converged() );
+	for(size_t i=0; i<4; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( xOff(i), x(i), 1.e-6 );
+
+	// Built from a NRSolver, the continuation uses its Jacobian mode. With
+	// automatic differentiation, each Jacobian is a single evaluation of the
+	// residuals rather than two per variable
+	NRSolver adSolver(pVppItems.get(),4,2);
+	adSolver.setJacobianMode(automaticDifferentiation);
+	VPPContinuation adContinuation(pVppItems.get(),2,&adSolver);
+
+	size_t nResiduals= pVppItems->getTelemetry().nResiduals_;
+	x= x0;
+	CPPUNIT_ASSERT( continuation.solve(2,6,5,6,x).converged() );
+	size_t nFdResiduals= pVppItems->getTelemetry().nResiduals_ - nResiduals;
+
+	nResiduals= pVppItems->getTelemetry().nResiduals_;
+	x= x0;
+	CPPUNIT_ASSERT( adContinuation.solve(2,6,5,6,x).converged() );
+	size_t nAdResiduals= pVppItems->getTelemetry().nResiduals_ - nResiduals;
+
+	for(size_t i=0; i<4; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( xV(i), x(i), 1.e-6 );
+	CPPUNIT_ASSERT( nAdResiduals < nFdResiduals );
+
+	// With a single corrector iteration the step must be halved, but
+	// the march still reaches the solution
+	continuation.setMaxCorrectorIters(1);
+	x= x0;
+	CPPUNIT_ASSERT( continuation.solve(2,6,5,6,x).converged() );
+	CPPUNIT_ASSERT( continuation.getNumHalvings()>0 );
+	for(size_t i=0; i<4; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( xV(i), x(i), 1.e-6 );
+
+	// A min step that cannot be reached fails the march, and leaves x unchanged
+	continuation.setMinStep(0.9);
+	x= x0;
+	const NRStatus& status= continuation.solve(2,6,5,6,x);
+	CPPUNIT_ASSERT( !status.converged() );
+	CPPUNIT_ASSERT_EQUAL( nrStepTooSmall, status.reason_ );
+	for(size_t i=0; i<4; i++)
+		CPPUNIT_ASSERT_EQUAL( x0(i), x(i) );
+
+}
 
+void TVPPTest::saoaAdaptiveTest() {
+
+	std::cout<<"=== Testing the adaptive sampling of the SAOA === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate three solvers, each with its own items : full grid,
+	// adaptive sampling and adaptive sampling on three threads
+	std::shared_ptr<VPPItemFactory> pFullItems( new VPPItemFactory(&parser,pSails) );
+	Optim::SAOASolverFactory fullSolver(pFullItems);
+
+	std::shared_ptr<VPPItemFactory> pAdaptiveItems( new VPPItemFactory(&parser,pSails) );
+	Optim::SAOASolverFactory adaptiveSolver(pAdaptiveItems);
+	adaptiveSolver.get()->setSampling(Optim::saoaAdaptive);
+
+	std::shared_ptr<VPPItemFactory> pThreadItems( new VPPItemFactory(&parser,pSails) );
+	Optim::SAOASolverFactory threadSolver(pThreadItems);
+	threadSolver.get()->setSampling(Optim::saoaAdaptive);
+	threadSolver.get()->setNumThreads(3);
+
+	CPPUNIT_ASSERT_THROW( threadSolver.get()->setNumThreads(0), VPPException );
+
+	for(size_t aTW=5; aTW<12; aTW+=6) {
+		for(size_t vTW=0; vTW<8; vTW++) {
+
+			fullSolver.run(vTW,aTW);
+			CPPUNIT_ASSERT_EQUAL( size_t(25), fullSolver.get()->getNumSamples() );
+
+			adaptiveSolver.run(vTW,aTW);
+			CPPUNIT_ASSERT( adaptiveSolver.get()->getNumSamples() < 25 );
+
+			threadSolver.run(vTW,aTW);
+
+			// The adaptive sampling finds an optimum at least as fast as the full grid
+			double uFull= fullSolver.get()->getResult(vTW,aTW)(0);
+			double uAdaptive= adaptiveSolver.get()->getResult(vTW,aTW)(0);
+			CPPUNIT_ASSERT( uAdaptive > uFull - 1.e-3 );
+
+			// The threads only change the warm start of the samples
+			Eigen::VectorXd xAdaptive= adaptiveSolver.get()->getResult(vTW,aTW);
+			Eigen::VectorXd xThread= threadSolver.get()->getResult(vTW,aTW);
+			for(size_t i=0; i<4; i++)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL( xAdaptive(i), xThread(i), 1.e-3 );
+		}
+	}
+
+	// The settings of the sampling are cloned with the factory
+	std::shared_ptr<Optim::SAOASolverFactory> pClone( threadSolver.clone() );
+	CPPUNIT_ASSERT_EQUAL( Optim::saoaAdaptive, pClone->get()->getSampling() );
+	CPPUNIT_ASSERT_EQUAL( size_t(3), pClone->get()->getNumThreads() );
+}
+
+// Solve a few wind points with COBYLA and with SLSQP, that uses the
+// exact derivatives of the constraints. Same optima, fewer evaluations
+void TVPPTest::nlOptSLSQPTest() {
+
+	std::cout<<"=== Testing the SLSQP optimizer vs COBYLA === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Each optimizer has its own items
+	std::shared_ptr<VPPItemFactory> pCobylaItems( new VPPItemFactory(&parser,pSails) );
+	std::shared_ptr<VPPItemFactory> pSLSQPItems( new VPPItemFactory(&parser,pSails) );
+
+	Optim::NLOptSolverFactory cobyla(pCobylaItems);
+	Optim::NLOptSLSQPSolverFactory slsqp(pSLSQPItems);
+
+	size_t aTW=5;
+	for(size_t vTW=0; vTW<6; vTW++){
+		cobyla.run(vTW,aTW);
+		slsqp.run(vTW,aTW);
+	}
+
+	size_t nCobyla=0, nSLSQP=0;
+	for(size_t vTW=0; vTW<6; vTW++){
+
+		const Result& cobylaRes= cobyla.get()->getResults()->get(vTW,aTW);
+		const Result& slsqpRes= slsqp.get()->getResults()->get(vTW,aTW);
+
+		// Both results are converged, and the velocities agree
+		CPPUNIT_ASSERT( !cobylaRes.discard() );
+		CPPUNIT_ASSERT( !slsqpRes.discard() );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( cobylaRes.getX()->coeff(0), slsqpRes.getX()->coeff(0), 1.e-3 );
+
+		nCobyla+= cobylaRes.getTelemetry().nEvaluations_;
+		nSLSQP+= slsqpRes.getTelemetry().nEvaluations_;
+	}
+
+	std::cout<<"Evaluations : COBYLA "<<nCobyla<<", SLSQP "<<nSLSQP<<std::endl;
+	CPPUNIT_ASSERT( nSLSQP>0 );
+	CPPUNIT_ASSERT( nSLSQP<nCobyla );
+}
+
+// Compare the Hessians of the residuals with second order finite
+// differences of the residuals
+void TVPPTest::vppHessianTest() {
+
+	std::cout<<"=== Testing the Hessians of the residuals === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	// Define a state vector: v, phi, crew, flat
+	Eigen::VectorXd x(4);
+	x << 2, 0.4, 2, .9;
+
+	VPPHessian H(x, pVppItems.get());
+	H.run(3,6);
+
+	// d2r/dxidxj = ( r(+i+j) - r(+i-j) - r(-i+j) + r(-i-j) ) / 4 epsi epsj
+	Eigen::VectorXd eps(4);
+	for(size_t i=0; i<4; i++)
+		eps(i)= 1.e-4 * std::max(1., std::fabs(x(i)));
+
+	for(size_t i=0; i<4; i++)
+		for(size_t j=0; j<4; j++) {
+
+			Eigen::VectorXd d2r= Eigen::VectorXd::Zero(2);
+			for(int si=-1; si<2; si+=2)
+				for(int sj=-1; sj<2; sj+=2) {
+					Eigen::VectorXd xp(x);
+					xp(i)+= si * eps(i);
+					xp(j)+= sj * eps(j);
+					d2r+= si * sj * pVppItems->getResiduals(3,6,xp);
+				}
+			d2r/= 4 * eps(i) * eps(j);
+
+			for(size_t iRes=0; iRes<2; iRes++) {
+
+				// The Hessians are symmetric
+				CPPUNIT_ASSERT_EQUAL( H.get(iRes)(i,j), H.get(iRes)(j,i) );
+
+				CPPUNIT_ASSERT_DOUBLES_EQUAL( d2r(iRes), H.get(iRes)(i,j),
+						1.e-3 * std::max(1., std::fabs(d2r(iRes))) );
+			}
+		}
+
+	CPPUNIT_ASSERT_THROW( H.get(2), VPPException );
+}
+
+// Run ipOpt with and without the warm start from the multipliers
+// of the neighbours. Same results, fewer evaluations
+void TVPPTest::ipOptWarmStartTest() {
+
+	std::cout<<"=== Testing the warm start of ipOpt === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_ipOptFullTest.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Each solver has its own items
+	std::shared_ptr<VPPItemFactory> pColdItems( new VPPItemFactory(&parser,pSails) );
+	std::shared_ptr<VPPItemFactory> pWarmItems( new VPPItemFactory(&parser,pSails) );
+
+	Optim::IpOptSolverFactory cold(pColdItems);
+	Optim::IpOptSolverFactory warm(pWarmItems);
+	warm.get()->setWarmStart(true);
+	CPPUNIT_ASSERT( warm.get()->getWarmStart() );
+	CPPUNIT_ASSERT( !cold.get()->getWarmStart() );
+
+	VPPJobRunner(&cold,parser.get("N_TWA"),parser.get("NTW"));
+	VPPJobRunner(&warm,parser.get("N_TWA"),parser.get("NTW"));
+
+	// The last wind point was started from the multipliers of a neighbour
+	CPPUNIT_ASSERT( warm.get()->isWarmStarted() );
+
+	ResultContainer* pCold= cold.get()->getResults();
+	ResultContainer* pWarm= warm.get()->getResults();
+
+	size_t nCold=0, nWarm=0;
+	for(size_t iWv=0; iWv<pCold->windVelocitySize(); iWv++)
+		for(size_t iWa=0; iWa<pCold->windAngleSize(); iWa++) {
+
+			CPPUNIT_ASSERT_EQUAL( pCold->get(iWv,iWa).discard(), pWarm->get(iWv,iWa).discard() );
+			if(pCold->get(iWv,iWa).discard())
+				continue;
+
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( pCold->get(iWv,iWa).getX()->coeff(0),
+					pWarm->get(iWv,iWa).getX()->coeff(0), 1.e-3 );
+
+			nCold+= pCold->get(iWv,iWa).getTelemetry().nEvaluations_;
+			nWarm+= pWarm->get(iWv,iWa).getTelemetry().nEvaluations_;
+		}
+
+	std::cout<<"Evaluations : cold start "<<nCold<<", warm start "<<nWarm<<std::endl;
+	CPPUNIT_ASSERT( nWarm<nCold );
+}
+
+
+// The wind grid is only one producer of wind conditions : the residuals of a
+// grid point are the same with its indices and with its wind condition, and
+// the solver can be run for any wind condition
+void TVPPTest::windConditionTest() {
+
+	std::cout<<"=== Testing the wind conditions === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+	WindItem* pWind= pVppItems->getWind();
+
+	// The wind condition of a grid point, and back
+	WindCondition wc= pWind->getWindCondition(3,4);
+	CPPUNIT_ASSERT_EQUAL( pWind->getTWV(3), wc.twv_ );
+	CPPUNIT_ASSERT_EQUAL( pWind->getTWA(4), wc.twa_ );
+
+	size_t iV=0, iA=0;
+	CPPUNIT_ASSERT( pWind->getWindIndices(wc,iV,iA) );
+	CPPUNIT_ASSERT_EQUAL( size_t(3), iV );
+	CPPUNIT_ASSERT_EQUAL( size_t(4), iA );
+	CPPUNIT_ASSERT( !pWind->getWindIndices(WindCondition(wc.twv_+0.01,wc.twa_),iV,iA) );
+
+	// Same residuals with the indices and with the wind condition. Empty
+	// the cache, so that both are computed by the items
+	Eigen::VectorXd x(4);
+	x << 2, 0.1, 0.5, 0.9;
+	Eigen::VectorXd resIndices= pVppItems->getResiduals(3,4,x);
+	pVppItems->clearCache();
+	Eigen::VectorXd resCondition= pVppItems->getResiduals(wc,x);
+	for(size_t i=0; i<2; i++)
+		CPPUNIT_ASSERT_EQUAL( resIndices(i), resCondition(i) );
+
+	// The compiled kernel is evaluated for the same wind condition
+	pVppItems->setCompiled(true);
+	pVppItems->clearCache();
+	Eigen::VectorXd resCompiled= pVppItems->getResiduals(wc,x);
+	pVppItems->setCompiled(false);
+	for(size_t i=0; i<2; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( resIndices(i), resCompiled(i), 1.e-9 );
+
+	// Solve the grid
+	Optim::SolverFactory solverFactory(pVppItems);
+	VPPJobRunner(&solverFactory,parser.get("N_TWA"),parser.get("NTW"));
+
+	// Solving the wind condition of a grid point from the solution of its
+	// neighbour recovers the result of the grid
+	Eigen::VectorXd xs= solverFactory.get()->getResult(3,3);
+	CPPUNIT_ASSERT( solverFactory.solve(wc,xs) );
+	for(size_t i=0; i<4; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( solverFactory.get()->getResult(3,4)(i), xs(i), 1.e-6 );
+
+	// A wind condition halfway between two grid angles is at equilibrium
+	WindCondition mid( wc.twv_, 0.5 * ( pWind->getTWA(4) + pWind->getTWA(5) ) );
+	CPPUNIT_ASSERT( !pWind->getWindIndices(mid,iV,iA) );
+	CPPUNIT_ASSERT( solverFactory.solve(mid,xs) );
+	Eigen::VectorXd residuals= pVppItems->getResiduals(mid,xs);
+	CPPUNIT_ASSERT( residuals.block(0,0,2,1).norm() < 1.e-5 );
+
+	// The off-grid solutions are not stored
+	CPPUNIT_ASSERT_EQUAL( size_t(parser.get("NTW")), solverFactory.get()->getResults()->windVelocitySize() );
+	CPPUNIT_ASSERT_EQUAL( size_t(parser.get("N_TWA")), solverFactory.get()->getResults()->windAngleSize() );
+}
+
+// Refine the wind angles of a solved grid where the interpolation
+// of the polars is not accurate enough
+void TVPPTest::angleRefinementTest() {
+
+	std::cout<<"=== Testing the refinement of the wind angles === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	// Solve the grid
+	Optim::SolverFactory solverFactory(pVppItems);
+	VPPJobRunner(&solverFactory,parser.get("N_TWA"),parser.get("NTW"));
+
+	ResultContainer* pResults= solverFactory.get()->getResults();
+	size_t nGrid= pResults->size();
+	CPPUNIT_ASSERT_EQUAL( pResults->windVelocitySize()*pResults->windAngleSize(), nGrid );
+
+	// Nothing to refine for a tolerance larger than the boat speed
+	CPPUNIT_ASSERT_EQUAL( size_t(0), VPPAngleRefiner(&solverFactory,1.e3).run() );
+
+	// Refine with the default tolerance
+	double tol=0.01, minInterval=mathUtils::toRad(0.5);
+	size_t nInserted= VPPAngleRefiner(&solverFactory,tol,minInterval).run();
+	CPPUNIT_ASSERT( nInserted>0 );
+	CPPUNIT_ASSERT_EQUAL( nGrid+nInserted, pResults->size() );
+
+	size_t nRefined=0, idx=0;
+	for(size_t iWv=0; iWv<pResults->windVelocitySize(); iWv++) {
+
+		std::vector<Result> results= pResults->getResultsForVelocity(iWv);
+		nRefined+= pResults->getNumRefinedResults(iWv);
+		CPPUNIT_ASSERT_EQUAL( pResults->windAngleSize()+pResults->getNumRefinedResults(iWv), results.size() );
+
+		for(size_t i=0; i<results.size(); i++) {
+
+			// The rows of the table walk the velocities, then the angles
+			Result row= pResults->get(idx++);
+			CPPUNIT_ASSERT_EQUAL( results[i].getiTWA(), row.getiTWA() );
+			CPPUNIT_ASSERT_EQUAL( results[i].getTWA(), row.getTWA() );
+			CPPUNIT_ASSERT_EQUAL( pResults->getWind()->getTWV(iWv), results[i].getTWV() );
+
+			// The refined angles are sorted, and follow the grid angle of their index
+			if(i)
+				CPPUNIT_ASSERT( results[i].getTWA() > results[i-1].getTWA() );
+			CPPUNIT_ASSERT( results[i].getTWA() >= pResults->getWind()->getTWA(results[i].getiTWA()) );
+
+			if(results[i].discard())
+				continue;
+
+			// The refined angles are at equilibrium
+			Eigen::VectorXd x= *results[i].getX();
+			WindCondition wc(results[i].getTWV(),results[i].getTWA());
+			CPPUNIT_ASSERT( pVppItems->getResiduals(wc,x).block(0,0,2,1).norm() < 1.e-5 );
+
+			// The tolerance is met, unless the interval is as narrow as allowed
+			if(i+1<results.size() && !results[i+1].discard() &&
+					results[i+1].getTWA() - results[i].getTWA() >= 2*minInterval )
+				CPPUNIT_ASSERT( VPPAngleRefiner::getInterpolationError(results,i) <= tol );
+		}
+	}
+	CPPUNIT_ASSERT_EQUAL( nInserted, nRefined );
+
+	// The grid results are untouched
+	for(size_t iWv=0; iWv<pResults->windVelocitySize(); iWv++)
+		for(size_t iWa=0; iWa<pResults->windAngleSize(); iWa++)
+			CPPUNIT_ASSERT_EQUAL( pResults->getWind()->getTWA(iWa), pResults->get(iWv,iWa).getTWA() );
+
+	// The refined results are written to file and read back
+	VPPResultIO writer(&parser, pResults);
+	writer.write("testFiles/testRefinedResult.vpp","w");
+
+	ResultContainer readResults(pVppItems->getWind());
+	VPPResultIO reader(&parser, &readResults);
+	reader.parse("testFiles/testRefinedResult.vpp");
+
+	CPPUNIT_ASSERT_EQUAL( pResults->size(), readResults.size() );
+	for(size_t i=0; i<pResults->size(); i++) {
+		CPPUNIT_ASSERT_EQUAL( pResults->get(i).getiTWA(), readResults.get(i).getiTWA() );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( pResults->get(i).getTWA(), readResults.get(i).getTWA(), 1.e-7 );
+		CPPUNIT_ASSERT_EQUAL( pResults->get(i).discard(), readResults.get(i).discard() );
+	}
+}
+
+// Solve the optimum VMG angles of each wind velocity and compare
+// them with the best angles of the grid
+void TVPPTest::targetSpeedTest() {
+
+	std::cout<<"=== Testing the target speeds === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	// Solve the grid, that brackets the optima
+	Optim::SolverFactory solverFactory(pVppItems);
+	VPPJobRunner(&solverFactory,parser.get("N_TWA"),parser.get("NTW"));
+	ResultContainer* pResults= solverFactory.get()->getResults();
+
+	VPPTargetSpeeds targetSpeeds(&solverFactory);
+	targetSpeeds.run();
+	targetSpeeds.print();
+	CPPUNIT_ASSERT_EQUAL( pResults->windVelocitySize(), targetSpeeds.size() );
+
+	for(size_t iWv=0; iWv<pResults->windVelocitySize(); iWv++) {
+
+		const TargetSpeed& target= targetSpeeds.get(iWv);
+		CPPUNIT_ASSERT_EQUAL( pResults->getWind()->getTWV(iWv), target.twv_ );
+
+		// Best VMG of the grid, upwind and downwind
+		double beatGrid=0, runGrid=0;
+		for(size_t iWa=0; iWa<pResults->windAngleSize(); iWa++) {
+			const Result& res= pResults->get(iWv,iWa);
+			if(res.discard())
+				continue;
+			double vmg= res.getX()->coeff(0) * cos(res.getTWA());
+			beatGrid= std::max(beatGrid,vmg);
+			runGrid= std::max(runGrid,-vmg);
+		}
+
+		const VMGOptimum* optima[2]= { &target.beat_, &target.run_ };
+		double gridVmg[2]= { beatGrid, runGrid }, sign[2]= { 1, -1 };
+
+		for(size_t i=0; i<2; i++) {
+
+			const VMGOptimum& optimum= *optima[i];
+			CPPUNIT_ASSERT( optimum.valid_ );
+
+			// At least as good as the grid, in a handful of solves
+			CPPUNIT_ASSERT( optimum.vmg_ >= gridVmg[i] - 1.e-12 );
+			CPPUNIT_ASSERT( optimum.nSolves_ <= 20 );
+
+			// The optimum is the solution of its wind angle
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( optimum.vmg_, sign[i] * optimum.x_(0) * cos(optimum.twa_), 1.e-12 );
+			Eigen::VectorXd x= optimum.x_;
+			WindCondition wc(target.twv_,optimum.twa_);
+			CPPUNIT_ASSERT( pVppItems->getResiduals(wc,x).block(0,0,2,1).norm() < 1.e-5 );
+		}
+	}
+
+	// The neighbouring angles of an optimum do not do better
+	const VMGOptimum& beat= targetSpeeds.get(20).beat_;
+	for(int side=-1; side<2; side+=2) {
+		Eigen::VectorXd x= beat.x_;
+		double twa= beat.twa_ + side * mathUtils::toRad(1);
+		CPPUNIT_ASSERT( solverFactory.solve(WindCondition(targetSpeeds.get(20).twv_,twa),x) );
+		CPPUNIT_ASSERT( x(0) * cos(twa) <= beat.vmg_ + 1.e-9 );
+	}
+}
+
+// Read the results stored by columns through the results, the table entries
+// and the column views
+void TVPPTest::resultContainerTest() {
+
+	std::cout<<"=== Testing the columns of the result container === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+	parser.parse("testFiles/variableFile_small_test.txt");
+
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+	std::shared_ptr<WindItem> pWind(new WindItem(&parser,pSails));
+
+	ResultContainer results(pWind.get());
+	size_t nWv= results.windVelocitySize(), nWa= results.windAngleSize();
+	CPPUNIT_ASSERT( nWv>2 && nWa>2 );
+
+	// All the results are discarded placeholders until pushed
+	CPPUNIT_ASSERT_EQUAL( nWv*nWa, results.size() );
+	CPPUNIT_ASSERT_EQUAL( nWv*nWa, results.getNumDiscardedResults() );
+
+	// Fill the grid with u= iWv + iWa/10, then discard a result
+	for(size_t iWv=0; iWv<nWv; iWv++)
+		for(size_t iWa=0; iWa<nWa; iWa++)
+			results.push_back(iWv, iWa, iWv+0.1*iWa, 0.01*iWa, 0.5, 0.9, 1.e-6, 2.e-6 );
+	results.remove(1,2);
+
+	CPPUNIT_ASSERT_EQUAL( size_t(1), results.getNumDiscardedResults() );
+	CPPUNIT_ASSERT_EQUAL( size_t(1), results.getNumDiscardedResultsForVelocity(1) );
+	CPPUNIT_ASSERT_EQUAL( size_t(1), results.getNumDiscardedResultsForAngle(2) );
+	CPPUNIT_ASSERT_EQUAL( nWv-1, results.getNumValidResultsForAngle(2) );
+	CPPUNIT_ASSERT( results.discard(1,2) );
+	CPPUNIT_ASSERT( results.get(1,2).discard() );
+
+	// Pushing a discarded result again restores the counters
+	results.push_back(1, 2, 1.2, 0.02, 0.5, 0.9, 1.e-6, 2.e-6 );
+	CPPUNIT_ASSERT_EQUAL( size_t(0), results.getNumDiscardedResults() );
+
+	// The views on the velocities are contiguous, the views on the angles strided
+	ResultContainer::ColumnView uWv= results.getVelocityView(TableResultType::u,2);
+	ResultContainer::ColumnView uWa= results.getAngleView(TableResultType::u,1);
+	CPPUNIT_ASSERT_EQUAL( Eigen::Index(nWa), uWv.size() );
+	CPPUNIT_ASSERT_EQUAL( Eigen::Index(nWv), uWa.size() );
+	for(size_t iWa=0; iWa<nWa; iWa++)
+		CPPUNIT_ASSERT_EQUAL( 2+0.1*iWa, uWv(iWa) );
+	for(size_t iWv=0; iWv<nWv; iWv++)
+		CPPUNIT_ASSERT_EQUAL( iWv+0.1, uWa(iWv) );
+
+	ResultContainer::ColumnView twa= results.getVelocityView(TableResultType::twa,0);
+	for(size_t iWa=0; iWa<nWa; iWa++)
+		CPPUNIT_ASSERT_EQUAL( pWind->getTWA(iWa), twa(iWa) );
+
+	// Set the telemetry of a result, then copy it to another container
+	SolverTelemetry telemetry;
+	telemetry.nIterations_= 7;
+	results.setTelemetry(2,1,telemetry);
+	CPPUNIT_ASSERT_EQUAL( size_t(7), results.get(2,1).getTelemetry().nIterations_ );
+
+	ResultContainer copied(pWind.get());
+	copied.copy(2,1,results);
+	CPPUNIT_ASSERT( copied.get(2,1) == results.get(2,1) );
+	CPPUNIT_ASSERT_EQUAL( size_t(7), copied.get(2,1).getTelemetry().nIterations_ );
+	CPPUNIT_ASSERT( !copied.discard(2,1) );
+	CPPUNIT_ASSERT_EQUAL( nWv*nWa-1, copied.getNumDiscardedResults() );
+
+	// Insert a refined result, then check the table entries read from the
+	// columns against the entries of the results
+	Eigen::VectorXd x(4), residuals(2);
+	x << 1.15, 0.015, 0.5, 0.9;
+	residuals << 1.e-6, 2.e-6;
+	results.insert(1, 0.5*(pWind->getTWA(1)+pWind->getTWA(2)), x, residuals);
+	CPPUNIT_ASSERT_EQUAL( nWv*nWa+1, results.size() );
+	CPPUNIT_ASSERT_EQUAL( 1.15, results.get(nWa+2).getX()->coeff(0) );
+
+	for(size_t idx=0; idx<results.size(); idx++)
+		for(int col=TableResultType::itwv; col<=TableResultType::residualNorm; col++)
+			CPPUNIT_ASSERT_EQUAL( results.get(idx).getTableEntry(col), results.getTableEntry(idx,col) );
+}
+
+// Write and read the results in the binary format, and convert them to and
+// from the text format
+void TVPPTest::binaryResultIOTest() {
+
+	std::cout<<"=== Testing VPP binary Results IO === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+	parser.parse("testFiles/variableFile_small_test.txt");
+
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+	WindItem* pWind= pVppItems->getWind();
+
+	// Fill the grid with values that do not fit in the 7 digits of the text
+	// format, discard a result and refine the grid
+	ResultContainer results(pWind);
+	for(size_t iWv=0; iWv<results.windVelocitySize(); iWv++)
+		for(size_t iWa=0; iWa<results.windAngleSize(); iWa++)
+			results.push_back(iWv, iWa, 1+M_PI*iWv+0.1234567891*iWa, 0.123456789*iWa,
+					0.5+1.e-9*iWv, 0.9-1.e-9*iWa, 1.23456789e-7, -9.87654321e-7 );
+	results.remove(1,2);
+
+	Eigen::VectorXd x(4), residuals(2);
+	x << 2.000000001, 0.1, 0.2, 0.3;
+	residuals << 1.e-9, 2.e-9;
+	results.insert(1, 0.5*(pWind->getTWA(2)+pWind->getTWA(3)), x, residuals);
+	results.insert(2, 0.5*(pWind->getTWA(0)+pWind->getTWA(1)), x, residuals, true);
+
+	string binFile("testFiles/testResult.vppb"), textFile("testFiles/testConvertedResult.vpp");
+	VPPBinaryResultIO writer(&parser,&results);
+	writer.write(binFile);
+
+	CPPUNIT_ASSERT( VPPBinaryResultIO::isBinary(binFile) );
+	CPPUNIT_ASSERT( !VPPBinaryResultIO::isBinary("testFiles/variableFile_small_test.txt") );
+	CPPUNIT_ASSERT( !VPPBinaryResultIO::isBinary("testFiles/noSuchFile.vppb") );
+
+	// The binary format is lossless : compare all the entries exactly
+	ResultContainer readResults(pWind);
+	VPPBinaryResultIO reader(&parser,&readResults);
+	reader.read(binFile);
+
+	CPPUNIT_ASSERT_EQUAL( results.size(), readResults.size() );
+	CPPUNIT_ASSERT_EQUAL( results.getNumDiscardedResults(), readResults.getNumDiscardedResults() );
+	CPPUNIT_ASSERT_EQUAL( size_t(1), readResults.getNumRefinedResults(1) );
+	CPPUNIT_ASSERT_EQUAL( size_t(1), readResults.getNumRefinedResults(2) );
+	for(size_t idx=0; idx<results.size(); idx++)
+		for(int col=TableResultType::itwv; col<=TableResultType::discard; col++)
+			CPPUNIT_ASSERT_EQUAL( results.getTableEntry(idx,col), readResults.getTableEntry(idx,col) );
+
+	// The solvers detect the format when importing the results
+	Optim::SolverFactory solverFactory(pVppItems);
+	solverFactory.get()->importResults(binFile);
+	CPPUNIT_ASSERT_EQUAL( results.size(), solverFactory.get()->getResults()->size() );
+	CPPUNIT_ASSERT( results.get(1,1) == solverFactory.get()->getResults()->get(1,1) );
+
+	// Convert to text and back. The text format rounds the values
+	ResultContainer convertedResults(pWind);
+	VPPBinaryResultIO converter(&parser,&convertedResults);
+	converter.convert(binFile,textFile);
+	CPPUNIT_ASSERT( !VPPBinaryResultIO::isBinary(textFile) );
+	converter.convert(textFile,binFile);
+	CPPUNIT_ASSERT( VPPBinaryResultIO::isBinary(binFile) );
+
+	reader.read(binFile);
+	CPPUNIT_ASSERT_EQUAL( results.size(), readResults.size() );
+	for(size_t idx=0; idx<results.size(); idx++) {
+		CPPUNIT_ASSERT_EQUAL( results.getTableEntry(idx,TableResultType::itwa), readResults.getTableEntry(idx,TableResultType::itwa) );
+		CPPUNIT_ASSERT_EQUAL( results.getTableEntry(idx,TableResultType::discard), readResults.getTableEntry(idx,TableResultType::discard) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( results.getTableEntry(idx,TableResultType::twa), readResults.getTableEntry(idx,TableResultType::twa), 1.e-7 );
+		for(int col=TableResultType::u; col<=TableResultType::residual_m; col++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( results.getTableEntry(idx,col), readResults.getTableEntry(idx,col),
+					1.e-6*fabs(results.getTableEntry(idx,col)) );
+	}
+
+	// A truncated file is rejected
+	{
+		std::ifstream in(binFile.c_str(),std::ios::binary);
+		std::string content((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+		std::ofstream out(binFile.c_str(),std::ios::binary);
+		out.write(content.data(),content.size()-8);
+	}
+	CPPUNIT_ASSERT_THROW( reader.read(binFile), VPPException );
+
+	// A file computed on a different wind grid is rejected
+	writer.write(binFile);
+	VariableFileParser otherParser;
+	otherParser.parse("testFiles/variableFile_test.txt");
+	std::shared_ptr<VPPItemFactory> pOtherItems( new VPPItemFactory(&otherParser,pSails) );
+	ResultContainer otherResults(pOtherItems->getWind());
+	CPPUNIT_ASSERT( otherResults.windVelocitySize() != results.windVelocitySize() );
+	CPPUNIT_ASSERT_THROW( VPPBinaryResultIO(&otherParser,&otherResults).read(binFile), VPPException );
+}
+
+void TVPPTest::nrSolverADTest() {
+
+	std::cout<<"=== Testing the NRSolver with automatic differentiation === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	NRSolver solver(pVppItems.get(),4,2);
+	CPPUNIT_ASSERT_EQUAL( solver.getJacobianMode(), finiteDifferences );
+
+	// The Jacobian mode is copied with the settings
+	NRSolver other(pVppItems.get(),4,2);
+	other.setJacobianMode(automaticDifferentiation);
+	solver.copySettings(other);
+	CPPUNIT_ASSERT_EQUAL( solver.getJacobianMode(), automaticDifferentiation );
+
+	// Fixed-size Newton loops, then the Broyden loop
+	for(size_t iMode=0; iMode<2; iMode++)
+		for(size_t subPbSize=2; subPbSize>0; subPbSize--) {
+
+			solver.setMode( iMode ? nrBroyden : nrNewton );
+			other.setMode( iMode ? nrBroyden : nrNewton );
+			solver.setSubPbSize(subPbSize);
+			other.setSubPbSize(subPbSize);
+
+			Eigen::VectorXd x0(4);
+			x0 << 2, 0.4, 2, .9;
+
+			// Reference : finite differences
+			solver.setJacobianMode(finiteDifferences);
+			Eigen::VectorXd xRef(x0);
+			CPPUNIT_ASSERT( solver.solve(3,6,xRef).converged() );
+
+			Eigen::VectorXd x(x0);
+			NRStatus status= other.solve(3,6,x);
+			CPPUNIT_ASSERT( status.converged() );
+
+			for(size_t i=0; i<4; i++)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL( xRef(i), x(i), 1.e-6 );
+		}
+}
+
+// Run the wind grid with the Broyden mode of the NRSolver on one and
+// two threads, and verify the results are identical
+void TVPPTest::broydenJobRunnerTest() {
+
+	std::cout<<"=== Testing the Broyden mode on the parallel job runner === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_small_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	size_t nta= parser.get(Var::nta_), ntw= parser.get(Var::ntw_);
+
+	// Serial run
+	Optim::SolverFactory serialFactory(pVppItems);
+	serialFactory.get()->getNRSolver()->setMode(nrBroyden);
+	VPPJobRunner(&serialFactory,nta,ntw,1);
+
+	// Parallel run on the clone of the items. Each thread solves several
+	// angles, so that the Jacobian of one angle cannot leak into the next
+	Optim::SolverFactory parallelFactory( std::shared_ptr<VPPItemFactory>(pVppItems->clone()) );
+	parallelFactory.get()->getNRSolver()->setMode(nrBroyden);
+	VPPJobRunner(&parallelFactory,nta,ntw,2);
+
+	// The results must be identical
+	ResultContainer* pSerial= serialFactory.get()->getResults();
+	ResultContainer* pParallel= parallelFactory.get()->getResults();
+	for(size_t iWv=0; iWv<ntw; iWv++)
+		for(size_t iWa=0; iWa<nta; iWa++) {
+			CPPUNIT_ASSERT_EQUAL( pSerial->get(iWv,iWa).discard(), pParallel->get(iWv,iWa).discard() );
+			for(size_t iCmp=0; iCmp<serialFactory.get()->getDimension(); iCmp++)
+				CPPUNIT_ASSERT_EQUAL(
+						pSerial->get(iWv,iWa).getX()->coeff(iCmp),
+						pParallel->get(iWv,iWa).getX()->coeff(iCmp) );
+		}
+}
+
+
+// Run the second order derivative checker of ipOpt on VPP_NLP. The checker
+// compares the derivatives handed to ipOpt with finite differences of the
+// objective and of the constraints at the starting point
+void TVPPTest::ipOptDerivativeTest() {
+
+	std::cout<<"=== Testing the derivatives of VPP_NLP with the checker of ipOpt === \n"<<std::endl;
+
+	// Instantiate a parser with the variables
+	VariableFileParser parser;
+
+	// Parse the variables file
+	parser.parse("testFiles/variableFile_test.txt");
+
+	// Instantiate the sailset
+	std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+	// Instantiate the items
+	std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+	Optim::IpOptSolverFactory solverFactory(pVppItems);
+	solverFactory.setNumericalHessian(true);
+
+	// Check the Hessian of VPPHessian along with the first derivatives.
+	// The checker only runs at the starting point, so one iteration is enough
+	IpoptApplication* pApp= solverFactory.getApplication();
+	pApp->Options()->SetStringValue("derivative_test", "second-order");
+	pApp->Options()->SetNumericValue("derivative_test_tol", 1.e-4);
+	pApp->Options()->SetIntegerValue("max_iter", 1);
+
+	// Write the report of the checker to file. Initialize again to open it
+	string outFile("testFiles/ipOptDerivativeTest.out");
+	pApp->Options()->SetStringValue("output_file", outFile);
+	pApp->Options()->SetIntegerValue("file_print_level", 5);
+	if(pApp->Initialize() != Solve_Succeeded)
+		CPPUNIT_FAIL("Error during initialization of ipOpt!");
+
+	// The checker runs before the first iteration, whatever the outcome of
+	// the optimization
+	try {
+		solverFactory.run(3,6);
+	} catch(NonConvergedException& e) {
+		// Expected after one iteration
+	}
+
+	// The checker reports a line per derivative out of tolerance, or
+	// a summary line if it has not found any
+	std::ifstream report(outFile.c_str());
+	CPPUNIT_ASSERT( report.good() );
+
+	bool noErrors=false;
+	string line;
+	while(std::getline(report,line))
+		if(line.find("No errors detected by derivative checker")!=string::npos)
+			noErrors=true;
+
+	report.close();
+	std::remove(outFile.c_str());
+
+	CPPUNIT_ASSERT( noErrors );
+}
+
+
+} // namespace Test
@@ -34,6 +34,9 @@ class TVPPTest : public CppUnit::TestFixture{
   /// Test the computation of the Jacobian matrix
   CPPUNIT_TEST(jacobianTest);
 
+  /// Test the Jacobian matrix computed by automatic differentiation
+  CPPUNIT_TEST(jacobianADTest);
+
   /// Test the computation of the Gradient vector
   CPPUNIT_TEST(gradientTest);
 
@@ -71,6 +74,102 @@ class TVPPTest : public CppUnit::TestFixture{
   /// read them back and check if the values are unchanged
   CPPUNIT_TEST(vppResultIOTest);
 
+  /// Check the effective span of the induced resistance against the
+  /// spline rebuilt at each call
+  CPPUNIT_TEST(inducedResistanceSpanTest);
+
+  /// Compare the Gradient computed with the implicit function theorem
+  /// against the finite differences of Newton solves
+  CPPUNIT_TEST(gradientImplicitFunctionTest);
+
+  /// Clone a VPPItemFactory and verify the clone computes the same
+  /// residuals while its state stays independent from the original
+  CPPUNIT_TEST(itemFactoryCloneTest);
+
+  /// Verify the cache of the residuals of the VPPItemFactory returns the
+  /// residuals of the items, counts hits and misses and stays bounded
+  CPPUNIT_TEST(residualCacheTest);
+
+  /// Solve a wind point and verify the telemetry of the solver is
+  /// stored with the result and exported
+  CPPUNIT_TEST(solverTelemetryTest);
+
+  /// Run the wind grid on a pool of threads in deterministic mode and
+  /// compare with the serial run
+  CPPUNIT_TEST(parallelJobRunnerTest);
+
+  /// Verify the compiled kernel of the VPPItemFactory computes the same
+  /// residuals as the items, for all the sail configurations
+  CPPUNIT_TEST(compiledKernelTest);
+
+  /// Verify the residuals of a batch of state vectors are the ones computed by
+  /// the items state by state, and use them for the finite difference Jacobian
+  CPPUNIT_TEST(batchResidualsTest);
+
+  /// Verify the NRSolver returns the status of a non-converged run
+  /// rather than blocking, and that its limits can be set
+  CPPUNIT_TEST(nrSolverStatusTest);
+
+  /// Solve a sequence of wind points with the Broyden mode of the NRSolver
+  /// and compare with the Newton mode
+  CPPUNIT_TEST(broydenSolverTest);
+
+  /// Compare the fixed-size Newton loop of the NRSolver with a Newton
+  /// loop built on VPPJacobian, for the 2x2 and 1x1 sub-problems
+  CPPUNIT_TEST(fixedSizeSolverTest);
+
+  /// March to the solution of a wind point by continuation from a
+  /// converged neighbour, along the wind velocity and the wind angle
+  CPPUNIT_TEST(continuationTest);
+
+  /// Compare the adaptive sampling of the SAOA with the full grid,
+  /// and the threaded sampling with the serial one
+  CPPUNIT_TEST(saoaAdaptiveTest);
+
+  /// Compare the gradient-based SLSQP optimizer with COBYLA : same
+  /// results with fewer evaluations
+  CPPUNIT_TEST(nlOptSLSQPTest);
+
+  /// Compare the Hessians of the residuals with second order
+  /// finite differences of the residuals
+  CPPUNIT_TEST(vppHessianTest);
+
+  /// Compare a run of ipOpt warm started from the multipliers of the
+  /// neighbours with a cold started run
+  CPPUNIT_TEST(ipOptWarmStartTest);
+
+  /// Evaluate and solve the model for wind conditions on and off
+  /// the wind grid
+  CPPUNIT_TEST(windConditionTest);
+
+  /// Refine the wind angles of a solved grid where the interpolation
+  /// of the polars is not accurate enough
+  CPPUNIT_TEST(angleRefinementTest);
+
+  /// Solve the optimum VMG angles of each wind velocity and compare
+  /// them with the best angles of the grid
+  CPPUNIT_TEST(targetSpeedTest);
+
+  /// Read the results stored by columns through the results, the
+  /// table entries and the column views
+  CPPUNIT_TEST(resultContainerTest);
+
+  /// Write and read the results in the binary format, and convert
+  /// them to and from the text format
+  CPPUNIT_TEST(binaryResultIOTest);
+
+  /// Solve with the Jacobians of the NRSolver computed by automatic
+  /// differentiation, and compare with the finite differences
+  CPPUNIT_TEST(nrSolverADTest);
+
+  /// Run the wind grid with the Broyden mode of the NRSolver on one and
+  /// two threads, and verify the results are identical
+  CPPUNIT_TEST(broydenJobRunnerTest);
+
+  /// Run the second order derivative checker of ipOpt on VPP_NLP, to
+  /// verify the gradients, the Jacobian and the numerical Hessian
+  CPPUNIT_TEST(ipOptDerivativeTest);
+
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -96,6 +195,9 @@ public:
   /// Test the computation of the Jacobian matrix
   void jacobianTest();
 
+  /// Test the Jacobian matrix computed by automatic differentiation
+  void jacobianADTest();
+
   /// Test the computation of the Gradient vector
   void gradientTest();
 
@@ -132,6 +234,102 @@ public:
   /// read them back and check if the values are unchanged
   void vppResultIOTest();
 
+  /// Check the effective span of the induced resistance against the
+  /// spline rebuilt at each call
+  void inducedResistanceSpanTest();
+
+  /// Compare the Gradient computed with the implicit function theorem
+  /// against the finite differences of Newton solves
+  void gradientImplicitFunctionTest();
+
+  /// Clone a VPPItemFactory and verify the clone computes the same
+  /// residuals while its state stays independent from the original
+  void itemFactoryCloneTest();
+
+  /// Verify the cache of the residuals of the VPPItemFactory returns the
+  /// residuals of the items, counts hits and misses and stays bounded
+  void residualCacheTest();
+
+  /// Solve a wind point and verify the telemetry of the solver is
+  /// stored with the result and exported
+  void solverTelemetryTest();
+
+  /// Run the wind grid on a pool of threads in deterministic mode and
+  /// compare with the serial run
+  void parallelJobRunnerTest();
+
+  /// Verify the compiled kernel of the VPPItemFactory computes the same
+  /// residuals as the items, for all the sail configurations
+  void compiledKernelTest();
+
+  /// Verify the residuals of a batch of state vectors are the ones computed by
+  /// the items state by state, and use them for the finite difference Jacobian
+  void batchResidualsTest();
+
+  /// Verify the NRSolver returns the status of a non-converged run
+  /// rather than blocking, and that its limits can be set
+  void nrSolverStatusTest();
+
+  /// Solve a sequence of wind points with the Broyden mode of the NRSolver
+  /// and compare with the Newton mode
+  void broydenSolverTest();
+
+  /// Compare the fixed-size Newton loop of the NRSolver with a Newton
+  /// loop built on VPPJacobian, for the 2x2 and 1x1 sub-problems
+  void fixedSizeSolverTest();
+
+  /// March to the solution of a wind point by continuation from a
+  /// converged neighbour, along the wind velocity and the wind angle
+  void continuationTest();
+
+  /// Compare the adaptive sampling of the SAOA with the full grid,
+  /// and the threaded sampling with the serial one
+  void saoaAdaptiveTest();
+
+  /// Compare the gradient-based SLSQP optimizer with COBYLA : same
+  /// results with fewer evaluations
+  void nlOptSLSQPTest();
+
+  /// Compare the Hessians of the residuals with second order
+  /// finite differences of the residuals
+  void vppHessianTest();
+
+  /// Compare a run of ipOpt warm started from the multipliers of the
+  /// neighbours with a cold started run
+  void ipOptWarmStartTest();
+
+  /// Evaluate and solve the model for wind conditions on and off
+  /// the wind grid
+  void windConditionTest();
+
+  /// Refine the wind angles of a solved grid where the interpolation
+  /// of the polars is not accurate enough
+  void angleRefinementTest();
+
+  /// Solve the optimum VMG angles of each wind velocity and compare
+  /// them with the best angles of the grid
+  void targetSpeedTest();
+
+  /// Read the results stored by columns through the results, the
+  /// table entries and the column views
+  void resultContainerTest();
+
+  /// Write and read the results in the binary format, and convert
+  /// them to and from the text format
+  void binaryResultIOTest();
+
+  /// Solve with the Jacobians of the NRSolver computed by automatic
+  /// differentiation, and compare with the finite differences
+  void nrSolverADTest();
+
+  /// Run the wind grid with the Broyden mode of the NRSolver on one and
+  /// two threads, and verify the results are identical
+  void broydenJobRunnerTest();
+
+  /// Run the second order derivative checker of ipOpt on VPP_NLP, to
+  /// verify the gradients, the Jacobian and the numerical Hessian
+  void ipOptDerivativeTest();
+
 };
 }; // namespace Test
 
@@ -0,0 +1,218 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <cmath>
+#include <Eigen/Core>
+
+/// Gradient of a Dual wrt the state variables (u, phi, b, f). Not aligned,
+/// so that the Duals can be stored as members of the VPPItems without
+/// requiring aligned allocators
+typedef Eigen::Matrix<double,4,1,Eigen::DontAlign> DualGradient;
+
+/// Dual number used for the forward-mode automatic differentiation
+/// of the VPPItems. A Dual stores a value and its derivatives wrt the
+/// state variables, that are propagated by the arithmetic operators and
+/// by the math functions below with the chain rule
+class Dual {
+
+	public:
+
+		/// Ctor for a constant : all derivatives are null
+		Dual(double val=0) :
+			val_(val),
+			d_(DualGradient::Zero()) {
+		}
+
+		/// Ctor for an independent variable : the derivative
+		/// wrt the iVar-th state variable is one
+		Dual(double val, size_t iVar) :
+			val_(val),
+			d_(DualGradient::Unit(iVar)) {
+		}
+
+		/// Ctor given the value and the derivatives
+		Dual(double val, const DualGradient& d) :
+			val_(val),
+			d_(d) {
+		}
+
+		/// Get the value
+		double val() const {
+			return val_;
+		}
+
+		/// Get the derivatives wrt the state variables
+		const DualGradient& d() const {
+			return d_;
+		}
+
+		/// Get the derivative wrt the iVar-th state variable
+		double d(size_t iVar) const {
+			return d_(iVar);
+		}
+
+		Dual& operator+=(const Dual& rhs) {
+			val_+= rhs.val_;
+			d_+= rhs.d_;
+			return *this;
+		}
+
+		Dual& operator-=(const Dual& rhs) {
+			val_-= rhs.val_;
+			d_-= rhs.d_;
+			return *this;
+		}
+
+		Dual& operator*=(const Dual& rhs) {
+			d_= d_ * rhs.val_ + val_ * rhs.d_;
+			val_*= rhs.val_;
+			return *this;
+		}
+
+		Dual& operator/=(const Dual& rhs) {
+			d_= ( d_ * rhs.val_ - val_ * rhs.d_ ) / ( rhs.val_ * rhs.val_ );
+			val_/= rhs.val_;
+			return *this;
+		}
+
+	private:
+
+		/// Value
+		double val_;
+
+		/// Derivatives wrt the state variables
+		DualGradient d_;
+};
+
+// Value of a scalar of the item updates, templated on double or Dual
+inline double valueOf(double a) {
+	return a;
+}
+
+inline double valueOf(const Dual& a) {
+	return a.val();
+}
+
+// Arithmetic operators. The doubles are promoted to constant Duals
+
+inline Dual operator-(const Dual& a) {
+	return Dual(-a.val(),-a.d());
+}
+
+inline Dual operator+(Dual a, const Dual& b) {
+	return a+=b;
+}
+
+inline Dual operator-(Dual a, const Dual& b) {
+	return a-=b;
+}
+
+inline Dual operator*(Dual a, const Dual& b) {
+	return a*=b;
+}
+
+inline Dual operator/(Dual a, const Dual& b) {
+	return a/=b;
+}
+
+// Operations with constants, that do not need to promote the constant
+
+inline Dual operator+(const Dual& a, double b) {
+	return Dual(a.val()+b, a.d());
+}
+
+inline Dual operator+(double a, const Dual& b) {
+	return Dual(a+b.val(), b.d());
+}
+
+inline Dual operator-(const Dual& a, double b) {
+	return Dual(a.val()-b, a.d());
+}
+
+inline Dual operator-(double a, const Dual& b) {
+	return Dual(a-b.val(), -b.d());
+}
+
+inline Dual operator*(const Dual& a, double b) {
+	return Dual(a.val()*b, a.d()*b);
+}
+
+inline Dual operator*(double a, const Dual& b) {
+	return Dual(a*b.val(), a*b.d());
+}
+
+inline Dual operator/(const Dual& a, double b) {
+	return Dual(a.val()/b, a.d()/b);
+}
+
+inline Dual operator/(double a, const Dual& b) {
+	return Dual(a/b.val(), -a/(b.val()*b.val()) * b.d());
+}
+
+// Comparisons only involve the values
+
+inline bool operator<(const Dual& a, const Dual& b) {
+	return a.val()<b.val();
+}
+
+inline bool operator>(const Dual& a, const Dual& b) {
+	return a.val()>b.val();
+}
+
+inline bool operator<=(const Dual& a, const Dual& b) {
+	return a.val()<=b.val();
+}
+
+inline bool operator>=(const Dual& a, const Dual& b) {
+	return a.val()>=b.val();
+}
+
+// Math functions : f(a) -> ( f(a), f'(a) * da )
+
+inline Dual sin(const Dual& a) {
+	return Dual(std::sin(a.val()), std::cos(a.val()) * a.d());
+}
+
+inline Dual cos(const Dual& a) {
+	return Dual(std::cos(a.val()), -std::sin(a.val()) * a.d());
+}
+
+inline Dual sqrt(const Dual& a) {
+	double s= std::sqrt(a.val());
+	return Dual(s, a.d() / (2 * s));
+}
+
+inline Dual exp(const Dual& a) {
+	double e= std::exp(a.val());
+	return Dual(e, e * a.d());
+}
+
+inline Dual log10(const Dual& a) {
+	return Dual(std::log10(a.val()), a.d() / (a.val() * std::log(10.)));
+}
+
+// Power with constant exponent. For a null value, the derivative is
+// the limit for n>1 (zero), as for the |phi|^1.7 of the heel items
+inline Dual pow(const Dual& a, double n) {
+	double p= std::pow(a.val(),n);
+	if(!a.val())
+		return Dual(p, (n==1 ? 1. : 0.) * a.d());
+	return Dual(p, n * std::pow(a.val(),n-1) * a.d());
+}
+
+// The derivative of |a| in zero is taken as zero
+inline Dual fabs(const Dual& a) {
+	if(a.val()<0)
+		return -a;
+	if(a.val()>0)
+		return a;
+	return Dual(0.);
+}
+
+inline Dual atan2(const Dual& y, const Dual& x) {
+	double r2= x.val() * x.val() + y.val() * y.val();
+	return Dual(std::atan2(y.val(),x.val()),
+			( x.val() * y.d() - y.val() * x.d() ) / r2 );
+}
+
+#endif
@@ -1,7 +1,9 @@
 #include "Interpolator.h"
 #include <math.h>
 #include "VPPException.h"
+#ifndef VPP_HEADLESS
 #include "VppXYCustomPlotWidget.h"
+#endif
 
 // Constructor
 Interpolator::Interpolator() {
@@ -162,6 +164,19 @@ double SplineInterpolator::interpolate(double val) {
 	return s_(val);
 }
 
+// Get the first derivative of the underlying spline for the value val
+double SplineInterpolator::interpolateD1(double val) {
+
+	return s_.deriv(1,val);
+}
+
+// Interpolate a Dual, chaining its derivatives with the derivative of the spline
+Dual SplineInterpolator::interpolate(const Dual& val) {
+
+	return Dual( s_(val.val()), s_.deriv(1,val.val()) * val.d() );
+}
+
+#ifndef VPP_HEADLESS
 // Plot the spline and its underlying source points.
 // Hand the points to a QCustomPlot
 void SplineInterpolator::plot(VppXYCustomPlotWidget* plot, double minVal,double maxVal,int nVals) {
@@ -256,6 +271,7 @@ void SplineInterpolator::plotD2(VppXYCustomPlotWidget* plot, double minVal,doubl
   plot->rescaleAxes();
 
 }
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////
 
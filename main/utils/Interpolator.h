@@ -5,6 +5,7 @@
 
 #include "Eigen/Core"
 #include "Spline.h"
+#include "Dual.h"
 #include <vector>
 
 /// Forward declarations
@@ -54,6 +55,14 @@ class SplineInterpolator {
 		/// Interpolate the function X-Y using the underlying spline for the value val
 		double interpolate(double);
 
+		/// Get the first derivative of the underlying spline for the value val
+		double interpolateD1(double);
+
+		/// Interpolate a Dual : the derivatives of val are chained with
+		/// the first derivative of the underlying spline
+		Dual interpolate(const Dual&);
+
+#ifndef VPP_HEADLESS
 		/// Plot the spline and its underlying source points.
 		/// Hand the points to a QCustomPlot
 		void plot(VppXYCustomPlotWidget* chart, double minVal,double maxVal,int nVals);
@@ -63,6 +72,7 @@ class SplineInterpolator {
 
 		/// Plot the second derivative of the spline and its underlying source points
 		void plotD2(VppXYCustomPlotWidget* plot, double minVal,double maxVal,int nVals );
+#endif
 
 		/// Declare the macro to allow for fixed size vector support
 		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -7,7 +7,8 @@
 Regression::Regression(Eigen::MatrixXd& x, Eigen::MatrixXd& y, Eigen::MatrixXd& z ) :
 xp_(x),
 yp_(y),
-zp_(z) {
+zp_(z),
+wp_(Eigen::MatrixXd::Ones(z.rows(),z.cols())) {
 
 	if( (xp_.rows() != yp_.rows()) || (xp_.rows() != zp_.rows()) )
 		throw VPPException(HERE, "The coordinate arrays row size mismatch");
@@ -17,6 +18,21 @@ zp_(z) {
 
 }
 
+// Constructor with the weights of the points
+Regression::Regression(Eigen::MatrixXd& x, Eigen::MatrixXd& y, Eigen::MatrixXd& z, Eigen::MatrixXd& w ) :
+xp_(x),
+yp_(y),
+zp_(z),
+wp_(w) {
+
+	if( (xp_.rows() != yp_.rows()) || (xp_.rows() != zp_.rows()) || (xp_.rows() != wp_.rows()) )
+		throw VPPException(HERE, "The coordinate arrays row size mismatch");
+
+	if( (xp_.cols() != yp_.cols()) || (xp_.cols() != zp_.cols()) || (xp_.cols() != wp_.cols()) )
+		throw VPPException(HERE, "The coordinate arrays col size mismatch");
+
+}
+
 
 // Destructor
 Regression::~Regression() {
@@ -40,10 +56,10 @@ Eigen::VectorXd Regression::compute() {
 			Q << xp_(i,j)*xp_(i,j), xp_(i,j)*yp_(i,j), yp_(i,j)*yp_(i,j), xp_(i,j), yp_(i,j), 1;
 
 			// Add the local A matrix to the global one
-			A += Q * Q.transpose();
+			A += wp_(i,j) * Q * Q.transpose();
 
 			// Add the local RHS to the global one
-			b += zp_(i,j) * Q;
+			b += wp_(i,j) * zp_(i,j) * Q;
 
 		}
 	}
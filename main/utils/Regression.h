@@ -18,6 +18,10 @@ class Regression {
 		/// Constructor with point arrays. Requires calling compute()
 		Regression(Eigen::MatrixXd&, Eigen::MatrixXd&, Eigen::MatrixXd& );
 
+		/// Constructor with point arrays and the weight of each point
+		/// in the least squares. Requires calling compute()
+		Regression(Eigen::MatrixXd&, Eigen::MatrixXd&, Eigen::MatrixXd&, Eigen::MatrixXd& );
+
 		/// Destructor
 		~Regression();
 
@@ -31,6 +35,9 @@ class Regression {
 
 		/// Point array to be used to compute the regression
 		Eigen::MatrixXd xp_, yp_, zp_;
+
+		/// Weight of each point
+		Eigen::MatrixXd wp_;
 };
 
 #endif
@@ -0,0 +1,57 @@
+#include "SolverTelemetry.h"
+
+// Ctor: all counters are null
+SolverTelemetry::SolverTelemetry() {
+	reset();
+}
+
+// Reset all counters
+void SolverTelemetry::reset() {
+	nResiduals_=0;
+	nUpdates_=0;
+	nIterations_=0;
+	nJacobians_=0;
+	nEvaluations_=0;
+	updateTime_=0;
+	linearAlgebraTime_=0;
+	wallTime_=0;
+	residualNorm_=0;
+}
+
+// Add the counters and the timers of another telemetry. The wall
+// time and the residual norm are the ones of this telemetry
+void SolverTelemetry::add(const SolverTelemetry& rhs) {
+	nResiduals_+= rhs.nResiduals_;
+	nUpdates_+= rhs.nUpdates_;
+	nIterations_+= rhs.nIterations_;
+	nJacobians_+= rhs.nJacobians_;
+	nEvaluations_+= rhs.nEvaluations_;
+	updateTime_+= rhs.updateTime_;
+	linearAlgebraTime_+= rhs.linearAlgebraTime_;
+}
+
+// Print the header of the columns written by print
+void SolverTelemetry::printHeader(FILE* outStream) {
+	fprintf(outStream,"nResiduals  nUpdates  nIterations  nJacobians  nEvaluations  "
+			"updateTime[s]  linearAlgebraTime[s]  wallTime[s]  residualNorm");
+}
+
+// Print the counters on a single line
+void SolverTelemetry::print(FILE* outStream) const {
+	fprintf(outStream,"%zu  %zu  %zu  %zu  %zu  %8.6e  %8.6e  %8.6e  %8.6e",
+			nResiduals_, nUpdates_, nIterations_, nJacobians_, nEvaluations_,
+			updateTime_, linearAlgebraTime_, wallTime_, residualNorm_);
+}
+
+//////////////////////////////////////////////////////
+
+// Ctor: start the timer
+TelemetryTimer::TelemetryTimer(double& time) :
+	time_(time),
+	start_(std::chrono::steady_clock::now()) {
+}
+
+// Dtor: stop the timer and add the elapsed time
+TelemetryTimer::~TelemetryTimer() {
+	time_+= std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+}
@@ -0,0 +1,82 @@
+#ifndef SOLVER_TELEMETRY_H
+#define SOLVER_TELEMETRY_H
+
+#include <stdio.h>
+#include <chrono>
+
+/// Counters of the work done to solve one wind point (twv, twa). The
+/// counters are filled by the VPPItemFactory, the VPPJacobian and the
+/// solvers, and stored with the Result of the wind point so that the
+/// costly wind points can be found and the tolerances tuned
+struct SolverTelemetry {
+
+	/// Ctor: all counters are null
+	SolverTelemetry();
+
+	/// Reset all counters
+	void reset();
+
+	/// Add the counters and the timers of another telemetry, for
+	/// instance of the work done on another thread
+	void add(const SolverTelemetry&);
+
+	/// Print the header of the columns written by print
+	static void printHeader(FILE* outStream=stdout);
+
+	/// Print the counters on a single line
+	void print(FILE* outStream=stdout) const;
+
+	/// Number of calls to VPPItemFactory::getResiduals(vTW,aTW,x),
+	/// including the calls answered by the cache
+	size_t nResiduals_;
+
+	/// Number of updates of the items
+	size_t nUpdates_;
+
+	/// Number of Newton-Raphson iterations
+	size_t nIterations_;
+
+	/// Number of Jacobian matrices built
+	size_t nJacobians_;
+
+	/// Number of evaluations of the objective function by the optimizer
+	size_t nEvaluations_;
+
+	/// Time spent updating the items [s]
+	double updateTime_;
+
+	/// Time spent solving the linear systems [s]
+	double linearAlgebraTime_;
+
+	/// Wall time spent solving the wind point [s]
+	double wallTime_;
+
+	/// Norm of the residuals (dF, dM) of the solution
+	double residualNorm_;
+};
+
+/// Scoped timer that adds the time spent in its scope to
+/// one of the timers of a SolverTelemetry
+class TelemetryTimer {
+
+	public:
+
+		/// Ctor: start the timer. The elapsed time will be added to time
+		explicit TelemetryTimer(double& time);
+
+		/// Dtor: stop the timer and add the elapsed time
+		~TelemetryTimer();
+
+	private:
+
+		/// Disallow default ctor
+		TelemetryTimer();
+
+		/// Timer the elapsed time is added to [s]
+		double& time_;
+
+		/// Time the timer was started at
+		std::chrono::steady_clock::time_point start_;
+};
+
+#endif
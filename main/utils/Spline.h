@@ -117,6 +117,9 @@ class spline {
 		std::vector<double> get_points(size_t pos);
 
 		double operator() (double x) const;
+
+		// derivative of order 1, 2 or 3 of the spline in x
+		double deriv(int order, double x) const;
 };
 
 
@@ -416,6 +419,64 @@ double spline::operator() (double x) const
 	return interpol;
 }
 
+double spline::deriv(int order, double x) const
+{
+	assert(order>0);
+
+	size_t n=m_x.size();
+	// find the closest point m_x[idx] < x, idx=0 even if x<m_x[0]
+	std::vector<double>::const_iterator it;
+	it=std::lower_bound(m_x.begin(),m_x.end(),x);
+	int idx=std::max( int(it-m_x.begin())-1, 0);
+
+	double h=x-m_x[idx];
+	double interpol;
+	if(x<m_x[0]) {
+		// extrapolation to the left
+		switch(order) {
+		case 1:
+			interpol=2.0*m_b0*h + m_c0;
+			break;
+		case 2:
+			interpol=2.0*m_b0;
+			break;
+		default:
+			interpol=0.0;
+			break;
+		}
+	} else if(x>m_x[n-1]) {
+		// extrapolation to the right
+		switch(order) {
+		case 1:
+			interpol=2.0*m_b[n-1]*h + m_c[n-1];
+			break;
+		case 2:
+			interpol=2.0*m_b[n-1];
+			break;
+		default:
+			interpol=0.0;
+			break;
+		}
+	} else {
+		// interpolation
+		switch(order) {
+		case 1:
+			interpol=(3.0*m_a[idx]*h + 2.0*m_b[idx])*h + m_c[idx];
+			break;
+		case 2:
+			interpol=6.0*m_a[idx]*h + 2.0*m_b[idx];
+			break;
+		case 3:
+			interpol=6.0*m_a[idx];
+			break;
+		default:
+			interpol=0.0;
+			break;
+		}
+	}
+	return interpol;
+}
+
 
 } // namespace tk
 
@@ -44,6 +44,10 @@ double SmoothedStepFunction::f(double x) {
 	return 1. / ( 1. + exp( - ( x - b_(0) ) / b_(1) ) );
 };
 
+Dual SmoothedStepFunction::f(const Dual& x) {
+	return 1. / ( 1. + exp( - ( x - b_(0) ) / b_(1) ) );
+};
+
 // Dtor
 SmoothedStepFunction::~SmoothedStepFunction(){ /* make nothing */ };
 
@@ -9,6 +9,7 @@
 #include "VPPException.h"
 #include "Eigen/Core"
 #include <Eigen/LU>
+#include "Dual.h"
 
 namespace mathUtils {
 
@@ -30,6 +31,11 @@ static bool isNotValid( double val ){
 	return false;
 };
 
+// Check the value of a Dual, as per the doubles of the value updates
+static bool isNotValid( const Dual& val ){
+	return isNotValid( val.val() );
+};
+
 
 // Define a smoothed step function, f(x) = 1 / ( 1 + e^(-(x-a)/b ) )
 // This is a function that ranges from Zero to One and it is Cinf
@@ -43,6 +49,9 @@ class SmoothedStepFunction {
 		// Compute the value of the function for a given x
 		double f(double x);
 
+		// Compute the value and the derivatives of the function for a given x
+		Dual f(const Dual& x);
+
 		// Dtor
 		~SmoothedStepFunction();
 
@@ -0,0 +1,325 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+#include <fstream>
+#include <getopt.h>
+
+using namespace std;
+
+// ------------------------
+// Directives for EIGEN
+#include <Eigen/Core>
+using namespace Eigen;
+
+#include "VariableFileParser.h"
+#include "VPPSettingsXmlParser.h"
+#include "SailSet.h"
+#include "VPPItemFactory.h"
+#include "VPPException.h"
+#include "Version.h"
+#include "VPPResultIO.h"
+#include "VPPBinaryResultIO.h"
+#include "VPPSolverFactoryBase.h"
+#include "VPPJobRunner.h"
+#include "VPPAngleRefiner.h"
+#include "VPPTargetSpeeds.h"
+
+// Print the usage of the batch program
+void printUsage(const char* programName) {
+
+	std::cout<<"\nUsage: "<<programName<<" [options] settingsFile"<<std::endl;
+	std::cout<<"  settingsFile      : VppSettings xml file, or variable file (.vppIn)"<<std::endl;
+	std::cout<<"Options:"<<std::endl;
+	std::cout<<"  -c sailCoeffFile  : sail coefficient file. Default : built-in coefficients"<<std::endl;
+	std::cout<<"  -o resultFile     : result file. Default : vppResults.vpp"<<std::endl;
+	std::cout<<"  -b                : write the result file in the binary format: lossless, and"<<std::endl;
+	std::cout<<"                      read with no parsing"<<std::endl;
+	std::cout<<"  -x inFile         : convert the result file inFile, text or binary, to the other"<<std::endl;
+	std::cout<<"                      format and write it to the result file. No analysis is run"<<std::endl;
+	std::cout<<"  -t telemetryFile  : write the solver telemetry of each wind point to file"<<std::endl;
+	std::cout<<"  -v targetFile     : solve the optimum beat and run angles of each wind speed"<<std::endl;
+	std::cout<<"                      and write the target speed table to file"<<std::endl;
+	std::cout<<"  -s solver         : nlOpt, nlOptSLSQP, ipOpt, noOpt or saoa. Default : the"<<std::endl;
+	std::cout<<"                      solver of the settings file, nlOpt for a variable file"<<std::endl;
+	std::cout<<"  -j nThreads       : number of threads. Default : 1"<<std::endl;
+	std::cout<<"  -a                : adaptive sampling of the saoa solver: refine the samples"<<std::endl;
+	std::cout<<"                      around the optimum instead of solving the full 5x5 grid"<<std::endl;
+	std::cout<<"  -n                : Hessian of the Lagrangian for the ipOpt solver, by finite"<<std::endl;
+	std::cout<<"                      differences of the AD gradients, rather than the limited-"<<std::endl;
+	std::cout<<"                      memory approximation"<<std::endl;
+	std::cout<<"  -i                : gradient of the objective of ipOpt by the implicit function"<<std::endl;
+	std::cout<<"                      theorem, rather than by finite differences of Newton solves"<<std::endl;
+	std::cout<<"  -w                : warm start ipOpt from the multipliers of the neighbouring"<<std::endl;
+	std::cout<<"                      wind point rather than from cold duals"<<std::endl;
+	std::cout<<"  -k                : evaluate the residuals with the compiled kernel rather"<<std::endl;
+	std::cout<<"                      than with the items. Faster, same results to round-off"<<std::endl;
+	std::cout<<"  -d                : compute the Jacobians by automatic differentiation rather"<<std::endl;
+	std::cout<<"                      than by finite differences"<<std::endl;
+	std::cout<<"  -q                : quasi-Newton NR solver: reuse the Jacobian of the previous"<<std::endl;
+	std::cout<<"                      wind point with Broyden updates instead of computing it"<<std::endl;
+	std::cout<<"                      at each iteration"<<std::endl;
+	std::cout<<"  -r                : relax the warm-start order of the threads. Faster, but"<<std::endl;
+	std::cout<<"                      the results may differ from the serial run"<<std::endl;
+	std::cout<<"  -R tolerance      : once the grid is solved, insert wind angles where the boat"<<std::endl;
+	std::cout<<"                      speed or the VMG interpolated along TWA is off by more than"<<std::endl;
+	std::cout<<"                      tolerance [m/s]. Default : no refinement"<<std::endl;
+	std::cout<<"  -h                : print this message\n"<<std::endl;
+}
+
+// Get the solver choice given its name
+solverChoice getSolver(const string& solverName) {
+
+	if(solverName=="nlOpt")
+		return solverChoice::nlOpt;
+	if(solverName=="ipOpt")
+		return solverChoice::ipOpt;
+	if(solverName=="noOpt")
+		return solverChoice::noOpt;
+	if(solverName=="saoa")
+		return solverChoice::saoa;
+	if(solverName=="nlOptSLSQP")
+		return solverChoice::nlOptSLSQP;
+
+	char msg[256];
+	sprintf(msg,"The value of solver: \"%s\" is not supported",solverName.c_str());
+	throw VPPException(HERE,msg);
+}
+
+// MAIN : run a full VPP analysis from the command line, without
+// instantiating any widget
+int main(int argc, char* argv[]) {
+
+	string sailCoeffFile, resultFile("vppResults.vpp"), solverName, telemetryFile, targetFile, convertFile;
+	size_t nThreads=1;
+	double refineTol=0;
+	bool binary=false, deterministic=true, compiled=false, broyden=false, autoDiff=false, adaptive=false, numericalHessian=false, implicitGradient=false, warmStart=false;
+
+	int opt;
+	while( (opt=getopt(argc,argv,"c:o:t:v:s:j:R:x:abdiknqrwh")) != -1 ) {
+		switch(opt) {
+		case 'c' :
+			sailCoeffFile= optarg;
+			break;
+		case 'o' :
+			resultFile= optarg;
+			break;
+		case 't' :
+			telemetryFile= optarg;
+			break;
+		case 'v' :
+			targetFile= optarg;
+			break;
+		case 's' :
+			solverName= optarg;
+			break;
+		case 'j' : {
+			// Reject anything but a positive integer : a negative value
+			// would wrap to a huge number of threads
+			char* pEnd;
+			long n= strtol(optarg,&pEnd,10);
+			if(pEnd==optarg || *pEnd!='\0' || n<1) {
+				printUsage(argv[0]);
+				return 1;
+			}
+			nThreads= n;
+			break;
+		}
+		case 'R' :
+			refineTol= atof(optarg);
+			break;
+		case 'x' :
+			convertFile= optarg;
+			break;
+		case 'a' :
+			adaptive= true;
+			break;
+		case 'b' :
+			binary= true;
+			break;
+		case 'd' :
+			autoDiff= true;
+			break;
+		case 'i' :
+			implicitGradient= true;
+			break;
+		case 'k' :
+			compiled= true;
+			break;
+		case 'n' :
+			numericalHessian= true;
+			break;
+		case 'q' :
+			broyden= true;
+			break;
+		case 'r' :
+			deterministic= false;
+			break;
+		case 'w' :
+			warmStart= true;
+			break;
+		case 'h' :
+			printUsage(argv[0]);
+			return 0;
+		default:
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if(optind != argc-1) {
+		printUsage(argv[0]);
+		return 1;
+	}
+	string settingsFile(argv[optind]);
+
+	std::cout<<"VPP batch, revision "<<currentRevNumber<<" built "<<buildDate<<std::endl;
+
+	// Set the precision of the output once, before any solver thread starts
+	std::cout.precision(15);
+
+	try {
+
+		// Instantiate a parser and fill it with the variables of the settings
+		// file. The xml settings also specify the solver
+		VariableFileParser parser;
+		solverChoice solver= solverChoice::nlOpt;
+
+		if(settingsFile.size()>4 && settingsFile.substr(settingsFile.size()-4)==".xml") {
+			VPPSettingsXmlParser xmlParser(&parser);
+			xmlParser.parse(settingsFile);
+			solver= xmlParser.getSolver();
+		}
+		else
+			parser.parse(settingsFile);
+
+		if(solverName.size())
+			solver= getSolver(solverName);
+
+		// Verify if the variable values are within the allowed ranges
+		parser.check();
+
+		// print variables
+		parser.print();
+
+		// Instantiate the sailset
+		std::shared_ptr<SailSet> pSails( SailSet::SailSetFactory(parser) );
+
+		// Instantiate the items
+		std::shared_ptr<VPPItemFactory> pVppItems( new VPPItemFactory(&parser,pSails) );
+
+		// The IO containers will parse the coeff file and override the current coeffs
+		if(sailCoeffFile.size()) {
+			SailCoefficientItem* pSailCoeffItem= pVppItems->getSailCoefficientItem();
+			pSailCoeffItem->getClIO()->parse( sailCoeffFile );
+			pSailCoeffItem->getCdIO()->parse( sailCoeffFile );
+
+			// Remember to refresh the spline interpolators with the new coefficient arrays
+			pSailCoeffItem->interpolateCoeffs();
+
+			// The residuals cached so far refer to the old coefficients
+			pVppItems->clearCache();
+		}
+
+		pVppItems->setCompiled(compiled);
+
+		// Convert a result file, without running the analysis
+		if(convertFile.size()) {
+			ResultContainer results(pVppItems->getWind());
+			VPPBinaryResultIO converter(&parser,&results);
+			converter.convert(convertFile,resultFile);
+			return 0;
+		}
+
+		// Instantiate a solver. This can be an optimizer (with opt vars)
+		// or a simple solver that will keep fixed the values of the optimization vars
+		std::shared_ptr<VPPSolverFactoryBase> pSolverFactory;
+		switch(solver){
+		case solverChoice::nlOpt :
+			pSolverFactory.reset( new Optim::NLOptSolverFactory(pVppItems) );
+			break;
+		case solverChoice::ipOpt :
+			{
+				Optim::IpOptSolverFactory* pIpOptFactory= new Optim::IpOptSolverFactory(pVppItems);
+				pIpOptFactory->setNumericalHessian(numericalHessian);
+				pIpOptFactory->get()->setWarmStart(warmStart);
+				if(implicitGradient)
+					pIpOptFactory->get()->setGradientMode(implicitFunctionTheorem);
+				pSolverFactory.reset( pIpOptFactory );
+			}
+			break;
+		case solverChoice::noOpt :
+			pSolverFactory.reset( new Optim::SolverFactory(pVppItems) );
+			break;
+		case solverChoice::saoa :
+			{
+				Optim::SAOASolverFactory* pSAOAFactory= new Optim::SAOASolverFactory(pVppItems);
+				if(adaptive)
+					pSAOAFactory->get()->setSampling(Optim::saoaAdaptive);
+				pSolverFactory.reset( pSAOAFactory );
+			}
+			break;
+		case solverChoice::nlOptSLSQP :
+			pSolverFactory.reset( new Optim::NLOptSLSQPSolverFactory(pVppItems) );
+			break;
+		}
+
+		if(broyden)
+			pSolverFactory->get()->getNRSolver()->setMode(nrBroyden);
+
+		if(autoDiff)
+			pSolverFactory->get()->setJacobianMode(automaticDifferentiation);
+
+		std::cout<<"Running the VPP analysis... "<<std::endl;
+
+		VPPJobRunner(pSolverFactory.get(),
+				parser.get(Var::nta_),
+				parser.get(Var::ntw_),
+				nThreads, deterministic);
+
+		// Refine the wind angles where the polars bend
+		if(refineTol>0) {
+			std::cout<<"Refining the wind angles... "<<std::endl;
+			VPPAngleRefiner(pSolverFactory.get(),refineTol).run();
+		}
+
+		// Make sure the result file can be written before handing it to the writer
+		if(!std::ofstream(resultFile.c_str())) {
+			char msg[256];
+			sprintf(msg,"Cannot write the result file \'%s\'",resultFile.c_str());
+			throw VPPException(HERE,msg);
+		}
+
+		if(binary) {
+			VPPBinaryResultIO writer(&parser, pSolverFactory->get()->getResults());
+			writer.write(resultFile);
+		}
+		else {
+			VPPResultIO writer(&parser, pSolverFactory->get()->getResults());
+			writer.write(resultFile,"w");
+		}
+
+		if(telemetryFile.size())
+			pSolverFactory->get()->exportTelemetry(telemetryFile);
+
+		// Solve the optimum VMG angles from the grid results
+		if(targetFile.size()) {
+			std::cout<<"Solving the target speeds... "<<std::endl;
+			VPPTargetSpeeds targetSpeeds(pSolverFactory.get());
+			targetSpeeds.run();
+			targetSpeeds.write(targetFile);
+		}
+
+	} catch(std::exception& e) {
+		std::cout<<"\n-----------------------------------------"<<std::endl;
+		std::cout<<" Exception caught in Main:  "<<std::endl;
+		std::cout<<" --> "<<e.what()<<std::endl;
+		std::cout<<" The program is terminated. "<<std::endl;
+		std::cout<<"-----------------------------------------\n"<<std::endl;
+		return 1;
+	}	catch(...) {
+		cout << "Unknown Exception occurred\n";
+		return 1;
+	}
+
+	return 0;
+}
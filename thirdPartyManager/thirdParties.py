@@ -561,7 +561,9 @@ class NLOpt( thirdParty ) :
 
 class Qt( thirdParty ) :
 
-    def __init__(self, env):
+    # modules : list of the Qt modules to be enabled, i.e. ['QtCore'].
+    # Default : all the modules of the Qt package
+    def __init__(self, env, modules=None):
         
         # Call mother-class constructor
         super(Qt,self).__init__()
@@ -592,7 +594,10 @@ class Qt( thirdParty ) :
 
         env.Tool('qt5')
 
-        env.EnableQt5Modules( qt.getLibs() )
+        if modules is None:
+            modules= qt.getLibs()
+
+        env.EnableQt5Modules( modules )
         
         self.__includePath__= qt.getIncludePath()
         
@@ -604,7 +609,7 @@ class Qt( thirdParty ) :
 
         # Confuse the frameworks and the libs too (required for 
         # self.__fixFrameworksPath__()
-        self.__frameworks__ = qt.getLibs()
+        self.__frameworks__ = modules
         
         self.__addTo__(env)
         